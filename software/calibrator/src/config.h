@@ -0,0 +1,16 @@
+// ===================================================================================
+// Library Configuration for Joypad Calibrator                                * v1.0 *
+// ===================================================================================
+//
+// Options of the shared drivers in software/lib for this firmware. An option set
+// here replaces the default in the header of its driver (see there), options set
+// on the command line by the makefile replace both. The file is included by
+// system.h and oled_bus.h ahead of their options, so the drivers and the firmware
+// are always built with the same settings.
+//
+// 2023 by Stefan Wagner:   https://github.com/wagiminator
+
+#pragma once
+
+#define LINK_MODE   2     // link cable test with measurement (link.h)
+#define GLYPH_SUBSET 1    // terminal font with the glyphs of src/glyphs.h (glyph.h)
@@ -0,0 +1,67 @@
+// Glyph tables of this firmware for glyph.c, generated by tools/glyph_subset.py
+// from font_5x8.h - do not edit, run "make glyphs" instead
+// 54 of 96 glyphs in 17 runs, 306 instead of 484 bytes:
+// !+-/0123456789>ABCDEFGHIJLNOPRSTUVWacdefiklnoprstuvyz~
+
+#pragma once
+
+#include <stdint.h>
+
+const uint8_t GLYPH_runs[] = { 33, 1, 43, 1, 45, 1, 47, 11, 62, 1, 65, 10, 76, 1, 78, 3, 82, 6, 97, 1, 99, 4, 105, 1, 107, 2, 110, 3, 114, 5, 121, 2, 126, 1, 0, 0 };
+
+const uint8_t GLYPH_font[] = {
+  0x00, 0x00, 0x2F, 0x00, 0x00,  // !
+  0x08, 0x08, 0x3E, 0x08, 0x08,  // +
+  0x08, 0x08, 0x08, 0x08, 0x08,  // -
+  0x20, 0x10, 0x08, 0x04, 0x02,  // /
+  0x3E, 0x51, 0x49, 0x45, 0x3E,  // 0
+  0x00, 0x42, 0x7F, 0x40, 0x00,  // 1
+  0x42, 0x61, 0x51, 0x49, 0x46,  // 2
+  0x21, 0x41, 0x45, 0x4B, 0x31,  // 3
+  0x18, 0x14, 0x12, 0x7F, 0x10,  // 4
+  0x27, 0x45, 0x45, 0x45, 0x39,  // 5
+  0x3C, 0x4A, 0x49, 0x49, 0x30,  // 6
+  0x01, 0x71, 0x09, 0x05, 0x03,  // 7
+  0x36, 0x49, 0x49, 0x49, 0x36,  // 8
+  0x06, 0x49, 0x49, 0x29, 0x1E,  // 9
+  0x00, 0x41, 0x22, 0x14, 0x08,  // >
+  0x7C, 0x12, 0x11, 0x12, 0x7C,  // A
+  0x7F, 0x49, 0x49, 0x49, 0x36,  // B
+  0x3E, 0x41, 0x41, 0x41, 0x22,  // C
+  0x7F, 0x41, 0x41, 0x22, 0x1C,  // D
+  0x7F, 0x49, 0x49, 0x49, 0x41,  // E
+  0x7F, 0x09, 0x09, 0x09, 0x01,  // F
+  0x3E, 0x41, 0x49, 0x49, 0x7A,  // G
+  0x7F, 0x08, 0x08, 0x08, 0x7F,  // H
+  0x00, 0x41, 0x7F, 0x41, 0x00,  // I
+  0x20, 0x40, 0x41, 0x3F, 0x01,  // J
+  0x7F, 0x40, 0x40, 0x40, 0x40,  // L
+  0x7F, 0x04, 0x08, 0x10, 0x7F,  // N
+  0x3E, 0x41, 0x41, 0x41, 0x3E,  // O
+  0x7F, 0x09, 0x09, 0x09, 0x06,  // P
+  0x7F, 0x09, 0x19, 0x29, 0x46,  // R
+  0x46, 0x49, 0x49, 0x49, 0x31,  // S
+  0x01, 0x01, 0x7F, 0x01, 0x01,  // T
+  0x3F, 0x40, 0x40, 0x40, 0x3F,  // U
+  0x1F, 0x20, 0x40, 0x20, 0x1F,  // V
+  0x3F, 0x40, 0x38, 0x40, 0x3F,  // W
+  0x20, 0x54, 0x54, 0x54, 0x78,  // a
+  0x38, 0x44, 0x44, 0x44, 0x20,  // c
+  0x38, 0x44, 0x44, 0x48, 0x7F,  // d
+  0x38, 0x54, 0x54, 0x54, 0x18,  // e
+  0x08, 0x7E, 0x09, 0x01, 0x02,  // f
+  0x00, 0x44, 0x7D, 0x40, 0x00,  // i
+  0x7F, 0x10, 0x28, 0x44, 0x00,  // k
+  0x00, 0x41, 0x7F, 0x40, 0x00,  // l
+  0x7C, 0x08, 0x04, 0x04, 0x78,  // n
+  0x38, 0x44, 0x44, 0x44, 0x38,  // o
+  0xFC, 0x24, 0x24, 0x24, 0x18,  // p
+  0x7C, 0x08, 0x04, 0x04, 0x08,  // r
+  0x48, 0x54, 0x54, 0x54, 0x20,  // s
+  0x04, 0x3F, 0x44, 0x40, 0x20,  // t
+  0x3C, 0x40, 0x40, 0x20, 0x7C,  // u
+  0x1C, 0x20, 0x40, 0x20, 0x1C,  // v
+  0x1C, 0xA0, 0xA0, 0xA0, 0x7C,  // y
+  0x44, 0x64, 0x54, 0x4C, 0x44,  // z
+  0x08, 0x04, 0x08, 0x10, 0x08,  // ~
+};
@@ -1,6 +1,6 @@
 // ===================================================================================
 // Project:   Joypad Calibrator
-// Version:   v1.0
+// Version:   v1.3
 // Year:      2023
 // Author:    Stefan Wagner
 // Github:    https://github.com/wagiminator
@@ -10,12 +10,228 @@
 //
 // Description:
 // ------------
-// Prints ADC-values of joypad-buttons on OLED for calibration.
+// Tunes the I2C clock of the display, calibrates the joypad and prints ADC-values
+// of joypad-buttons on OLED.
+//
+// At start the I2C clock is raised one step of its divider at a time (from
+// I2C_CLKRATE up to I2C_RATE_MAX). At each step the display has to acknowledge
+// its address and every byte of CLK_BURSTS bursts of NOP commands. The first
+// step that fails (a byte not acknowledged or the bus stuck, which the bus
+// recovery frees again) ends the search. The highest rate passed less CLK_MARGIN
+// percent is saved in the flash key-value store (KV_KEY_I2CCLK), where the games
+// read it at boot (JOY_BUS_CAL in joypad.h).
+//
+// Hold each direction when asked: while it is held, the pad is sampled at a high
+// rate (ADC_fast()) into a histogram around the first sample. The median of the
+// histogram is the centre of the band, the samples outside the CAL_TAIL share at
+// either end give the noise. The deviation is the largest one that keeps the
+// bands apart and above the released range. If it leaves room for the noise,
+// the calibration is saved in the flash key-value store (KV_KEY_PADCAL), where
+// the games read it at boot (JOY_PAD_CAL in joypad.h). Pressing the fire
+// button instead of a direction skips the calibration.
+//
+// Note that a chip erase clears the store, so the calibration only survives if
+// the games are flashed without one.
+//
+// Afterwards the fire button starts the link cable test with a second console
+// that runs the calibrator as well (see link.h): the consoles exchange inputs
+// in lockstep at the tick rate of the games, once a second the link statistics
+// are shown: round trip min/avg/max on side 0, the spread of the time between
+// the packets of side 0 (jitter) on side 1, and the longest wait for the peer.
 
 // ===================================================================================
 // Libraries, Definitions and Macros
 // ===================================================================================
 #include <driver.h>           // TinyJoypad conversion driver
+#include "flash_kv.h"         // key-value store in flash
+#include "link.h"             // link cable play over USART1
+
+#define CAL_SAMPLES   4096    // samples per direction
+#define CAL_BINS      64      // histogram window in ADC counts
+#define CAL_TAIL      41      // samples dropped as outliers at either end (1%)
+#define CAL_MARGIN    2       // counts to keep between the noise and a band edge
+#define CAL_RELEASED  10      // highest ADC value of the released pad
+#define CLK_BURSTS    64      // command bursts per I2C clock step
+#define CLK_BURST_LEN 32      // NOP commands per burst
+#define CLK_MARGIN    20      // percent the saved rate stays below the highest passed
+#define LINK_TICK_US  2000    // tick period of the link test (as Tiny Tris)
+#define LINK_REPORT   500     // ticks between two reports
+
+// Directions in ascending order of their ADC values (as in the games' JOY_BAND)
+const char* const CAL_NAME[] = {
+  "RIGHT", "UP", "UP+RIGHT", "DOWN", "DOWN+RIGHT", "LEFT", "UP+LEFT", "DOWN+LEFT"
+};
+
+uint16_t CAL_hist[CAL_BINS];  // samples per ADC count above CAL_base
+uint16_t CAL_base;
+uint16_t CAL_centre[8];       // band centres
+uint8_t  CAL_noise[8];        // largest distance of a sample from its centre
+
+// ===================================================================================
+// I2C Clock Tuning
+// ===================================================================================
+
+// Send the bursts at the current rate, returns 0 if a byte wasn't acknowledged
+uint8_t CLK_check(void) {
+  uint8_t cmd[CLK_BURST_LEN + 1];
+  uint8_t i;
+  cmd[0] = OLED_CMD_MODE;
+  for(i=1; i<=CLK_BURST_LEN; i++) cmd[i] = 0xE3;  // NOP
+  for(i=0; i<CLK_BURSTS; i++) if(!I2C_probe(OLED_ADDR, cmd, sizeof(cmd))) return 0;
+  return 1;
+}
+
+// Find the highest rate the display takes, save it less the margin
+void CLK_tune(void) {
+  uint32_t best = I2C_CLKRATE, rate;
+  uint16_t div, khz, old;
+  uint8_t  c[KV_I2CCLK_LEN];
+  for(div = CLK_freq() / (3 * I2C_CLKRATE) - 1; div; div--) {
+    rate = (CLK_freq() + 3 * div - 1) / (3 * div);  // lowest rate with this divider
+    if(rate > I2C_RATE_MAX) break;
+    I2C_setRate(rate);
+    if(!CLK_check()) break;
+    best = rate;
+  }
+  if(I2C_error) I2C_recover();                      // (back at I2C_CLKRATE)
+  rate = best - best / 100 * CLK_MARGIN;
+  if(rate < I2C_CLKRATE) rate = I2C_CLKRATE;
+  I2C_setRate(rate);
+  OLED_init();                                      // (a failed burst may have
+  khz = rate / 1000;                                //  garbled the settings)
+  OLED_print("I2C "); OLED_printD(best / 1000);
+  OLED_print(" -> "); OLED_printD(khz); OLED_print("kHz");
+  old = (KV_get(KV_KEY_I2CCLK, c, KV_I2CCLK_LEN) == KV_I2CCLK_LEN) ? c[0] | (uint16_t)c[1] << 8 : 0;
+  if(khz != old) {
+    c[0] = khz;
+    c[1] = khz >> 8;
+    KV_set(KV_KEY_I2CCLK, c, KV_I2CCLK_LEN);
+    KV_sync();
+    OLED_print(" saved");
+  }
+  OLED_newline();
+}
+
+// ===================================================================================
+// Calibration Functions
+// ===================================================================================
+
+// Sample the held direction d, returns 0 if the pad didn't stay in the window
+uint8_t CAL_sample(uint8_t d) {
+  uint16_t i, n = 0, v, sum, lo = 0, hi = 0, mid = 0;
+  for(i=0; i<CAL_BINS; i++) CAL_hist[i] = 0;
+  v = ADC_read();
+  CAL_base = (v > CAL_BINS / 2) ? v - CAL_BINS / 2 : 0;
+  for(i=0; i<CAL_SAMPLES; i++) {
+    v = ADC_read() - CAL_base;              // (below CAL_base: wraps out of the window)
+    if(v < CAL_BINS) {
+      CAL_hist[v]++;
+      n++;
+    }
+  }
+  if(n < CAL_SAMPLES - CAL_TAIL) return 0;
+  for(i=0, sum=0; i<CAL_BINS; i++) {        // percentiles from the running sum
+    if(sum <= CAL_TAIL) lo = i;
+    sum += CAL_hist[i];
+    if(sum <= (n >> 1)) mid = i + 1;
+    if(sum <  n - CAL_TAIL) hi = i + 1;
+  }
+  CAL_centre[d] = CAL_base + mid;
+  CAL_noise[d]  = (mid - lo > hi - mid) ? mid - lo : hi - mid;
+  return 1;
+}
+
+// Ask for each direction and sample it, returns 0 if skipped
+uint8_t CAL_measure(void) {
+  uint8_t d = 0;
+  ADC_fast();
+  while(d < 8) {
+    OLED_print("Hold "); OLED_print((char*)CAL_NAME[d]); OLED_flush();
+    while(ADC_read() <= CAL_RELEASED) if(JOY_act_pressed()) {
+      OLED_println(" - skip");
+      ADC_slow();
+      return 0;
+    }
+    DLY_ms(200);                            // let the contact settle
+    if(CAL_sample(d)) {
+      OLED_write(' '); OLED_printD(CAL_centre[d]);
+      OLED_write('~'); OLED_printD(CAL_noise[d]);
+      d++;
+    }
+    else OLED_print(" unsteady");
+    OLED_newline();
+    while(ADC_read() > CAL_RELEASED);
+    DLY_ms(200);
+  }
+  ADC_slow();
+  return 1;
+}
+
+// Derive the deviation and save the calibration, returns 0 if it doesn't fit
+uint8_t CAL_save(void) {
+  uint8_t  c[KV_PADCAL_LEN] = {0};
+  uint16_t dev;
+  uint8_t  d, noise = 0;
+  if(CAL_centre[0] <= CAL_RELEASED + 1) return 0;
+  dev = CAL_centre[0] - CAL_RELEASED - 1;           // keep above released
+  for(d=0; d<8; d++) {
+    if(d) {
+      if(CAL_centre[d] <= CAL_centre[d-1]) return 0;  // out of order
+      uint16_t half = (CAL_centre[d] - CAL_centre[d-1] - 1) >> 1;
+      if(half < dev) dev = half;
+    }
+    if(CAL_noise[d] > noise) noise = CAL_noise[d];
+    c[d] = CAL_centre[d];
+    c[8 + (d >> 2)] |= (CAL_centre[d] >> 8) << ((d & 3) << 1);
+  }
+  if(dev > 255) dev = 255;
+  OLED_print("DEV "); OLED_printD(dev);
+  OLED_print(" NOISE "); OLED_printD(noise); OLED_newline();
+  if(dev < noise + CAL_MARGIN) return 0;
+  c[KV_PADCAL_LEN - 1] = dev;
+  KV_set(KV_KEY_PADCAL, c, KV_PADCAL_LEN);
+  KV_sync();
+  return 1;
+}
+
+// ===================================================================================
+// Link Cable Test
+// ===================================================================================
+
+// Run the link test until the link is lost or the fire button is pressed again
+void LINK_test(void) {
+  uint16_t seed = 0xACE1;
+  uint32_t next;
+  while(JOY_act_pressed());
+  OLED_print("Link ");
+  OLED_flush();
+  LINK_init();
+  if(!LINK_start(&seed)) {
+    OLED_println("- no peer");
+    return;
+  }
+  OLED_println(LINK_side ? "side 1" : "side 0");
+  next = STK->CNT;
+  while(LINK_on) {
+    if(JOY_act_pressed()) LINK_stop();
+    next += LINK_TICK_US * DLY_US_TIME;
+    while((int32_t)(STK->CNT - next) < 0);
+    if(LINK_tick(JOY_act_pressed() ? LINK_ACT : 0, 0)) next = STK->CNT;
+    if(LINK_stat.ticks < LINK_REPORT) continue;
+    if(LINK_side) {
+      OLED_print("JIT "); OLED_printD(LINK_stat.gap_max - LINK_stat.gap_min);
+    }
+    else {
+      OLED_print("RTT "); OLED_printD(LINK_stat.rtt_min);
+      OLED_write('/'); OLED_printD(LINK_stat.rtt_sum / LINK_stat.ticks);
+      OLED_write('/'); OLED_printD(LINK_stat.rtt_max);
+    }
+    OLED_print(" W "); OLED_printD(LINK_stat.wait_max); OLED_newline();
+    LINK_stat_reset();
+  }
+  OLED_println("Link off");
+  while(JOY_act_pressed());
+}
 
 // ===================================================================================
 // Main Function
@@ -23,10 +239,18 @@
 int main(void) {
   // Setup
   JOY_init();
+  KV_init();
+
+  // Tune the display bus
+  CLK_tune();
+
+  // Calibrate
+  if(CAL_measure()) OLED_println(CAL_save() ? "Saved" : "Bands too close!");
 
   // Loop
   while(1) {
     OLED_printD(ADC_read()); OLED_write('\n');
     DLY_ms(500);
+    if(JOY_act_pressed()) LINK_test();
   }
 }
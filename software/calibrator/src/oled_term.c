@@ -1,5 +1,5 @@
 // ===================================================================================
-// SSD1306 128x64 Pixels OLED Terminal Functions                              * v1.0 *
+// SSD1306 128x64 Pixels OLED Terminal Functions                              * v1.2 *
 // ===================================================================================
 //
 // Collection of the most necessary functions for controlling an SSD1306 128x64 pixels
@@ -17,42 +17,7 @@
 // 2022 by Stefan Wagner: https://github.com/wagiminator
 
 #include "oled_term.h"
-
-// Standard ASCII 5x8 font (adapted from Neven Boyanov and Stephen Denne)
-const uint8_t OLED_FONT[] = {
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x2F, 0x00, 0x00, 0x00, 0x07, 0x00, 0x07, 0x00,
-  0x14, 0x7F, 0x14, 0x7F, 0x14, 0x24, 0x2A, 0x7F, 0x2A, 0x12, 0x23, 0x13, 0x08, 0x64, 0x62,
-  0x36, 0x49, 0x55, 0x22, 0x50, 0x00, 0x05, 0x03, 0x00, 0x00, 0x00, 0x1C, 0x22, 0x41, 0x00,
-  0x00, 0x41, 0x22, 0x1C, 0x00, 0x14, 0x08, 0x3E, 0x08, 0x14, 0x08, 0x08, 0x3E, 0x08, 0x08,
-  0x00, 0x00, 0xA0, 0x60, 0x00, 0x08, 0x08, 0x08, 0x08, 0x08, 0x00, 0x60, 0x60, 0x00, 0x00,
-  0x20, 0x10, 0x08, 0x04, 0x02, 0x3E, 0x51, 0x49, 0x45, 0x3E, 0x00, 0x42, 0x7F, 0x40, 0x00,
-  0x42, 0x61, 0x51, 0x49, 0x46, 0x21, 0x41, 0x45, 0x4B, 0x31, 0x18, 0x14, 0x12, 0x7F, 0x10,
-  0x27, 0x45, 0x45, 0x45, 0x39, 0x3C, 0x4A, 0x49, 0x49, 0x30, 0x01, 0x71, 0x09, 0x05, 0x03,
-  0x36, 0x49, 0x49, 0x49, 0x36, 0x06, 0x49, 0x49, 0x29, 0x1E, 0x00, 0x36, 0x36, 0x00, 0x00,
-  0x00, 0x56, 0x36, 0x00, 0x00, 0x08, 0x14, 0x22, 0x41, 0x00, 0x14, 0x14, 0x14, 0x14, 0x14,
-  0x00, 0x41, 0x22, 0x14, 0x08, 0x02, 0x01, 0x51, 0x09, 0x06, 0x32, 0x49, 0x59, 0x51, 0x3E,
-  0x7C, 0x12, 0x11, 0x12, 0x7C, 0x7F, 0x49, 0x49, 0x49, 0x36, 0x3E, 0x41, 0x41, 0x41, 0x22,
-  0x7F, 0x41, 0x41, 0x22, 0x1C, 0x7F, 0x49, 0x49, 0x49, 0x41, 0x7F, 0x09, 0x09, 0x09, 0x01,
-  0x3E, 0x41, 0x49, 0x49, 0x7A, 0x7F, 0x08, 0x08, 0x08, 0x7F, 0x00, 0x41, 0x7F, 0x41, 0x00,
-  0x20, 0x40, 0x41, 0x3F, 0x01, 0x7F, 0x08, 0x14, 0x22, 0x41, 0x7F, 0x40, 0x40, 0x40, 0x40,
-  0x7F, 0x02, 0x0C, 0x02, 0x7F, 0x7F, 0x04, 0x08, 0x10, 0x7F, 0x3E, 0x41, 0x41, 0x41, 0x3E,
-  0x7F, 0x09, 0x09, 0x09, 0x06, 0x3E, 0x41, 0x51, 0x21, 0x5E, 0x7F, 0x09, 0x19, 0x29, 0x46,
-  0x46, 0x49, 0x49, 0x49, 0x31, 0x01, 0x01, 0x7F, 0x01, 0x01, 0x3F, 0x40, 0x40, 0x40, 0x3F,
-  0x1F, 0x20, 0x40, 0x20, 0x1F, 0x3F, 0x40, 0x38, 0x40, 0x3F, 0x63, 0x14, 0x08, 0x14, 0x63,
-  0x07, 0x08, 0x70, 0x08, 0x07, 0x61, 0x51, 0x49, 0x45, 0x43, 0x00, 0x7F, 0x41, 0x41, 0x00,
-  0x02, 0x04, 0x08, 0x10, 0x20, 0x00, 0x41, 0x41, 0x7F, 0x00, 0x04, 0x02, 0x01, 0x02, 0x04,
-  0x40, 0x40, 0x40, 0x40, 0x40, 0x00, 0x01, 0x02, 0x04, 0x00, 0x20, 0x54, 0x54, 0x54, 0x78,
-  0x7F, 0x48, 0x44, 0x44, 0x38, 0x38, 0x44, 0x44, 0x44, 0x20, 0x38, 0x44, 0x44, 0x48, 0x7F,
-  0x38, 0x54, 0x54, 0x54, 0x18, 0x08, 0x7E, 0x09, 0x01, 0x02, 0x18, 0xA4, 0xA4, 0xA4, 0x7C,
-  0x7F, 0x08, 0x04, 0x04, 0x78, 0x00, 0x44, 0x7D, 0x40, 0x00, 0x40, 0x80, 0x84, 0x7D, 0x00,
-  0x7F, 0x10, 0x28, 0x44, 0x00, 0x00, 0x41, 0x7F, 0x40, 0x00, 0x7C, 0x04, 0x18, 0x04, 0x78,
-  0x7C, 0x08, 0x04, 0x04, 0x78, 0x38, 0x44, 0x44, 0x44, 0x38, 0xFC, 0x24, 0x24, 0x24, 0x18,
-  0x18, 0x24, 0x24, 0x18, 0xFC, 0x7C, 0x08, 0x04, 0x04, 0x08, 0x48, 0x54, 0x54, 0x54, 0x20,
-  0x04, 0x3F, 0x44, 0x40, 0x20, 0x3C, 0x40, 0x40, 0x20, 0x7C, 0x1C, 0x20, 0x40, 0x20, 0x1C,
-  0x3C, 0x40, 0x30, 0x40, 0x3C, 0x44, 0x28, 0x10, 0x28, 0x44, 0x1C, 0xA0, 0xA0, 0xA0, 0x7C,
-  0x44, 0x64, 0x54, 0x4C, 0x44, 0x08, 0x36, 0x41, 0x41, 0x00, 0x00, 0x00, 0x7F, 0x00, 0x00,
-  0x00, 0x41, 0x41, 0x36, 0x08, 0x08, 0x04, 0x08, 0x10, 0x08, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
-};
+#include "glyph.h"
 
 // OLED initialisation sequence
 const uint8_t OLED_INIT_CMD[] = {
@@ -67,6 +32,12 @@ const uint8_t OLED_INIT_CMD[] = {
 // OLED global variables
 uint8_t line, column, scroll;
 
+#if OLED_LINEBUF > 0
+uint8_t  OLED_buf[128];                   // columns of the current line
+uint8_t  OLED_from;                       // first character of it not sent yet
+uint16_t OLED_ticket;                     // last transfer from OLED_buf
+#endif
+
 // OLED set cursor to line start
 void OLED_setline(uint8_t line) {
   I2C_start(OLED_ADDR);                   // start transmission to OLED
@@ -82,8 +53,15 @@ void OLED_clearline(uint8_t line) {
   OLED_setline(line);                     // set cursor to line start
   I2C_start(OLED_ADDR);                   // start transmission to OLED
   I2C_write(OLED_DAT_MODE);               // set data mode
+  #if OLED_LINEBUF > 0
+  I2C_wait(OLED_ticket);                  // buffer free again?
+  for(i=0; i<128; i++) OLED_buf[i] = 0x00;
+  I2C_writeBuffer(OLED_buf, 128);         // clear the line in one transfer
+  OLED_ticket = I2C_fence();
+  #else
   for(i=128; i; i--) I2C_write(0x00);     // clear the line
   I2C_stop();                             // stop transmission
+  #endif
 }
 
 // OLED clear screen
@@ -92,6 +70,9 @@ void OLED_clear(void) {
   for(i=0; i<8; i++) OLED_clearline(i);
   line = scroll;
   column = 0;
+  #if OLED_LINEBUF > 0
+  OLED_from = 0;
+  #endif
   OLED_setline((line + scroll) & 0x07);
 }
 
@@ -119,43 +100,71 @@ void OLED_init(void) {
   OLED_clear();                           // clear screen
 }
 
+#if OLED_LINEBUF > 0
+
+// OLED put a single character into the line buffer
+void OLED_plotChar(char c) {
+  if(!column) I2C_wait(OLED_ticket);      // line start: last line sent?
+  GLYPH_put(&OLED_buf[(column << 2) + (column << 1)], c);   // -> column * 6
+}
+
+// OLED send the characters of the line not sent yet (the cursor of the OLED
+// is already behind the ones sent before)
+void OLED_flush(void) {
+  uint8_t from = (OLED_from << 2) + (OLED_from << 1);
+  if(column <= OLED_from) return;
+  I2C_start(OLED_ADDR);                   // start transmission to OLED
+  I2C_write(OLED_DAT_MODE);               // set data mode
+  I2C_writeBuffer(&OLED_buf[from], (column << 2) + (column << 1) - from);
+  OLED_ticket = I2C_fence();
+  OLED_from = column;
+}
+
+#else
+
 // OLED plot a single character
 void OLED_plotChar(char c) {
   uint8_t i;
-  uint16_t ptr = c - 32;                  // character pointer
-  ptr += ptr << 2;                        // -> ptr = (ch - 32) * 5;
+  const uint8_t* g = GLYPH_get(c);        // glyph (0: blank)
   I2C_start(OLED_ADDR);                   // start transmission to OLED
   I2C_write(OLED_DAT_MODE);               // set data mode
-  for(i=5 ; i; i--) I2C_write(OLED_FONT[ptr++]);
+  for(i=5 ; i; i--) I2C_write(g ? *g++ : 0x00);
   I2C_write(0x00);                        // write space between characters
   I2C_stop();                             // stop transmission
 }
 
+#endif
+
+// OLED set cursor to the start of the current line
+void OLED_return(void) {
+  OLED_flush();
+  column = 0;
+  #if OLED_LINEBUF > 0
+  OLED_from = 0;
+  #endif
+  OLED_setline((line + scroll) & 0x07);
+}
+
+// OLED set cursor to the start of the next line, scroll at the bottom
+void OLED_linefeed(void) {
+  OLED_flush();
+  if(line == 7) OLED_scrollDisplay();
+  else line++;
+  OLED_return();
+}
+
 // OLED write a character or handle control characters
 void OLED_write(char c) {
   c = c & 0x7F;                           // ignore top bit
   // normal character
   if(c >= 32) {
     OLED_plotChar(c);
-    if(++column > 20) {
-      column = 0;
-      if(line == 7) OLED_scrollDisplay();
-      else line++;
-      OLED_setline((line + scroll) & 0x07);
-    }
+    if(++column > 20) OLED_linefeed();
   }
   // new line
-  else if(c == '\n') {
-    column = 0;
-    if(line == 7) OLED_scrollDisplay();
-    else line++;
-    OLED_setline((line + scroll) & 0x07);
-  }
+  else if(c == '\n') OLED_linefeed();
   // carriage return
-  else if(c == '\r') {
-    column = 0;
-    OLED_setline((line + scroll) & 0x07);
-  }
+  else if(c == '\r') OLED_return();
 }
 
 // OLED print string
@@ -169,25 +178,28 @@ void OLED_println(char* str) {
   OLED_write('\n');
 }
 
-// For BCD conversion
-const uint32_t DIVIDER[] = {1, 10, 100, 1000, 10000, 100000, 1000000,
-                            10000000, 100000000, 1000000000};
+// Unsigned division by 10 without a divide (shift-add reciprocal, exact for
+// the full 32-bit range, Hacker's Delight chapter 10)
+uint32_t OLED_div10(uint32_t n) {
+  uint32_t q = (n >> 1) + (n >> 2);
+  q += q >> 4;
+  q += q >> 8;
+  q += q >> 16;
+  q >>= 3;
+  uint32_t r = n - (((q << 2) + q) << 1);
+  return q + (r > 9);
+}
 
-// Print decimal value (BCD conversion by substraction method)
+// Print decimal value (digits split off by division-free divide by 10)
 void OLED_printD(uint32_t value) {
-  uint8_t digits   = 10;                          // print 10 digits
-  uint8_t leadflag = 0;                           // flag for leading spaces
-  while(digits--) {                               // for all digits
-    uint8_t digitval = 0;                         // start with digit value 0
-    uint32_t divider = DIVIDER[digits];           // read current divider
-    while(value >= divider) {                     // if current divider fits into the value
-      leadflag = 1;                               // end of leading spaces
-      digitval++;                                 // increase digit value
-      value -= divider;                           // decrease value by divider
-    }
-    if(!digits)  leadflag++;                      // least digit has to be printed
-    if(leadflag) OLED_write(digitval + '0');      // print the digit
-  }
+  char    digit[10];                              // up to 10 digits
+  uint8_t n = 0;
+  do {
+    uint32_t q = OLED_div10(value);
+    digit[n++] = '0' + value - (((q << 2) + q) << 1);
+    value = q;
+  } while(value);
+  while(n) OLED_write(digit[--n]);                // most significant first
 }
 
 // Convert byte nibble into hex character and print it
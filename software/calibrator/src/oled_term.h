@@ -1,10 +1,19 @@
 // ===================================================================================
-// SSD1306 128x64 Pixels OLED Terminal Functions                              * v1.0 *
+// SSD1306 128x64 Pixels OLED Terminal Functions                              * v1.2 *
 // ===================================================================================
 //
 // Collection of the most necessary functions for controlling an SSD1306 128x64 pixels
 // I2C OLED for the display of text in the context of emulating a terminal output.
 //
+// With OLED_LINEBUF the characters of a line are collected in a RAM buffer and
+// sent in one transfer (via DMA if enabled in i2c_tx.h) when the line ends by a
+// newline, carriage return or wrap, or when OLED_flush() is called. Text that
+// doesn't end its line only shows up on the next OLED_flush(). Without it every
+// character is sent in a transfer of its own right away.
+//
+// The characters are rendered by glyph.c, with the glyphs of src/glyphs.h only
+// (GLYPH_SUBSET in config.h, "make glyphs" after changing the texts).
+//
 // Functions available:
 // --------------------
 // OLED_init()              Init OLED display
@@ -18,6 +27,7 @@
 // OLED_printW(n)           Print hex word value
 // OLED_printB(n)           Print hex byte value
 // OLED_newline()           Print newline
+// OLED_flush()             Send the characters of the line not shown yet
 //
 // References:
 // -----------
@@ -38,6 +48,9 @@ extern "C" {
 
 #include "i2c_tx.h"
 
+// OLED parameters
+#define OLED_LINEBUF      1       // 0: send every character, 1: send whole lines
+
 // OLED definitions
 #define OLED_ADDR         0x78    // OLED write address (0x3C << 1)
 #define OLED_CMD_MODE     0x00    // set command mode
@@ -78,6 +91,12 @@ void OLED_printB(uint8_t value);  // print hex byte value
 #define OLED_newline() OLED_write('\n')   // print newline
 #define OLED_printS OLED_print            // alias
 
+#if OLED_LINEBUF > 0
+void OLED_flush(void);            // send the buffered characters of the line
+#else
+  #define OLED_flush()
+#endif
+
 #ifdef __cplusplus
 };
 #endif
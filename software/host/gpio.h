@@ -0,0 +1,64 @@
+// ===================================================================================
+// Host Simulator: GPIO and ADC Functions                                     * v1.1 *
+// ===================================================================================
+//
+// Stands in for gpio.h in host builds. Pin setup is ignored, reading the fire
+// button and the joypad ADC returns the state of the input script (see sim.c).
+// The supply voltage is the one set with "-b" (fresh cell by default).
+// Every read takes 1us of virtual time, so loops that wait for a button don't
+// stall the clock.
+//
+// 2023 by Stefan Wagner:   https://github.com/wagiminator
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "system.h"
+
+enum{ PA0, PA1, PA2, PA3, PA4, PA5, PA6, PA7,
+      PC0, PC1, PC2, PC3, PC4, PC5, PC6, PC7,
+      PD0, PD1, PD2, PD3, PD4, PD5, PD6, PD7};
+
+enum{PIN_INT_OFF, PIN_INT_RISING, PIN_INT_FALLING, PIN_INT_BOTH};
+
+uint8_t  SIM_pin_read(uint8_t pin);
+uint16_t SIM_adc_read(void);
+void     SIM_adc_dma(volatile uint16_t* buf, uint16_t len);
+extern uint16_t SIM_vdd;
+
+#define PIN_input(PIN)            ((void)(PIN))
+#define PIN_input_PU(PIN)         ((void)(PIN))
+#define PIN_input_PD(PIN)         ((void)(PIN))
+#define PIN_input_AN(PIN)         ((void)(PIN))
+#define PIN_output(PIN)           ((void)(PIN))
+#define PIN_alternate(PIN)        ((void)(PIN))
+#define PIN_low(PIN)              ((void)(PIN))
+#define PIN_high(PIN)             ((void)(PIN))
+#define PIN_toggle(PIN)           ((void)(PIN))
+#define PIN_write(PIN, val)       ((void)(PIN), (void)(val))
+#define PIN_read(PIN)             SIM_pin_read(PIN)
+
+#define PIN_INT_set(PIN, TYPE)    ((void)(PIN), (void)(TYPE))
+#define PIN_INT_enable()
+#define PIN_INT_disable()
+#define PIN_INTFLAG_read(PIN)     0
+#define PIN_INTFLAG_clear(PIN)    ((void)(PIN))
+#define PIN_INT_ISR               void SIM_pin_isr(void)
+
+#define ADC_init()
+#define ADC_input(PIN)            ((void)(PIN))
+#define ADC_slow()
+#define ADC_fast()
+#define ADC_read()                SIM_adc_read()
+#define ADC_DMA_start(buf, len)   SIM_adc_dma(buf, len)
+#define ADC_VDD_init()
+#define ADC_VDD_start()
+#define ADC_VDD_done()            1
+#define ADC_VDD_get()             SIM_vdd
+
+#ifdef __cplusplus
+};
+#endif
@@ -0,0 +1,35 @@
+// ===================================================================================
+// Host Simulator: Profiler Hooks                                             * v1.0 *
+// ===================================================================================
+//
+// Stands in for prof.h in host builds. The hooks of the frame profiler feed the
+// statistics of the simulator instead: PROF_begin(PROF_COMPOSE) counts
+// compositor calls, PROF_frame() ends a tick.
+//
+// 2023 by Stefan Wagner:   https://github.com/wagiminator
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "system.h"
+
+#define PROF_ENABLE   0           // (the target profiler is not built)
+
+enum {PROF_LOGIC, PROF_INPUT, PROF_COMPOSE, PROF_I2C, PROF_SOUND, PROF_IDLE, PROF_PHASES};
+
+void SIM_phase(uint8_t phase);
+void SIM_frame(uint8_t rendered);
+
+#define PROF_begin(phase)         SIM_phase(phase)
+#define PROF_end()
+#define PROF_IRQ_BEGIN()
+#define PROF_IRQ_END(phase)
+#define PROF_frame(rendered)      SIM_frame(rendered)
+#define PROF_overlay(buf, x0, x1, y)
+
+#ifdef __cplusplus
+};
+#endif
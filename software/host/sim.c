@@ -0,0 +1,626 @@
+// ===================================================================================
+// Host Simulator for the Games                                               * v1.0 *
+// ===================================================================================
+//
+// "make host" in a game folder builds the unchanged game sources for the PC,
+// with system.h, gpio.h and prof.h of this folder instead of the target ones and
+// this file instead of the I2C driver. The OLED bytes go into an emulated SSD1306
+// with its 128x64 pixels display RAM, the buttons come from an input script.
+// Virtual time passes on delays and waits, with every I2C byte (22.5us at 400kHz)
+// and with every button or joypad read (1us). The horizontal scroll of the
+// SSD1306 moves the display RAM as well, the continuous one at SIM_OLED_HZ
+// display frames per second.
+//
+// Usage: bin/<game>_sim [options]
+//   -i file     input script, lines of "<ms> <keys>" hold keys for ms milliseconds
+//               (keys: any of U D L R A, or - for none; # starts a comment)
+//   -n ticks    stop after this many game loop ticks (default 1000)
+//   -t ms       stop after this much virtual time (default 600000)
+//   -p file     write the screen as PBM image at the end
+//   -r file     replay an input recording (see replay.h) instead of the script
+//   -u file     write the bytes sent via UART (telemetry, recording) to a file
+//   -f file     capture every new screen content into a frames file
+//   -k file     flash pages of the key-value store (flash_kv.h) and of the game
+//               snapshot (snapshot.h): loaded at the start if the file exists
+//               (erased otherwise), saved at the end. A software reset ends the
+//               simulation, so a game suspended with "-k" resumes in the next run
+//   -e file     image of the I2C EEPROM (asset.h, made by tools/asset_pack.py),
+//               read by I2C_read() at device address 0xA0; without it there is
+//               no EEPROM on the bus
+//   -b mV       supply voltage seen by the battery governor (battery.h), default
+//               3300 (fresh cell)
+//   -v          print one line per rendered frame
+//
+// At the end a summary with the compositor calls (PROF_begin(PROF_COMPOSE)) and
+// I2C bytes per rendered frame and the simulation speed is printed. The CRC-32 of
+// the display RAM (per frame with -v, and at the end) tells whether two builds
+// show exactly the same pixels.
+//
+// A frames file holds one entry of u32 tick (little-endian) and the 1024 bytes of
+// the display RAM (page by page) for every screen content, taken whenever the
+// screen has changed at the next input read of the game (not of its interrupt
+// handlers), tick end or delay, so title screens
+// are captured as well as rendered ticks. software/tools/frame_diff.py compares
+// two of them ("make golden" / "make check" in the game folders).
+//
+// Host builds have the input recorder in both modes: without -r the inputs of the
+// script are recorded, so "-i play.txt -u play.tlm" and
+// "replay_tool.py extract play.tlm play.rec" turn a script into a recording that
+// replays the same way on the device and with "-r play.rec".
+//
+// 2023 by Stefan Wagner:   https://github.com/wagiminator
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "system.h"
+#include "gpio.h"
+#include "prof.h"
+#include "latency.h"
+
+// Peripheral registers
+SIM_STK_T    SIM_stk;
+SIM_RCC_T    SIM_rcc;
+SIM_TIM_T    SIM_tim1;
+SIM_I2C_T    SIM_i2c1;
+SIM_DMA_CH_T SIM_dma6;
+SIM_PFIC_T   SIM_pfic;
+
+// Game entry (main() renamed by the build) and driver tables
+int SIM_main(void);
+extern uint16_t JOY_BAND[];             // (points of the stored calibration if loaded)
+extern const uint8_t  JOY_BAND_DIR[];
+__attribute__((weak)) void SIM_pin_isr(void) {}
+
+// Options
+static long   SIM_ticks_max = 1000;
+static long   SIM_time_max  = 600000;
+static char*  SIM_pbm;
+static int    SIM_verbose;
+static FILE*  SIM_uart;
+static FILE*  SIM_frames_f;
+static int    SIM_inisr;
+static char*  SIM_kv;
+static uint8_t* SIM_eeprom;             // EEPROM image (-e)
+static long   SIM_eeprom_size;
+
+static void SIM_capture(void);
+
+// Input recorder of the game (replay.h), if it is built in
+extern const uint8_t* REC_data __attribute__((weak));
+void REC_end(void) __attribute__((weak));
+
+// Flash pages of the key-value store (flash_kv.c) and of the snapshot (snapshot.c),
+// if they are built in
+extern volatile uint8_t KV_flash[] __attribute__((weak));
+extern const uint16_t KV_flash_size __attribute__((weak));
+extern volatile uint8_t SNAP_flash[] __attribute__((weak));
+extern const uint16_t SNAP_flash_size __attribute__((weak));
+
+// Load flash pages, erased if there is no file yet (or it is of another size)
+static void SIM_kv_load(void) {
+  FILE* f;
+  if(!KV_flash) return;
+  memset((uint8_t*)KV_flash, 0xFF, KV_flash_size);
+  if(SNAP_flash) memset((uint8_t*)SNAP_flash, 0xFF, SNAP_flash_size);
+  if(SIM_kv && (f = fopen(SIM_kv, "rb"))) {
+    if(fread((uint8_t*)KV_flash, 1, KV_flash_size, f) != KV_flash_size)
+      memset((uint8_t*)KV_flash, 0xFF, KV_flash_size);
+    else if(SNAP_flash && fread((uint8_t*)SNAP_flash, 1, SNAP_flash_size, f) != SNAP_flash_size)
+      memset((uint8_t*)SNAP_flash, 0xFF, SNAP_flash_size);
+    fclose(f);
+  }
+}
+
+// Save flash pages
+static void SIM_kv_save(void) {
+  FILE* f;
+  if(!KV_flash || !SIM_kv) return;
+  if(!(f = fopen(SIM_kv, "wb"))) { perror(SIM_kv); return; }
+  fwrite((uint8_t*)KV_flash, 1, KV_flash_size, f);
+  if(SNAP_flash) fwrite((uint8_t*)SNAP_flash, 1, SNAP_flash_size, f);
+  fclose(f);
+}
+
+// ===================================================================================
+// Input Script
+// ===================================================================================
+#define SIM_KEY_UP     0x01
+#define SIM_KEY_RIGHT  0x02
+#define SIM_KEY_DOWN   0x04
+#define SIM_KEY_LEFT   0x08
+#define SIM_KEY_ACT    0x80
+
+typedef struct { uint64_t until; uint8_t keys; } SIM_STEP;
+
+static SIM_STEP* SIM_script;
+static int       SIM_steps, SIM_step;
+static uint8_t   SIM_keys;
+static volatile uint16_t* SIM_ring;
+static uint16_t  SIM_ringlen;
+
+static void SIM_load(const char* name) {
+  FILE* f = fopen(name, "r");
+  char  line[256];
+  uint64_t t = 0;
+  if(!f) { perror(name); exit(1); }
+  while(fgets(line, sizeof(line), f)) {
+    char* c = strchr(line, '#');
+    long  ms;
+    char  keys[32] = "-";
+    uint8_t k = 0;
+    if(c) *c = 0;
+    if(sscanf(line, "%ld %31s", &ms, keys) < 1) continue;
+    for(c=keys; *c; c++) {
+      switch(*c) {
+        case 'U': case 'u': k |= SIM_KEY_UP;    break;
+        case 'R': case 'r': k |= SIM_KEY_RIGHT; break;
+        case 'D': case 'd': k |= SIM_KEY_DOWN;  break;
+        case 'L': case 'l': k |= SIM_KEY_LEFT;  break;
+        case 'A': case 'a': k |= SIM_KEY_ACT;   break;
+      }
+    }
+    t += ms * DLY_MS_TIME;
+    SIM_script = realloc(SIM_script, (SIM_steps + 1) * sizeof(SIM_STEP));
+    SIM_script[SIM_steps].until = t;
+    SIM_script[SIM_steps].keys  = k;
+    SIM_steps++;
+  }
+  fclose(f);
+}
+
+// ADC value of the pressed directions (band points of the game's driver)
+static uint16_t SIM_adc_value(void) {
+  uint8_t dirs = SIM_keys & 0x0F;
+  if(!dirs) return 0;
+  for(int i=0; i<8; i++) if(JOY_BAND_DIR[i] == dirs) return JOY_BAND[i];
+  return 0;
+}
+
+static uint64_t SIM_time;                     // virtual time (doesn't wrap)
+
+// Update key state to the virtual time, fire the pin interrupt on button edges
+static void SIM_input(void) {
+  uint8_t last = SIM_keys;
+  while(SIM_step < SIM_steps && SIM_time >= SIM_script[SIM_step].until) SIM_step++;
+  SIM_keys = (SIM_step < SIM_steps) ? SIM_script[SIM_step].keys : 0;
+  if(SIM_ring) for(uint16_t i=0; i<SIM_ringlen; i++) SIM_ring[i] = SIM_adc_value();
+  if((last ^ SIM_keys) & SIM_KEY_ACT) {
+    SIM_inisr = 1;                             // (the ISR may hit a half sent frame)
+    SIM_pin_isr();
+    SIM_inisr = 0;
+  }
+}
+
+uint8_t SIM_pin_read(uint8_t pin) {
+  SIM_capture();
+  DLY_us(1);
+  return (pin == PA2) ? !(SIM_keys & SIM_KEY_ACT) : 1;
+}
+
+uint16_t SIM_vdd = 3300;                      // supply voltage (mV)
+
+uint16_t SIM_adc_read(void) {
+  SIM_capture();
+  DLY_us(1);
+  return SIM_adc_value();
+}
+
+void SIM_adc_dma(volatile uint16_t* buf, uint16_t len) {
+  SIM_ring    = buf;
+  SIM_ringlen = len;
+  SIM_input();
+}
+
+// ===================================================================================
+// Virtual Clock and Timed Tasks
+// ===================================================================================
+static struct {
+  uint32_t due;
+  TSK_FUNC fn;
+  void*    ctx;
+} SIM_task[SYS_TASKS];
+
+static void SIM_end(void);
+
+uint8_t TSK_after(uint16_t ms, TSK_FUNC fn, void* ctx) {
+  for(uint8_t i=0; i<SYS_TASKS; i++) {
+    if(!SIM_task[i].fn) {
+      SIM_task[i].due = SIM_stk.CNT + (uint32_t)ms * DLY_MS_TIME;
+      SIM_task[i].ctx = ctx;
+      SIM_task[i].fn  = fn;
+      return i;
+    }
+  }
+  return TSK_NONE;
+}
+
+void TSK_cancel(uint8_t id) {
+  if(id < SYS_TASKS) SIM_task[id].fn = 0;
+}
+
+uint8_t TSK_pending(uint8_t id) {
+  return (id < SYS_TASKS) && SIM_task[id].fn;
+}
+
+void TSK_run(void) {
+  for(uint8_t i=0; i<SYS_TASKS; i++) {
+    TSK_FUNC fn = SIM_task[i].fn;
+    if(fn && ((int32_t)(SIM_stk.CNT - SIM_task[i].due)) >= 0) {
+      SIM_task[i].fn = 0;
+      fn(SIM_task[i].ctx);
+    }
+  }
+}
+
+// Move the clock by n ticks
+static void SIM_tick(uint32_t n) {
+  SIM_stk.CNT += n;
+  SIM_time    += n;
+  SIM_input();
+  if(SIM_time >= (uint64_t)SIM_time_max * DLY_MS_TIME) SIM_end();
+}
+
+// Move the clock to t, stopping at due tasks and input changes on the way
+static void SIM_advance(uint32_t t) {
+  while((int32_t)(SIM_stk.CNT - t) < 0) {
+    uint32_t step = t - SIM_stk.CNT;
+    for(uint8_t i=0; i<SYS_TASKS; i++) {
+      uint32_t d = SIM_task[i].due - SIM_stk.CNT;
+      if(SIM_task[i].fn && (int32_t)d > 0 && d < step) step = d;
+    }
+    if(SIM_step < SIM_steps && SIM_script[SIM_step].until - SIM_time < step)
+      step = SIM_script[SIM_step].until - SIM_time;
+    SIM_tick(step);
+    TSK_run();
+  }
+}
+
+void DLY_ticks(uint32_t n) {
+  SIM_tick(n);
+}
+
+void TSK_until(uint32_t t) {
+  SIM_capture();
+  TSK_run();
+  SIM_advance(t);
+}
+
+uint32_t TSK_next(uint32_t t) {
+  for(uint8_t i=0; i<SYS_TASKS; i++)
+    if(SIM_task[i].fn && ((int32_t)(SIM_task[i].due - t)) < 0) t = SIM_task[i].due;
+  return t;
+}
+
+void SLEEP_until(uint32_t t) {
+  uint32_t step = t - SIM_stk.CNT;
+  SIM_capture();
+  if((int32_t)step <= 0) return;
+  if(SIM_step < SIM_steps && SIM_script[SIM_step].until - SIM_time < step)
+    step = SIM_script[SIM_step].until - SIM_time;
+  SIM_tick(step ? step : 1);
+}
+
+// ===================================================================================
+// SSD1306 Emulation (I2C driver replacement)
+// ===================================================================================
+uint8_t SIM_ram[8 * 128];                     // display RAM, page by page
+static uint8_t SIM_dirty;                     // display RAM changed since the last capture
+
+static uint8_t  SIM_mode;                     // 0: horizontal, 1: vertical, 2: page
+static uint8_t  SIM_x0, SIM_x1 = 127, SIM_p0, SIM_p1 = 7, SIM_x, SIM_p;
+static uint8_t  SIM_ctrl;                     // 1: control byte expected
+static uint8_t  SIM_data;                     // 1: data stream, 0: command stream
+static uint8_t  SIM_cmd[8], SIM_cmdlen, SIM_cmdneed;
+static uint32_t SIM_bytes;                    // I2C bytes of the current frame
+uint32_t        I2C_rate = 400000;            // bus clock (I2C_setRate())
+static uint8_t  SIM_sdir, SIM_sp0, SIM_sp1;   // scroll setup: command, page band
+static uint16_t SIM_srate;                    // display frames per scroll step
+static uint8_t  SIM_son;                      // 1: continuous scroll is running
+static uint64_t SIM_stime;                    // virtual time of the last scroll step
+
+#define SIM_I2C_HZ      I2C_rate              // bus clock: each byte takes 9 clocks
+#define SIM_OLED_HZ     100                   // display frames per second (scroll steps)
+
+// Frames per scroll step of the speed codes of the scroll setup
+static const uint16_t SIM_SRATE[] = {5, 64, 128, 256, 3, 4, 25, 2};
+
+// Move the display RAM of pages p0..p1 one column right (dir 0) or left (dir 1)
+static void SIM_scroll(uint8_t p0, uint8_t p1, uint8_t dir) {
+  for(uint8_t p=p0; p<=p1 && p<8; p++) {
+    uint8_t* row = &SIM_ram[p << 7];
+    uint8_t  b;
+    if(dir) { b = row[0];   memmove(row, row + 1, 127); row[127] = b; }
+    else    { b = row[127]; memmove(row + 1, row, 127); row[0]   = b; }
+    SIM_dirty = 1;
+  }
+}
+
+// Catch up with the steps of the continuous scroll (diagonal: horizontal part only)
+static void SIM_scroll_run(void) {
+  uint64_t step = (uint64_t)F_CPU * SIM_srate / SIM_OLED_HZ;
+  if(!SIM_son) return;
+  while(SIM_time - SIM_stime >= step) {
+    SIM_scroll(SIM_sp0, SIM_sp1, SIM_sdir & 1);
+    SIM_stime += step;
+  }
+}
+
+static void SIM_command(void) {
+  switch(SIM_cmd[0]) {
+    case 0x20: SIM_mode = SIM_cmd[1] & 3; break;
+    case 0x21: SIM_x0 = SIM_x = SIM_cmd[1] & 127; SIM_x1 = SIM_cmd[2] & 127; break;
+    case 0x22: SIM_p0 = SIM_p = SIM_cmd[1] & 7;   SIM_p1 = SIM_cmd[2] & 7;   break;
+    case 0x26: case 0x27: case 0x29: case 0x2A:
+      if(SIM_son) break;                      // (ignored while scrolling)
+      SIM_sdir = SIM_cmd[0] - (SIM_cmd[0] >= 0x29 ? 0x29 : 0x26);
+      SIM_sp0 = SIM_cmd[2] & 7; SIM_srate = SIM_SRATE[SIM_cmd[3] & 7]; SIM_sp1 = SIM_cmd[4] & 7;
+      break;
+    case 0x2C: case 0x2D: if(!SIM_son) SIM_scroll(SIM_cmd[2] & 7, SIM_cmd[4] & 7, SIM_cmd[0] & 1); break;
+    case 0x2E: SIM_scroll_run(); SIM_son = 0; break;
+    case 0x2F: if(SIM_srate) { SIM_son = 1; SIM_stime = SIM_time; } break;
+    case 0x81: case 0xAE: case 0xAF:          // contrast, display off / on (idle manager)
+      if(SIM_verbose) printf("%9.3f s  %s %u\n", (double)SIM_time / DLY_MS_TIME / 1000,
+                             SIM_cmd[0] == 0x81 ? "contrast" : "display", SIM_cmd[0] == 0x81 ?
+                             SIM_cmd[1] : SIM_cmd[0] == 0xAF);
+      break;
+    default:
+      if((SIM_cmd[0] & 0xF8) == 0xB0) SIM_p = SIM_cmd[0] & 7;
+      else if(SIM_cmd[0] < 0x10) SIM_x = (SIM_x & 0xF0) | SIM_cmd[0];
+      else if(SIM_cmd[0] < 0x20) SIM_x = (SIM_x & 0x0F) | ((SIM_cmd[0] & 7) << 4);
+      break;
+  }
+}
+
+// Number of bytes of a command including its arguments
+static uint8_t SIM_cmdsize(uint8_t c) {
+  switch(c) {
+    case 0x20: case 0x81: case 0x8D: case 0xA8: case 0xD3: case 0xD5:
+    case 0xD9: case 0xDA: case 0xDB: return 2;
+    case 0x21: case 0x22: case 0xA3: return 3;
+    case 0x29: case 0x2A: return 6;
+    case 0x26: case 0x27: return 7;
+    case 0x2C: case 0x2D: return 8;
+    default:   return 1;
+  }
+}
+
+static void SIM_byte(uint8_t b) {
+  SIM_bytes++;
+  DLY_ticks(F_CPU * 9 / SIM_I2C_HZ);
+  if(SIM_ctrl) {
+    SIM_ctrl = 0;
+    SIM_data = (b & 0x40) != 0;
+    return;
+  }
+  if(SIM_data) {
+    uint8_t* cell = &SIM_ram[(SIM_p << 7) | SIM_x];
+    if(*cell != b) SIM_dirty = 1;
+    *cell = b;
+    if(SIM_mode == 1) {
+      if(SIM_p++ >= SIM_p1) { SIM_p = SIM_p0; if(SIM_x++ >= SIM_x1) SIM_x = SIM_x0; }
+    }
+    else if(SIM_mode == 2) { if(SIM_x < 127) SIM_x++; }
+    else if(SIM_x++ >= SIM_x1) { SIM_x = SIM_x0; if(SIM_p++ >= SIM_p1) SIM_p = SIM_p0; }
+    return;
+  }
+  if(!SIM_cmdlen) SIM_cmdneed = SIM_cmdsize(b);
+  SIM_cmd[SIM_cmdlen++] = b;
+  if(SIM_cmdlen >= SIM_cmdneed) {
+    SIM_command();
+    SIM_cmdlen = 0;
+  }
+}
+
+void I2C_init(void) {}
+void I2C_start(uint8_t addr) {
+  SIM_bytes++;
+  DLY_ticks(F_CPU * 9 / SIM_I2C_HZ);
+  SIM_ctrl   = 1;
+  SIM_cmdlen = 0;
+}
+void I2C_write(uint8_t data) { SIM_byte(data); }
+void I2C_stop(void) {}
+void I2C_streamBuffer(uint8_t* buf, uint16_t len) { while(len--) SIM_byte(*buf++); }
+void I2C_writeBuffer(uint8_t* buf, uint16_t len) { I2C_streamBuffer(buf, len); }
+void I2C_fill(uint8_t p, uint16_t len) { while(len--) SIM_byte(p); }
+uint16_t I2C_fence(void) { return 0; }
+void I2C_wait(uint16_t ticket) {}
+void I2C_flush(void) {}
+void I2C_DMA_wait(void) {}
+void I2C_setRate(uint32_t rate) { I2C_rate = rate; }
+
+// Transfers are done when they return: a stamped ticket is sent at once
+volatile uint32_t I2C_stamp_time;
+volatile uint8_t  I2C_stamp_on;
+void I2C_stamp(uint16_t ticket) { I2C_stamp_time = STK->CNT; }
+
+// The simulated bus never fails
+volatile uint8_t  I2C_error;
+volatile uint16_t I2C_errors;
+uint16_t          I2C_recoveries;
+void I2C_recover(void) { I2C_error = 0; }
+
+// EEPROM at 0xA0 (-e): two memory address bytes, sequential read wrapping around
+uint8_t I2C_read(uint8_t addr, const uint8_t* reg, uint8_t reglen, uint8_t* buf, uint16_t len) {
+  uint32_t n = (reglen ? 2 : 1) + reglen + len, a;
+  SIM_bytes += n;
+  DLY_ticks((uint64_t)F_CPU * 9 * n / SIM_I2C_HZ);
+  if((addr & 0xFE) != 0xA0 || !SIM_eeprom || reglen != 2) return 0;
+  a = (reg[0] << 8) | reg[1];
+  while(len--) *buf++ = SIM_eeprom[a++ % SIM_eeprom_size];
+  return 1;
+}
+
+static void SIM_eeprom_load(const char* name) {
+  FILE* f = fopen(name, "rb");
+  if(!f) { perror(name); exit(1); }
+  fseek(f, 0, SEEK_END);
+  SIM_eeprom_size = ftell(f);
+  rewind(f);
+  if(SIM_eeprom_size <= 0 || SIM_eeprom_size > 0x10000) {
+    fprintf(stderr, "%s: EEPROM image must hold 1 .. 65536 bytes\n", name); exit(1);
+  }
+  SIM_eeprom = malloc(SIM_eeprom_size);
+  if(fread(SIM_eeprom, 1, SIM_eeprom_size, f) != (size_t)SIM_eeprom_size) { perror(name); exit(1); }
+  fclose(f);
+}
+
+// ===================================================================================
+// UART (bytes go to the -u file)
+// ===================================================================================
+volatile uint16_t UART_dropped;
+
+void UART_init(void) {}
+uint8_t UART_free(void) { return 255; }
+void UART_flush(void) {}
+uint8_t UART_write(const uint8_t* buf, uint8_t len) {
+  if(SIM_uart) fwrite(buf, 1, len, SIM_uart);
+  return 1;
+}
+
+static void SIM_load_rec(const char* name) {
+  FILE* f = fopen(name, "rb");
+  uint8_t* rec;
+  long len;
+  if(!f) { perror(name); exit(1); }
+  if(!&REC_data) { fprintf(stderr, "%s: game is built without replay\n", name); exit(1); }
+  fseek(f, 0, SEEK_END);
+  len = ftell(f);
+  rewind(f);
+  rec = calloc(len + 2, 1);                    // (0, 0 end marker if missing)
+  if(fread(rec, 1, len, f) != (size_t)len) { perror(name); exit(1); }
+  fclose(f);
+  REC_data = rec;
+}
+
+// ===================================================================================
+// Statistics and Output
+// ===================================================================================
+static long     SIM_ticks, SIM_frames;
+static uint32_t SIM_compose;                  // compositor calls of the current frame
+static uint64_t SIM_compose_sum, SIM_bytes_sum;
+static uint32_t SIM_compose_max, SIM_bytes_max;
+static long     SIM_captured;
+static clock_t  SIM_clock;
+
+void SIM_phase(uint8_t phase) {
+  if(phase == PROF_COMPOSE) SIM_compose++;
+}
+
+static void SIM_write_pbm(const char* name) {
+  FILE* f = fopen(name, "wb");
+  if(!f) { perror(name); return; }
+  fprintf(f, "P4\n128 64\n");
+  for(int y=0; y<64; y++) {
+    for(int x=0; x<128; x+=8) {
+      uint8_t b = 0;
+      for(int i=0; i<8; i++)
+        if(SIM_ram[((y >> 3) << 7) | (x + i)] & (1 << (y & 7))) b |= 0x80 >> i;
+      fputc(b, f);
+    }
+  }
+  fclose(f);
+}
+
+// Write the screen to the frames file if it has changed
+static void SIM_capture(void) {
+  uint8_t t[4] = {SIM_ticks, SIM_ticks >> 8, SIM_ticks >> 16, SIM_ticks >> 24};
+  SIM_scroll_run();
+  if(!SIM_frames_f || !SIM_dirty || SIM_inisr) return;
+  fwrite(t, 1, 4, SIM_frames_f);
+  fwrite(SIM_ram, 1, sizeof(SIM_ram), SIM_frames_f);
+  SIM_dirty = 0;
+  SIM_captured++;
+}
+
+// CRC-32 of the display RAM
+static uint32_t SIM_crc(void) {
+  uint32_t c = 0xFFFFFFFF;
+  for(int i=0; i<1024; i++) {
+    c ^= SIM_ram[i];
+    for(int k=0; k<8; k++) c = (c >> 1) ^ (0xEDB88320 & -(c & 1));
+  }
+  return ~c;
+}
+
+static void SIM_end(void) {
+  double secs = (double)(clock() - SIM_clock) / CLOCKS_PER_SEC;
+  double vsec = (double)SIM_time / F_CPU;
+  long   n    = SIM_frames ? SIM_frames : 1;
+  if(REC_end) REC_end();
+  SIM_kv_save();
+  if(SIM_uart) fclose(SIM_uart);
+  if(SIM_frames_f) {
+    SIM_capture();
+    fclose(SIM_frames_f);
+    printf("captured screens:       %ld\n", SIM_captured);
+  }
+  if(SIM_pbm) SIM_write_pbm(SIM_pbm);
+  printf("%ld ticks, %ld rendered frames, %.1f s virtual time\n", SIM_ticks, SIM_frames, vsec);
+  printf("screen CRC-32:          %08X\n", SIM_crc());
+  printf("compositor calls/frame: avg %.1f max %u\n", (double)SIM_compose_sum / n, SIM_compose_max);
+  printf("I2C bytes/frame:        avg %.1f max %u\n", (double)SIM_bytes_sum / n, SIM_bytes_max);
+  #if LAT_ENABLE > 0
+  printf("input latency (us):     min %u avg %u p99 %u max %u of %u, %u lost\n",
+         LAT_result.min, LAT_result.avg, LAT_result.p99, LAT_result.max, LAT_result.count, LAT_lost);
+  #endif
+  printf("host: %.3f s, %.0f ticks/s, %.0fx real time\n", secs,
+         secs > 0 ? SIM_ticks / secs : 0, secs > 0 ? vsec / secs : 0);
+  exit(0);
+}
+
+// Software reset: the simulation ends here
+void RST_now(void) {
+  printf("reset at tick %ld\n", SIM_ticks);
+  SIM_end();
+}
+
+void SIM_frame(uint8_t rendered) {
+  SIM_capture();
+  SIM_ticks++;
+  if(rendered) {
+    SIM_frames++;
+    SIM_compose_sum += SIM_compose;
+    SIM_bytes_sum   += SIM_bytes;
+    if(SIM_compose > SIM_compose_max) SIM_compose_max = SIM_compose;
+    if(SIM_bytes   > SIM_bytes_max)   SIM_bytes_max   = SIM_bytes;
+    if(SIM_verbose) printf("frame %6ld  tick %7ld  compose %4u  bytes %5u  crc %08X\n",
+                           SIM_frames, SIM_ticks, SIM_compose, SIM_bytes, SIM_crc());
+    SIM_compose = 0;
+    SIM_bytes   = 0;
+  }
+  if(SIM_ticks >= SIM_ticks_max) SIM_end();
+}
+
+int main(int argc, char** argv) {
+  for(int i=1; i<argc; i++) {
+    if(!strcmp(argv[i], "-v")) SIM_verbose = 1;
+    else if(i + 1 < argc && !strcmp(argv[i], "-i")) SIM_load(argv[++i]);
+    else if(i + 1 < argc && !strcmp(argv[i], "-n")) SIM_ticks_max = atol(argv[++i]);
+    else if(i + 1 < argc && !strcmp(argv[i], "-t")) SIM_time_max  = atol(argv[++i]);
+    else if(i + 1 < argc && !strcmp(argv[i], "-p")) SIM_pbm = argv[++i];
+    else if(i + 1 < argc && !strcmp(argv[i], "-r")) SIM_load_rec(argv[++i]);
+    else if(i + 1 < argc && !strcmp(argv[i], "-k")) SIM_kv = argv[++i];
+    else if(i + 1 < argc && !strcmp(argv[i], "-e")) SIM_eeprom_load(argv[++i]);
+    else if(i + 1 < argc && !strcmp(argv[i], "-b")) SIM_vdd = atoi(argv[++i]);
+    else if(i + 1 < argc && !strcmp(argv[i], "-u")) {
+      if(!(SIM_uart = fopen(argv[++i], "wb"))) { perror(argv[i]); return 1; }
+    }
+    else if(i + 1 < argc && !strcmp(argv[i], "-f")) {
+      if(!(SIM_frames_f = fopen(argv[++i], "wb"))) { perror(argv[i]); return 1; }
+    }
+    else {
+      fprintf(stderr, "usage: %s [-i script] [-r recording] [-n ticks] [-t ms] "
+                      "[-p screen.pbm] [-u uart.tlm] [-f screens.frames] [-k flash.kv] [-e eeprom.bin] [-b mV] [-v]\n", argv[0]);
+      return 1;
+    }
+  }
+  SIM_kv_load();
+  SIM_clock = clock();
+  SIM_input();
+  SIM_main();
+  SIM_end();
+  return 0;
+}
@@ -0,0 +1,127 @@
+// ===================================================================================
+// Host Simulator: System Functions                                           * v1.0 *
+// ===================================================================================
+//
+// Stands in for system.h/ch32v003.h when a game is built for the PC ("make host").
+// SysTick is a virtual clock that only moves on delays and waits, so a simulated
+// session runs as fast as the host allows and exactly the same way every time.
+// The few peripheral registers the drivers touch are plain variables.
+//
+// 2023 by Stefan Wagner:   https://github.com/wagiminator
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "config.h"                 // options of the firmware (in its src folder)
+
+#define SIM               1         // host simulator build
+
+#ifndef F_CPU
+#define F_CPU             12000000
+#endif
+
+#define SYS_USE_VECTORS   1
+#define STK_FREQ          F_CPU
+#define CLK_freq()        (F_CPU)
+#define RAMFUNC
+#define SYS_TASKS         4
+#define SYS_STARTUP_PROF  0
+
+// Interrupt handlers are plain functions on the host
+#define interrupt         used
+
+// Peripheral registers
+typedef struct { volatile uint32_t CNT; } SIM_STK_T;
+typedef struct {
+  volatile uint32_t APB2PCENR, APB1PCENR, AHBPCENR;
+} SIM_RCC_T;
+typedef struct {
+  volatile uint16_t CTLR1, CHCTLR1, CCER, BDTR, DMAINTENR, INTFR, SWEVGR;
+  volatile uint16_t PSC, ATRLR, RPTCR, CH2CVR;
+} SIM_TIM_T;
+typedef struct { volatile uint16_t STAR1, STAR2; } SIM_I2C_T;
+typedef struct { volatile uint32_t CFGR; } SIM_DMA_CH_T;
+typedef struct { volatile uint32_t SCTLR; } SIM_PFIC_T;
+
+extern SIM_STK_T    SIM_stk;
+extern SIM_RCC_T    SIM_rcc;
+extern SIM_TIM_T    SIM_tim1;
+extern SIM_I2C_T    SIM_i2c1;
+extern SIM_DMA_CH_T SIM_dma6;
+extern SIM_PFIC_T   SIM_pfic;
+
+#define STK               (&SIM_stk)
+#define RCC               (&SIM_rcc)
+#define TIM1              (&SIM_tim1)
+#define I2C1              (&SIM_i2c1)
+#define DMA1_Channel6     (&SIM_dma6)
+#define PFIC              (&SIM_pfic)
+
+#define RCC_TIM1EN        0x0800
+#define I2C_STAR2_BUSY    0x0002
+#define DMA_CFG6_EN       0x0001
+#define PFIC_SEVONPEND    0x0010
+#define TIM_CEN           0x0001
+#define TIM_URS           0x0004
+#define TIM_UIE           0x0001
+#define TIM_UIF           0x0001
+#define TIM_UG            0x0001
+#define TIM_OC2PE         0x0800
+#define TIM_OC2M_1        0x2000
+#define TIM_OC2M_2        0x4000
+#define TIM_CC2E          0x0010
+#define TIM_CC2P          0x0020
+#define TIM_MOE           0x8000
+
+typedef enum {EXTI7_0_IRQn, TIM1_UP_IRQn, DMA1_Channel1_IRQn, DMA1_Channel4_IRQn,
+              DMA1_Channel6_IRQn, I2C1_EV_IRQn} IRQn_Type;
+#define NVIC_EnableIRQ(n)   ((void)(n))
+#define NVIC_DisableIRQ(n)  ((void)(n))
+#define VTF_enable(n, irq, fn) ((void)(fn))
+
+// Interrupts can't interrupt on the host
+#define INT_ATOMIC_BLOCK  for(int __ToDo = 1; __ToDo; __ToDo = 0)
+#define INT_enable()
+#define INT_disable()
+
+// Delays move the virtual clock
+#define DLY_US_TIME       (F_CPU / 1000000)             // system ticks per us
+#define DLY_MS_TIME       (F_CPU / 1000)                // system ticks per ms
+#define DLY_us(n)         DLY_ticks((n) * DLY_US_TIME)  // delay n microseconds
+#define DLY_ms(n)         DLY_ticks((n) * DLY_MS_TIME)  // delay n milliseconds
+void DLY_ticks(uint32_t n);                             // delay n system ticks
+
+// Timed tasks (same semantics as on the target)
+#define TSK_NONE          0xFF                          // no free task slot
+typedef void (*TSK_FUNC)(void* ctx);                    // task function
+uint8_t TSK_after(uint16_t ms, TSK_FUNC fn, void* ctx); // call fn(ctx) in ms milliseconds
+void TSK_cancel(uint8_t id);                            // cancel waiting task
+uint8_t TSK_pending(uint8_t id);                        // check if task is waiting
+void TSK_run(void);                                     // call due tasks
+void TSK_until(uint32_t t);                             // wait until SYSTICK count t
+#define TSK_delay(n)      TSK_until(STK->CNT + (uint32_t)(n) * DLY_MS_TIME)
+#define TSK_idle(t)       TSK_until(t)
+
+// Startup profiler (off on the host)
+#define STARTUP_STAGES    8
+enum {STARTUP_DATA, STARTUP_BSS, STARTUP_CLOCK, STARTUP_USER};
+#define STARTUP_mark(stage)
+uint32_t TSK_next(uint32_t t);                          // next due time, at most t
+
+// Sleep: the virtual clock moves on to t or to the next input change ("interrupt"),
+// standby with AWU works the same way and keeps the clock
+void SLEEP_until(uint32_t t);
+#define AWU_start(n)
+#define AWU_stop()
+#define AWU_stdby(ms)     SLEEP_until(STK->CNT + (uint32_t)(ms) * DLY_MS_TIME)
+#define CLK_init()
+enum {CLK_FAST, CLK_SLOW};                              // (one clock on the host)
+void RST_now(void);                                     // ends the simulation
+
+#ifdef __cplusplus
+};
+#endif
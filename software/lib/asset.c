@@ -0,0 +1,79 @@
+// ===================================================================================
+// Asset Loader for an I2C EEPROM on the Display Bus                          * v1.0 *
+// ===================================================================================
+// 2023 by Stefan Wagner:   https://github.com/wagiminator
+
+#include "asset.h"
+
+#define ASSET_NONE    0xFFFF        // no line cached
+
+// Index and read cache
+uint16_t ASSET_off[ASSET_MAX];              // offset of each asset in the image
+uint16_t ASSET_len[ASSET_MAX];              // its length, 0: missing
+uint16_t ASSET_tag[ASSET_LINES];            // image address / ASSET_LINE of each line
+uint8_t  ASSET_cache[ASSET_LINES][ASSET_LINE];
+uint8_t  ASSET_next;                        // line replaced next
+
+// Read len bytes from image address a, returns 0 if there is no EEPROM
+static uint8_t ASSET_fetch(uint16_t a, uint8_t* buf, uint16_t len) {
+  #if OLED_BUS == OLED_BUS_I2C
+  uint8_t mem[2] = {a >> 8, a};
+  return I2C_read(ASSET_ADDR, mem, 2, buf, len);
+  #else
+  return 0;                                 // (no I2C bus with an SPI display)
+  #endif
+}
+
+// Read the index
+uint8_t ASSET_init(uint8_t game) {
+  uint8_t h[4], e[4], i;
+  for(i=0; i<ASSET_LINES; i++) ASSET_tag[i] = ASSET_NONE;
+  for(i=0; i<ASSET_MAX; i++) ASSET_len[i] = 0;
+  if(!ASSET_fetch(0, h, 4)) return 0;
+  if(h[0] != ASSET_MAGIC0 || h[1] != ASSET_MAGIC1 || h[2] != game) return 0;
+  if(h[3] > ASSET_MAX) h[3] = ASSET_MAX;
+  for(i=0; i<h[3]; i++) {
+    if(!ASSET_fetch(4 + (i << 2), e, 4)) return 0;
+    ASSET_off[i] = e[0] | (uint16_t)e[1] << 8;
+    ASSET_len[i] = e[2] | (uint16_t)e[3] << 8;
+  }
+  return h[3];
+}
+
+// Length of asset id
+uint16_t ASSET_size(uint8_t id) {
+  return id < ASSET_MAX ? ASSET_len[id] : 0;
+}
+
+// Copy len bytes from offset off of asset id into buf through the cache
+uint16_t ASSET_read(uint8_t id, uint16_t off, void* buf, uint16_t len) {
+  uint8_t* b = buf;
+  uint16_t n, a, tag;
+  uint8_t  i;
+  if(off >= ASSET_size(id)) return 0;
+  if(len > ASSET_len[id] - off) len = ASSET_len[id] - off;
+  a = ASSET_off[id] + off;
+  for(n=0; n<len; n++, a++) {
+    tag = a / ASSET_LINE;
+    for(i=0; i<ASSET_LINES && ASSET_tag[i] != tag; i++);
+    if(i == ASSET_LINES) {                  // miss: replace the next line
+      i = ASSET_next;
+      ASSET_next = (ASSET_next + 1) % ASSET_LINES;
+      if(!ASSET_fetch(tag * ASSET_LINE, ASSET_cache[i], ASSET_LINE)) {
+        ASSET_tag[i] = ASSET_NONE;
+        return n;
+      }
+      ASSET_tag[i] = tag;
+    }
+    *b++ = ASSET_cache[i][a & (ASSET_LINE - 1)];
+  }
+  return len;
+}
+
+// Read len bytes from offset off of asset id straight into the page buffer
+uint8_t ASSET_page(uint8_t id, uint16_t off, uint8_t len) {
+  if((uint32_t)off + len > ASSET_size(id)) return 0;
+  if(!ASSET_fetch(ASSET_off[id] + off, OLED_pageptr, len)) return 0;
+  OLED_pageptr += len;
+  return 1;
+}
@@ -0,0 +1,67 @@
+// ===================================================================================
+// Asset Loader for an I2C EEPROM on the Display Bus                          * v1.0 *
+// ===================================================================================
+//
+// Reads levels, maps and screens from a 24Cxx EEPROM (24C32 .. 24C512, 16-bit
+// memory addresses) that shares the I2C bus with the OLED. The image starts with
+// an index, all numbers are little-endian:
+//
+//   u8 'T', u8 'A', u8 game, u8 count    header (game: tag of the game, see below)
+//   count x { u16 offset, u16 length }   assets 0 .. count-1, offset from image start
+//
+// ASSET_init(game) reads the index once; if there is no EEPROM, or the image is
+// one of another game, all assets are missing (size 0) and the game uses what it
+// has in flash. software/tools/asset_pack.py packs the assets into an image.
+//
+// ASSET_read() goes through a small RAM cache of ASSET_LINES lines of ASSET_LINE
+// bytes, so reading a level record field by field costs one bus transaction per
+// line. ASSET_page() streams a block of a bitmap straight into the page buffer of
+// oled_min.c (between OLED_page_start() and OLED_page_end()), which then hands it
+// to the display in one transfer. The EEPROM reads are blocking and wait for the
+// display transfers queued before (it is the same bus).
+//
+// Functions available:
+// --------------------
+// ASSET_init(game)         read the index (at startup), returns number of assets
+// ASSET_size(id)           length of asset id in bytes (0: missing)
+// ASSET_read(id,off,buf,len) copy len bytes from offset off of asset id into buf,
+//                          returns number of bytes copied
+// ASSET_page(id,off,len)   read len bytes from offset off of asset id into the page
+//                          buffer, returns 0 if they are missing
+//
+// 2023 by Stefan Wagner:   https://github.com/wagiminator
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "oled_min.h"
+
+// Asset parameters
+#ifndef ASSET_ADDR
+#define ASSET_ADDR        0xA0      // EEPROM write address (0x50 << 1)
+#endif
+#ifndef ASSET_MAX
+#define ASSET_MAX         4         // max number of assets in the index
+#endif
+#ifndef ASSET_LINES
+#define ASSET_LINES       2         // lines of the read cache
+#endif
+#ifndef ASSET_LINE
+#define ASSET_LINE        16        // bytes per cache line (power of 2)
+#endif
+
+#define ASSET_MAGIC0      'T'
+#define ASSET_MAGIC1      'A'
+
+// Asset functions
+uint8_t  ASSET_init(uint8_t game);
+uint16_t ASSET_size(uint8_t id);
+uint16_t ASSET_read(uint8_t id, uint16_t off, void* buf, uint16_t len);
+uint8_t  ASSET_page(uint8_t id, uint16_t off, uint8_t len);
+
+#ifdef __cplusplus
+};
+#endif
@@ -0,0 +1,89 @@
+// ===================================================================================
+// Battery Governor for CH32V003                                              * v1.0 *
+// ===================================================================================
+// 2023 by Stefan Wagner:   https://github.com/wagiminator
+
+#include "battery.h"
+#include "gpio.h"
+#include "telemetry.h"
+
+#if BAT_ENABLE > 0
+
+// Settings of the levels (see battery.h)
+const BAT_POLICY BAT_POLICIES[BAT_LEVELS] = {
+  {0xFFFF,       127, 0, 0,          CLK_FAST},   // FULL
+  {BAT_MV_LOW,    63, 0, 1,          CLK_FAST},   // LOW
+  {BAT_MV_WEAK,   16, 1, 2,          CLK_FAST},   // WEAK
+  {BAT_MV_EMPTY,   1, 1, BAT_SILENT, CLK_SLOW}    // EMPTY
+};
+
+uint8_t  BAT_level;                   // level (BAT_FULL .. BAT_EMPTY)
+uint16_t BAT_mv;                      // averaged supply voltage (mV)
+uint16_t BAT_acc;                     // 8 * BAT_mv (running average)
+uint8_t  BAT_new;                     // 1: level changed, not taken yet
+uint8_t  BAT_blink;                   // symbol phase at EMPTY
+
+// Take a sample, move to the level of the average, returns 1 if it changed
+static uint8_t BAT_update(uint16_t mv) {
+  uint8_t lv = BAT_level;
+  BAT_acc = BAT_acc - (BAT_acc >> 3) + mv;
+  BAT_mv  = BAT_acc >> 3;
+  while((lv < BAT_EMPTY) && (BAT_mv < BAT_POLICIES[lv + 1].mv)) lv++;
+  while(lv && (BAT_mv >= BAT_POLICIES[lv].mv + BAT_HYST)) lv--;
+  if(lv == BAT_level) return 0;
+  BAT_level = lv;
+  BAT_new   = 1;
+  return 1;
+}
+
+// Sampler task: take the last conversion, start the next one
+static void BAT_task(void* ctx) {
+  if(ADC_VDD_done() && BAT_update(ADC_VDD_get())) {
+    TLM_counter(TLM_ID_BAT_LEVEL, BAT_level);
+    TLM_counter(TLM_ID_BAT_MV, BAT_mv);
+  }
+  ADC_VDD_start();
+  BAT_blink ^= 1;
+  TSK_after(BAT_PERIOD_MS, BAT_task, 0);
+}
+
+// Set up the sampler, the first sample is taken at once
+void BAT_init(void) {
+  uint16_t mv;
+  ADC_VDD_init();
+  ADC_VDD_start();
+  while(!ADC_VDD_done());             // (a few us)
+  mv = ADC_VDD_get();
+  BAT_acc = mv << 3;
+  BAT_update(mv);                     // (a weak cell is governed from the start)
+  TSK_after(BAT_PERIOD_MS, BAT_task, 0);
+}
+
+// Check for a new level, returns 1 once after a change
+uint8_t BAT_take(void) {
+  uint8_t n = BAT_new;
+  BAT_new = 0;
+  return n;
+}
+
+// Draw the battery symbol into the composed span of page y (columns x0..x1):
+// body with two bar cells and the terminal on the right
+void BAT_overlay(uint8_t* buf, uint8_t x0, uint8_t x1, uint8_t y) {
+  uint8_t x, bars;
+  if((y != BAT_OVL_PAGE) || !BAT_level) return;
+  if((BAT_level == BAT_EMPTY) && BAT_blink) return;
+  if((x1 < BAT_OVL_X) || (x0 > BAT_OVL_X + 9)) return;
+  if(x1 > BAT_OVL_X + 9) x1 = BAT_OVL_X + 9;
+  bars = BAT_EMPTY - BAT_level;
+  for(x = (x0 > BAT_OVL_X) ? x0 : BAT_OVL_X; x <= x1; x++) {
+    uint8_t col = x - BAT_OVL_X;
+    uint8_t v   = 0x42;                           // top and bottom edge
+    if((col == 0) || (col == 8)) v = 0x7E;        // walls
+    else if(col == 9) v = 0x18;                   // terminal
+    else if(((col == 2) || (col == 3)) && (bars > 0)) v = 0x5A;
+    else if(((col == 5) || (col == 6)) && (bars > 1)) v = 0x5A;
+    buf[x - x0] = v;
+  }
+}
+
+#endif
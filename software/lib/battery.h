@@ -0,0 +1,140 @@
+// ===================================================================================
+// Battery Governor for CH32V003                                              * v1.0 *
+// ===================================================================================
+//
+// Samples the supply voltage in the background and picks the settings of the
+// console from it, so a draining coin cell costs brightness, refresh rate and
+// volume step by step instead of ending in brown-out resets.
+//
+// The sampler is a timed task (TSK_after() in system.h) that runs every
+// BAT_PERIOD_MS: it reads the last conversion of Vref and starts the next one.
+// Vref is converted as injected channel of the ADC (ADC_VDD_start() in gpio.h),
+// which runs between the regular conversions of the joypad and keeps the pad
+// samples (and the DMA ring they are written to) as they are. The voltage of
+// VDD is averaged over the last 8 samples or so (BAT_mv, mV), so the short dips
+// of the buzzer don't count.
+//
+// The governor sorts BAT_mv into four levels. A level is entered when BAT_mv
+// falls below its threshold and left when it rises BAT_HYST above it again:
+//
+//   level  VDD below      contrast  render interval  sound duty  clock profile
+//   FULL   -              127       x1               50%         CLK_FAST
+//   LOW    BAT_MV_LOW     63        x1               25%         CLK_FAST
+//   WEAK   BAT_MV_WEAK    16        x2               12%         CLK_FAST
+//   EMPTY  BAT_MV_EMPTY   1         x2               silent      CLK_SLOW
+//
+// The joypad engine applies them (JOY_bat_check() in joypad.c): the contrast
+// as soon as the level changes (not while the idle manager has dimmed the
+// display), the render interval of the frame scheduler, the duty of the sound
+// timer and the clock profile of the game loop (with SYS_CLK_PROFILES) with their next use.
+// A new level and the voltage are sent as telemetry counters TLM_ID_BAT_LEVEL
+// and TLM_ID_BAT_MV (telemetry.h).
+//
+// From level LOW on, LAYER_compose() (oled_layer.h) draws a battery symbol over
+// the game at column BAT_OVL_X of page BAT_OVL_PAGE: two bars at LOW, one at
+// WEAK, a blinking empty one at EMPTY. Like the profiler overlay it is drawn
+// into the spans the game composes. The suspend at 2.7V (SNAP_PVD in
+// snapshot.h) stays the last resort below EMPTY.
+//
+// The thresholds sit on the discharge curve of a CR2032 under the load of the
+// console: a fresh cell gives about 3.0V, most of its life is spent on the flat
+// part around 2.9V and the knee at about 2.8V marks the last few percent, after
+// which the voltage falls off quickly. So a normal cell runs at FULL, LOW starts
+// at the knee and WEAK and EMPTY follow down to the suspend.
+//
+// The voltage is taken from Vref (1.2V typical), whose tolerance shifts all
+// thresholds alike: set them in the config.h of the firmware if the console
+// runs on a rechargeable cell (LIR2032, 3.6V) or another supply.
+//
+// Functions available:
+// --------------------
+// BAT_init()               set up the sampler (ADC set up already)
+// BAT_take()               1 once after the level has changed
+// BAT_contrast()           display contrast of the level
+// BAT_render()             render interval of the level (shift: x1, x2, ...)
+// BAT_volume()             sound duty of the level (shift of 50%, BAT_SILENT: off)
+// BAT_clock()              clock profile of the game loop of the level
+// BAT_overlay(buf, x0, x1, y)  draw the battery symbol into a composed span
+// BAT_level                level (BAT_FULL .. BAT_EMPTY)
+// BAT_mv                   averaged supply voltage in mV
+//
+// 2023 by Stefan Wagner:   https://github.com/wagiminator
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "system.h"
+
+// Governor options
+#ifndef BAT_ENABLE
+#define BAT_ENABLE    1           // 1: sample VDD and govern the settings
+#endif
+#ifndef BAT_PERIOD_MS
+#define BAT_PERIOD_MS 250         // ms between two samples
+#endif
+#ifndef BAT_MV_LOW
+#define BAT_MV_LOW    2800        // level LOW below this VDD (mV, knee of a CR2032)
+#endif
+#ifndef BAT_MV_WEAK
+#define BAT_MV_WEAK   2760        // level WEAK below this VDD (mV)
+#endif
+#ifndef BAT_MV_EMPTY
+#define BAT_MV_EMPTY  2730        // level EMPTY below this VDD (mV)
+#endif
+#ifndef BAT_HYST
+#define BAT_HYST      30          // mV above the threshold to leave a level
+#endif
+#ifndef BAT_OVL_X
+#define BAT_OVL_X     118         // first column of the battery symbol (10 columns)
+#endif
+#ifndef BAT_OVL_PAGE
+#define BAT_OVL_PAGE  7           // page of the battery symbol
+#endif
+
+// Levels
+enum {BAT_FULL, BAT_LOW, BAT_WEAK, BAT_EMPTY, BAT_LEVELS};
+
+#define BAT_SILENT    8           // BAT_volume(): no sound
+
+#if BAT_ENABLE > 0
+
+// Settings of a level
+typedef struct {
+  uint16_t mv;                    // entered below this VDD (mV)
+  uint8_t  contrast;              // display contrast
+  uint8_t  render;                // render interval (shift)
+  uint8_t  volume;                // sound duty (shift of 50%)
+  uint8_t  clock;                 // clock profile of the game loop
+} BAT_POLICY;
+
+extern const BAT_POLICY BAT_POLICIES[BAT_LEVELS];
+extern uint8_t  BAT_level;        // level (BAT_FULL .. BAT_EMPTY)
+extern uint16_t BAT_mv;           // averaged supply voltage (mV)
+
+void BAT_init(void);
+uint8_t BAT_take(void);
+void BAT_overlay(uint8_t* buf, uint8_t x0, uint8_t x1, uint8_t y);
+
+#define BAT_contrast()  (BAT_POLICIES[BAT_level].contrast)
+#define BAT_render()    (BAT_POLICIES[BAT_level].render)
+#define BAT_volume()    (BAT_POLICIES[BAT_level].volume)
+#define BAT_clock()     (BAT_POLICIES[BAT_level].clock)
+
+#else
+
+#define BAT_init()
+#define BAT_take()      0
+#define BAT_contrast()  127
+#define BAT_render()    0
+#define BAT_volume()    0
+#define BAT_clock()     CLK_FAST
+#define BAT_overlay(buf, x0, x1, y)
+
+#endif
+
+#ifdef __cplusplus
+};
+#endif
@@ -0,0 +1,98 @@
+// ===================================================================================
+// Packed BCD Counters and Cached Digit Fields                                * v1.0 *
+// ===================================================================================
+//
+// Scores, lines and levels are only ever shown as decimal digits, so they can be
+// counted in packed BCD right away: each nibble holds one digit (digit 0 in the
+// lowest nibble), the renderer just picks the nibble and indexes the glyph.
+//
+// Functions available:
+// --------------------
+// BCD_add(a, b)                  Packed BCD sum a + b (7 digits, carries ripple)
+// BCD_inc(a)                     Packed BCD a + 1
+// BCD_from(v)                    Convert binary value (once, e.g. on load)
+// BCD_digit(v, i)                Digit i of packed BCD v
+// BCD_glyph(font, w, v, i)       Pointer to glyph of digit i in a font of w bytes
+//                                per digit
+// BCD_HUD_span(hud, key, buf, x0, x1, y, draw, ctx)
+//                                Layer span of a cached digit field (see below)
+//
+// A cached digit field keeps the page bytes of its box in RAM. They are redrawn
+// by draw(x, y, ctx) only when key differs from the key of the last redraw, so
+// the pixel function of an unchanged field doesn't run at all. key is any 32-bit
+// value the field depends on, usually the BCD value itself.
+//
+//   uint8_t score_bytes[20];
+//   BCD_HUD score_hud = {BCD_NONE, 0, 20, 1, 1, score_bytes};
+//
+// 2023 by Stefan Wagner:   https://github.com/wagiminator
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "fast_math.h"
+
+typedef uint32_t BCD;                    // 7 packed BCD digits
+#define BCD_NONE  0xFFFFFFFF             // key of an empty field cache
+
+// Digit access
+#define BCD_digit(v, i)           ((uint8_t)(((v) >> ((i) << 2)) & 0x0F))
+#define BCD_glyph(font, w, v, i)  (&(font)[BCD_digit(v, i) * (w)])
+
+// Packed BCD addition: add 6 to every digit so that decimal carries become
+// binary carries, then take the 6 back out of every digit that didn't carry
+static inline BCD BCD_add(BCD a, BCD b) {
+  uint32_t t1 = a + 0x06666666;
+  uint32_t t2 = t1 + b;
+  uint32_t t5 = ~(t2 ^ t1 ^ b) & 0x11111110;
+  return t2 - ((t5 >> 2) | (t5 >> 3));
+}
+
+static inline BCD BCD_inc(BCD a) { return BCD_add(a, 1); }
+
+// Convert binary value to packed BCD
+static inline BCD BCD_from(uint16_t v) {
+  BCD r = 0;
+  for(uint8_t i=0; v; i+=4) {
+    uint16_t q = FM_div10(v);
+    r |= (BCD)(v - (((q << 2) + q) << 1)) << i;
+    v  = q;
+  }
+  return r;
+}
+
+// Cached digit field
+typedef uint8_t (*BCD_DRAW)(uint8_t x, uint8_t y, void* ctx);
+
+typedef struct {
+  uint32_t key;                          // key of the cached bytes
+  uint8_t  x0, width;                    // columns of the field
+  uint8_t  p0, p1;                       // pages of the field
+  uint8_t* cache;                        // width bytes per page, page by page
+} BCD_HUD;
+
+// OR columns x0..x1 of page y of the field into buf, redraw the cache first
+// if key changed
+static inline void BCD_HUD_span(BCD_HUD* hud, uint32_t key, uint8_t* buf,
+                                uint8_t x0, uint8_t x1, uint8_t y,
+                                BCD_DRAW draw, void* ctx) {
+  uint8_t* src = hud->cache;
+  if(hud->key != key) {
+    hud->key = key;
+    for(uint8_t p=hud->p0; p<=hud->p1; p++) {
+      for(uint8_t x=0; x<hud->width; x++) *src++ = draw(hud->x0 + x, p, ctx);
+    }
+    src = hud->cache;
+  }
+  for(uint8_t p=hud->p0; p<y; p++) src += hud->width;
+  src += x0 - hud->x0;
+  for(; x0<=x1; x0++) *buf++ |= *src++;
+}
+
+#ifdef __cplusplus
+};
+#endif
@@ -0,0 +1,90 @@
+// ===================================================================================
+// Benchmark Build of the Games for CH32V003                                  * v1.1 *
+// ===================================================================================
+// 2023 by Stefan Wagner:   https://github.com/wagiminator
+
+#include "bench.h"
+
+#if BENCH > 0
+
+#include "oled_bus.h"
+#include "uart_tx.h"
+#include "telemetry.h"
+
+const BENCH_STEP* BENCH_step = BENCH_SCRIPT;  // current script step
+uint8_t           BENCH_reads;                // reads of the current step so far
+uint8_t           BENCH_last;                 // input of the last BENCH_clicked()
+uint16_t          BENCH_ticks;                // measured ticks
+uint16_t          BENCH_renders;              // rendered ticks
+uint32_t          BENCH_start;                // SysTick count of the last tick end
+uint32_t          BENCH_sum;                  // cycles of all measured ticks
+uint32_t          BENCH_min = 0xFFFFFFFF;     // cycles of the fastest tick
+uint32_t          BENCH_max;                  // cycles of the slowest tick
+uint32_t          BENCH_bytes;                // bus byte count at the first tick
+
+// Next scripted input
+uint8_t BENCH_input(void) {
+  if(BENCH_reads >= BENCH_step->reads) {
+    BENCH_reads = 0;
+    if(!(++BENCH_step)->reads) BENCH_step = BENCH_SCRIPT;
+  }
+  BENCH_reads++;
+  return BENCH_step->input;
+}
+
+// Action button newly pressed?
+uint8_t BENCH_clicked(void) {
+  uint8_t in = BENCH_input();
+  uint8_t result = (in & ~BENCH_last & BENCH_ACT) != 0;
+  BENCH_last = in;
+  return result;
+}
+
+// Append little-endian value of n bytes
+static uint8_t* BENCH_put(uint8_t* p, uint32_t v, uint8_t n) {
+  while(n--) {
+    *p++ = v;
+    v >>= 8;
+  }
+  return p;
+}
+
+// Send result record every second, never returns
+static void BENCH_report(void) {
+  uint8_t  rec[3 + 20 + 1];
+  uint8_t* p = rec + 3;
+  uint8_t  i, sum;
+  rec[0] = TLM_SYNC;
+  rec[1] = TLM_BENCH;
+  rec[2] = 20;
+  p = BENCH_put(p, BENCH_ticks,   2);
+  p = BENCH_put(p, BENCH_renders, 2);
+  p = BENCH_put(p, BENCH_sum,     4);
+  p = BENCH_put(p, BENCH_min,     4);
+  p = BENCH_put(p, BENCH_max,     4);
+  p = BENCH_put(p, BUS_bytes - BENCH_bytes, 4);
+  for(sum=0, i=1; i<3+20; i++) sum += rec[i];
+  *p = sum;
+  UART_init();
+  while(1) {
+    UART_write(rec, sizeof(rec));
+    DLY_ms(1000);
+  }
+}
+
+// End of tick: measure cycles since the end of the last one
+void BENCH_tick(uint8_t rendered) {
+  uint32_t now = STK->CNT;
+  uint32_t t   = now - BENCH_start;
+  if(!BENCH_start) BENCH_bytes = BUS_bytes;   // first tick: start measuring
+  else {
+    BENCH_sum += t;
+    if(t < BENCH_min) BENCH_min = t;
+    if(t > BENCH_max) BENCH_max = t;
+    BENCH_renders += rendered;
+    if(++BENCH_ticks >= BENCH_TICKS) BENCH_report();
+  }
+  BENCH_start = now | 1;                      // (never 0)
+}
+
+#endif
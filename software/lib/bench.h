@@ -0,0 +1,65 @@
+// ===================================================================================
+// Benchmark Build of the Games for CH32V003                                  * v1.1 *
+// ===================================================================================
+//
+// "make bench" builds the game with BENCH=1. It then runs unattended and measures
+// the cycles (SysTick counts at STK_FREQ) of every game loop tick:
+//
+// - Inputs come from the game's BENCH_SCRIPT[] (in driver.h). Each step holds the
+//   input for a number of reads of the buttons, the script repeats at its end.
+// - The tick scheduler doesn't wait, every JOY_FRAME_RENDER-th tick is rendered.
+//   Delays and sounds are skipped, JOY_random() keeps its fixed seed.
+// - The display bus driver counts the bytes put on the bus. With I2C_SINK or
+//   SPI_SINK 2 (default of "make bench") nothing is sent at all, so only
+//   composition and game logic are measured; with 1 ("make bench SINK=1") the bus
+//   waits count as well.
+//
+// BENCH_TICKS ticks after the first one, the result is sent every second as a
+// record of the telemetry format (TLM_BENCH, see telemetry.h) via UART on PD5 and
+// the game stops. software/tools/telemetry_decode.py prints it.
+//
+//   TLM_BENCH    u16 ticks, u16 rendered, u32 cycles, u32 min, u32 max, u32 bytes
+//
+// Functions available:
+// --------------------
+// BENCH_input()            next scripted input (direction bits | BENCH_ACT)
+// BENCH_clicked()          1 if the action button is newly pressed in the script
+// BENCH_tick(rendered)     end of a game loop tick
+//
+// 2023 by Stefan Wagner:   https://github.com/wagiminator
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "system.h"
+
+#ifndef BENCH
+#define BENCH         0           // 1: benchmark build (set by "make bench")
+#endif
+
+// Benchmark parameters
+#ifndef BENCH_TICKS
+#define BENCH_TICKS   1024        // number of measured ticks
+#endif
+#define BENCH_ACT     0x80        // script input: action button pressed
+
+// Script step: input held for a number of reads, {0, 0} ends the script
+typedef struct {
+  uint8_t input;
+  uint8_t reads;
+} BENCH_STEP;
+
+#if BENCH > 0
+extern const BENCH_STEP BENCH_SCRIPT[];
+
+uint8_t BENCH_input(void);
+uint8_t BENCH_clicked(void);
+void BENCH_tick(uint8_t rendered);
+#endif
+
+#ifdef __cplusplus
+};
+#endif
@@ -0,0 +1,109 @@
+// ===================================================================================
+// Division-Free Integer Helpers for RV32EC                                   * v1.0 *
+// ===================================================================================
+//
+// The CH32V003 core has no hardware multiply or divide, so every '/', '%' and
+// non-trivial '*' in C ends up in a slow libgcc loop (__udivsi3, __mulsi3).
+// The helpers below replace the constant divisors used in the games by exact
+// shift-add reciprocal sequences (Hacker's Delight, chapter 10). All of them are
+// exact for the full 16-bit input range:
+//
+//   FM_div3(n)   FM_div5(n)   FM_div7(n)   FM_div10(n)
+//   FM_div14(n)  FM_div24(n)  FM_div1000(n)
+//   FM_mod3(n)   FM_mod5(n)   FM_mod10(n)  FM_mod24(n)
+//
+// FM_mod_small() handles a variable divisor by repeated subtraction, which is
+// cheaper than the library call as long as n / d stays a handful of steps.
+//
+// FM_split10() splits a value into decimal digits, FM_below() scales a random
+// number into 0..n-1 without a modulo.
+//
+// 2023 by Stefan Wagner:   https://github.com/wagiminator
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+// Unsigned division by small constants
+static inline uint16_t FM_div3(uint16_t n) {
+  uint32_t q = (n >> 2) + (n >> 4);
+  q += q >> 4;
+  q += q >> 8;
+  uint32_t r = n - ((q << 1) + q);
+  return q + ((((r << 3) + (r << 1) + r)) >> 5);
+}
+
+static inline uint16_t FM_div5(uint16_t n) {
+  uint32_t q = (n >> 1) + (n >> 2);
+  q += q >> 4;
+  q += q >> 8;
+  q >>= 2;
+  uint32_t r = n - ((q << 2) + q);
+  return q + ((((r << 3) - r)) >> 5);
+}
+
+static inline uint16_t FM_div7(uint16_t n) {
+  uint32_t q = (n >> 1) + (n >> 4);
+  q += q >> 6;
+  q += q >> 12;
+  q >>= 2;
+  uint32_t r = n - ((q << 3) - q);
+  return q + ((r + 1) >> 3);
+}
+
+static inline uint16_t FM_div10(uint16_t n) {
+  uint32_t q = (n >> 1) + (n >> 2);
+  q += q >> 4;
+  q += q >> 8;
+  q >>= 3;
+  uint32_t r = n - (((q << 2) + q) << 1);
+  return q + ((r + 6) >> 4);
+}
+
+static inline uint16_t FM_div14(uint16_t n)   { return FM_div7(n >> 1); }
+static inline uint16_t FM_div24(uint16_t n)   { return FM_div3(n >> 3); }
+static inline uint16_t FM_div1000(uint16_t n) { return FM_div10(FM_div10(FM_div10(n))); }
+
+// Remainders
+static inline uint8_t  FM_mod3(uint16_t n)  { uint16_t q = FM_div3(n);  return n - ((q << 1) + q); }
+static inline uint8_t  FM_mod5(uint16_t n)  { uint16_t q = FM_div5(n);  return n - ((q << 2) + q); }
+static inline uint8_t  FM_mod10(uint16_t n) { uint16_t q = FM_div10(n); return n - (((q << 2) + q) << 1); }
+static inline uint8_t  FM_mod24(uint16_t n) { uint16_t q = FM_div24(n); return n - ((q << 4) + (q << 3)); }
+
+// Remainder for a variable divisor when the quotient is known to be small
+static inline uint8_t  FM_mod_small(uint8_t n, uint8_t d) { while(n >= d) n -= d; return n; }
+
+// Signed division by 3 (truncates towards zero like C)
+static inline int16_t FM_sdiv3(int16_t n) {
+  return (n < 0) ? -(int16_t)FM_div3(-n) : (int16_t)FM_div3(n);
+}
+
+// Split val into its lowest cnt decimal digits, least significant first
+static inline void FM_split10(uint16_t val, uint8_t *d, uint8_t cnt) {
+  while(cnt--) {
+    uint16_t q = FM_div10(val);
+    *d++ = val - (((q << 2) + q) << 1);
+    val  = q;
+  }
+}
+
+// Bounded random number 0..n-1 from a 16-bit random number r:
+// (r >> 8) * n >> 8, the multiply is a shift-add loop over the bits of n
+static inline uint8_t FM_below(uint16_t r, uint8_t n) {
+  uint32_t a   = r >> 8;
+  uint32_t acc = 0;
+  while(n) {
+    if(n & 1) acc += a;
+    a <<= 1;
+    n >>= 1;
+  }
+  return acc >> 8;
+}
+
+#ifdef __cplusplus
+};
+#endif
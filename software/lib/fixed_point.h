@@ -0,0 +1,68 @@
+// ===================================================================================
+// Multiply-Free 8.8 Fixed-Point Physics for RV32EC                           * v1.0 *
+// ===================================================================================
+//
+// Positions and velocities of the moving objects (lander, balls) as signed 8.8
+// fixed-point numbers: the high byte is the pixel, the low byte the sub-pixel
+// part (1/256 px). A velocity is given in px per physics step, so one step of
+// the integration is a plain 16-bit add per axis. The CH32V003 core has neither
+// an FPU nor a hardware multiplier, so every float operation and every non-
+// trivial '*' would end up in a slow libgcc loop; the helpers below only add,
+// negate, shift and compare.
+//
+//   FX_from(i)               pixel i as 8.8
+//   FX_const(f)              constant f as 8.8 (folded by the compiler)
+//   FX_int(a)                pixel of a (rounded down)
+//   FX_half(a)               a / 2 (rounded down)
+//   FX_abs(a)                |a|
+//   FX_clamp(a, lo, hi)      a limited to lo..hi
+//   FX_accel(v, a, lim)      velocity *v plus acceleration a (gravity, thrust),
+//                            limited to -lim..lim
+//   FX_move(p, v)            position vector *p plus velocity vector *v
+//   FX_reflect_x(v)          reflection of velocity vector *v at a vertical wall
+//   FX_reflect_y(v)          reflection of velocity vector *v at a horizontal wall
+//
+// Range: -128.0 .. +127.99 px, enough for the 128 x 64 screen.
+//
+// 2023 by Stefan Wagner:   https://github.com/wagiminator
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+typedef int16_t FX;                       // signed 8.8 fixed point
+typedef struct { FX x, y; } FX_VEC;       // 8.8 vector
+
+#define FX_SHIFT      8
+#define FX_ONE        (1 << FX_SHIFT)
+
+#define FX_from(i)    ((FX)((i) << FX_SHIFT))
+#define FX_const(f)   ((FX)((f) * FX_ONE + ((f) < 0 ? -0.5 : 0.5)))
+#define FX_int(a)     ((int16_t)((a) >> FX_SHIFT))
+#define FX_half(a)    ((FX)((a) >> 1))
+
+static inline FX FX_abs(FX a) { return (a < 0) ? -a : a; }
+
+static inline FX FX_clamp(FX a, FX lo, FX hi) {
+  return (a < lo) ? lo : (a > hi) ? hi : a;
+}
+
+// Integration steps
+static inline void FX_accel(FX* v, FX a, FX lim) { *v = FX_clamp(*v + a, -lim, lim); }
+
+static inline void FX_move(FX_VEC* p, const FX_VEC* v) {
+  p->x += v->x;
+  p->y += v->y;
+}
+
+// Reflections
+static inline void FX_reflect_x(FX_VEC* v) { v->x = -v->x; }
+static inline void FX_reflect_y(FX_VEC* v) { v->y = -v->y; }
+
+#ifdef __cplusplus
+};
+#endif
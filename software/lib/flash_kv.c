@@ -0,0 +1,257 @@
+// ===================================================================================
+// Wear-Levelled Key-Value Store in Flash for CH32V003                        * v1.2 *
+// ===================================================================================
+// 2023 by Stefan Wagner:   https://github.com/wagiminator
+
+#include "flash_kv.h"
+
+#define KV_NONE       0xFF        // no cache entry
+#define KV_DIRTY      0xFF        // home of an entry that is not committed yet
+#define KV_ERASE      0x01        // state: page after the head has to be erased
+#define KV_TASK       0x02        // state: commit task is waiting
+#define KV_READY      0x04        // state: log has been read
+
+#define KV_next(p)    ((p) < KV_PAGES - 1 ? (p) + 1 : 0)
+
+// Flash pages of the store
+#ifdef SIM
+volatile uint8_t KV_flash[KV_PAGES][KV_PAGE];   // loaded/saved by the simulator ("-k")
+const uint16_t   KV_flash_size = sizeof(KV_flash);
+#else
+volatile uint8_t KV_flash[KV_PAGES][KV_PAGE] __attribute__((section(".kvstore"), aligned(KV_PAGE)));
+#endif
+
+// RAM cache
+uint8_t  KV_key[KV_KEYS];             // key of each entry
+uint8_t  KV_len[KV_KEYS];             // length of its value, 0: entry unused
+uint8_t  KV_home[KV_KEYS];            // page with its latest record or KV_DIRTY
+uint8_t  KV_val[KV_KEYS][KV_VALUE];   // latest value
+uint8_t  KV_head;                     // page written last
+uint16_t KV_seq;                      // sequence number of the head page
+uint8_t  KV_state;                    // KV_ERASE, KV_TASK, KV_READY
+
+// ===================================================================================
+// Flash Programming (64-byte fast mode)
+// ===================================================================================
+#ifdef SIM
+
+void KV_page_erase(volatile uint8_t* page) {
+  for(uint8_t i=0; i<KV_PAGE; i++) page[i] = 0xFF;
+}
+
+void KV_page_program(volatile uint8_t* page, const uint32_t* buf) {
+  for(uint8_t i=0; i<KV_PAGE; i++) page[i] &= ((const uint8_t*)buf)[i];
+}
+
+#else
+
+// Unlock flash and fast programming mode
+static void KV_unlock(void) {
+  FLASH->KEYR     = 0x45670123;
+  FLASH->KEYR     = 0xCDEF89AB;
+  FLASH->MODEKEYR = 0x45670123;
+  FLASH->MODEKEYR = 0xCDEF89AB;
+}
+
+// Wait for the end of a flash operation
+static void KV_wait(void) {
+  while(FLASH->STATR & FLASH_STATR_BSY);
+  FLASH->STATR = FLASH_STATR_EOP;
+}
+
+// Erase 64-byte page
+void KV_page_erase(volatile uint8_t* page) {
+  KV_unlock();
+  FLASH->CTLR |= FLASH_CTLR_PAGE_ER;
+  FLASH->ADDR  = FLASH_BASE | (uint32_t)page;
+  FLASH->CTLR |= FLASH_CTLR_STRT;
+  KV_wait();
+  FLASH->CTLR &= ~FLASH_CTLR_PAGE_ER;
+  FLASH->CTLR |= FLASH_CTLR_LOCK | FLASH_CTLR_FLOCK;
+}
+
+// Program erased 64-byte page with 16 words through the page buffer
+void KV_page_program(volatile uint8_t* page, const uint32_t* buf) {
+  volatile uint32_t* dst = (volatile uint32_t*)(FLASH_BASE | (uint32_t)page);
+  KV_unlock();
+  FLASH->CTLR |= FLASH_CTLR_PAGE_PG;
+  FLASH->CTLR |= FLASH_CTLR_BUF_RST;
+  KV_wait();
+  for(uint8_t i=0; i<KV_PAGE/4; i++) {
+    dst[i] = buf[i];
+    FLASH->CTLR |= FLASH_CTLR_BUF_LOAD;
+    KV_wait();
+  }
+  FLASH->ADDR  = (uint32_t)dst;
+  FLASH->CTLR |= FLASH_CTLR_STRT;
+  KV_wait();
+  FLASH->CTLR &= ~FLASH_CTLR_PAGE_PG;
+  FLASH->CTLR |= FLASH_CTLR_LOCK | FLASH_CTLR_FLOCK;
+}
+
+#endif
+
+#define KV_erase(p)       KV_page_erase(KV_flash[p])
+#define KV_program(p, b)  KV_page_program(KV_flash[p], b)
+
+// ===================================================================================
+// Log and Cache
+// ===================================================================================
+
+// CRC-8 (polynomial 0x07) of one more byte
+static uint8_t KV_crc(uint8_t crc, uint8_t b) {
+  crc ^= b;
+  for(uint8_t i=0; i<8; i++) crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : crc << 1;
+  return crc;
+}
+
+// Check if page p is erased
+static uint8_t KV_blank(uint8_t p) {
+  for(uint8_t i=0; i<KV_PAGE; i++) if(KV_flash[p][i] != 0xFF) return 0;
+  return 1;
+}
+
+// Cache entry of key, a free one if key isn't cached, KV_NONE if the cache is full
+static uint8_t KV_entry(uint8_t key) {
+  uint8_t i, free = KV_NONE;
+  for(i=0; i<KV_KEYS; i++) {
+    if(!KV_len[i]) { if(free == KV_NONE) free = i; }
+    else if(KV_key[i] == key) return i;
+  }
+  return free;
+}
+
+// Check if an entry is not committed yet
+static uint8_t KV_dirty(void) {
+  for(uint8_t i=0; i<KV_KEYS; i++) if(KV_len[i] && KV_home[i] == KV_DIRTY) return 1;
+  return 0;
+}
+
+// Commit: program the page after the head with the dirty entries and the entries
+// whose latest record is in the page after that (erased next)
+static void KV_commit(void) {
+  uint32_t page[KV_PAGE/4];
+  uint8_t* b = (uint8_t*)page;
+  uint8_t  p = KV_next(KV_head);
+  uint8_t  v = KV_next(p);
+  uint8_t  n = KV_HEAD, i, j, crc;
+  for(i=0; i<KV_PAGE/4; i++) page[i] = 0xFFFFFFFF;
+  if(++KV_seq == 0xFFFF) KV_seq = 0;          // (0xFFFF: erased)
+  b[0] = KV_seq;
+  b[1] = KV_seq >> 8;
+  for(i=0; i<KV_KEYS; i++) {
+    if(!KV_len[i] || (KV_home[i] != KV_DIRTY && KV_home[i] != v)) continue;
+    b[n++] = KV_key[i];
+    b[n++] = KV_len[i];
+    crc = KV_crc(KV_crc(0, KV_key[i]), KV_len[i]);
+    for(j=0; j<KV_len[i]; j++) crc = KV_crc(crc, b[n++] = KV_val[i][j]);
+    b[n++] = crc;
+    KV_home[i] = p;
+  }
+  KV_program(p, page);
+  KV_head = p;
+  if(!KV_blank(v)) KV_state |= KV_ERASE;
+}
+
+// Erase the page after the head (entries still in it are committed again)
+static void KV_clear(void) {
+  uint8_t p = KV_next(KV_head);
+  for(uint8_t i=0; i<KV_KEYS; i++) if(KV_home[i] == p) KV_home[i] = KV_DIRTY;
+  KV_erase(p);
+  KV_state &= ~KV_ERASE;
+}
+
+static void KV_task(void* ctx);
+
+// Schedule the commit task
+static void KV_schedule(void) {
+  if(!(KV_state & KV_TASK) && TSK_after(0, KV_task, 0) != TSK_NONE) KV_state |= KV_TASK;
+}
+
+// Commit task: one flash operation per call
+static void KV_task(void* ctx) {
+  KV_state &= ~KV_TASK;
+  if(KV_state & KV_ERASE) KV_clear();
+  else if(KV_dirty()) KV_commit();
+  if((KV_state & KV_ERASE) || KV_dirty()) KV_schedule();
+}
+
+// Read the log into the cache, oldest page first
+void KV_init(void) {
+  uint8_t  p, n, i, j, key, len, crc, found = 0;
+  uint16_t s;
+  if(KV_state & KV_READY) return;
+  KV_state |= KV_READY;
+  KV_head = KV_PAGES - 1;
+  KV_seq  = 0xFFFF;
+  for(p=0; p<KV_PAGES; p++) {
+    s = KV_flash[p][0] | (uint16_t)KV_flash[p][1] << 8;
+    if(s == 0xFFFF) continue;
+    if(!found || (int16_t)(s - KV_seq) > 0) {
+      KV_head = p;
+      KV_seq  = s;
+      found   = 1;
+    }
+  }
+  p = KV_head;
+  do {
+    p = KV_next(p);
+    if((KV_flash[p][0] & KV_flash[p][1]) == 0xFF) continue;
+    for(n=KV_HEAD; n+3<=KV_PAGE; n+=len+3) {
+      key = KV_flash[p][n];
+      len = KV_flash[p][n+1];
+      if(key > KV_KEY_MAX || !len || len > KV_VALUE || n + len + 3 > KV_PAGE) break;
+      crc = KV_crc(KV_crc(0, key), len);
+      for(j=0; j<len; j++) crc = KV_crc(crc, KV_flash[p][n+2+j]);
+      if(crc != KV_flash[p][n+2+len]) break;  // torn record: rest of the page is void
+      i = KV_entry(key);
+      if(i == KV_NONE) continue;
+      KV_key[i]  = key;
+      KV_len[i]  = len;
+      KV_home[i] = p;
+      for(j=0; j<len; j++) KV_val[i][j] = KV_flash[p][n+2+j];
+    }
+  } while(p != KV_head);
+  if(!KV_blank(KV_next(KV_head))) {           // erase interrupted by a power loss
+    KV_state |= KV_ERASE;
+    KV_schedule();
+  }
+}
+
+// Copy the cached value of key into buf, returns its length
+uint8_t KV_get(uint8_t key, void* buf, uint8_t len) {
+  uint8_t i = KV_entry(key);
+  if(i == KV_NONE || !KV_len[i]) return 0;
+  if(len > KV_len[i]) len = KV_len[i];
+  for(uint8_t j=0; j<len; j++) ((uint8_t*)buf)[j] = KV_val[i][j];
+  return KV_len[i];
+}
+
+// Store value of key, commit in the background if it has changed
+void KV_set(uint8_t key, const void* buf, uint8_t len) {
+  const uint8_t* b = buf;
+  uint8_t i = KV_entry(key), j;
+  if(i == KV_NONE || !len || len > KV_VALUE || key > KV_KEY_MAX) return;
+  if(KV_len[i] == len) {
+    for(j=0; j<len && KV_val[i][j] == b[j]; j++);
+    if(j == len) return;                      // unchanged
+  }
+  KV_key[i]  = key;
+  KV_len[i]  = len;
+  KV_home[i] = KV_DIRTY;
+  for(j=0; j<len; j++) KV_val[i][j] = b[j];
+  KV_schedule();
+}
+
+// Commit pending values now
+void KV_sync(void) {
+  while((KV_state & KV_ERASE) || KV_dirty()) {
+    if(KV_state & KV_ERASE) KV_clear();
+    else KV_commit();
+  }
+}
+
+// Check if values still have to be committed
+uint8_t KV_pending(void) {
+  return KV_dirty();
+}
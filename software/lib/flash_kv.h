@@ -0,0 +1,100 @@
+// ===================================================================================
+// Wear-Levelled Key-Value Store in Flash for CH32V003                        * v1.3 *
+// ===================================================================================
+//
+// Keeps small values (high scores, settings) across power cycles in the last
+// KV_PAGES 64-byte pages of the flash. The store is an append-only log: a commit
+// programs the next page of the ring with the records changed since the last
+// commit, using the 64-byte fast page programming mode. The pages are written in
+// turn, so every page gets the same wear. Each page starts with a u16 sequence
+// number, followed by the records
+//
+//   u8 key, u8 len, value[len], u8 CRC-8 (polynomial 0x07) of key, len, value
+//
+// up to a key of 0xFF (erased). A record with a wrong CRC ends its page, so a
+// write torn by a power loss costs that page, never a value of an older one.
+//
+// KV_init() reads the log once, oldest page first, into a RAM cache of the latest
+// value of every key; KV_get() only reads the cache. KV_set() updates the cache
+// and schedules the commit as a timed task (TSK_after() in system.h), so flash is
+// only written from TSK_run(), i.e. while a game waits for its next frame. A
+// commit is split into two task runs: the page program, then the erase of the
+// page after it. That page is always erased ahead of the next commit, and the
+// records whose latest copy is in it are carried over into the page written
+// before, so no value is lost and no commit waits for an erase. KV_sync()
+// finishes a pending commit right away.
+//
+// The store belongs to the device, not to a program: the joypad calibration and
+// the I2C clock rate written by the calibrator (KV_KEY_PADCAL, KV_KEY_I2CCLK) are
+// read by every game, so keep the keys below KV_KEY_SHARED for the values of the
+// game itself.
+//
+// The pages are reserved by the .kvstore section at the end of FLASH in the
+// linker script; ld fails if the program grows into them. The CPU stalls while
+// a page is programmed or erased (code runs from flash). A chip erase clears
+// the store.
+//
+// Functions available:
+// --------------------
+// KV_init()                read the log into the cache (at startup, later calls
+//                          return right away)
+// KV_get(key, buf, len)    copy up to len bytes of the value of key (0..KV_KEY_MAX)
+//                          into buf, returns its length (0: not stored)
+// KV_set(key, buf, len)    store len (1..KV_VALUE) bytes as value of key,
+//                          committed to flash in the background
+// KV_sync()                commit pending values now (waits for the flash)
+// KV_pending()             1 if values still have to be committed
+//
+// KV_page_erase(page)      erase a 64-byte page of flash (aligned, e.g. of the
+//                          game snapshot in snapshot.h)
+// KV_page_program(page,b)  program an erased 64-byte page with the 16 words of b
+//
+// 2023 by Stefan Wagner:   https://github.com/wagiminator
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "system.h"
+
+// Store parameters
+#define KV_PAGES      8           // pages of the ring (64 bytes each, 2..128)
+#ifndef KV_KEYS
+#define KV_KEYS       4           // keys cached in RAM
+#endif
+#define KV_VALUE      11          // max length of a value in bytes
+#define KV_KEY_MAX    0xFE        // highest key (0xFF marks the end of a page)
+
+#define KV_PAGE       64          // fast programming page size
+#define KV_HEAD       2           // u16 sequence number at the start of a page
+
+// Keys shared by all programs
+#define KV_KEY_SHARED 0xF0        // first shared key
+#define KV_KEY_PADCAL 0xF0        // joypad calibration, written by the calibrator
+#define KV_PADCAL_LEN 11          // bits 0..7 of the 8 band points in ascending order
+                                  // (E, N, NE, S, SE, W, NW, SW), their bits 8..9 in
+                                  // two bytes (points 0..3, 4..7, 2 bits each from
+                                  // bit 0 up), the deviation
+#define KV_KEY_I2CCLK 0xF1        // I2C clock rate of the display, by the calibrator
+#define KV_I2CCLK_LEN 2           // rate in kHz, low byte first
+
+#if KV_KEYS * (KV_VALUE + 3) > KV_PAGE - KV_HEAD
+#error "flash_kv.h: all cached keys must fit into one page (KV_KEYS, KV_VALUE)"
+#endif
+
+// Store functions
+void KV_init(void);                                       // read log into cache
+uint8_t KV_get(uint8_t key, void* buf, uint8_t len);      // read value from cache
+void KV_set(uint8_t key, const void* buf, uint8_t len);   // store value
+void KV_sync(void);                                       // commit pending now
+uint8_t KV_pending(void);                                 // commit pending?
+
+// Flash page functions (64-byte fast mode)
+void KV_page_erase(volatile uint8_t* page);                         // erase page
+void KV_page_program(volatile uint8_t* page, const uint32_t* buf);  // program page
+
+#ifdef __cplusplus
+};
+#endif
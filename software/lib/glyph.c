@@ -0,0 +1,67 @@
+// ===================================================================================
+// Shared Text Renderer with Subset Fonts                                     * v1.0 *
+// ===================================================================================
+// 2023 by Stefan Wagner:   https://github.com/wagiminator
+
+#include "glyph.h"
+
+#if GLYPH_SUBSET > 0
+#include "glyphs.h"                   // glyphs of the firmware (src, generated)
+#else
+#include "font_5x8.h"                 // all glyphs
+#endif
+
+// Pointer to the columns of the glyph of c, 0 if it has none
+const uint8_t* GLYPH_get(char c) {
+  const uint8_t* run = GLYPH_runs;
+  uint16_t idx = 0;
+  while(run[1]) {
+    uint8_t k = (uint8_t)c - run[0];
+    if(k < run[1]) {
+      idx += k;
+      return &GLYPH_font[(idx << 2) + idx];   // -> idx * 5
+    }
+    idx += run[1];
+    run += 2;
+  }
+  return 0;
+}
+
+// Write the columns of c and the blank column behind it
+uint8_t* GLYPH_put(uint8_t* buf, char c) {
+  const uint8_t* g = GLYPH_get(c);
+  for(uint8_t i=GLYPH_W; i; i--) *buf++ = g ? *g++ : 0x00;
+  *buf++ = 0x00;
+  return buf;
+}
+
+// Write the characters of a string
+uint8_t* GLYPH_print(uint8_t* buf, const char* s) {
+  while(*s) buf = GLYPH_put(buf, *s++);
+  return buf;
+}
+
+// OR columns x0..x1 of a string at column xs into a row of the compositor
+void GLYPH_span(uint8_t* buf, const char* s, uint8_t xs, uint8_t x0, uint8_t x1) {
+  const uint8_t* g;
+  uint8_t col;
+  while(*s && xs + GLYPH_ADV <= x0) {     // characters left of the span
+    xs += GLYPH_ADV;
+    s++;
+  }
+  if(!*s || xs > x1) return;
+  if(xs > x0) {                           // span starts left of the string
+    buf += xs - x0;
+    x0   = xs;
+  }
+  col = x0 - xs;
+  g   = GLYPH_get(*s);
+  for(; x0<=x1; x0++, buf++) {
+    if(g && col < GLYPH_W) *buf |= g[col];
+    if(++col == GLYPH_ADV) {
+      if(!*++s) break;
+      col = 0;
+      g   = GLYPH_get(*s);
+    }
+  }
+}
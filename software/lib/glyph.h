@@ -0,0 +1,53 @@
+// ===================================================================================
+// Shared Text Renderer with Subset Fonts                                     * v1.0 *
+// ===================================================================================
+//
+// Renders characters of the 5x8 font (font_5x8.h) as page bytes: five columns per
+// glyph and a blank one between the characters, six columns per character in
+// total. They are written into a page buffer (e.g. the line buffer of a terminal
+// or a buffer sent as it is) or ORed into a row of the layer compositor.
+//
+// With GLYPH_SUBSET the tables come from src/glyphs.h of the firmware instead of
+// the whole font. tools/glyph_subset.py generates them from the literals of the
+// sources and the characters composed at run time ("make glyphs"), so the image
+// only holds the glyphs that are printed. Characters without a glyph in the
+// tables are rendered as blank columns, so a space costs nothing.
+//
+// The glyphs are found by the runs of consecutive codes in the tables (digits,
+// capitals, ...), a few compares per character. Take the glyph pointer out of
+// a loop that renders the same character again.
+//
+// Functions available:
+// --------------------
+// GLYPH_get(c)             Pointer to the 5 columns of c, 0 if c has no glyph
+// GLYPH_put(buf, c)        Write the 6 columns of c to buf, returns buf + 6
+// GLYPH_print(buf, s)      Write the characters of string s, returns the end
+// GLYPH_span(buf, s, xs, x0, x1)
+//                          OR columns x0..x1 of string s, whose first character
+//                          starts at column xs, into the row buf (at column x0)
+//
+// 2023 by Stefan Wagner:   https://github.com/wagiminator
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "system.h"
+
+#ifndef GLYPH_SUBSET
+#define GLYPH_SUBSET  0           // 0: whole font, 1: tables of src/glyphs.h
+#endif
+
+#define GLYPH_W       5           // columns of a glyph
+#define GLYPH_ADV     6           // columns of a character (glyph and blank)
+
+const uint8_t* GLYPH_get(char c);
+uint8_t* GLYPH_put(uint8_t* buf, char c);
+uint8_t* GLYPH_print(uint8_t* buf, const char* s);
+void GLYPH_span(uint8_t* buf, const char* s, uint8_t xs, uint8_t x0, uint8_t x1);
+
+#ifdef __cplusplus
+};
+#endif
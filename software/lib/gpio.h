@@ -1,5 +1,5 @@
 // ===================================================================================
-// Basic GPIO Functions for CH32V003                                          * v1.6 *
+// Basic GPIO Functions for CH32V003                                          * v1.7 *
 // ===================================================================================
 //
 // Pins must be defined as PA0, PA1, .., PC0, PC1, etc. - e.g.:
@@ -66,6 +66,14 @@
 // ADC_read()               Sample and read ADC value (0..1023)
 // ADC_read_VDD()           Sample and read supply voltage (VDD) in millivolts (mV)
 //
+// ADC_DMA_start(buf, len)  Start continuous conversions into circular buffer (DMA)
+// ADC_DMA_stop()           Stop continuous conversions (ADC_read() can be used again)
+//
+// ADC_VDD_init()           Set up Vref as injected channel (after ADC_init())
+// ADC_VDD_start()          Start conversion of Vref between the regular ones
+// ADC_VDD_done()           Check if the conversion of Vref is done
+// ADC_VDD_get()            Read supply voltage (VDD) in mV of that conversion
+//
 // Op-Amp Comparator (OPA) functions available:
 // --------------------------------------------
 // OPA_enable()             Enable OPA comparator
@@ -83,6 +91,9 @@
 //   (For example, PA1 and PC1 cannot be used simultaneously, but PA1 and PC2).
 // - Pins used for ADC must be set with PIN_input_AN beforehand. Only the following 
 //   pins can be used as INPUT for the ADC: PA1, PA2, PC4, PD2, PD3, PD4, PD5, PD6.
+// - The injected conversion of Vref (ADC_VDD_...) interrupts a running regular
+//   conversion, which is then done again, so VDD can be sampled while ADC_read()
+//   or ADC_DMA_start() sample the regular input undisturbed.
 // - Pins used as input for OPA comparator must be set with PIN_input_AN beforehand.
 //   Only the following pins can be used for the OPA: PA1 or PD0 as negative
 //   (inverting) input, PA2 or PD7 as positive (non-inverting) input and PD4 as
@@ -398,11 +409,48 @@ static inline uint16_t ADC_read(void) {
   return ADC1->RDATAR;                          // return result
 }
 
+// Continuous conversions of the ADC input, DMA channel 1 writes the results
+// into buf[0..len-1] round and round without any involvement of the CPU
+static inline void ADC_DMA_start(volatile uint16_t* buf, uint16_t len) {
+  RCC->AHBPCENR |= RCC_DMA1EN;                  // enable DMA module clock
+  DMA1_Channel1->CFGR  = 0;                     // disable channel for setup
+  DMA1_Channel1->PADDR = (uint32_t)&ADC1->RDATAR; // peripheral address
+  DMA1_Channel1->MADDR = (uint32_t)buf;         // memory address
+  DMA1_Channel1->CNTR  = len;                   // number of samples
+  DMA1_Channel1->CFGR  = DMA_CFGR1_MINC         // increment memory address
+                       | DMA_CFGR1_CIRC         // circular mode
+                       | DMA_CFGR1_PSIZE_0      // 16-bit peripheral
+                       | DMA_CFGR1_MSIZE_0      // 16-bit memory
+                       | DMA_CFGR1_EN;          // enable channel
+  ADC1->CTLR2 |= ADC_DMA | ADC_CONT;            // DMA requests, continuous mode
+  ADC1->CTLR2 |= ADC_SWSTART;                   // start first conversion
+}
+
+static inline void ADC_DMA_stop(void) {
+  ADC1->CTLR2 &= ~(ADC_DMA | ADC_CONT);         // single conversions again
+  DMA1_Channel1->CFGR = 0;                      // disable DMA channel
+  (void)ADC1->RDATAR;                           // clear pending EOC flag
+}
+
 static inline uint16_t ADC_read_VDD(void) {
   ADC_input_VREF();                             // set VREF as ADC input
   return((uint32_t)1200 * 1023 / ADC_read());   // return VDD im mV
 }
 
+// Vref as the only injected channel (JSQ4 with JL = 0), started by software
+static inline void ADC_VDD_init(void) {
+  ADC1->ISQR   = (uint32_t)8 << 15;             // injected channel: Vref
+  ADC1->CTLR2 |= ADC_JEXTSEL | ADC_JEXTTRIG;     // trigger: JSWSTART
+}
+
+#define ADC_VDD_start()     (ADC1->STATR = ~ADC_JEOC, ADC1->CTLR2 |= ADC_JSWSTART)
+#define ADC_VDD_done()      (ADC1->STATR & ADC_JEOC)
+
+static inline uint16_t ADC_VDD_get(void) {
+  uint16_t v = ADC1->IDATAR1;                   // Vref of the injected conversion
+  return v ? (uint32_t)1200 * 1023 / v : 0;     // return VDD in mV
+}
+
 // ===================================================================================
 // OPA Functions
 // ===================================================================================
@@ -0,0 +1,691 @@
+// ===================================================================================
+// Basic I2C Master Functions for CH32V003                                    * v2.0 *
+// ===================================================================================
+// 2023 by Stefan Wagner:   https://github.com/wagiminator
+
+#include "i2c_tx.h"
+
+// Interrupt handlers
+void I2C1_EV_IRQHandler(void);
+void DMA1_Channel6_IRQHandler(void);
+
+// I2C event flag definitions
+#define I2C_START_GENERATED     0x00010003    // BUSY, MSL, SB
+#define I2C_ADDR_TRANSMITTED    0x00820003    // BUSY, MSL, ADDR, TXE
+#define I2C_BYTE_TRANSMITTED    0x00840003    // BUSY, MSL, BTF, TXE
+#define I2C_checkEvent(n)       (((((uint32_t)I2C1->STAR1<<16) | I2C1->STAR2) & n) == n)
+
+// Hot functions, run from SRAM if enabled
+#if I2C_IN_RAM > 0
+  #define I2C_HOT               RAMFUNC
+#else
+  #define I2C_HOT
+#endif
+
+#if I2C_SINK > 0
+volatile uint32_t I2C_bytes;                      // number of bytes put on the bus
+#define I2C_count(n)            I2C_bytes += (n)
+#else
+#define I2C_count(n)
+#endif
+
+volatile uint8_t  I2C_error;                      // bus failure, 0: working
+volatile uint16_t I2C_errors;                     // number of bus failures
+uint16_t          I2C_recoveries;                 // number of recoveries
+uint32_t          I2C_rate = I2C_CLKRATE;         // clock rate (Hz)
+
+#if I2C_SINK == 2
+// ===================================================================================
+// Null Sink (benchmark builds): bytes are counted, but not sent
+// ===================================================================================
+void I2C_init(void) {}
+void I2C_setClock(void) {}
+void I2C_setRate(uint32_t rate) { I2C_rate = (rate > I2C_RATE_MAX) ? I2C_RATE_MAX : rate; }
+void I2C_start(uint8_t addr) { I2C_count(1); }
+void I2C_write(uint8_t data) { I2C_count(1); }
+void I2C_stop(void) {}
+void I2C_writeBuffer(uint8_t* buf, uint16_t len) { I2C_count(len); }
+void I2C_streamBuffer(uint8_t* buf, uint16_t len) { I2C_count(len); }
+void I2C_fill(uint8_t p, uint16_t len) { I2C_count(len); }
+uint8_t I2C_read(uint8_t addr, const uint8_t* reg, uint8_t reglen, uint8_t* buf, uint16_t len) {
+  I2C_count((reglen ? 2 : 1) + reglen + len);
+  while(len--) *buf++ = 0xFF;                     // (like an erased EEPROM)
+  return 1;
+}
+uint8_t I2C_probe(uint8_t addr, const uint8_t* buf, uint16_t len) {
+  I2C_count(1 + len);
+  return 1;
+}
+void I2C_recover(void) { I2C_error = 0; }
+void I2C_DMA_wait(void) {}
+void I2C_flush(void) {}
+#if I2C_QUEUE > 0
+uint16_t I2C_fence(void) { return 0; }
+void I2C_wait(uint16_t ticket) {}
+#if I2C_STAMP > 0
+volatile uint32_t I2C_stamp_time;
+volatile uint8_t  I2C_stamp_on;
+void I2C_stamp(uint16_t ticket) { I2C_stamp_time = STK->CNT; }
+#endif
+#endif
+
+#else
+
+#if I2C_TIMEOUT > 0
+// Progress watch of a wait
+typedef struct {
+  uint32_t since;                                 // SysTick count of the last progress
+  uint32_t mark;                                  // transfer state seen then
+} I2C_WATCH;
+
+static uint8_t I2C_expired(I2C_WATCH* w);
+
+// Wait until cond is true, give up after I2C_TIMEOUT us without progress or if the
+// bus has already failed (I2C_error is set then)
+#define I2C_until(cond) for(I2C_WATCH w_ = {0, 0xFFFFFFFF}; !(cond) && !I2C_expired(&w_); )
+#else
+#define I2C_until(cond) while(!(cond))
+#endif
+
+// Fast mode clock divider of the rate (SCL low:high 2:1), rounded up
+static uint16_t I2C_divider(void) {
+  uint32_t div = (CLK_freq() + 3 * I2C_rate - 1) / (3 * I2C_rate);
+  return div ? div : 1;
+}
+
+// Init I2C
+void I2C_init(void) {
+  #if I2C_REMAP == 0
+  // Enable GPIO port C and I2C module
+  RCC->APB2PCENR |= RCC_AFIOEN | RCC_IOPCEN;
+  RCC->APB1PCENR |= RCC_I2C1EN;
+
+  // Set pin PC1 (SDA) and PC2 (SCL) to output, open-drain, 10MHz, multiplex
+  GPIOC->CFGLR = (GPIOC->CFGLR & ~(((uint32_t)0b1111<<(1<<2)) | ((uint32_t)0b1111<<(2<<2))))
+                               |  (((uint32_t)0b1101<<(1<<2)) | ((uint32_t)0b1101<<(2<<2)));
+  #elif I2C_REMAP == 1
+  // Remap I2C pins, enable GPIO port D and I2C module
+  RCC->APB2PCENR |= RCC_AFIOEN | RCC_IOPDEN;
+  RCC->APB1PCENR |= RCC_I2C1EN;
+  AFIO->PCFR1    |= 1<<1;
+
+  // Set pin PD0 (SDA) and PD1 (SCL) to output, open-drain, 10MHz, multiplex
+  GPIOD->CFGLR = (GPIOD->CFGLR & ~(((uint32_t)0b1111<<(0<<2)) | ((uint32_t)0b1111<<(1<<2))))
+                               |  (((uint32_t)0b1101<<(0<<2)) | ((uint32_t)0b1101<<(1<<2)));
+  #elif I2C_REMAP == 2
+  // Remap I2C pins, enable GPIO port C and I2C module
+  RCC->APB2PCENR |= RCC_AFIOEN | RCC_IOPCEN;
+  RCC->APB1PCENR |= RCC_I2C1EN;
+  AFIO->PCFR1    |= 1<<22;
+
+  // Set pin PC6 (SDA) and PC5 (SCL) to output, open-drain, 10MHz, multiplex
+  GPIOC->CFGLR = (GPIOC->CFGLR & ~(((uint32_t)0b1111<<(6<<2)) | ((uint32_t)0b1111<<(5<<2))))
+                               |  (((uint32_t)0b1101<<(6<<2)) | ((uint32_t)0b1101<<(5<<2)));
+  #else
+    #warning Wrong I2C REMAP
+  #endif
+
+  // Set I2C module clock frequency (in MHz)
+  I2C1->CTLR2 = 4;
+
+  // Set bus clock configuration
+  I2C1->CKCFGR = I2C_divider() | I2C_CKCFGR_FS;
+
+  // Enable I2C
+  I2C1->CTLR1 = I2C_CTLR1_PE;
+
+  #if I2C_DMA > 0
+  // Setup DMA Channel 6
+  RCC->AHBPCENR |= RCC_DMA1EN;                    // enable DMA module clock
+  DMA1_Channel6->PADDR = (uint32_t)&I2C1->DATAR;  // peripheral address
+  DMA1_Channel6->CFGR  = DMA_CFG6_MINC            // increment memory address
+                       | DMA_CFG6_DIR             // memory to I2C
+                       | DMA_CFG6_TCIE;           // transfer complete interrupt enable
+  DMA1->INTFCR         = DMA_CGIF6;               // clear interrupt flags
+  NVIC_EnableIRQ(DMA1_Channel6_IRQn);             // enable the DMA IRQ
+  #endif
+
+  #if I2C_QUEUE > 0
+  #if I2C_VTF >= 0
+  VTF_enable(I2C_VTF, I2C1_EV_IRQn, I2C1_EV_IRQHandler); // fast interrupt
+  #endif
+  NVIC_EnableIRQ(I2C1_EV_IRQn);                   // enable the I2C event IRQ
+  #elif I2C_DMA > 0 && I2C_VTF >= 0
+  VTF_enable(I2C_VTF, DMA1_Channel6_IRQn, DMA1_Channel6_IRQHandler);
+  #endif
+}
+
+// Set bus clock configuration for the current system clock (waits for the bus)
+void I2C_setClock(void) {
+  I2C_flush();
+  I2C1->CTLR1  = 0;                               // clock can only be set when disabled
+  I2C1->CKCFGR = I2C_divider() | I2C_CKCFGR_FS;
+  I2C1->CTLR1  = I2C_CTLR1_PE;
+}
+
+// Set bus clock rate (Hz, up to I2C_RATE_MAX, waits for the bus)
+void I2C_setRate(uint32_t rate) {
+  I2C_rate = (rate > I2C_RATE_MAX) ? I2C_RATE_MAX : rate;
+  I2C_setClock();
+}
+
+// Wait until the DMA transfer is done
+void I2C_DMA_wait(void) {
+  I2C_until(!I2C_DMA_busy());
+}
+
+#if I2C_QUEUE > 0
+// ===================================================================================
+// Interrupt Driven Transmit Queue
+// ===================================================================================
+
+// Queue token definitions (lower byte contains address or data byte)
+#define I2C_TOK_START   0x0100                    // START condition + address
+#define I2C_TOK_STOP    0x0200                    // STOP condition
+#define I2C_TOK_BUFFER  0x0400                    // next buffer from buffer queue
+#define I2C_TOK_FILL    0x0800                    // (with BUFFER) repeat its first byte
+
+// Queue states
+#define I2C_Q_IDLE      0                         // no transmission open
+#define I2C_Q_RUN       1                         // interrupt or DMA will follow
+#define I2C_Q_STALL     2                         // transmission open, queue empty
+
+#define I2C_IT_ALL      (I2C_CTLR2_ITEVTEN | I2C_CTLR2_ITBUFEN)
+
+// Queue variables
+uint16_t          I2C_queue[I2C_QUEUE_LEN];       // token ring buffer
+volatile uint16_t I2C_qin;                        // number of tokens queued
+volatile uint16_t I2C_qout;                       // number of tokens processed
+volatile uint8_t  I2C_qstate;                     // queue state
+volatile uint8_t  I2C_open;                       // 1: START sent, STOP not yet
+#if I2C_STAMP > 0
+volatile uint16_t I2C_stamp_at;                   // ticket to be stamped
+volatile uint8_t  I2C_stamp_on;                   // 1: ticket not sent yet
+volatile uint32_t I2C_stamp_time;                 // SysTick count it was sent at
+#endif
+#if I2C_DMA > 0
+uint8_t*          I2C_bufptr[I2C_BUF_LEN];        // queued DMA buffer pointers
+uint8_t           I2C_fillpat[I2C_BUF_LEN];       // pattern bytes of queued fills
+uint16_t          I2C_buflen[I2C_BUF_LEN];        // queued DMA buffer lengths
+volatile uint8_t  I2C_bufin;                      // number of buffers queued
+volatile uint8_t  I2C_bufout;                     // number of buffers processed
+#endif
+
+// Process the queue as far as possible (called by interrupts or to restart)
+static I2C_HOT void I2C_process(void) {
+  uint16_t star1 = I2C1->STAR1;
+  if(star1 & I2C_STAR1_SB) {                      // START generated?
+    I2C1->DATAR = (uint8_t)I2C_queue[I2C_qout & (I2C_QUEUE_LEN - 1)]; // send address
+    I2C_qout++;
+    return;                                       // ADDR event will follow
+  }
+  if(star1 & I2C_STAR1_ADDR) (void)I2C1->STAR2;   // address sent -> clear flag
+  while(1) {
+    if(I2C_qout == I2C_qin) {                     // queue empty?
+      I2C1->CTLR2 &= ~I2C_IT_ALL;                 // -> disable interrupts
+      I2C_qstate = I2C_open ? I2C_Q_STALL : I2C_Q_IDLE;
+      return;
+    }
+    uint16_t token = I2C_queue[I2C_qout & (I2C_QUEUE_LEN - 1)];
+    if(token & I2C_TOK_START) {                   // START condition?
+      I2C_until(!(I2C1->CTLR1 & I2C_CTLR1_STOP)); // -> wait for last STOP to finish
+      if(I2C_error) return;                       // -> (bus has failed)
+      I2C1->CTLR1 |= I2C_CTLR1_START;             // -> set START condition
+      I2C1->CTLR2 |= I2C_IT_ALL;                  // -> SB event will follow
+      I2C_open = 1;
+      return;
+    }
+    if(token & I2C_TOK_STOP) {                    // STOP condition?
+      if(!(I2C1->STAR1 & I2C_STAR1_BTF)) {        // -> last byte not sent yet?
+        I2C1->CTLR2 = (I2C1->CTLR2 & ~I2C_CTLR2_ITBUFEN) | I2C_CTLR2_ITEVTEN;
+        return;                                   // -> wait for BTF event
+      }
+      I2C1->CTLR1 |= I2C_CTLR1_STOP;              // -> set STOP condition
+      I2C_open = 0;
+      I2C_qout++;
+      #if I2C_STAMP > 0
+      if(I2C_stamp_on && I2C_qout == I2C_stamp_at) { // -> stamped ticket sent?
+        I2C_stamp_time = STK->CNT;
+        I2C_stamp_on   = 0;
+      }
+      #endif
+      continue;                                   // -> proceed with next token
+    }
+    #if I2C_DMA > 0
+    if(token & I2C_TOK_BUFFER) {                  // data buffer via DMA?
+      uint8_t i = I2C_bufout & (I2C_BUF_LEN - 1);
+      I2C1->CTLR2 &= ~I2C_IT_ALL;                 // -> DMA interrupt will follow
+      DMA1_Channel6->CNTR  = I2C_buflen[i];       // -> number of bytes to be transfered
+      DMA1_Channel6->MADDR = (uint32_t)I2C_bufptr[i]; // -> memory address
+      if(token & I2C_TOK_FILL) DMA1_Channel6->CFGR &= ~DMA_CFG6_MINC; // -> fill: fixed
+      else                     DMA1_Channel6->CFGR |=  DMA_CFG6_MINC; //    source byte
+      DMA1_Channel6->CFGR |= DMA_CFG6_EN;         // -> enable DMA channel
+      I2C1->CTLR2         |= I2C_CTLR2_DMAEN;     // -> enable DMA request
+      return;
+    }
+    #endif
+    if(!(I2C1->STAR1 & I2C_STAR1_TXE)) {          // data byte, but register full?
+      I2C1->CTLR2 |= I2C_IT_ALL;                  // -> wait for TXE event
+      return;
+    }
+    I2C1->DATAR = (uint8_t)token;                 // send data byte
+    I2C_qout++;
+  }
+}
+
+// Put token into queue and restart processing if necessary
+static void I2C_enqueue(uint16_t token) {
+  I2C_until((uint16_t)(I2C_qin - I2C_qout) < I2C_QUEUE_LEN); // wait while queue full
+  if(I2C_error) return;                           // bus has failed: drop token
+  I2C_queue[I2C_qin & (I2C_QUEUE_LEN - 1)] = token;
+  I2C_qin++;
+  INT_ATOMIC_BLOCK {
+    if(I2C_error) I2C_qout = I2C_qin;             // failed meanwhile: drop token
+    else if(I2C_qstate != I2C_Q_RUN) {           // queue processing stopped?
+      I2C_qstate = I2C_Q_RUN;
+      I2C_process();                              // -> restart processing
+    }
+  }
+}
+
+// Queue START condition (addr must contain R/W bit)
+void I2C_start(uint8_t addr) {
+  I2C_count(1);
+  I2C_enqueue(I2C_TOK_START | addr);
+}
+
+// Queue data byte
+void I2C_write(uint8_t data) {
+  I2C_count(1);
+  I2C_enqueue(data);
+}
+
+// Queue STOP condition
+void I2C_stop(void) {
+  I2C_enqueue(I2C_TOK_STOP);
+}
+
+// Queue data buffer, keep transmission open
+void I2C_streamBuffer(uint8_t* buf, uint16_t len) {
+  I2C_count(len);
+  #if I2C_DMA > 0
+  I2C_until((uint8_t)(I2C_bufin - I2C_bufout) < I2C_BUF_LEN); // wait while buffer queue full
+  if(I2C_error) return;
+  I2C_bufptr[I2C_bufin & (I2C_BUF_LEN - 1)] = buf;
+  I2C_buflen[I2C_bufin & (I2C_BUF_LEN - 1)] = len;
+  I2C_bufin++;
+  I2C_enqueue(I2C_TOK_BUFFER);
+  #else
+  while(len--) I2C_enqueue(*buf++);
+  #endif
+}
+
+// Queue data buffer and stop
+void I2C_writeBuffer(uint8_t* buf, uint16_t len) {
+  I2C_streamBuffer(buf, len);
+  I2C_stop();
+}
+
+// Queue len copies of byte p and stop
+void I2C_fill(uint8_t p, uint16_t len) {
+  I2C_count(len);
+  #if I2C_DMA > 0
+  I2C_until((uint8_t)(I2C_bufin - I2C_bufout) < I2C_BUF_LEN); // wait while buffer queue full
+  if(I2C_error) return;
+  uint8_t i = I2C_bufin & (I2C_BUF_LEN - 1);
+  I2C_fillpat[i] = p;                             // (the slot is free until it is sent)
+  I2C_bufptr[i]  = &I2C_fillpat[i];
+  I2C_buflen[i]  = len;
+  I2C_bufin++;
+  I2C_enqueue(I2C_TOK_BUFFER | I2C_TOK_FILL);
+  #else
+  while(len--) I2C_enqueue(p);
+  #endif
+  I2C_stop();
+}
+
+// Get ticket for everything queued so far
+uint16_t I2C_fence(void) {
+  return I2C_qin;
+}
+
+// Wait until everything queued before ticket was sent
+void I2C_wait(uint16_t ticket) {
+  I2C_until((int16_t)(I2C_qout - ticket) >= 0);
+}
+
+#if I2C_STAMP > 0
+// Take the time the STOP in front of ticket is sent (at once if it already is)
+void I2C_stamp(uint16_t ticket) {
+  INT_ATOMIC_BLOCK {
+    if((int16_t)(I2C_qout - ticket) >= 0) {
+      I2C_stamp_time = STK->CNT;
+      I2C_stamp_on   = 0;
+    }
+    else {
+      I2C_stamp_at = ticket;
+      I2C_stamp_on = 1;
+    }
+  }
+}
+#endif
+
+// Wait until queue is empty and bus is free (last transmission must be stopped)
+void I2C_flush(void) {
+  I2C_until((I2C_qstate != I2C_Q_RUN) && !I2C_busy());
+}
+
+// Interrupt service routine (I2C event)
+void I2C1_EV_IRQHandler(void) __attribute__((interrupt)) I2C_HOT;
+void I2C1_EV_IRQHandler(void) {
+  I2C_process();
+}
+
+#if I2C_DMA > 0
+// Interrupt service routine (DMA transfer complete)
+void DMA1_Channel6_IRQHandler(void) __attribute__((interrupt)) I2C_HOT;
+void DMA1_Channel6_IRQHandler(void) {
+  I2C1->CTLR2         &= ~I2C_CTLR2_DMAEN;        // disable DMA request
+  DMA1_Channel6->CFGR &= ~DMA_CFG6_EN;            // disable DMA channel
+  DMA1->INTFCR         = DMA_CGIF6;               // clear interrupt flags
+  I2C_bufout++;                                   // buffer sent
+  I2C_qout++;                                     // buffer token processed
+  I2C_process();                                  // proceed with next token
+}
+#endif
+
+#else
+// ===================================================================================
+// Blocking Functions
+// ===================================================================================
+
+// Start I2C transmission (addr must contain R/W bit)
+void I2C_start(uint8_t addr) {
+  I2C_count(1);
+  if(I2C_error) return;                           // bus has failed
+  I2C_until(!(I2C1->STAR2 & I2C_STAR2_BUSY));     // wait until bus ready
+  if(I2C_error) return;
+  I2C1->CTLR1 |= I2C_CTLR1_START;                 // set START condition
+  I2C_until(I2C1->STAR1 & I2C_STAR1_SB);          // wait for START generated
+  if(I2C_error) return;
+  I2C1->DATAR = addr;                             // send slave address + R/W bit
+  I2C_until(I2C_checkEvent(I2C_ADDR_TRANSMITTED)); // wait for address transmitted
+}
+
+// Send data byte via I2C bus
+I2C_HOT void I2C_write(uint8_t data) {
+  I2C_count(1);
+  I2C_until(I2C1->STAR1 & I2C_STAR1_TXE);         // wait for last byte transmitted
+  if(I2C_error) return;                           // (bus has failed)
+  I2C1->DATAR = data;                             // send data byte
+}
+
+// Stop I2C transmission
+void I2C_stop(void) {
+  I2C_until(I2C1->STAR1 & I2C_STAR1_BTF);         // wait for last byte transmitted
+  if(I2C_error) return;                           // (bus has failed)
+  I2C1->CTLR1 |= I2C_CTLR1_STOP;                  // set STOP condition
+}
+
+// Wait until the bus is free and the DMA is done
+void I2C_flush(void) {
+  I2C_until(!I2C_busy() && !I2C_DMA_busy());
+}
+
+#if I2C_DMA > 0
+// Set STOP condition after DMA transfer?
+volatile uint8_t I2C_dmastop;
+
+// Send data buffer via I2C bus using DMA (transmission must be started before)
+void I2C_writeBuffer(uint8_t* buf, uint16_t len) {
+  if(I2C_error) return;                           // bus has failed
+  I2C_dmastop = 1;                                // stop when transfer completed
+  I2C_streamBuffer(buf, len);                     // start DMA transfer
+}
+
+// Send data buffer via I2C bus using DMA, keep transmission open
+void I2C_streamBuffer(uint8_t* buf, uint16_t len) {
+  I2C_count(len);
+  if(I2C_error) return;                           // bus has failed
+  DMA1_Channel6->CNTR  = len;                     // number of bytes to be transfered
+  DMA1_Channel6->MADDR = (uint32_t)buf;           // memory address
+  DMA1_Channel6->CFGR |= DMA_CFG6_MINC            // increment memory address
+                       | DMA_CFG6_EN;             // enable DMA channel
+  I2C1->CTLR2         |= I2C_CTLR2_DMAEN;         // enable DMA request
+}
+
+// Send len copies of byte p via I2C bus using DMA and stop
+void I2C_fill(uint8_t p, uint16_t len) {
+  static uint8_t pat;                             // source of the transfer
+  I2C_count(len);
+  if(I2C_error) return;                           // bus has failed
+  pat = p;
+  I2C_dmastop = 1;                                // stop when transfer completed
+  DMA1_Channel6->CNTR  = len;                     // number of bytes to be transfered
+  DMA1_Channel6->MADDR = (uint32_t)&pat;          // memory address
+  DMA1_Channel6->CFGR  = (DMA1_Channel6->CFGR & ~DMA_CFG6_MINC) // fixed source byte
+                       | DMA_CFG6_EN;             // enable DMA channel
+  I2C1->CTLR2         |= I2C_CTLR2_DMAEN;         // enable DMA request
+}
+
+// Interrupt service routine (DMA transfer complete)
+void DMA1_Channel6_IRQHandler(void) __attribute__((interrupt)) I2C_HOT;
+void DMA1_Channel6_IRQHandler(void) {
+  I2C1->CTLR2         &= ~I2C_CTLR2_DMAEN;        // disable DMA request
+  DMA1_Channel6->CFGR &= ~DMA_CFG6_EN;            // disable DMA channel
+  DMA1->INTFCR         = DMA_CGIF6;               // clear interrupt flags
+  if(I2C_dmastop) {                               // end of transmission?
+    I2C_dmastop = 0;
+    I2C_until(I2C1->STAR1 & I2C_STAR1_BTF);       // wait for last byte transmitted
+    if(!I2C_error) I2C1->CTLR1 |= I2C_CTLR1_STOP; // set STOP condition
+  }
+}
+
+#else
+// Send data buffer via I2C bus (blocking fallback)
+void I2C_writeBuffer(uint8_t* buf, uint16_t len) {
+  I2C_streamBuffer(buf, len);                     // send data bytes
+  I2C_stop();                                     // stop transmission
+}
+
+// Send data buffer via I2C bus, keep transmission open (blocking fallback)
+void I2C_streamBuffer(uint8_t* buf, uint16_t len) {
+  while(len-- && !I2C_error) I2C_write(*buf++);  // send data bytes
+}
+
+// Send len copies of byte p via I2C bus and stop (blocking fallback)
+void I2C_fill(uint8_t p, uint16_t len) {
+  while(len-- && !I2C_error) I2C_write(p);        // send data bytes
+  I2C_stop();                                     // stop transmission
+}
+#endif
+#endif // I2C_QUEUE
+
+// ===================================================================================
+// Receive and Probe (blocking, polled)
+// ===================================================================================
+
+// Send START and address, returns 0 if the device doesn't acknowledge (then stopped)
+static uint8_t I2C_address(uint8_t addr) {
+  I2C_count(1);
+  I2C1->CTLR1 |= I2C_CTLR1_START;                 // set (repeated) START condition
+  I2C_until(I2C1->STAR1 & I2C_STAR1_SB);          // wait for START generated
+  if(I2C_error) return 0;
+  I2C1->DATAR = addr;                             // send slave address + R/W bit
+  I2C_until(I2C1->STAR1 & (I2C_STAR1_ADDR | I2C_STAR1_AF)); // wait for ACK or NAK
+  if(I2C_error) return 0;
+  if(I2C1->STAR1 & I2C_STAR1_AF) {                // no device?
+    I2C1->STAR1 &= ~I2C_STAR1_AF;                 // -> clear flag
+    I2C1->CTLR1 |=  I2C_CTLR1_STOP;               // -> set STOP condition
+    return 0;
+  }
+  (void)I2C1->STAR2;                              // clear ADDR flag
+  return 1;
+}
+
+// Send reglen bytes of reg to device addr, then read len bytes into buf
+uint8_t I2C_read(uint8_t addr, const uint8_t* reg, uint8_t reglen, uint8_t* buf, uint16_t len) {
+  I2C_flush();                                    // queue empty and bus free
+  I2C_until(!(I2C1->CTLR1 & I2C_CTLR1_STOP));     // wait for last STOP to finish
+  if(I2C_error) return 0;                         // bus has failed
+  if(reglen) {                                    // write register/memory address
+    if(!I2C_address(addr & 0xFE)) return 0;
+    while(reglen--) {
+      I2C_count(1);
+      I2C_until(I2C1->STAR1 & I2C_STAR1_TXE);     // wait for free data register
+      I2C1->DATAR = *reg++;
+    }
+    I2C_until(I2C1->STAR1 & I2C_STAR1_BTF);       // wait for last byte transmitted
+    if(I2C_error) return 0;
+  }
+  I2C1->CTLR1 |= I2C_CTLR1_ACK;                   // acknowledge received bytes
+  if(!I2C_address(addr | 0x01)) return 0;         // read: reception starts
+  I2C_count(len);
+  while(len--) {
+    if(!len) {                                    // last byte?
+      I2C1->CTLR1 &= ~I2C_CTLR1_ACK;              // -> set NAK
+      I2C1->CTLR1 |=  I2C_CTLR1_STOP;             // -> set STOP condition
+    }
+    I2C_until(I2C1->STAR1 & I2C_STAR1_RXNE);      // wait for data byte received
+    if(I2C_error) return 0;
+    *buf++ = I2C1->DATAR;
+  }
+  return 1;
+}
+
+// Send len bytes of buf to device addr and stop, returns 0 if one isn't acknowledged
+uint8_t I2C_probe(uint8_t addr, const uint8_t* buf, uint16_t len) {
+  I2C_flush();                                    // queue empty and bus free
+  I2C_until(!(I2C1->CTLR1 & I2C_CTLR1_STOP));     // wait for last STOP to finish
+  if(I2C_error) return 0;                         // bus has failed
+  if(!I2C_address(addr & 0xFE)) return 0;
+  I2C_count(len);
+  while(len--) {
+    I2C_until(I2C1->STAR1 & (I2C_STAR1_TXE | I2C_STAR1_AF)); // free data register or NAK
+    if(I2C_error || (I2C1->STAR1 & I2C_STAR1_AF)) break;
+    I2C1->DATAR = *buf++;
+  }
+  I2C_until(I2C1->STAR1 & (I2C_STAR1_BTF | I2C_STAR1_AF)); // last byte transmitted or NAK
+  if(I2C_error) return 0;
+  I2C1->CTLR1 |= I2C_CTLR1_STOP;                  // set STOP condition
+  if(I2C1->STAR1 & I2C_STAR1_AF) {                // byte not acknowledged?
+    I2C1->STAR1 &= ~I2C_STAR1_AF;                 // -> clear flag
+    return 0;
+  }
+  return 1;
+}
+
+// ===================================================================================
+// Timeouts and Bus Recovery
+// ===================================================================================
+
+// Pins of the bus
+#if I2C_REMAP == 1
+  #define I2C_GPIO      GPIOD
+  #define I2C_SDA       0
+  #define I2C_SCL       1
+#elif I2C_REMAP == 2
+  #define I2C_GPIO      GPIOC
+  #define I2C_SDA       6
+  #define I2C_SCL       5
+#else
+  #define I2C_GPIO      GPIOC
+  #define I2C_SDA       1
+  #define I2C_SCL       2
+#endif
+
+// Stop interrupts and DMA, drop everything queued (interrupts must be disabled)
+static void I2C_drop(void) {
+  I2C1->CTLR2 &= ~(I2C_CTLR2_ITEVTEN | I2C_CTLR2_ITBUFEN | I2C_CTLR2_DMAEN);
+  #if I2C_DMA > 0
+  DMA1_Channel6->CFGR &= ~DMA_CFG6_EN;            // stop DMA channel
+  DMA1->INTFCR         = DMA_CGIF6;               // clear interrupt flags
+  #endif
+  #if I2C_QUEUE > 0
+  I2C_qout   = I2C_qin;                           // drop queued tokens
+  #if I2C_STAMP > 0
+  I2C_stamp_on = 0;                               // (dropped: I2C_errors has changed)
+  #endif
+  #if I2C_DMA > 0
+  I2C_bufout = I2C_bufin;                         // drop queued buffers
+  #endif
+  I2C_qstate = I2C_Q_IDLE;
+  I2C_open   = 0;
+  #elif I2C_DMA > 0
+  I2C_dmastop = 0;
+  #endif
+}
+
+#if I2C_TIMEOUT > 0
+// Give up the bus until I2C_recover()
+static void I2C_fail(void) {
+  INT_ATOMIC_BLOCK {
+    I2C_drop();
+    if(!I2C_error) I2C_errors++;
+    I2C_error = I2C_ERR_TIMEOUT;
+  }
+}
+
+// Check wait for timeout, returns 1 if the bus has failed
+static uint8_t I2C_expired(I2C_WATCH* w) {
+  uint32_t now  = STK->CNT;
+  uint32_t mark = 0;                              // transfer state: progress if changed
+  if(I2C_error) return 1;
+  #if I2C_QUEUE > 0
+  mark = I2C_qout;
+  #endif
+  #if I2C_DMA > 0
+  mark = (mark << 16) | DMA1_Channel6->CNTR;
+  #endif
+  if(mark != w->mark) {                           // first check or progress?
+    w->mark  = mark;
+    w->since = now;
+    return 0;
+  }
+  if((now - w->since) < (uint32_t)I2C_TIMEOUT * DLY_US_TIME) return 0;
+  I2C_fail();
+  return 1;
+}
+#endif
+
+// Free the bus and init I2C again after a failure
+void I2C_recover(void) {
+  uint8_t i;
+  INT_ATOMIC_BLOCK {
+    I2C_drop();                                   // (make sure nothing is running)
+  }
+  I2C1->CTLR1 = 0;                                // disable I2C
+
+  // Set SDA and SCL to output, open-drain, 10MHz, released (high)
+  I2C_GPIO->BSHR  = ((uint32_t)1<<I2C_SDA) | ((uint32_t)1<<I2C_SCL);
+  I2C_GPIO->CFGLR = (I2C_GPIO->CFGLR & ~(((uint32_t)0b1111<<(I2C_SDA<<2)) | ((uint32_t)0b1111<<(I2C_SCL<<2))))
+                                     |  (((uint32_t)0b0101<<(I2C_SDA<<2)) | ((uint32_t)0b0101<<(I2C_SCL<<2)));
+  DLY_us(5);
+
+  // Clock out up to 9 SCL pulses (100kHz) until the slave releases SDA
+  for(i=0; (i<9) && !(I2C_GPIO->INDR & ((uint32_t)1<<I2C_SDA)); i++) {
+    I2C_GPIO->BCR  = (uint32_t)1<<I2C_SCL;        // SCL low
+    DLY_us(5);
+    I2C_GPIO->BSHR = (uint32_t)1<<I2C_SCL;        // SCL high
+    DLY_us(5);
+  }
+
+  // STOP condition: SDA rises while SCL is high
+  I2C_GPIO->BCR  = (uint32_t)1<<I2C_SCL;          // SCL low
+  DLY_us(5);
+  I2C_GPIO->BCR  = (uint32_t)1<<I2C_SDA;          // SDA low
+  DLY_us(5);
+  I2C_GPIO->BSHR = (uint32_t)1<<I2C_SCL;          // SCL high
+  DLY_us(5);
+  I2C_GPIO->BSHR = (uint32_t)1<<I2C_SDA;          // SDA high
+  DLY_us(5);
+
+  // Reset I2C module and init it again (pins back to I2C)
+  RCC->APB1PRSTR |=  RCC_I2C1RST;
+  RCC->APB1PRSTR &= ~RCC_I2C1RST;
+  I2C_rate = I2C_CLKRATE;                         // (a raised rate may have caused it)
+  I2C_init();
+  I2C_error = 0;
+  I2C_recoveries++;
+}
+#endif // I2C_SINK
@@ -0,0 +1,210 @@
+// ===================================================================================
+// Basic I2C Master Functions for CH32V003                                    * v2.1 *
+// ===================================================================================
+//
+// Functions available:
+// --------------------
+// I2C_init()               Init I2C with defined clock rate (400kHz)
+// I2C_setClock()           Set clock rate again after a system clock switch
+// I2C_setRate(rate)        Set clock rate to rate (Hz) instead of I2C_CLKRATE
+// I2C_start(addr)          I2C start transmission, addr must contain R/W bit
+// I2C_write(b)             I2C transmit one data byte via I2C
+// I2C_stop()               I2C stop transmission
+// I2C_writeBuffer(buf,len) Send buffer (*buf) with length (len) via I2C/DMA and stop
+// I2C_streamBuffer(buf,len) Send buffer (*buf) with length (len) via I2C/DMA, no stop
+// I2C_fill(p,len)          Send len copies of byte p via I2C/DMA and stop
+// I2C_busy()               Check if I2C bus is busy (e.g. DMA transfer in progress)
+// I2C_DMA_busy()           Check if DMA transfer is in progress
+// I2C_DMA_wait()           Wait until the DMA transfer is done
+// I2C_fence()              Get ticket for everything queued so far
+// I2C_wait(ticket)         Wait until everything queued before ticket was sent
+// I2C_stamp(ticket)        Take the time the STOP in front of ticket is sent
+// I2C_stamped()            Check if the time of the last I2C_stamp() is taken
+// I2C_flush()              Wait until the queue is empty and the bus is free
+// I2C_read(a,reg,n,buf,len) Send n bytes (*reg) to device a, then read len bytes
+// I2C_probe(a,buf,len)     Send len bytes (*buf) to device a, 0 if one isn't ACKed
+// I2C_recover()            Free the bus and init I2C again after a failure
+// I2C_error                Bus failure (I2C_ERR_TIMEOUT), 0 if the bus is working
+// I2C_errors               Number of bus failures so far
+// I2C_recoveries           Number of bus recoveries (I2C_recover()) so far
+// I2C_rate                 Clock rate set (Hz)
+// I2C_bytes                Number of bytes put on the bus (if I2C_SINK > 0)
+//
+// If I2C_DMA is enabled, I2C_writeBuffer() returns immediately, the transfer runs in
+// the background and the STOP condition is set by the DMA interrupt. The next
+// I2C_start() waits until the bus is free again. The buffer must not be altered
+// until then. I2C_streamBuffer() leaves the transmission open, so several buffers
+// can be sent in one transaction. Wait for the DMA (I2C_DMA_wait()) before the
+// next buffer or I2C_stop() follows. I2C_fill() is I2C_writeBuffer() of a constant:
+// the DMA runs without memory increment over one pattern byte kept by the driver,
+// so clearing the screen needs neither a buffer nor CPU time.
+//
+// If I2C_QUEUE is enabled, I2C_start(), I2C_write(), I2C_stop(), I2C_writeBuffer(),
+// I2C_streamBuffer() and I2C_fill() don't wait for the bus. They put their request
+// into a ring buffer, which is processed by the I2C event interrupt (and by DMA for
+// data buffers). The functions only block if the queue is full. A buffer handed over
+// must not be altered until I2C_wait() on a ticket taken by I2C_fence() after
+// queueing it returns. I2C_wait() and I2C_flush() are also available (and
+// trivial) without the queue.
+//
+// With I2C_STAMP the event interrupt takes the SysTick count (in I2C_stamp_time)
+// at which the transmission ending right before a ticket is stopped, i.e. when
+// everything queued up to it has left the bus. The ticket must directly follow a
+// STOP (I2C_fence() after I2C_writeBuffer() or I2C_stop()), one ticket at a time.
+// It is set by default if the latency meter is enabled (LAT_ENABLE, latency.h).
+//
+// I2C_read() is the only receiving function, e.g. for an EEPROM on the display bus:
+// it waits until the queue is empty and the bus is free, writes the register or
+// memory address bytes and reads the data after a repeated START, all blocking.
+// It returns 0 if the device doesn't acknowledge its address (i.e. isn't there).
+// I2C_probe() is its sending counterpart: it writes the bytes the same way and
+// returns 0 as soon as the device doesn't acknowledge one of them (or its address).
+//
+// The bus starts at I2C_CLKRATE. Many SSD1306 modules take a much faster clock,
+// I2C_setRate() raises it up to I2C_RATE_MAX: the calibrator finds the rate of a
+// console by probing (stored as KV_KEY_I2CCLK in flash_kv.h), the games set it at
+// boot (JOY_BUS_CAL in joypad.h). The clock divider is rounded up, so the bus
+// runs at the rate or the next lower one the system clock can make, also after a
+// clock switch. A bus recovery (I2C_recover()) goes back to I2C_CLKRATE.
+//
+// With I2C_TIMEOUT every wait of the driver (for the bus, a flag, a free queue slot,
+// a ticket, also the waits within the interrupt handlers) gives up after so many
+// microseconds without progress, e.g. when the display was unplugged or a slave
+// holds SDA low. The driver then drops everything queued, sets I2C_error and ignores
+// all transfers (they return at once, I2C_read() returns 0) until I2C_recover()
+// clocks out up to 9 SCL pulses and a STOP condition to release the slave, resets
+// the I2C module and inits it again. The display has to be set up again afterwards
+// (oled_min.c does so at the start of the next frame).
+//
+// With I2C_VTF >= 0 the interrupt that drives the transfers (I2C event with the
+// queue, DMA otherwise) is served via that VTF slot (see system.h).
+//
+// With I2C_IN_RAM the interrupt handlers and the byte-wise write run from SRAM
+// (RAMFUNC, see system.h), which spares them the flash wait state at 48MHz.
+//
+// I2C_SINK is meant for benchmark builds ("make bench" sets it): with 1 all bytes
+// (address bytes included) are counted in I2C_bytes, with 2 they are only counted
+// and the bus isn't touched at all.
+//
+// I2C remap settings (set below in I2C parameters):
+// -------------------------------------------------
+// I2C_REMAP   SDA-pin  SCL-pin
+//        0      PC1      PC2
+//        1      PD0      PD1
+//        2      PC6      PC5
+//
+// External pull-up resistors (4k7 - 10k) are mandatory!
+// 2023 by Stefan Wagner:   https://github.com/wagiminator
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "system.h"
+
+// I2C Parameters
+#ifndef I2C_CLKRATE
+#define I2C_CLKRATE   400000    // I2C bus clock rate (Hz)
+#endif
+#ifndef I2C_RATE_MAX
+#define I2C_RATE_MAX  2000000   // highest clock rate of I2C_setRate() (Hz)
+#endif
+#ifndef I2C_REMAP
+#define I2C_REMAP     0         // I2C pin remapping (see above)
+#endif
+#ifndef I2C_DMA
+#define I2C_DMA       1         // 0: blocking transfers only, 1: enable DMA transfers
+#endif
+#ifndef I2C_QUEUE
+#define I2C_QUEUE     1         // 0: blocking functions, 1: interrupt driven queue
+#endif
+#ifndef I2C_QUEUE_LEN
+#define I2C_QUEUE_LEN 32        // length of transmit queue (power of 2)
+#endif
+#ifndef I2C_BUF_LEN
+#define I2C_BUF_LEN   4         // max number of queued DMA buffers (power of 2)
+#endif
+#ifndef I2C_IN_RAM
+#define I2C_IN_RAM    0         // 1: run interrupt handlers from SRAM (.ramfunc)
+#endif
+#ifndef I2C_VTF
+#define I2C_VTF       0         // VTF slot of the transfer interrupt (-1: none)
+#endif
+#ifndef I2C_SINK
+#define I2C_SINK      0         // 0: bus, 1: bus and byte count, 2: byte count only
+#endif
+#ifndef I2C_STAMP
+#if defined(LAT_ENABLE) && LAT_ENABLE > 0
+#define I2C_STAMP     1         // 1: time stamp of a ticket (I2C_stamp(), queue only)
+#else
+#define I2C_STAMP     0
+#endif
+#endif
+#ifndef I2C_TIMEOUT
+#define I2C_TIMEOUT   2000      // us without progress until the bus fails (0: never)
+#endif
+
+#define I2C_ERR_TIMEOUT 1       // I2C_error: a wait timed out
+
+// Interrupt enable check
+#if (I2C_DMA > 0 || I2C_QUEUE > 0) && SYS_USE_VECTORS == 0
+  #error Interrupt vector table must be enabled (SYS_USE_VECTORS in system.h)!
+#endif
+
+// I2C Functions
+void I2C_init(void);            // I2C init function
+void I2C_setClock(void);        // set clock rate for the current CLK_freq()
+void I2C_setRate(uint32_t rate);  // set clock rate (Hz)
+void I2C_start(uint8_t addr);   // I2C start transmission, addr must contain R/W bit
+void I2C_write(uint8_t data);   // I2C transmit one data byte via I2C
+void I2C_stop(void);            // I2C stop transmission
+void I2C_writeBuffer(uint8_t* buf, uint16_t len);  // send buffer and stop
+void I2C_streamBuffer(uint8_t* buf, uint16_t len); // send buffer, keep transmission open
+void I2C_fill(uint8_t p, uint16_t len);            // send len copies of p and stop
+uint8_t I2C_read(uint8_t addr, const uint8_t* reg, uint8_t reglen, uint8_t* buf, uint16_t len);
+uint8_t I2C_probe(uint8_t addr, const uint8_t* buf, uint16_t len);
+void I2C_recover(void);         // free the bus and init I2C again after a failure
+void I2C_flush(void);           // wait until queue is empty and bus is free
+void I2C_DMA_wait(void);        // wait until the DMA transfer is done
+
+extern volatile uint8_t  I2C_error;       // bus failure, 0: working
+extern volatile uint16_t I2C_errors;      // number of bus failures
+extern uint16_t          I2C_recoveries;  // number of recoveries
+extern uint32_t          I2C_rate;        // clock rate (Hz)
+
+#if I2C_SINK > 0
+extern volatile uint32_t I2C_bytes; // number of bytes put on the bus
+#endif
+
+#if I2C_SINK == 2
+  #define I2C_busy()     0
+  #define I2C_DMA_busy() 0
+#else
+#define I2C_busy()  (I2C1->STAR2 & I2C_STAR2_BUSY)  // check if I2C is busy
+#if I2C_DMA > 0
+  #define I2C_DMA_busy() (DMA1_Channel6->CFGR & DMA_CFG6_EN) // check if DMA is busy
+#else
+  #define I2C_DMA_busy() 0
+#endif
+#endif
+
+#if I2C_QUEUE > 0
+uint16_t I2C_fence(void);       // get ticket for everything queued so far
+void I2C_wait(uint16_t ticket); // wait until everything before ticket was sent
+#else
+  #define I2C_fence()   0
+  #define I2C_wait(t)
+#endif
+
+#if I2C_QUEUE > 0 && I2C_STAMP > 0
+extern volatile uint32_t I2C_stamp_time;  // SysTick count the ticket was sent at
+extern volatile uint8_t  I2C_stamp_on;    // 1: not sent yet
+void I2C_stamp(uint16_t ticket);          // take the time ticket is sent
+#define I2C_stamped()   (!I2C_stamp_on)   // check if the time is taken
+#endif
+
+#ifdef __cplusplus
+};
+#endif
@@ -0,0 +1,773 @@
+// ===================================================================================
+// Tiny Joypad Engine for CH32V003                                            * v1.0 *
+// ===================================================================================
+// 2023 by Stefan Wagner:   https://github.com/wagiminator
+
+#define JOY_DRIVER                            // (the driver's own delays and sounds)
+#include "joypad.h"
+
+#if JOY_PAD_DMA > 0
+volatile uint16_t JOY_ring[JOY_PAD_RING];     // latest joypad samples, written by DMA
+#endif
+
+// Interrupt handlers (see below)
+void TIM1_UP_IRQHandler(void) __attribute__((interrupt));
+void EXTI7_0_IRQHandler(void) __attribute__((interrupt));
+
+// Fast boot: JOY_init() only sets up what the first screen needs. The ADC with
+// its calibration is set up by a task at the first wait of the game, i.e. while
+// the first screen is being sent, or by the first JOY_poll() before that.
+uint8_t JOY_pad_ready;                        // 1: joypad ADC is set up
+
+void JOY_pad_init(void) {
+  if(JOY_pad_ready) return;
+  ADC_init();
+  ADC_input(PIN_PAD);
+  #if JOY_PAD_DMA > 0
+  ADC_slow();
+  ADC_DMA_start(JOY_ring, JOY_PAD_RING);
+  #endif
+  BAT_init();                                 // (VDD between the pad samples)
+  JOY_pad_ready = 1;
+  STARTUP_mark(JOY_BOOT_PAD);
+}
+
+// First wait of the game: the first screen is queued
+void JOY_boot(void* ctx) {
+  STARTUP_mark(JOY_BOOT_FRAME);
+  JOY_pad_init();
+  #if SYS_STARTUP_PROF > 0
+  BUS_flush();                                // (profiler only: wait until it is shown)
+  STARTUP_mark(JOY_BOOT_SHOWN);
+  TLM_startup(STARTUP_us, STARTUP_STAGES);
+  #endif
+}
+
+void JOY_cal_load(void);                      // (see below)
+void JOY_bus_load(void);
+
+// Init driver
+void JOY_init(void) {
+  PIN_input_AN(PIN_PAD);
+  PIN_input_PU(PIN_ACT);
+  PIN_output(PIN_BEEP);
+  PIN_high(PIN_BEEP);
+  #if JOY_SND_TIMER > 0
+  RCC->APB2PCENR |= RCC_TIM1EN;
+  TIM1->PSC       = (CLK_freq() / 1000000) - 1; // count in us
+  TIM1->CHCTLR1   = TIM_OC2M_2;               // channel 2 forced inactive
+  TIM1->CCER      = TIM_CC2E | TIM_CC2P;      // channel 2 output, active low
+  TIM1->BDTR      = TIM_MOE;                  // main output enable
+  TIM1->CTLR1     = TIM_URS;                  // no interrupt on software update
+  TIM1->DMAINTENR = TIM_UIE;                  // update interrupt ends a note
+  #if JOY_SND_VTF >= 0
+  VTF_enable(JOY_SND_VTF, TIM1_UP_IRQn, TIM1_UP_IRQHandler);
+  #endif
+  NVIC_EnableIRQ(TIM1_UP_IRQn);
+  PIN_alternate(PIN_BEEP);                    // PA1 = TIM1 channel 2
+  #endif
+  OLED_init();
+  STARTUP_mark(JOY_BOOT_OLED);
+  #if JOY_ASSETS > 0
+  ASSET_init(JOY_ASSET_GAME);
+  #endif
+  #if JOY_PAD_CAL > 0 || JOY_BUS_CAL > 0
+  KV_init();                                  // (the game's own keys are read as well)
+  #endif
+  #if JOY_PAD_CAL > 0
+  JOY_cal_load();
+  #endif
+  #if JOY_BUS_CAL > 0 && OLED_BUS == OLED_BUS_I2C
+  JOY_bus_load();
+  #endif
+  #if JOY_FAST_BOOT == 0
+  JOY_pad_init();
+  #endif
+  #if JOY_FAST_BOOT > 0 || SYS_STARTUP_PROF > 0
+  TSK_after(0, JOY_boot, 0);
+  #endif
+  #if JOY_EVENTS > 0
+  PIN_INT_set(PIN_ACT, PIN_INT_BOTH);
+  #if JOY_PIN_VTF >= 0
+  VTF_enable(JOY_PIN_VTF, EXTI7_0_IRQn, EXTI7_0_IRQHandler);
+  #endif
+  PIN_INT_enable();
+  #endif
+  TLM_init();
+  REC_init(&rnval);
+  LINK_init();
+  STARTUP_mark(JOY_BOOT_INIT);
+}
+
+// Joypad snapshot
+uint16_t JOY_padval;              // ADC value of the last snapshot
+uint8_t  JOY_dirs;                // direction bits of the last snapshot
+uint8_t  JOY_edges;               // directions newly pressed with the last snapshot
+
+// Calibration points in ascending order and their direction bits, the points
+// and the deviation are replaced by the stored calibration (JOY_cal_load())
+uint16_t JOY_BAND[] = {JOY_E, JOY_N, JOY_NE, JOY_S, JOY_SE, JOY_W, JOY_NW, JOY_SW};
+uint16_t JOY_dev    = JOY_DEV;
+const uint8_t  JOY_BAND_DIR[] = {
+  JOY_RIGHT, JOY_UP, JOY_UP | JOY_RIGHT, JOY_DOWN,
+  JOY_DOWN | JOY_RIGHT, JOY_LEFT, JOY_UP | JOY_LEFT, JOY_DOWN | JOY_LEFT
+};
+
+#if JOY_EVENTS > 0
+// Input event queue (JOY_EVENT in joypad.h)
+JOY_EVENT         JOY_evt[JOY_EVT_SIZE];
+volatile uint8_t  JOY_evt_head;   // next write index
+volatile uint8_t  JOY_evt_tail;   // next read index
+volatile uint8_t  JOY_act_state;  // last queued button state (1: pressed)
+volatile uint32_t JOY_act_time;   // SysTick count of the last queued button edge
+
+// Queue event, the oldest event is dropped if the queue is full
+void JOY_event_put(uint8_t type, uint8_t dirs, uint32_t time) {
+  INT_ATOMIC_BLOCK {
+    JOY_EVENT* e = &JOY_evt[JOY_evt_head];
+    e->type = type;
+    e->dirs = dirs;
+    e->time = time;
+    TLM_input(type, dirs, time);
+    LAT_input(time, type >= JOY_EVT_PAD_PRESS);     // (pad: seen by this tick)
+    JOY_evt_head = (JOY_evt_head + 1) & (JOY_EVT_SIZE - 1);
+    if(JOY_evt_head == JOY_evt_tail) JOY_evt_tail = (JOY_evt_tail + 1) & (JOY_EVT_SIZE - 1);
+  }
+}
+
+// Fetch oldest event, returns 0 if there is none
+uint8_t JOY_event_get(JOY_EVENT* e) {
+  uint8_t result = 0;
+  INT_ATOMIC_BLOCK {
+    if(JOY_evt_tail != JOY_evt_head) {
+      *e = JOY_evt[JOY_evt_tail];
+      JOY_evt_tail = (JOY_evt_tail + 1) & (JOY_EVT_SIZE - 1);
+      result = 1;
+    }
+  }
+  return result;
+}
+
+// Discard all queued events
+void JOY_event_flush(void) {
+  INT_ATOMIC_BLOCK { JOY_evt_tail = JOY_evt_head; }
+}
+
+// Check for a button press since the last call, consumes the events up to it
+uint8_t JOY_act_clicked(void) {
+  JOY_EVENT e;
+  uint8_t   result = 0;
+  while(!result && JOY_event_get(&e)) result = (e.type == JOY_EVT_ACT_PRESS);
+  return REC_input(REC_CLICK, result);
+}
+
+// Queue button edge if the state changed and the last edge is debounced;
+// JOY_poll() catches up on a final edge that fell into the debounce time.
+// Atomic, so the pin interrupt can't queue the same edge while JOY_poll() does.
+void JOY_act_edge(void) {
+  INT_ATOMIC_BLOCK {
+    uint8_t  state = JOY_act_raw();          // (not recorded, runs in the ISR)
+    uint32_t now   = STK->CNT;
+    if((state != JOY_act_state)
+      && ((now - JOY_act_time) >= (uint32_t)JOY_DEBOUNCE * DLY_MS_TIME)) {
+      JOY_act_state = state;
+      JOY_act_time  = now;
+      JOY_event_put(state ? JOY_EVT_ACT_PRESS : JOY_EVT_ACT_RELEASE, 0, now);
+    }
+  }
+}
+
+// Pin interrupt on both edges of the button
+PIN_INT_ISR {
+  PIN_INTFLAG_clear(PIN_ACT);
+  JOY_act_edge();
+}
+#endif
+
+// Decode ADC value into direction bits (binary search over the bands)
+uint8_t JOY_decode(uint16_t val) {
+  uint8_t lo = 0, hi = 8;
+  while(lo < hi) {                          // first band with val < point + JOY_dev
+    uint8_t mid = (lo + hi) >> 1;
+    if(val >= JOY_BAND[mid] + JOY_dev) lo = mid + 1;
+    else hi = mid;
+  }
+  return ((lo < 8) && (val > JOY_BAND[lo] - JOY_dev)) ? JOY_BAND_DIR[lo] : 0;
+}
+
+#if JOY_PAD_CAL > 0
+// Take the joypad calibration from the store (KV_KEY_PADCAL in flash_kv.h),
+// unless there is none or its bands overlap, are out of order or reach into
+// the released range
+void JOY_cal_load(void) {
+  uint8_t  c[KV_PADCAL_LEN];
+  uint16_t p[8];
+  uint8_t  i, dev;
+  if(KV_get(KV_KEY_PADCAL, c, KV_PADCAL_LEN) != KV_PADCAL_LEN) return;
+  dev = c[KV_PADCAL_LEN - 1];
+  for(i=0; i<8; i++) {
+    p[i] = c[i] | (uint16_t)((c[8 + (i >> 2)] >> ((i & 3) << 1)) & 3) << 8;
+    if(i && (p[i] <= p[i-1] + (dev << 1))) return;
+  }
+  if(!dev || (p[0] <= 10 + dev)) return;
+  for(i=0; i<8; i++) JOY_BAND[i] = p[i];
+  JOY_dev = dev;
+}
+#endif
+
+#if JOY_BUS_CAL > 0 && OLED_BUS == OLED_BUS_I2C
+// Raise the display bus clock to the rate the calibrator found for this console
+// (KV_KEY_I2CCLK in flash_kv.h), unless there is none or it is out of range
+void JOY_bus_load(void) {
+  uint8_t  c[KV_I2CCLK_LEN];
+  uint16_t khz;
+  if(KV_get(KV_KEY_I2CCLK, c, KV_I2CCLK_LEN) != KV_I2CCLK_LEN) return;
+  khz = c[0] | (uint16_t)c[1] << 8;
+  if((khz <= I2C_CLKRATE / 1000) || (khz > I2C_RATE_MAX / 1000)) return;
+  I2C_setRate((uint32_t)khz * 1000);
+}
+#endif
+
+// Sample the joypad and decode the direction bits (not recorded).
+// With background sampling the ring is averaged and the new directions are only
+// taken if all samples agree, so the pad can't flicker between neighbouring
+// bands (e.g. JOY_N and JOY_NE) while a button is pressed or released.
+uint8_t JOY_pad_read(void) {
+  uint8_t  dirs;
+  #if BENCH > 0
+  dirs = BENCH_input() & 0x0F;                // scripted directions
+  JOY_padval = dirs ? 0x3FF : 0;
+  #elif JOY_PAD_DMA > 0
+  uint16_t min = 0xFFFF, max = 0, sum = 0;
+  for(uint8_t i=0; i<JOY_PAD_RING; i++) {
+    uint16_t v = JOY_ring[i];
+    sum += v;
+    if(v < min) min = v;
+    if(v > max) max = v;
+  }
+  JOY_padval = sum / JOY_PAD_RING;
+  dirs = JOY_decode(min);
+  if(dirs != JOY_decode(max)) dirs = JOY_dirs;  // in transition: keep last state
+  #else
+  JOY_padval = ADC_read();
+  dirs = JOY_decode(JOY_padval);
+  #endif
+  return dirs;
+}
+
+// Take a joypad snapshot, call once per frame
+uint8_t JOY_poll(void) {
+  uint8_t  dirs;
+  #if JOY_FAST_BOOT > 0
+  if(!JOY_pad_ready) JOY_pad_init();          // (polled before the first wait)
+  #endif
+  PROF_begin(PROF_INPUT);
+  dirs = REC_input(REC_PAD, JOY_pad_read());
+  JOY_edges = dirs & ~JOY_dirs;
+  #if JOY_EVENTS > 0
+  JOY_act_edge();
+  if(JOY_edges) JOY_event_put(JOY_EVT_PAD_PRESS, JOY_edges, STK->CNT);
+  if(JOY_dirs & ~dirs) JOY_event_put(JOY_EVT_PAD_RELEASE, JOY_dirs & ~dirs, STK->CNT);
+  #endif
+  JOY_dirs  = dirs;
+  PROF_end();
+  return dirs;
+}
+
+// Buzzer (sound effects: SFX_... in joypad.h)
+const uint8_t*   JOY_sfx_ptr;                 // next step, 0 if no effect is playing
+const uint8_t*   JOY_sfx_loop;                // first step of the loop
+uint8_t          JOY_sfx_cnt;                 // number of loop passes
+uint8_t          JOY_sfx_pass;                // current loop pass
+uint8_t          JOY_sfx_prio;                // priority of the playing effect
+
+// Fetch next note of the playing effect, returns 0 at its end
+uint8_t JOY_sfx_step(uint8_t* freq, uint8_t* dur) {
+  const uint8_t* p = JOY_sfx_ptr;
+  while(p) {
+    switch(*p++) {
+      case SFX_OP_NOTE:
+        *freq = p[0];
+        *dur  = p[1];
+        JOY_sfx_ptr = p + 2;
+        return 1;
+      case SFX_OP_SLIDE: {
+        uint8_t f = p[0], s = p[2], n = JOY_sfx_pass;
+        while(n) {                            // f += s * pass
+          if(n & 1) f += s;
+          s <<= 1; n >>= 1;
+        }
+        *freq = f;
+        *dur  = p[1];
+        JOY_sfx_ptr = p + 3;
+        return 1;
+      }
+      case SFX_OP_LOOP:
+        JOY_sfx_cnt  = *p++;
+        JOY_sfx_pass = 0;
+        JOY_sfx_loop = p;
+        break;
+      case SFX_OP_NEXT:
+        if(++JOY_sfx_pass < JOY_sfx_cnt) p = JOY_sfx_loop;
+        break;
+      default:
+        p = 0;
+        break;
+    }
+  }
+  JOY_sfx_ptr  = 0;
+  JOY_sfx_prio = 0;
+  return 0;
+}
+
+#if JOY_SND_TIMER > 0
+// JOY_sound(freq, dur) queues a note and returns at once, it only waits while
+// the queue is full. A note lasts dur periods of 2 * (255 - freq) us like the
+// busy loop, freq = 0 is a rest. TIM1 generates the square wave, its
+// repetition counter ends the note after dur periods and the update interrupt
+// starts the next one.
+uint8_t          JOY_snd_freq[JOY_SND_SIZE];
+uint8_t          JOY_snd_dur[JOY_SND_SIZE];
+volatile uint8_t JOY_snd_head;                // next write index
+volatile uint8_t JOY_snd_tail;                // next read index
+volatile uint8_t JOY_snd_busy;                // 1: note is playing
+
+// Play next note of the effect or the queue, or silence the buzzer
+void JOY_sound_next(void) {
+  uint16_t half;
+  uint8_t  freq, dur;
+  if(!JOY_sfx_step(&freq, &dur)) {
+    if(JOY_snd_tail == JOY_snd_head) {
+      TIM1->CTLR1  &= ~TIM_CEN;
+      TIM1->CHCTLR1 = TIM_OC2M_2;             // forced inactive: buzzer off
+      JOY_snd_busy  = 0;
+      return;
+    }
+    freq = JOY_snd_freq[JOY_snd_tail];
+    dur  = JOY_snd_dur[JOY_snd_tail];
+    JOY_snd_tail = (JOY_snd_tail + 1) & (JOY_SND_SIZE - 1);
+  }
+  half = 255 - freq;
+  if(!half) half = 1;
+  TIM1->ATRLR   = (half << 1) - 1;
+  TIM1->CH2CVR  = (freq && JOY_SOUND) ? half >> BAT_volume() : 0;  // (duty: volume)
+  TIM1->RPTCR   = dur - 1;
+  TIM1->CHCTLR1 = TIM_OC2M_2 | TIM_OC2M_1 | TIM_OC2PE;  // PWM mode 1
+  TIM1->SWEVGR  = TIM_UG;                     // load note, restart counter
+  TIM1->CTLR1  |= TIM_CEN;
+  JOY_snd_busy  = 1;
+}
+
+// Queue note
+void JOY_sound(uint8_t freq, uint8_t dur) {
+  uint8_t next = (JOY_snd_head + 1) & (JOY_SND_SIZE - 1);
+  if(!dur) return;
+  PROF_begin(PROF_SOUND);
+  while(next == JOY_snd_tail);                // wait for a free slot
+  PROF_end();
+  INT_ATOMIC_BLOCK {
+    JOY_snd_freq[JOY_snd_head] = freq;
+    JOY_snd_dur[JOY_snd_head]  = dur;
+    JOY_snd_head = next;
+    if(!JOY_snd_busy) JOY_sound_next();
+  }
+}
+
+// Start sound effect
+void JOY_sfx(const uint8_t* sfx) {
+  INT_ATOMIC_BLOCK {
+    if(!JOY_sfx_ptr || (sfx[0] >= JOY_sfx_prio)) {
+      JOY_sfx_prio = sfx[0];
+      JOY_sfx_ptr  = sfx + 1;
+      JOY_sound_next();                       // cut the current note
+    }
+  }
+}
+
+// Note finished
+void TIM1_UP_IRQHandler(void) {
+  PROF_IRQ_BEGIN();
+  TIM1->INTFR = ~TIM_UIF;
+  JOY_sound_next();
+  PROF_IRQ_END(PROF_SOUND);
+}
+#else
+void JOY_sound(uint8_t freq, uint8_t dur) {
+  while(dur--) {
+    #if JOY_SOUND == 1
+    if(freq && (BAT_volume() < BAT_SILENT)) PIN_low(PIN_BEEP);
+    #endif
+    DLY_us(255 - freq);
+    PIN_high(PIN_BEEP);
+    DLY_us(255 - freq);
+  }
+}
+
+// Play sound effect (blocking)
+void JOY_sfx(const uint8_t* sfx) {
+  uint8_t freq, dur;
+  JOY_sfx_ptr = sfx + 1;
+  while(JOY_sfx_step(&freq, &dur)) JOY_sound(freq, dur);
+}
+#endif
+
+// Pseudo random number generator
+uint16_t rnval = 0xACE1;
+uint16_t JOY_random(void) {
+  rnval = (rnval >> 0x01) ^ (-(rnval & 0x01) & 0xB400);
+  return rnval;
+}
+
+// Idle manager: waiting screens (title, attract mode) call JOY_idle(ms) instead of
+// JOY_DLY_ms(ms), a still screen calls JOY_idle(JOY_IDLE_POLL) in its button loop.
+// The chip sleeps meanwhile, a button edge ends the wait early. The time without
+// input is counted: after JOY_IDLE_DIM seconds the display is dimmed, after
+// JOY_IDLE_OFF seconds it is switched off and the chip stands by until the button
+// (EXTI) or the joypad (checked every JOY_IDLE_AWU ms, woken by AWU) is pressed.
+// That input only switches the display on again, JOY_idle() returns when it is
+// released. The game calls JOY_idle_wake() when it leaves the screen
+// (JOY_frame_start() does).
+uint8_t  JOY_idle_level;                      // 0: display on, 1: dimmed, 2: off
+uint32_t JOY_idle_ms;                         // time without input in ms
+uint32_t JOY_idle_last;                       // SysTick count of the last JOY_idle()
+#if JOY_EVENTS > 0
+uint32_t JOY_idle_edge;                       // last button edge seen by JOY_idle()
+#endif
+
+// Check for input (raw, not recorded), also for edges the game already took
+uint8_t JOY_idle_input(void) {
+  uint8_t in = JOY_act_raw() || JOY_pad_raw();
+  #if JOY_EVENTS > 0
+  if(JOY_act_time != JOY_idle_edge) {
+    JOY_idle_edge = JOY_act_time;
+    in = 1;
+  }
+  #endif
+  return in;
+}
+
+// Display on at the contrast of the battery level, start counting again
+void JOY_idle_wake(void) {
+  if(JOY_idle_level > 1) OLED_display_on();
+  if(JOY_idle_level) OLED_contrast(BAT_contrast());
+  JOY_idle_level = 0;
+  JOY_idle_ms    = 0;
+}
+
+// Frame scheduler
+// The game loop runs one logic tick per JOY_FRAME_US, timed by SysTick, and
+// calls JOY_frame_wait() at its end. A loop that falls behind (e.g. because of
+// a long screen update) runs its next ticks back to back to catch up, up to
+// JOY_FRAME_LAG ticks; beyond that, e.g. after a blocking pause, the missed
+// time is dropped. JOY_frame_render is set on every JOY_FRAME_RENDER-th tick
+// (every second one of those on a weak battery, BAT_render() in battery.h),
+// except while catching up, so rendering gives way to game logic on overrun.
+uint32_t JOY_frame_next;                      // SysTick count of the next tick
+uint8_t  JOY_frame_cnt;                       // ticks since the last render tick
+uint8_t  JOY_frame_render = 1;                // 1: render in this tick
+
+// Clock profiles (SYS_CLK_PROFILES in system.h): the game loop of the frame
+// scheduler runs at 48MHz, waiting screens (JOY_DLY_ms) at 6MHz. The buses are
+// drained before a switch, their dividers and the sound timer's are set again.
+#if SYS_CLK_PROFILES > 0
+void JOY_clock(uint8_t p) {
+  if(p == CLK_profile) return;
+  BUS_flush();
+  #if TLM_ENABLE > 0 || REC_MODE > 0 || LINK_MODE > 0
+  UART_flush();
+  #endif
+  CLK_setProfile(p);
+  BUS_setClock();
+  #if TLM_ENABLE > 0 || REC_MODE > 0 || LINK_MODE > 0
+  UART_setClock();
+  #endif
+  #if JOY_SND_TIMER > 0
+  TIM1->PSC = (CLK_freq() / 1000000) - 1;     // count in us
+  #endif
+}
+#endif
+
+// Link play (LINK_MODE, see link.h): at the end of each tick JOY_frame_wait()
+// exchanges the inputs of the tick with the other console, the data of
+// JOY_link_send() goes along. Each console plays its own game with the peer's
+// data (JOY_link_recv()), or both play the same game with the inputs of both
+// players (JOY_player_...(): 0 is side 0, 1 is side 1), which the consoles share
+// in lockstep. Without link player 0 is this console, player 1 is idle.
+#if LINK_MODE > 0
+uint8_t JOY_link_out;                         // data for the next packet (0: none)
+
+// Fetch the data of the peer's last packet (0: none)
+uint8_t JOY_link_recv(void) {
+  uint8_t v = LINK_data;
+  LINK_data = 0;
+  return v;
+}
+#endif
+
+// Suspend/resume (SNAP_ENABLE, see snapshot.h): the game calls JOY_resume() once
+// at startup with its tag and the version of its SNAP_STATE variables. If there
+// is a snapshot of it, the state is restored and JOY_resume() returns 1: the game
+// draws its screen again and goes on with its game loop. From then on, holding
+// the button and the JOY_SNAP_DIRS directions (DOWN) for SNAP_HOLD ms, or VDD
+// staying below the PVD level for SNAP_PVD_MS (SNAP_PVD, dips of the buzzer
+// pass), suspends the game at the end of a tick: the state is saved, the display
+// switched off and the chip stands by until there is input, then it resets and
+// resumes. Link play is never suspended.
+#if SNAP_ENABLE > 0
+volatile uint8_t JOY_snap_req;                // 1: suspend at the end of the tick
+uint8_t  JOY_snap_game;                       // tag of the game (0: no suspend)
+uint8_t  JOY_snap_ver;                        // version of its state
+uint16_t JOY_snap_seed SNAP_STATE;            // JOY_random() state of the snapshot
+#if JOY_EVENTS > 0 && JOY_SNAP_DIRS >= 0
+uint32_t JOY_snap_since;                      // SysTick count without the gesture
+#endif
+#if SNAP_PVD > 0 && !defined(SIM)
+volatile uint8_t JOY_pvd_low;                 // 1: VDD fell below the PVD level
+volatile uint32_t JOY_pvd_time;               // SysTick count of the fall
+
+// Low voltage is confirmed on every tick: VDD back above the level cancels it,
+// below it for SNAP_PVD_MS requests the suspend
+static inline void JOY_pvd_check(void) {
+  if(!JOY_pvd_low) return;
+  if(!PVD_isLow()) JOY_pvd_low = 0;
+  else if((STK->CNT - JOY_pvd_time) >= (uint32_t)SNAP_PVD_MS * DLY_MS_TIME) JOY_snap_req = 1;
+}
+#endif
+
+void JOY_suspend(void);                       // (see below)
+#endif
+
+// Battery governor (battery.h): a new level sets the contrast at once (unless the
+// display is dimmed), the render interval, the sound duty and the clock profile
+// of the game loop are taken from the level where they are used
+void JOY_bat_check(void) {
+  if(BAT_take() && !JOY_idle_level) OLED_contrast(BAT_contrast());
+}
+
+// Restart the schedule from now
+void JOY_frame_start(void) {
+  JOY_clock(BAT_clock());
+  JOY_idle_wake();
+  JOY_frame_next   = STK->CNT + JOY_FRAME_US * DLY_US_TIME;
+  JOY_frame_cnt    = 0;
+  JOY_frame_render = 1;
+}
+
+// Grayscale: while the game waits for its next tick, the bitplanes of the shaded
+// layers are sent one after the other (LAYER_gray_frame()), as long as the time
+// left is longer than the last one took. The game hands over the context of its
+// layers with JOY_gray_start(ctx). The number of bitplane frames per second is
+// sent as telemetry counter TLM_ID_GRAY, so it doubles as a benchmark of the bus.
+#if JOY_GRAY > 0
+void*    JOY_gray_ctx;                        // context of the layers
+uint32_t JOY_gray_time;                       // SysTick counts of the last frame
+uint32_t JOY_gray_sec;                        // start of the counted second
+uint16_t JOY_gray_cnt;                        // frames in the counted second
+
+void JOY_gray_start(void* ctx) {
+  JOY_gray_ctx  = ctx;
+  JOY_gray_time = 0;
+  JOY_gray_sec  = STK->CNT;
+  JOY_gray_cnt  = 0;
+}
+
+void JOY_gray(uint32_t until) {
+  uint32_t t;
+  while((int32_t)(until - (t = STK->CNT)) > (int32_t)JOY_gray_time) {
+    if(!LAYER_gray_frame(JOY_gray_ctx)) break;
+    JOY_gray_time = STK->CNT - t;
+    JOY_gray_cnt++;
+  }
+  if(STK->CNT - JOY_gray_sec >= 1000 * DLY_MS_TIME) {
+    TLM_counter(TLM_ID_GRAY, JOY_gray_cnt);
+    JOY_gray_sec += 1000 * DLY_MS_TIME;
+    JOY_gray_cnt  = 0;
+  }
+}
+#endif
+
+// Wait for the next tick, timed tasks run meanwhile
+void JOY_frame_wait(void) {
+  int32_t late;
+  uint8_t every = JOY_FRAME_RENDER << BAT_render();
+  JOY_clock(BAT_clock());
+  TSK_run();
+  JOY_bat_check();
+  PROF_frame(JOY_frame_render);               // profiler: tick ends here
+  #if PROF_ENABLE == 0
+  TLM_frame(JOY_frame_render, 0, 0);          // (profiler sends phase times)
+  #endif
+  REC_frame(JOY_frame_render, OLED_crc);      // recorder: frame hash
+  #if BENCH > 0
+  BENCH_tick(JOY_frame_render);               // benchmark: no waiting
+  late = 0;
+  #else
+  PROF_begin(PROF_IDLE);
+  late = (int32_t)(STK->CNT - JOY_frame_next);
+  if(late < 0) {
+    #if JOY_GRAY > 0
+    JOY_gray(JOY_frame_next);
+    #endif
+    TSK_idle(JOY_frame_next);
+    late = 0;
+  }
+  PROF_end();
+  if(late > JOY_FRAME_LAG * JOY_FRAME_US * DLY_US_TIME) {
+    JOY_frame_next = STK->CNT;                // too far behind: drop the missed ticks
+    late = 0;
+  }
+  #endif
+  #if LINK_MODE > 0
+  if(LINK_on && LINK_tick((JOY_act_raw() ? LINK_ACT : 0) | JOY_pad_read(), JOY_link_out)) {
+    JOY_frame_next = STK->CNT;                // side 1: side 0 sets the pace
+    late = 0;
+  }
+  JOY_link_out = 0;
+  #endif
+  #if REC_MODE > 0
+  late = 0;                                   // recorder: fixed render cadence
+  #endif
+  JOY_frame_next += JOY_FRAME_US * DLY_US_TIME;
+  if(++JOY_frame_cnt >= every
+    && (late < JOY_FRAME_US * DLY_US_TIME || JOY_frame_cnt >= every << 1)) {
+    JOY_frame_cnt    = 0;
+    JOY_frame_render = 1;
+  }
+  else JOY_frame_render = 0;
+  LAT_tick();                                 // latency meter: next tick starts
+  #if SNAP_ENABLE > 0
+  #if JOY_EVENTS > 0 && JOY_SNAP_DIRS >= 0
+  if(!JOY_act_state || (JOY_dirs != JOY_SNAP_DIRS)) JOY_snap_since = STK->CNT;
+  else if((STK->CNT - JOY_snap_since) >= (uint32_t)SNAP_HOLD * DLY_MS_TIME) JOY_snap_req = 1;
+  #endif
+  #if SNAP_PVD > 0 && !defined(SIM)
+  JOY_pvd_check();
+  #endif
+  if(JOY_snap_req) JOY_suspend();
+  #endif
+}
+
+// Delays (timed tasks keep running, the chip sleeps in between)
+#if SYS_CLK_PROFILES > 0
+void JOY_DLY_ms(uint16_t ms) {
+  uint32_t end = STK->CNT + (uint32_t)ms * DLY_MS_TIME;
+  JOY_clock(CLK_SLOW);                      // (may wait for the buses)
+  TSK_idle(end);
+}
+#endif
+
+// Stand by with the display off until there is input
+void JOY_idle_standby(void) {
+  JOY_clock(CLK_SLOW);                        // (standby wakes up on the HSI)
+  BUS_flush();
+  #if TLM_ENABLE > 0 || REC_MODE > 0 || LINK_MODE > 0
+  UART_flush();
+  #endif
+  AWU_start(JOY_IDLE_AWU);
+  PFIC->SCTLR |= PFIC_SEVONPEND;              // the button interrupt wakes up, too
+  do {
+    AWU_stdby(JOY_IDLE_AWU);
+    #if SYS_CLK_PROFILES == 0
+    CLK_init();                               // (the PLL is off after standby)
+    #endif
+    DLY_ms(1);                                // fresh joypad samples
+  } while(!JOY_idle_input());
+  PFIC->SCTLR &= ~PFIC_SEVONPEND;
+  AWU_stop();
+}
+
+#if SNAP_ENABLE > 0
+#if SNAP_PVD > 0 && !defined(SIM)
+// Low voltage: start the check of JOY_pvd_check() (a fall during one only
+// goes on with it)
+void PVD_IRQHandler(void) __attribute__((interrupt));
+void PVD_IRQHandler(void) {
+  EXTI->INTFR = EXTI_INTF_INTF8;
+  if(!JOY_pvd_low) {
+    JOY_pvd_time = STK->CNT;
+    JOY_pvd_low  = 1;
+  }
+}
+#endif
+
+// Save the state, stand by with the display off, reset on input
+void JOY_suspend(void) {
+  JOY_snap_req = 0;
+  if(!JOY_snap_game || JOY_linked()) return;
+  JOY_snap_seed = rnval;
+  BUS_flush();
+  if(!SNAP_save(JOY_snap_game, JOY_snap_ver)) return;
+  OLED_display_off();
+  while(JOY_act_raw() || JOY_pad_raw()) JOY_DLY_ms(10);  // (release: no input)
+  JOY_DLY_ms(JOY_DEBOUNCE);
+  JOY_idle_input();
+  JOY_idle_standby();
+  RST_now();
+}
+
+// Restore the snapshot of the game, returns 1 if it goes on from there
+uint8_t JOY_resume(uint8_t game, uint8_t version) {
+  JOY_snap_game = game;
+  JOY_snap_ver  = version;
+  #if SNAP_PVD > 0 && !defined(SIM)
+  PVD_enable();
+  PVD_set_2V7();                              // (below BAT_MV_EMPTY, battery.h)
+  PVD_RT_enable();                            // (PVD output rises when VDD falls)
+  PVD_INT_enable();
+  NVIC_EnableIRQ(PVD_IRQn);
+  #endif
+  if(!SNAP_load(game, version)) return 0;
+  rnval = JOY_snap_seed;
+  while(JOY_act_raw()) JOY_DLY_ms(10);        // (the wake-up press is no input)
+  JOY_event_flush();
+  return 1;
+}
+#endif
+
+// Wait ms milliseconds on a waiting screen (see above)
+void JOY_idle(uint16_t ms) {
+  uint32_t d = (STK->CNT - JOY_idle_last) / DLY_MS_TIME;
+  if(d < 1000) JOY_idle_last += d * DLY_MS_TIME;  // (keeps the fraction of a ms)
+  else {                                      // first call after a game
+    JOY_idle_last = STK->CNT;
+    d = 0;
+  }
+  JOY_bat_check();
+  if(JOY_idle_input()) JOY_idle_wake();
+  else {
+    JOY_idle_ms += d;
+    #if JOY_IDLE_DIM > 0
+    if(!JOY_idle_level && (JOY_idle_ms >= JOY_IDLE_DIM * 1000UL)) {
+      OLED_contrast(JOY_IDLE_LOW);
+      JOY_idle_level = 1;
+    }
+    #endif
+    #if JOY_IDLE_OFF > 0
+    if(JOY_idle_ms >= JOY_IDLE_OFF * 1000UL) {
+      OLED_display_off();
+      JOY_idle_level = 2;
+      JOY_idle_standby();
+      JOY_idle_wake();
+      while(JOY_act_raw() || JOY_pad_raw()) JOY_DLY_ms(10);
+      JOY_event_flush();                      // (the wake-up press is no click)
+      JOY_idle_input();
+      JOY_idle_last = STK->CNT;
+      return;
+    }
+    #endif
+  }
+  if(ms) {                                    // (a button edge ends the wait)
+    uint32_t end  = STK->CNT + (uint32_t)ms * DLY_MS_TIME;
+    #if JOY_EVENTS > 0
+    uint32_t edge = JOY_act_time;
+    #endif
+    JOY_clock(CLK_SLOW);
+    while(((int32_t)(STK->CNT - end)) < 0) {
+      #if JOY_EVENTS > 0
+      if(JOY_act_time != edge) break;
+      #endif
+      TSK_run();
+      SLEEP_until(TSK_next(end));
+    }
+  }
+}
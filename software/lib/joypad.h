@@ -0,0 +1,432 @@
+// ===================================================================================
+// Tiny Joypad Engine for CH32V003                                            * v1.0 *
+// ===================================================================================
+//
+// The part of the TinyJoypad conversion driver that all games share: buttons and
+// joypad, sound, frame scheduler, idle manager, suspend/resume and link play.
+// The driver.h of a game includes this header and adds its display and layer
+// aliases and its BENCH_SCRIPT[]; the pins and the JOY_* tuning of the game are
+// set in its config.h, so this driver is built with the same settings.
+//
+// Buttons and joypad:
+// The joypad is sampled in the background (JOY_PAD_DMA) and decoded into
+// direction bits by a binary search over the calibration points, the points
+// stored by the calibrator replace those of the config (JOY_PAD_CAL). JOY_poll()
+// takes the snapshot the direction calls read, once per frame. With JOY_EVENTS
+// the button edges (pin interrupt) and the pad edges (JOY_poll()) are queued
+// with the SysTick count at the edge, JOY_act_clicked() consumes them.
+//
+// Sound:
+// Sound effects are byte strings in flash (SFX_... steps, see below), played by
+// JOY_sfx(). With JOY_SND_TIMER TIM1 plays the notes in the background and
+// JOY_sound() only queues them.
+//
+// Frame scheduler:
+// The game loop runs one logic tick per JOY_FRAME_US and calls JOY_frame_wait()
+// at its end. JOY_frame_render is set on every JOY_FRAME_RENDER-th tick, except
+// while the loop catches up after an overrun.
+//
+// Idle manager:
+// Waiting screens call JOY_idle(ms) instead of JOY_DLY_ms(ms). After JOY_IDLE_DIM
+// seconds without input the display is dimmed, after JOY_IDLE_OFF seconds it is
+// switched off and the chip stands by until there is input.
+//
+// Functions available:
+// --------------------
+// JOY_init()               init driver (pins, sound timer, display, stored calibration)
+// JOY_poll()               take a joypad snapshot, returns the direction bits
+// JOY_pad_read()           sample and decode the joypad (not recorded)
+// JOY_act_pressed()        button state (recorded, see replay.h)
+// JOY_act_clicked()        button press since the last call
+// JOY_up_pressed() etc.    direction of the last snapshot
+// JOY_event_get(e)         fetch oldest input event, 0 if there is none
+// JOY_event_flush()        discard all queued events
+// JOY_sound(freq, dur)     play or queue a note
+// JOY_sfx(sfx)             start a sound effect
+// JOY_random()             pseudo random number
+// JOY_frame_start()        restart the schedule of the frame scheduler
+// JOY_frame_wait()         wait for the next tick
+// JOY_idle(ms)             wait on a waiting screen
+// JOY_idle_wake()          display on, start counting again
+// JOY_DLY_ms(ms)           delay (timed tasks keep running)
+// JOY_resume(game, ver)    restore the snapshot of the game (SNAP_ENABLE)
+// JOY_gray_start(ctx)      send the bitplanes of the shaded layers (JOY_GRAY)
+// JOY_link_start() etc.    link play (LINK_MODE)
+//
+// 2023 by Stefan Wagner:   https://github.com/wagiminator
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "system.h"
+#include "gpio.h"
+#include "oled_min.h"
+#include "oled_layer.h"
+#include "prof.h"
+#include "telemetry.h"
+#include "bench.h"
+#include "replay.h"
+#include "flash_kv.h"
+#include "snapshot.h"
+#include "latency.h"
+#include "battery.h"
+#include "link.h"
+#include "asset.h"
+#if SYS_CLK_PROFILES > 0 || TLM_ENABLE > 0 || REC_MODE > 0 || LINK_MODE > 0
+#include "uart_tx.h"
+#endif
+
+// Pin assignments
+#ifndef PIN_ACT
+#define PIN_ACT       PA2         // pin connected to fire button
+#endif
+#ifndef PIN_BEEP
+#define PIN_BEEP      PA1         // pin connected to buzzer
+#endif
+#ifndef PIN_PAD
+#define PIN_PAD       PC4         // pin conected to direction buttons
+#endif
+
+// Joypad calibration values (ascending: E, N, NE, S, SE, W, NW, SW)
+#ifndef JOY_N
+#define JOY_N         197         // joypad UP
+#define JOY_NE        259         // joypad UP + RIGHT
+#define JOY_E         90          // joypad RIGHT
+#define JOY_SE        388         // joypad DOWN + RIGHT
+#define JOY_S         346         // joypad DOWN
+#define JOY_SW        616         // joypad DOWN + LEFT
+#define JOY_W         511         // joypad LEFT
+#define JOY_NW        567         // JOYPAD UP + LEFT
+#endif
+#ifndef JOY_DEV
+#define JOY_DEV       20          // deviation (points must be > 2 * JOY_DEV apart)
+#endif
+#ifndef JOY_PAD_CAL
+#define JOY_PAD_CAL   1           // 1: use the calibration stored by the calibrator if found
+#endif
+#ifndef JOY_BUS_CAL
+#define JOY_BUS_CAL   1           // 1: use the I2C clock rate stored by the calibrator if found
+#endif
+
+// Sound
+#ifndef JOY_SOUND
+#define JOY_SOUND     1           // 0: no sound, 1: with sound
+#endif
+#ifndef JOY_SND_TIMER
+#define JOY_SND_TIMER 1           // 0: busy loop, 1: played by TIM1 in the background
+#endif
+#ifndef JOY_SND_SIZE
+#define JOY_SND_SIZE  16          // length of note queue (power of 2)
+#endif
+#ifndef JOY_SND_VTF
+#define JOY_SND_VTF   1           // VTF slot of the sound timer interrupt (-1: none)
+#endif
+
+// Joypad sampling
+#ifndef JOY_PAD_DMA
+#define JOY_PAD_DMA   1           // 0: sample on JOY_poll(), 1: sample in background (DMA)
+#endif
+#ifndef JOY_PAD_RING
+#define JOY_PAD_RING  8           // number of background samples (power of 2)
+#endif
+#ifndef JOY_FAST_BOOT
+#define JOY_FAST_BOOT 1           // 1: set up the joypad ADC after the first screen
+#endif
+
+// Input events
+#ifndef JOY_EVENTS
+#define JOY_EVENTS    1           // 0: poll only, 1: button (EXTI) and pad event queue
+#endif
+#ifndef JOY_EVT_SIZE
+#define JOY_EVT_SIZE  8           // length of event queue (power of 2)
+#endif
+#ifndef JOY_DEBOUNCE
+#define JOY_DEBOUNCE  5           // button debounce time in ms
+#endif
+#ifndef JOY_PIN_VTF
+#define JOY_PIN_VTF   -1          // VTF slot of the button interrupt (-1: none)
+#endif
+
+// Fast interrupts (see system.h): the two VTF slots serve the display (BUS_VTF)
+// and the sound timer, the seldom button edges use the vector table
+#if (JOY_SND_VTF >= 0 && JOY_SND_VTF == BUS_VTF) \
+  || (JOY_PIN_VTF >= 0 && (JOY_PIN_VTF == BUS_VTF || JOY_PIN_VTF == JOY_SND_VTF))
+  #error Each VTF slot can only serve one interrupt!
+#endif
+
+// External assets (asset.h): levels and screens from an I2C EEPROM on the bus
+#ifndef JOY_ASSETS
+#define JOY_ASSETS    0           // 0: flash only, 1: load assets from an EEPROM if found
+#endif
+#ifndef JOY_ASSET_GAME
+#define JOY_ASSET_GAME 0          // game tag of the EEPROM image (asset_pack.py -g)
+#endif
+
+// Frame scheduler
+#ifndef JOY_FRAME_US
+#define JOY_FRAME_US      30000   // logic tick period in us
+#endif
+#ifndef JOY_FRAME_RENDER
+#define JOY_FRAME_RENDER  1       // render every n-th tick
+#endif
+#ifndef JOY_FRAME_LAG
+#define JOY_FRAME_LAG     3       // max number of ticks to catch up after an overrun
+#endif
+
+// Grayscale (LAYER_GRAY in oled_layer.h)
+#ifndef JOY_GRAY
+#define JOY_GRAY      0           // 1: shaded layers, their bitplanes are sent while waiting
+#endif                            //    for the next tick (needs ~60 full frames/s on the bus)
+
+// Idle manager (waiting screens)
+#ifndef JOY_IDLE_DIM
+#define JOY_IDLE_DIM  20          // dim the display after n seconds without input (0: never)
+#endif
+#ifndef JOY_IDLE_OFF
+#define JOY_IDLE_OFF  60          // switch it off after n seconds and stand by (0: never)
+#endif
+#ifndef JOY_IDLE_LOW
+#define JOY_IDLE_LOW  4           // contrast while dimmed (0..255, normal: 127)
+#endif
+#ifndef JOY_IDLE_AWU
+#define JOY_IDLE_AWU  125         // ms between joypad checks in standby
+#endif
+#ifndef JOY_IDLE_POLL
+#define JOY_IDLE_POLL 20          // ms between button reads of a still screen
+#endif
+
+#if JOY_PAD_DMA > 0
+extern volatile uint16_t JOY_ring[JOY_PAD_RING];  // latest joypad samples, written by DMA
+#endif
+
+extern uint16_t rnval;            // seed of JOY_random()
+extern uint8_t  JOY_pad_ready;    // 1: joypad ADC is set up
+
+// Startup stages (SYS_STARTUP_PROF in system.h, sent as TLM_STARTUP record)
+enum {JOY_BOOT_OLED = STARTUP_USER, JOY_BOOT_INIT, JOY_BOOT_FRAME, JOY_BOOT_PAD,
+      JOY_BOOT_SHOWN};
+
+void JOY_init(void);
+void JOY_pad_init(void);
+
+// EEPROM assets
+#if JOY_ASSETS > 0
+#define JOY_ASSET_size            ASSET_size
+#define JOY_ASSET_read            ASSET_read
+#define JOY_ASSET_page            ASSET_page
+#else
+#define JOY_ASSET_size(id)        0
+#define JOY_ASSET_read(id, o, b, l) 0
+#define JOY_ASSET_page(id, o, l)  0
+#endif
+
+// Buttons (the game's reads pass through the input recorder, see replay.h)
+#if BENCH > 0
+#define JOY_act_raw()             ((BENCH_input() & BENCH_ACT) != 0)
+#else
+#define JOY_act_raw()             (!PIN_read(PIN_ACT))
+#endif
+#define JOY_act_pressed()         REC_input(REC_ACT, JOY_act_raw())
+#define JOY_act_released()        (!JOY_act_pressed())
+#if JOY_PAD_DMA > 0
+#define JOY_pad_raw()             (JOY_ring[0] > 10)
+#else
+#define JOY_pad_raw()             (JOY_pad_ready && (ADC_read() > 10))
+#endif
+#define JOY_pad_pressed()         (JOY_padval > 10)
+#define JOY_pad_released()        (JOY_padval <= 10)
+#define JOY_all_released()        (JOY_act_released() && JOY_pad_released())
+
+// Joypad directions (read from the snapshot taken by JOY_poll())
+#define JOY_UP      0x01
+#define JOY_RIGHT   0x02
+#define JOY_DOWN    0x04
+#define JOY_LEFT    0x08
+
+#define JOY_up_pressed()          ((JOY_dirs & JOY_UP)    != 0)
+#define JOY_down_pressed()        ((JOY_dirs & JOY_DOWN)  != 0)
+#define JOY_left_pressed()        ((JOY_dirs & JOY_LEFT)  != 0)
+#define JOY_right_pressed()       ((JOY_dirs & JOY_RIGHT) != 0)
+
+// Suspend gesture (SNAP_ENABLE): the button held together with exactly these
+// directions for SNAP_HOLD ms suspends the game, -1 leaves only the suspend on
+// low voltage, for games whose play holds the button (thrust, autofire)
+#ifndef JOY_SNAP_DIRS
+#define JOY_SNAP_DIRS JOY_DOWN    // direction bits of the gesture (-1: no gesture)
+#endif
+
+extern uint16_t JOY_padval;       // ADC value of the last snapshot
+extern uint8_t  JOY_dirs;         // direction bits of the last snapshot
+extern uint8_t  JOY_edges;        // directions newly pressed with the last snapshot
+
+// Calibration points in ascending order and their direction bits
+extern uint16_t JOY_BAND[];
+extern uint16_t JOY_dev;
+extern const uint8_t JOY_BAND_DIR[];
+
+#if JOY_EVENTS > 0
+// Input event queue: button edges are queued by the pin interrupt, pad
+// direction edges by JOY_poll(), each with the SysTick count at the edge
+enum {JOY_EVT_NONE, JOY_EVT_ACT_PRESS, JOY_EVT_ACT_RELEASE, JOY_EVT_PAD_PRESS, JOY_EVT_PAD_RELEASE};
+
+typedef struct {
+  uint8_t  type;                  // JOY_EVT_...
+  uint8_t  dirs;                  // direction bits of pad events
+  uint32_t time;                  // SysTick count of the edge
+} JOY_EVENT;
+
+extern volatile uint8_t  JOY_act_state;   // last queued button state (1: pressed)
+extern volatile uint32_t JOY_act_time;    // SysTick count of the last queued button edge
+
+void    JOY_event_put(uint8_t type, uint8_t dirs, uint32_t time);
+uint8_t JOY_event_get(JOY_EVENT* e);
+void    JOY_event_flush(void);
+uint8_t JOY_act_clicked(void);
+void    JOY_act_edge(void);
+#else
+#define JOY_event_flush()
+#define JOY_act_clicked()         JOY_act_pressed()
+#endif
+
+uint8_t JOY_decode(uint16_t val);
+uint8_t JOY_pad_read(void);
+uint8_t JOY_poll(void);
+
+// Buzzer
+// Sound effects are byte strings in flash: a priority followed by steps.
+//   SFX_NOTE(f, d)       note like JOY_sound(f, d), f = 0 is a rest
+//   SFX_REST_MS(ms)      rest of ms milliseconds (up to 130)
+//   SFX_LOOP(n)          repeat the steps up to SFX_NEXT n times (no nesting)
+//   SFX_SLIDE(f, d, s)   note inside a loop, its pitch moves by s every pass
+//   SFX_NEXT             end of the loop
+//   SFX_END              end of the effect
+// JOY_sfx() starts an effect unless one with a higher priority is playing.
+// Running effects are preempted, notes of JOY_sound() wait until it is over.
+#define SFX_OP_END          0
+#define SFX_OP_NOTE         1
+#define SFX_OP_SLIDE        2
+#define SFX_OP_LOOP         3
+#define SFX_OP_NEXT         4
+
+#define SFX_NOTE(f, d)      SFX_OP_NOTE, (f), (d)
+#define SFX_REST(d)         SFX_OP_NOTE, 0, (d)
+#define SFX_REST_MS(ms)     SFX_REST(((ms) * 1000UL + 255) / 510)
+#define SFX_SLIDE(f, d, s)  SFX_OP_SLIDE, (f), (d), (uint8_t)(s)
+#define SFX_LOOP(n)         SFX_OP_LOOP, (n)
+#define SFX_NEXT            SFX_OP_NEXT
+#define SFX_END             SFX_OP_END
+
+extern const uint8_t* JOY_sfx_ptr;            // next step, 0 if no effect is playing
+
+#define JOY_sfx_playing()   (JOY_sfx_ptr != 0)
+
+void JOY_sound(uint8_t freq, uint8_t dur);
+void JOY_sfx(const uint8_t* sfx);
+
+#if JOY_SND_TIMER > 0
+extern volatile uint8_t JOY_snd_busy;         // 1: note is playing
+
+// Wait until the effect and all queued notes are played
+#define JOY_sound_wait()  while(JOY_snd_busy)
+#else
+#define JOY_sound_wait()
+#endif
+
+uint16_t JOY_random(void);
+
+// Idle manager
+extern uint8_t JOY_idle_level;                // 0: display on, 1: dimmed, 2: off
+
+void JOY_idle(uint16_t ms);
+void JOY_idle_wake(void);
+
+// Frame scheduler
+extern uint8_t JOY_frame_render;              // 1: render in this tick
+
+void JOY_frame_start(void);
+void JOY_frame_wait(void);
+
+// Clock profiles (SYS_CLK_PROFILES in system.h)
+#if SYS_CLK_PROFILES > 0
+void JOY_clock(uint8_t p);
+#else
+#define JOY_clock(p)
+#endif
+
+// Grayscale (JOY_GRAY)
+#if JOY_GRAY > 0
+void JOY_gray_start(void* ctx);
+#else
+#define JOY_gray_start(ctx)
+#endif
+
+// Link play (LINK_MODE, see link.h): each console plays its own game with the
+// peer's data (JOY_link_send(), JOY_link_recv()), or both play the same game
+// with the inputs of both players (JOY_player_...(): 0 is side 0, 1 is side 1),
+// which the consoles share in lockstep. Without link player 0 is this console,
+// player 1 is idle.
+#if LINK_MODE > 0
+extern uint8_t JOY_link_out;                  // data for the next packet (0: none)
+
+uint8_t JOY_link_recv(void);
+
+#define JOY_link_start()          LINK_start(&rnval)
+#define JOY_link_stop             LINK_stop
+#define JOY_linked()              LINK_on
+#define JOY_link_side()           LINK_side
+#define JOY_link_send(v)          (JOY_link_out = (v))
+#define JOY_player_dirs(p)        (LINK_on ? LINK_in[p] & 0x0F : (p) ? 0 : JOY_poll())
+#define JOY_player_act(p)         (LINK_on ? (LINK_in[p] & LINK_ACT) != 0 \
+                                           : (p) ? 0 : JOY_act_pressed())
+#else
+#define JOY_link_start()          0
+#define JOY_link_stop()
+#define JOY_linked()              0
+#define JOY_link_side()           0
+#define JOY_link_send(v)
+#define JOY_link_recv()           0
+#define JOY_player_dirs(p)        ((p) ? 0 : JOY_poll())
+#define JOY_player_act(p)         ((p) ? 0 : JOY_act_pressed())
+#endif
+
+// Suspend/resume (SNAP_ENABLE, see snapshot.h and JOY_SNAP_DIRS above)
+#if SNAP_ENABLE > 0
+uint8_t JOY_resume(uint8_t game, uint8_t version);
+#else
+#define JOY_resume(game, version) 0
+#endif
+
+// Delays (timed tasks keep running, the chip sleeps in between)
+#if SYS_CLK_PROFILES > 0
+void JOY_DLY_ms(uint16_t ms);
+#else
+#define JOY_DLY_ms(ms)  TSK_idle(STK->CNT + (uint32_t)(ms) * DLY_MS_TIME)
+#endif
+#define JOY_DLY_us    DLY_us
+
+// The game's view of a benchmark build (see bench.h): scripted clicks, no delays;
+// benchmark and host simulator builds (see software/host) are silent. The driver
+// itself (JOY_DRIVER) still uses its own functions.
+#ifndef JOY_DRIVER
+#if BENCH > 0
+#undef  JOY_act_clicked
+#define JOY_act_clicked()         BENCH_clicked()
+#undef  JOY_DLY_ms
+#define JOY_DLY_ms(ms)            TSK_run()
+#define JOY_idle(ms)              TSK_run()
+#endif
+
+#if BENCH > 0 || defined(SIM)
+#undef  JOY_sound_wait
+#define JOY_sound_wait()
+#define JOY_sound(f, d)           ((void)(f), (void)(d))
+#define JOY_sfx(sfx)              ((void)(sfx))
+#endif
+#endif
+
+#ifdef __cplusplus
+};
+#endif
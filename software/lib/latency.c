@@ -0,0 +1,147 @@
+// ===================================================================================
+// Input-to-Photon Latency Meter for CH32V003                                 * v1.0 *
+// ===================================================================================
+// 2023 by Stefan Wagner:   https://github.com/wagiminator
+
+#include "latency.h"
+#include "telemetry.h"
+#include "oled_bus.h"
+
+#if LAT_ENABLE > 0
+
+#if OLED_BUS == OLED_BUS_I2C && I2C_QUEUE > 0 && I2C_STAMP > 0
+#define LAT_STAMP     1           // end of the transfer stamped by the I2C interrupt
+#else
+#define LAT_STAMP     0           // transfers are done at the end of the frame
+#endif
+
+// Stages of a measurement
+enum {LAT_IDLE, LAT_SEEN, LAT_TAKEN, LAT_FRAME, LAT_SENDING};
+
+LAT_STAT LAT_result;                  // results of the session at the last report
+uint16_t LAT_hist[LAT_BINS];          // measurements by latency
+uint16_t LAT_lost;                    // taken inputs without a sent frame
+uint8_t  LAT_ovl[4];                  // overlay digits
+uint8_t  LAT_dirty;                   // 1: the frame sends pixels
+
+volatile uint8_t LAT_stage;           // stage of the running measurement
+uint32_t LAT_t0;                      // SysTick count of the input
+uint32_t LAT_t1;                      // end of the transfer of the tagged frame
+uint16_t LAT_errors;                  // bus failures when the frame was tagged
+uint32_t LAT_min = 0xFFFFFFFF;        // of the session (us)
+uint32_t LAT_max, LAT_sum;
+uint16_t LAT_count;                   // measurements of the session
+uint8_t  LAT_new;                     // measurements since the last report
+
+// Start a new session
+void LAT_reset(void) {
+  LAT_stage = LAT_IDLE;
+  LAT_min   = 0xFFFFFFFF;
+  LAT_max   = 0;
+  LAT_sum   = 0;
+  LAT_count = 0;
+  LAT_new   = 0;
+  LAT_lost  = 0;
+  for(uint8_t i=0; i<LAT_BINS; i++) LAT_hist[i] = 0;
+}
+
+// Publish the results of the session
+static void LAT_report(void) {
+  uint16_t need = LAT_count - LAT_count / 100;
+  uint16_t cum  = 0;
+  uint8_t  i, ms;
+  for(i=0; i<LAT_BINS - 1; i++) {
+    cum += LAT_hist[i];
+    if(cum >= need) break;
+  }
+  LAT_result.min   = LAT_min;
+  LAT_result.avg   = LAT_sum / LAT_count;
+  LAT_result.p99   = (i < LAT_BINS - 1) ? (uint32_t)(i + 1) * LAT_BIN_US : LAT_max;
+  LAT_result.max   = LAT_max;
+  if(LAT_result.p99 > LAT_max) LAT_result.p99 = LAT_max;
+  LAT_result.count = LAT_count;
+  ms = (LAT_result.avg > 99000) ? 99 : LAT_result.avg / 1000;
+  LAT_ovl[0] = ms / 10;
+  LAT_ovl[1] = ms % 10;
+  ms = (LAT_result.p99 > 99000) ? 99 : LAT_result.p99 / 1000;
+  LAT_ovl[2] = ms / 10;
+  LAT_ovl[3] = ms % 10;
+  TLM_counter(TLM_ID_LAT_MIN,  LAT_result.min);
+  TLM_counter(TLM_ID_LAT_AVG,  LAT_result.avg);
+  TLM_counter(TLM_ID_LAT_P99,  LAT_result.p99);
+  TLM_counter(TLM_ID_LAT_MAX,  LAT_result.max);
+  TLM_counter(TLM_ID_LAT_LOST, LAT_lost);
+  LAT_new = 0;
+}
+
+// Finish the running measurement if its frame has been sent or it timed out
+static void LAT_check(void) {
+  uint8_t stage = LAT_stage;
+  if(stage == LAT_SENDING) {
+    if(BUS_errors != LAT_errors) {    // frame lost by a bus failure
+      LAT_lost++;
+      LAT_stage = LAT_IDLE;
+      return;
+    }
+    #if LAT_STAMP > 0
+    if(!I2C_stamped()) return;
+    LAT_t1 = I2C_stamp_time;
+    #endif
+    uint32_t us = (LAT_t1 - LAT_t0) / DLY_US_TIME;
+    uint32_t bin = us / LAT_BIN_US;
+    if(us < LAT_min) LAT_min = us;
+    if(us > LAT_max) LAT_max = us;
+    LAT_sum += us;
+    LAT_count++;
+    LAT_hist[(bin < LAT_BINS) ? bin : LAT_BINS - 1]++;
+    LAT_stage = LAT_IDLE;
+    if(++LAT_new >= LAT_WINDOW) LAT_report();
+    return;
+  }
+  if(stage != LAT_IDLE && (STK->CNT - LAT_t0) >= (uint32_t)LAT_MAX_MS * DLY_MS_TIME) {
+    if(stage != LAT_SEEN) LAT_lost++; // (untaken inputs time out unnoticed)
+    LAT_stage = LAT_IDLE;
+  }
+}
+
+// Input event (may run in the pin interrupt)
+void LAT_input(uint32_t time, uint8_t taken) {
+  uint8_t stage = LAT_stage;
+  if(stage == LAT_SEEN && (time - LAT_t0) >= (uint32_t)LAT_MAX_MS * DLY_MS_TIME)
+    stage = LAT_IDLE;                 // (an untaken input outside the game loop)
+  if(stage != LAT_IDLE) return;
+  LAT_t0    = time;
+  LAT_stage = taken ? LAT_TAKEN : LAT_SEEN;
+}
+
+// Start of a tick: the game logic takes the inputs seen so far
+void LAT_tick(void) {
+  LAT_check();
+  if(LAT_stage == LAT_SEEN) LAT_stage = LAT_TAKEN;
+}
+
+// Start of a frame
+void LAT_frame_begin(void) {
+  LAT_check();
+  LAT_dirty = 0;
+  if(LAT_stage == LAT_TAKEN) LAT_stage = LAT_FRAME;
+}
+
+// End of a frame: tagged if it changes the screen, else the next one is
+void LAT_frame_end(void) {
+  if(LAT_stage != LAT_FRAME) return;
+  if(!LAT_dirty) {
+    LAT_stage = LAT_TAKEN;
+    return;
+  }
+  LAT_errors = BUS_errors;
+  #if LAT_STAMP > 0
+  I2C_stamp(BUS_fence());
+  #else
+  LAT_t1 = STK->CNT;
+  #endif
+  LAT_stage = LAT_SENDING;
+  LAT_check();
+}
+
+#endif
@@ -0,0 +1,103 @@
+// ===================================================================================
+// Input-to-Photon Latency Meter for CH32V003                                 * v1.0 *
+// ===================================================================================
+//
+// Measures the time from an input to the end of the transfer of the first frame
+// that shows the game's answer to it, i.e. what the input sampler, the frame
+// scheduler and the display pipeline add up to:
+//
+//   input    the SysTick count of the input event (JOY_event_put() in joypad.c):
+//            a button edge is stamped by the pin interrupt, a pad change by the
+//            JOY_poll() that decodes it from the background samples
+//   taken    a pad change is taken by the game logic of the same tick, a button
+//            edge by the one of the next tick (LAT_tick() at its start)
+//   frame    the first frame begun afterwards that changes the screen (with
+//            OLED_DIFF: sends a segment at all) is the one tagged
+//   sent     the end of its transfer: with the I2C queue the event interrupt
+//            stamps the STOP of its last transmission (I2C_STAMP in i2c_tx.h),
+//            otherwise the transfers are done (or nearly, SPI DMA) at its end
+//
+// One input is measured at a time, the ones that come while it runs are not.
+// Inputs outside of the game loop (title screens) time out unnoticed. A taken
+// input without a sent frame within LAT_MAX_MS, or one whose frame got lost by
+// a bus failure, is counted in LAT_lost. The display shows the frame at its
+// next refresh (about 10 ms more at most), which no firmware can see.
+//
+// The statistics cover the whole session (since reset or LAT_reset()). Every
+// LAT_WINDOW measurements LAT_result is updated and sent as telemetry counters
+// TLM_ID_LAT_MIN, _AVG, _P99, _MAX (us) and _LOST (telemetry.h). p99 comes from
+// a histogram of LAT_BINS bins of LAT_BIN_US, it is the upper bound of its bin.
+// With the profiler overlay (prof.h) page 1 shows avg and p99 in ms below busy
+// time and fps.
+//
+// "make latency" builds a game with the meter, the profiler and telemetry.
+//
+// Functions available:
+// --------------------
+// LAT_input(time, taken)   input event at SysTick count time (taken: 1 if the game
+//                          logic of this tick sees it)
+// LAT_tick()               start of a tick of the frame scheduler
+// LAT_frame_begin()        start of a frame (OLED_window_begin)
+// LAT_changed()            the frame sends pixels (OLED_page_end)
+// LAT_frame_end()          end of a frame (OLED_frame_end)
+// LAT_reset()              start a new session
+//
+// 2023 by Stefan Wagner:   https://github.com/wagiminator
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "system.h"
+
+// Latency meter options
+#ifndef LAT_ENABLE
+#define LAT_ENABLE    0           // 1: latency meter hooks are compiled in
+#endif
+#ifndef LAT_WINDOW
+#define LAT_WINDOW    16          // measurements between two reports
+#endif
+#ifndef LAT_MAX_MS
+#define LAT_MAX_MS    250         // ms until an input counts as lost
+#endif
+#define LAT_BINS      32          // histogram bins (the last one: everything above)
+#define LAT_BIN_US    2000        // width of a bin in us
+
+#if LAT_ENABLE > 0
+
+// Results of the session (us)
+typedef struct {
+  uint32_t min, avg, p99, max;
+  uint16_t count;                 // measurements
+} LAT_STAT;
+
+extern LAT_STAT LAT_result;
+extern uint16_t LAT_hist[LAT_BINS];
+extern uint16_t LAT_lost;
+extern uint8_t  LAT_ovl[4];       // overlay digits: avg and p99 in ms
+extern uint8_t  LAT_dirty;        // 1: the frame sends pixels
+
+void LAT_input(uint32_t time, uint8_t taken);
+void LAT_tick(void);
+void LAT_frame_begin(void);
+void LAT_frame_end(void);
+void LAT_reset(void);
+
+#define LAT_changed()   (LAT_dirty = 1)
+
+#else
+
+#define LAT_input(time, taken)
+#define LAT_tick()
+#define LAT_frame_begin()
+#define LAT_changed()
+#define LAT_frame_end()
+#define LAT_reset()
+
+#endif
+
+#ifdef __cplusplus
+};
+#endif
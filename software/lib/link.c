@@ -0,0 +1,186 @@
+// ===================================================================================
+// Link Cable Play over USART1 for CH32V003                                   * v1.0 *
+// ===================================================================================
+// 2023 by Stefan Wagner:   https://github.com/wagiminator
+
+#include "link.h"
+
+#if LINK_MODE > 0
+
+#include "uart_tx.h"
+
+uint8_t  LINK_on;                     // 1: linked
+uint8_t  LINK_side;                   // 0: sends first, 1: answers
+uint8_t  LINK_in[2];                  // inputs of both sides of the last exchange
+uint8_t  LINK_data;                   // data of the peer's last packet
+uint8_t  LINK_tick_cnt;               // ticks since LINK_start() (parity bit)
+uint8_t  LINK_rx[2];                  // packet being received
+uint8_t  LINK_rx_len;                 // bytes of it so far
+
+#if LINK_MODE > 1
+LINK_STAT LINK_stat;
+uint32_t  LINK_last;                  // side 1: arrival of the last packet of side 0
+
+void LINK_stat_reset(void) {
+  LINK_stat.ticks    = 0;
+  LINK_stat.rtt_min  = 0xFFFF;
+  LINK_stat.rtt_max  = 0;
+  LINK_stat.rtt_sum  = 0;
+  LINK_stat.gap_min  = 0xFFFF;
+  LINK_stat.gap_max  = 0;
+  LINK_stat.wait_max = 0;
+}
+#endif
+
+// Init USART1 half-duplex
+void LINK_init(void) {
+  UART_init();
+}
+
+// Send hello record of type t with seed s
+static void LINK_hello(uint8_t t, uint16_t s) {
+  uint8_t h[5] = {t, s & 0x7F, (s >> 7) & 0x7F, s >> 14, 0};
+  h[4] = (t + h[1] + h[2] + h[3]) & 0x7F;
+  UART_send(h, 5);
+}
+
+// Find the peer and agree on seed and sides, returns 1 if linked
+uint8_t LINK_start(uint16_t* seed) {
+  uint8_t  h[5] = {0}, got = 0, b, i, t;
+  uint16_t mine = *seed ^ STK->CNT;   // (the start press differs on the consoles)
+  uint16_t peer = 0;
+  uint32_t start = STK->CNT, next = start;
+  LINK_on = 0;
+  while(UART_read(&b));               // drop what came before
+  while(1) {
+    if((int32_t)(STK->CNT - next) >= 0) {
+      if((STK->CNT - start) >= (uint32_t)LINK_WAIT * DLY_MS_TIME) return 0;
+      LINK_hello(got ? 'A' : 'H', mine);
+      next = STK->CNT + (LINK_HELLO + (mine & 15)) * DLY_MS_TIME;
+    }
+    if(!UART_read(&b)) continue;
+    for(i=0; i<4; i++) h[i] = h[i+1]; // (the last five bytes)
+    h[4] = b;
+    if((h[0] != 'H' && h[0] != 'A') || h[3] > 3 || (h[1] | h[2]) & 0x80) continue;
+    if(((h[0] + h[1] + h[2] + h[3]) & 0x7F) != h[4]) continue;
+    t    = h[0];
+    h[0] = 0;                         // (taken)
+    peer = h[1] | (uint16_t)h[2] << 7 | (uint16_t)h[3] << 14;
+    if(peer == mine) {                // same seed: draw a new one
+      mine ^= STK->CNT | 1;
+      got = 0;
+      continue;
+    }
+    got = 1;
+    if(t == 'A') break;               // the peer has our seed as well
+  }
+  LINK_hello('A', mine);              // (the peer may still wait for it)
+  *seed = mine ^ peer;
+  if(!*seed) *seed = 0xACE1;
+  LINK_side     = (mine > peer);
+  LINK_tick_cnt = 0;
+  LINK_rx_len   = 0;
+  LINK_in[0]    = 0;
+  LINK_in[1]    = 0;
+  LINK_data     = 0;
+  LINK_on       = 1;
+  #if LINK_MODE > 1
+  LINK_stat_reset();
+  #endif
+  return 1;
+}
+
+// End the link, the peer is told
+void LINK_stop(void) {
+  uint8_t q[2] = {0xC0, 0};           // (data byte 0: stop)
+  if(!LINK_on) return;
+  LINK_on = 0;
+  UART_send(q, 2);
+}
+
+// Receive packet of the peer, returns 1 if it is complete (in LINK_rx)
+static uint8_t LINK_recv(void) {
+  uint8_t b;
+  while(UART_read(&b)) {
+    if(b & 0x80) {                    // header
+      LINK_rx[0]  = b;
+      LINK_rx[1]  = 0;
+      LINK_rx_len = 1;
+      if(!(b & 0x40)) break;
+    }
+    else if(LINK_rx_len == 1 && (LINK_rx[0] & 0x40)) {
+      LINK_rx[1]  = b;                // data byte
+      LINK_rx_len = 2;
+      if(!b) {
+        LINK_on     = 0;              // peer has stopped
+        LINK_rx_len = 0;
+      }
+      break;
+    }
+  }
+  if(!LINK_rx_len || ((LINK_rx[0] & 0x40) && LINK_rx_len < 2)) return 0;
+  LINK_rx_len = 0;
+  return 1;
+}
+
+// Wait for the packet of the peer, returns 0 if the link is lost
+static uint8_t LINK_wait(uint32_t since) {
+  while(!LINK_recv()) {
+    if(!LINK_on || (STK->CNT - since) >= (uint32_t)LINK_TIMEOUT * DLY_MS_TIME) {
+      LINK_on = 0;
+      return 0;
+    }
+  }
+  if(((LINK_rx[0] >> 5) & 1) != (LINK_tick_cnt & 1)) {
+    LINK_on = 0;                      // out of step
+    return 0;
+  }
+  return 1;
+}
+
+// Exchange the inputs of a tick, returns 1 if the schedule restarts now
+uint8_t LINK_tick(uint8_t in, uint8_t data) {
+  uint8_t  pkt[2];
+  uint8_t  restart = 0;
+  uint32_t t0 = STK->CNT;
+  if(!LINK_on) return 0;
+  pkt[0] = 0x80 | (data ? 0x40 : 0) | (LINK_tick_cnt & 1) << 5 | (in & 0x1F);
+  pkt[1] = data;
+  if(LINK_side) {                     // side 1: answer the packet of side 0
+    if(!LINK_wait(t0)) return 0;
+    restart = 1;                      // (side 0 sets the pace)
+    #if LINK_MODE > 1
+    uint32_t gap  = (UART_rx_time - LINK_last) / DLY_US_TIME;
+    uint32_t wait = (STK->CNT - t0) / DLY_US_TIME;
+    if(LINK_stat.ticks) {
+      if(gap < LINK_stat.gap_min) LINK_stat.gap_min = gap;
+      if(gap > LINK_stat.gap_max) LINK_stat.gap_max = (gap > 0xFFFF) ? 0xFFFF : gap;
+    }
+    if(wait > LINK_stat.wait_max) LINK_stat.wait_max = (wait > 0xFFFF) ? 0xFFFF : wait;
+    LINK_last = UART_rx_time;
+    #endif
+    UART_send(pkt, data ? 2 : 1);
+  }
+  else {                              // side 0: send, wait for the answer
+    UART_send(pkt, data ? 2 : 1);
+    if(!LINK_wait(t0)) return 0;
+    #if LINK_MODE > 1
+    uint32_t rtt = (UART_rx_time - t0) / DLY_US_TIME;
+    if(rtt > 0xFFFF) rtt = 0xFFFF;
+    if(rtt < LINK_stat.rtt_min) LINK_stat.rtt_min = rtt;
+    if(rtt > LINK_stat.rtt_max) LINK_stat.rtt_max = rtt;
+    LINK_stat.rtt_sum += rtt;
+    if(rtt > LINK_stat.wait_max) LINK_stat.wait_max = rtt;
+    #endif
+  }
+  #if LINK_MODE > 1
+  LINK_stat.ticks++;
+  #endif
+  LINK_in[LINK_side]  = in & 0x1F;
+  LINK_in[!LINK_side] = LINK_rx[0] & 0x1F;
+  LINK_data = (LINK_rx[0] & 0x40) ? LINK_rx[1] : 0;
+  LINK_tick_cnt++;
+  return restart;
+}
+
+#endif
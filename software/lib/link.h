@@ -0,0 +1,116 @@
+// ===================================================================================
+// Link Cable Play over USART1 for CH32V003                                   * v1.0 *
+// ===================================================================================
+//
+// Two consoles play together over one wire between their PD5 pins (pin 8 of the
+// CH32V003J4M6, at the programming header) and GND. The USART runs half-duplex
+// at UART_BAUD (uart_tx.h), open-drain: one of the consoles needs a pull-up on the
+// wire (e.g. 10k to VCC).
+//
+// Start: both consoles call LINK_start() (e.g. when fire is pressed on the title
+// screen). They send hello records until each has the other's seed:
+//
+//   'H' or 'A', s0, s1, s2, sum       seed in 7-bit parts, 'A': peer's seed known,
+//                                     sum = type + s0 + s1 + s2 (mod 128)
+//
+// Both take the XOR of the two seeds as the seed of JOY_random(), the console
+// with the lower seed becomes side 0. The hellos are sent at intervals that
+// depend on the seed, so two that collide on the wire don't collide again.
+//
+// Play: at the end of every tick of the frame scheduler LINK_tick() exchanges
+// the inputs of the tick (button and directions) in deterministic lockstep.
+// Side 0 sends its packet, side 1 waits for it and answers with its own, so they
+// never send at the same time:
+//
+//   1 x s a d d d d                   x: data byte follows, s: tick parity,
+//   0 v v v v v v v                   a: button, dddd: JOY_UP..JOY_LEFT,
+//                                     v: data of the game (1..127, optional)
+//
+// Afterwards both consoles have the same inputs of both sides in LINK_in[] and
+// use them in the next tick, so an input takes effect at most one tick (a
+// fraction of a frame) later than without the link. Side 0 keeps its own tick
+// rate, side 1 restarts its schedule with each packet of side 0. A wrong tick
+// parity or LINK_TIMEOUT without packet ends the link, as does LINK_stop() on
+// the other console (a packet with data byte 0).
+//
+// Measurement (LINK_MODE 2): LINK_stat collects the round trip times (side 0:
+// from sending its packet to the answer), the time between the packets of side
+// 0 as seen by side 1 (their spread is the jitter of the lockstep) and the
+// longest wait for the peer. The calibrator shows them (fire button).
+//
+// Functions available:
+// --------------------
+// LINK_init()              Init USART1 half-duplex (UART_init)
+// LINK_start(&seed)        Find the peer (LINK_WAIT ms at most), returns 1 if linked,
+//                          seed: JOY_random() state, set to the common seed
+// LINK_tick(in, data)      Exchange the inputs of a tick (LINK_ACT | directions) and
+//                          data (0: none), returns 1 if the schedule restarts now
+// LINK_stop()              End the link (the peer is told)
+// LINK_on                  1 while linked
+// LINK_side                0 or 1 on the two consoles
+// LINK_in[2]               inputs of side 0 and side 1 of the last exchange
+// LINK_data                data of the peer's last packet (0: none)
+//
+// 2023 by Stefan Wagner:   https://github.com/wagiminator
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "system.h"
+
+#ifndef LINK_MODE
+#define LINK_MODE     0           // 0: off, 1: link play, 2: with measurement
+#endif
+#ifndef LINK_WAIT
+#define LINK_WAIT     3000        // ms LINK_start() waits for the peer
+#endif
+#ifndef LINK_TIMEOUT
+#define LINK_TIMEOUT  1000        // ms without packet until the link is lost
+#endif
+#define LINK_HELLO    20          // ms between hello records (plus 0..15 ms)
+
+#define LINK_ACT      0x10        // button bit of an input (directions: 0x0F)
+
+#if LINK_MODE > 0
+
+#if TLM_ENABLE > 0 || REC_MODE > 0
+#error "LINK_MODE: the link cable and telemetry/recording share USART1"
+#endif
+
+void LINK_init(void);
+uint8_t LINK_start(uint16_t* seed);
+uint8_t LINK_tick(uint8_t in, uint8_t data);
+void LINK_stop(void);
+
+extern uint8_t LINK_on;
+extern uint8_t LINK_side;
+extern uint8_t LINK_in[2];
+extern uint8_t LINK_data;
+
+#if LINK_MODE > 1
+typedef struct {
+  uint16_t ticks;                 // ticks exchanged
+  uint16_t rtt_min, rtt_max;      // side 0: round trip in us
+  uint32_t rtt_sum;
+  uint16_t gap_min, gap_max;      // side 1: us between the packets of side 0
+  uint16_t wait_max;              // longest wait for the peer in us
+} LINK_STAT;
+
+extern LINK_STAT LINK_stat;
+void LINK_stat_reset(void);
+#endif
+
+#else
+#define LINK_init()
+#define LINK_start(seed)          0
+#define LINK_tick(in, data)       0
+#define LINK_stop()
+#define LINK_on                   0
+#endif
+
+#ifdef __cplusplus
+};
+#endif
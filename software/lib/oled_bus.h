@@ -0,0 +1,112 @@
+// ===================================================================================
+// Display Bus Selection for SSD1306 OLED                                     * v1.2 *
+// ===================================================================================
+//
+// Maps the transfers of oled_min.c onto the interface the display module is wired
+// to, chosen by OLED_BUS at compile time. All mappings are macros, so the I2C build
+// is the same as calling i2c_tx.h directly.
+//
+// OLED_BUS   Transport                 Pins
+//        0   I2C (i2c_tx.h)            SDA PC1, SCL PC2 (I2C_REMAP)
+//        1   4-wire SPI (spi_tx.h)     SCK PC5, MOSI PC6, D/C PC2, CS PC1, RES PC3
+//
+// On I2C, blocking, DMA and interrupt driven queue transfers are selected by I2C_DMA
+// and I2C_QUEUE in i2c_tx.h. On SPI, the bus is about 20 times faster, transfers are
+// blocking or DMA (SPI_DMA in spi_tx.h) and there is no queue.
+//
+// Functions available:
+// --------------------
+// BUS_init()               init the interface
+// BUS_setClock()           set clock rate again after a system clock switch
+// BUS_command()            start sending command bytes
+// BUS_data()               start sending display data
+// BUS_write(b)             send one byte
+// BUS_stop()               end of command or data bytes
+// BUS_writeBuffer(buf,len) send buffer and stop (in the background with DMA)
+// BUS_streamBuffer(buf,len) send buffer, keep transmission open
+// BUS_fill(p,len)          send len copies of byte p and stop (DMA without increment)
+// BUS_DMA_busy()           check if a DMA transfer is in progress
+// BUS_DMA_wait()           wait until the DMA transfer is done
+// BUS_fence()              get ticket for everything queued so far
+// BUS_wait(ticket)         wait until everything queued before ticket was sent
+// BUS_flush()              wait until everything was sent
+// BUS_bytes                number of bytes sent (if I2C_SINK/SPI_SINK > 0)
+// BUS_failed()             check if the bus has failed (I2C_TIMEOUT, only on I2C)
+// BUS_recover()            free the bus and init the interface again after a failure
+// BUS_errors               number of bus failures so far
+// BUS_recoveries           number of recoveries so far
+// BUS_DMA, BUS_QUEUE       1: transfers run in the background, are queued
+// BUS_VTF                  VTF slot used by the interface (-1: none)
+//
+// 2023 by Stefan Wagner:   https://github.com/wagiminator
+
+#pragma once
+
+#include "config.h"               // options of the firmware (in its src folder)
+
+#define OLED_BUS_I2C      0
+#define OLED_BUS_SPI      1
+
+#ifndef OLED_BUS
+#define OLED_BUS          OLED_BUS_I2C  // interface of the display module (see above)
+#endif
+
+#define OLED_ADDR         0x78    // OLED write address (0x3C << 1)
+#define OLED_CMD_MODE     0x00    // set command mode
+#define OLED_DAT_MODE     0x40    // set data mode
+
+#if OLED_BUS == OLED_BUS_I2C
+#include "i2c_tx.h"
+
+#define BUS_init()                  I2C_init()
+#define BUS_setClock()              I2C_setClock()
+#define BUS_command()               (I2C_start(OLED_ADDR), I2C_write(OLED_CMD_MODE))
+#define BUS_data()                  (I2C_start(OLED_ADDR), I2C_write(OLED_DAT_MODE))
+#define BUS_write(b)                I2C_write(b)
+#define BUS_stop()                  I2C_stop()
+#define BUS_writeBuffer(buf, len)   I2C_writeBuffer(buf, len)
+#define BUS_streamBuffer(buf, len)  I2C_streamBuffer(buf, len)
+#define BUS_fill(p, len)            I2C_fill(p, len)
+#define BUS_DMA_busy()              I2C_DMA_busy()
+#define BUS_DMA_wait()              I2C_DMA_wait()
+#define BUS_fence()                 I2C_fence()
+#define BUS_wait(t)                 I2C_wait(t)
+#define BUS_flush()                 I2C_flush()
+#define BUS_bytes                   I2C_bytes
+#define BUS_failed()                I2C_error
+#define BUS_recover()               I2C_recover()
+#define BUS_errors                  I2C_errors
+#define BUS_recoveries              I2C_recoveries
+#define BUS_DMA                     I2C_DMA
+#define BUS_QUEUE                   I2C_QUEUE
+#define BUS_VTF                     I2C_VTF
+
+#elif OLED_BUS == OLED_BUS_SPI
+#include "spi_tx.h"
+
+#define BUS_init()                  SPI_init()
+#define BUS_setClock()              SPI_setClock()
+#define BUS_command()               SPI_command()
+#define BUS_data()                  SPI_data()
+#define BUS_write(b)                SPI_write(b)
+#define BUS_stop()                  SPI_stop()
+#define BUS_writeBuffer(buf, len)   SPI_writeBuffer(buf, len)
+#define BUS_streamBuffer(buf, len)  SPI_streamBuffer(buf, len)
+#define BUS_fill(p, len)            SPI_fill(p, len)
+#define BUS_DMA_busy()              SPI_DMA_busy()
+#define BUS_DMA_wait()              while(SPI_DMA_busy())
+#define BUS_fence()                 0
+#define BUS_wait(t)
+#define BUS_flush()                 SPI_flush()
+#define BUS_bytes                   SPI_bytes
+#define BUS_failed()                0
+#define BUS_recover()
+#define BUS_errors                  0
+#define BUS_recoveries              0
+#define BUS_DMA                     SPI_DMA
+#define BUS_QUEUE                   0
+#define BUS_VTF                     (-1)
+
+#else
+  #error "oled_bus.h: unknown OLED_BUS"
+#endif
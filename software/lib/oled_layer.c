@@ -0,0 +1,193 @@
+// ===================================================================================
+// Layer Compositor for SSD1306 OLED Page Buffer                              * v1.5 *
+// ===================================================================================
+// 2023 by Stefan Wagner:   https://github.com/wagiminator
+
+#include "oled_layer.h"
+#include "prof.h"
+#include "battery.h"
+
+// Word of the page buffer or of a table (may alias the bytes it is made of)
+typedef uint32_t __attribute__((may_alias)) LAYER_WORD;
+
+uint8_t LAYER_num;                    // number of layer slots in use
+#if LAYER_GRAY > 0
+uint16_t LAYER_skip[2];               // layers not in bitplane 0 / 1 (bit = id)
+uint8_t  LAYER_plane;                 // bitplane being composed
+uint8_t  LAYER_phase;                 // position in the plane sequence 0, 0, 1
+#endif
+
+// Register draw-span callback of layer (layer is hidden until a box is set)
+void LAYER_add(uint8_t id, LAYER_SPAN span) {
+  LAYER_list[id].span = span;
+  LAYER_hide(id);
+  #if LAYER_GRAY > 0
+  LAYER_shade(id, LAYER_FULL);
+  #endif
+  if(id >= LAYER_num) LAYER_num = id + 1;
+}
+
+// Set bounding box of layer (columns x0..x1, pages p0..p1), clipped to screen
+void LAYER_set(uint8_t id, int16_t x0, int16_t x1, int8_t p0, int8_t p1) {
+  LAYER* l = &LAYER_list[id];
+  if(x0 < 0)   x0 = 0;
+  if(x1 > 127) x1 = 127;
+  if(p0 < 0)   p0 = 0;
+  if(p1 > 7)   p1 = 7;
+  if((x0 > x1) || (p0 > p1)) {            // nothing visible?
+    LAYER_hide(id);
+    return;
+  }
+  l->x0 = x0; l->x1 = x1;
+  l->p0 = p0; l->p1 = p1;
+}
+
+// Hide layer
+void LAYER_hide(uint8_t id) {
+  LAYER_list[id].p0 = 8;
+  LAYER_list[id].p1 = 0;
+}
+
+// Compose columns x0..x1 of page y into page buffer
+uint8_t* LAYER_compose(uint8_t y, uint8_t x0, uint8_t x1, void* ctx) {
+  uint8_t* buf = OLED_pageptr;
+  LAYER*   l   = LAYER_list;
+  #if LAYER_GRAY > 0
+  uint16_t skip = LAYER_skip[LAYER_plane];
+  #else
+  uint16_t skip = 0;
+  #endif
+  uint8_t* p = buf;
+  uint8_t  n = x1 - x0 + 1;
+  PROF_begin(PROF_COMPOSE);
+  #if LAYER_WIDE > 0
+  for(; n && ((uintptr_t)p & 3); n--) *p++ = 0;
+  for(; n >= 4; n -= 4, p += 4) *(LAYER_WORD*)p = 0;
+  #endif
+  for(; n; n--) *p++ = 0;
+  for(uint8_t i=LAYER_num; i; i--, l++, skip >>= 1) {
+    if((y < l->p0) || (y > l->p1)) continue;  // layer not on this page
+    if(skip & 1) continue;                    // layer not in this bitplane
+    uint8_t a = (l->x0 > x0) ? l->x0 : x0;    // clip span to bounding box
+    uint8_t b = (l->x1 < x1) ? l->x1 : x1;
+    if(a > b) continue;
+    l->span(buf + a - x0, a, b, y, ctx);
+  }
+  PROF_overlay(buf, x0, x1, y);
+  BAT_overlay(buf, x0, x1, y);
+  PROF_end();
+  OLED_pageptr = buf + x1 - x0 + 1;
+  return buf;
+}
+
+// Set bounding box of layer to sprite s at column x, pixel row y
+void LAYER_place(uint8_t id, const SPRITE* s, int16_t x, uint8_t y) {
+  LAYER_set(id, x, x + s->w - 1, y >> 3, (y + (s->h << 3) - 1) >> 3);
+}
+
+// Draw columns x0..x1 of page y of sprite s at column sx, pixel row sy into buf
+void LAYER_blit(uint8_t* buf, uint8_t x0, uint8_t x1, uint8_t y,
+                const SPRITE* s, int16_t sx, uint8_t sy) {
+  const uint8_t* top  = 0;                // sprite page starting at the top of page y
+  const uint8_t* bot  = 0;                // sprite page spilling over from page y-1
+  const uint8_t* mtop = 0;
+  const uint8_t* mbot = 0;
+  const uint8_t* mask = s->mask ? s->mask : s->data;
+  uint8_t d = sy & 7;                     // vertical offset within the page
+  int8_t  k = y - (sy >> 3);              // sprite page at the top of page y
+  int16_t a = (sx > x0) ? sx : x0;        // clip span to the sprite
+  int16_t b = sx + s->w - 1;
+  if(b > x1) b = x1;
+  if((a > b) || (k < 0) || (k > s->h)) return;
+  if(k < s->h) {
+    top  = s->data + k * s->w + (a - sx);
+    mtop = mask    + k * s->w + (a - sx);
+  }
+  if(d && k) {
+    bot  = s->data + (k - 1) * s->w + (a - sx);
+    mbot = mask    + (k - 1) * s->w + (a - sx);
+  }
+  if(!top && !bot) return;
+  buf += a - x0;
+  if(!s->mask) {                          // (no mask: just OR the bytes)
+    if(top) LAYER_or(buf, top, b - a + 1, d);
+    if(bot) LAYER_or(buf, bot, b - a + 1, d - 8);
+    return;
+  }
+  for(; a <= b; a++, buf++) {
+    uint8_t dat = 0, msk = 0;
+    if(top) { dat  = *top++ << d;       msk  = *mtop++ << d; }
+    if(bot) { dat |= *bot++ >> (8 - d); msk |= *mbot++ >> (8 - d); }
+    *buf = (*buf & ~msk) | dat;
+  }
+}
+
+// OR n bytes of src into buf, each shifted within its byte (shift > 0: << shift,
+// shift < 0: >> -shift)
+void LAYER_or(uint8_t* buf, const uint8_t* src, uint8_t n, int8_t shift) {
+  uint8_t up = (shift > 0) ? shift : 0;
+  uint8_t dn = (shift < 0) ? -shift : 0;
+  #if LAYER_WIDE > 0
+  if(n >= 8) {
+    uint32_t lanes = (uint32_t)(((0xFF << up) & 0xFF) >> dn) * 0x01010101;
+    uint8_t  words, k;
+    for(; (uintptr_t)buf & 3; n--) *buf++ |= (uint8_t)(*src++ << up) >> dn;
+    LAYER_WORD*       dst = (LAYER_WORD*)buf;
+    const LAYER_WORD* s   = (const LAYER_WORD*)(src - ((uintptr_t)src & 3));
+    k = ((uintptr_t)src & 3) << 3;        // bits src is past the word boundary
+    buf += n & ~3;
+    src += n & ~3;
+    words = n >> 2;
+    n &= 3;
+    if(!k) {
+      for(; words; words--) *dst++ |= ((*s++ << up) >> dn) & lanes;
+    }
+    else {                                // funnel two aligned words into one
+      uint32_t lo = *s++, hi;
+      for(; words; words--) {
+        hi = *s++;
+        *dst++ |= ((((lo >> k) | (hi << (32 - k))) << up) >> dn) & lanes;
+        lo = hi;
+      }
+    }
+  }
+  #endif
+  for(; n; n--) *buf++ |= (uint8_t)(*src++ << up) >> dn;
+}
+
+#if LAYER_GRAY > 0
+// Set shade of layer (LAYER_FULL, LAYER_LIGHT, LAYER_DIM)
+void LAYER_shade(uint8_t id, uint8_t shade) {
+  uint16_t mask = 1 << id;
+  LAYER_skip[0] &= ~mask;
+  LAYER_skip[1] &= ~mask;
+  if(!(shade & 1)) LAYER_skip[0] |= mask;
+  if(!(shade & 2)) LAYER_skip[1] |= mask;
+}
+
+// Send the next bitplane of the box of the shaded layers, returns 0 if none is shown
+uint8_t LAYER_gray_frame(void* ctx) {
+  LAYER*   l    = LAYER_list;
+  uint16_t gray = LAYER_skip[0] | LAYER_skip[1];
+  uint8_t  x0 = 127, x1 = 0, p0 = 7, p1 = 0;
+  for(uint8_t i=LAYER_num; i; i--, l++, gray >>= 1) {
+    if(!(gray & 1) || (l->p0 > l->p1)) continue;
+    if(l->x0 < x0) x0 = l->x0;
+    if(l->x1 > x1) x1 = l->x1;
+    if(l->p0 < p0) p0 = l->p0;
+    if(l->p1 > p1) p1 = l->p1;
+  }
+  if(x0 > x1) return 0;
+  if(++LAYER_phase > 2) LAYER_phase = 0;
+  LAYER_plane = (LAYER_phase == 2);
+  OLED_window_begin(x0, x1, p0, p1);
+  for(uint8_t y=p0; y<=p1; y++) {
+    OLED_page_start(y);
+    LAYER_compose(y, x0, x1, ctx);
+    OLED_page_end();
+  }
+  OLED_frame_end();
+  LAYER_plane = 0;                          // (frames of the game: plane 0)
+  return 1;
+}
+#endif
@@ -0,0 +1,172 @@
+// ===================================================================================
+// Layer Compositor for SSD1306 OLED Page Buffer                              * v1.5 *
+// ===================================================================================
+//
+// Functions available:
+// --------------------
+// LAYER_add(id, span)            Register draw-span callback of layer id (hidden)
+// LAYER_set(id, x0, x1, p0, p1)  Set bounding box of layer (clipped to screen)
+// LAYER_hide(id)                 Hide layer
+// LAYER_compose(y, x0, x1, ctx)  Compose columns x0..x1 of page y into page buffer
+// LAYER_shade(id, shade)         Set shade of layer (LAYER_GRAY)
+// LAYER_gray_frame(ctx)          Send next bitplane of the shaded layers (LAYER_GRAY)
+// LAYER_place(id, spr, x, y)     Set bounding box of layer to sprite at column x, row y
+// LAYER_blit(buf,x0,x1,y,spr,x,y) Draw columns x0..x1 of page y of a sprite (span helper)
+// LAYER_or(buf, src, n, shift)   OR n bytes of src, shifted within their byte (span helper)
+// LAYER_STATIC(name, LIST)       Define draw-span callback of a static layer set
+//
+// A screen is built from layers. Each layer has a bounding box (columns x0..x1,
+// pages p0..p1) and a draw-span callback:
+//
+//   void span(uint8_t* buf, uint8_t x0, uint8_t x1, uint8_t y, void* ctx)
+//
+// The callback must OR the pixels of columns x0..x1 of page y into buf[0] to
+// buf[x1-x0]. LAYER_compose() is called between OLED_page_start() and
+// OLED_page_end() instead of sending each byte. It clears the requested span in
+// the page buffer and calls only the layers whose bounding box intersects it,
+// clipped to the intersection. Layers are called in the order of their ids, each
+// span from left to right. The pointer ctx is handed to the callbacks. The start
+// of the composed span in the page buffer is returned. The overlays of the
+// profiler (prof.h) and of the battery governor (battery.h) are drawn over all
+// layers.
+//
+// A sprite is described by a SPRITE: its width in columns, its height in pages and
+// its bytes, page by page (w bytes of its first page, then of the second, ...). A
+// sprite with an AND mask of the same layout is drawn as (dst & ~mask) | data, so
+// it hides what the layers before it drew below it; without mask (NULL) its bytes
+// are ORed. LAYER_blit() is called from a draw-span callback with the position of
+// the sprite (column x, pixel row y 0..63, any vertical offset within a page). It
+// only touches the columns and pages the sprite covers, so a layer can draw several
+// sprites; LAYER_place() sets the box of a single-sprite layer, then the compositor
+// skips all spans outside of it.
+//
+// LAYER_or() ORs a row of bytes (a line of a table in page layout, a strip
+// rendered into RAM) into buf, each byte shifted by shift pixels within itself:
+// down the page (b << shift) for shift > 0, up to the page above (b >> -shift)
+// for shift < 0, so the two parts of a row at a vertical offset d are drawn with
+// shift d and d - 8. If LAYER_WIDE is enabled, rows of 8 bytes or more are done
+// a 32-bit word (4 columns) at a time: the bytes up to the next word boundary of
+// buf one by one, then words, where a src that is not on the same word boundary
+// is read as aligned words and funneled together, then the rest byte by byte.
+// The per-byte shift is a word shift masked to the lanes. Tables read this way
+// should be declared LAYER_ALIGN (4-byte aligned) with rows of a multiple of 4
+// bytes, then the columns of page buffer and table have the same alignment and
+// each word is a single load. The page buffers are aligned, LAYER_compose()
+// clears the span word by word. LAYER_blit() uses LAYER_or() for sprites
+// without mask.
+//
+// Layers whose boxes never change can be merged into one static layer set. The
+// set is a list macro of its layers with their boxes as constants, in drawing order:
+//
+//   #define HUD(L, y) L(y, LayerScore, 0, 20, 1, 1) L(y, LayerFuel, 5, 19, 6, 6)
+//   LAYER_STATIC(LayerHud, HUD)
+//
+// LAYER_STATIC() defines the draw-span callback LayerHud() of the set, which is
+// added like any other layer with the union of the boxes. It holds one case per
+// page, the list is expanded in each of them with the page as a constant, so the
+// page tests fold at compile time and each case only calls the layers that can
+// appear on its page. Only the columns are clipped at run time, and the callbacks
+// of the set don't have to check their own box.
+//
+// If LAYER_GRAY is enabled, a layer can be shaded with LAYER_shade(): the pixels
+// are composed into two bitplanes, plane 0 is shown in two of three frames and
+// plane 1 in the third, a LAYER_LIGHT layer (plane 0 only) then looks at 2/3 and
+// a LAYER_DIM one (plane 1 only) at 1/3 of the brightness, pixels of both at
+// full brightness. The frames of the game compose plane 0 (so their content
+// doesn't depend on timing), LAYER_gray_frame() composes the next plane of the
+// sequence 0, 0, 1 for the bounding box of the visible shaded layers and sends
+// it, all layers included. This has to be done at 60 or more frames per second
+// to look steady, so it is only useful with a fast bus and a small shaded box,
+// or as the bus benchmark it also is. Pages of the box that don't differ
+// between the planes aren't sent again (OLED_DIFF).
+//
+// The number of layers is set by LAYER_MAX in the config.h of the firmware. The
+// layer table itself is defined once by the application with LAYER_TABLE.
+//
+// 2023 by Stefan Wagner:   https://github.com/wagiminator
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "oled_min.h"
+
+// Layer parameters
+#ifndef LAYER_MAX
+#define LAYER_MAX     8           // max number of layers
+#endif
+#ifndef LAYER_GRAY
+#define LAYER_GRAY    1           // 1: shaded layers (two bitplanes)
+#endif
+#ifndef LAYER_WIDE
+#define LAYER_WIDE    1           // 1: compose rows of bytes 4 columns at a time
+#endif
+
+#define LAYER_ALIGN   __attribute__((aligned(4)))   // tables read by LAYER_or()
+
+// Layer shades: bitplanes a layer is composed into
+#define LAYER_FULL    3           // both planes: full brightness (default)
+#define LAYER_LIGHT   1           // plane 0 (two of three frames): 2/3
+#define LAYER_DIM     2           // plane 1 (one of three frames): 1/3
+
+// Layer draw-span callback
+typedef void (*LAYER_SPAN)(uint8_t* buf, uint8_t x0, uint8_t x1, uint8_t y, void* ctx);
+
+// Layer descriptor
+typedef struct {
+  LAYER_SPAN span;                // draw-span callback
+  uint8_t x0, x1;                 // bounding box columns
+  uint8_t p0, p1;                 // bounding box pages (p0 > p1: hidden)
+} LAYER;
+
+// Sprite descriptor
+typedef struct {
+  uint8_t w;                      // width in columns
+  uint8_t h;                      // height in pages
+  const uint8_t* data;            // w * h bytes, page by page
+  const uint8_t* mask;            // pixels cleared below the sprite, same layout (or NULL)
+} SPRITE;
+
+// Layer table (instantiate once in the application)
+extern LAYER LAYER_list[];
+#define LAYER_TABLE   LAYER LAYER_list[LAYER_MAX]
+
+// Layer functions
+void LAYER_add(uint8_t id, LAYER_SPAN span);
+void LAYER_set(uint8_t id, int16_t x0, int16_t x1, int8_t p0, int8_t p1);
+void LAYER_hide(uint8_t id);
+uint8_t* LAYER_compose(uint8_t y, uint8_t x0, uint8_t x1, void* ctx);
+void LAYER_place(uint8_t id, const SPRITE* s, int16_t x, uint8_t y);
+void LAYER_blit(uint8_t* buf, uint8_t x0, uint8_t x1, uint8_t y,
+                const SPRITE* s, int16_t sx, uint8_t sy);
+void LAYER_or(uint8_t* buf, const uint8_t* src, uint8_t n, int8_t shift);
+#if LAYER_GRAY > 0
+void LAYER_shade(uint8_t id, uint8_t shade);
+uint8_t LAYER_gray_frame(void* ctx);
+#endif
+
+// Static layer sets (see above)
+#define LAYER_STATIC(name, LIST)                                                \
+  void name(uint8_t* buf, uint8_t x0, uint8_t x1, uint8_t y, void* ctx) {       \
+    switch(y) {                                                                 \
+      case 0:  LIST(LAYER_STATIC_SPAN, 0) break;                                \
+      case 1:  LIST(LAYER_STATIC_SPAN, 1) break;                                \
+      case 2:  LIST(LAYER_STATIC_SPAN, 2) break;                                \
+      case 3:  LIST(LAYER_STATIC_SPAN, 3) break;                                \
+      case 4:  LIST(LAYER_STATIC_SPAN, 4) break;                                \
+      case 5:  LIST(LAYER_STATIC_SPAN, 5) break;                                \
+      case 6:  LIST(LAYER_STATIC_SPAN, 6) break;                                \
+      default: LIST(LAYER_STATIC_SPAN, 7) break;                                \
+    }                                                                           \
+  }
+
+#define LAYER_STATIC_SPAN(y, span, lx0, lx1, lp0, lp1)                          \
+  if(((y) >= (lp0)) && ((y) <= (lp1)) && (x1 >= (lx0)) && (x0 <= (lx1)))       \
+    span(buf + ((x0 < (lx0)) ? (lx0) - x0 : 0), (x0 < (lx0)) ? (lx0) : x0,      \
+         (x1 > (lx1)) ? (lx1) : x1, (y), ctx);
+
+#ifdef __cplusplus
+};
+#endif
@@ -0,0 +1,510 @@
+// ===================================================================================
+// SSD1306 128x64 Pixels OLED Minimal Functions                               * v1.8 *
+// ===================================================================================
+//
+// Collection of the most necessary functions for controlling an SSD1306 128x64 pixels
+// OLED on I2C or 4-wire SPI (OLED_BUS in oled_bus.h).
+//
+// Screen updates are composed page by page into a page buffer with OLED_page_start(),
+// OLED_page_send() and OLED_page_end(). If DMA is enabled in the bus driver, two page
+// buffers are used, so the next page can be composed while the last one is still
+// being transferred in the background. Full screen updates should be enclosed by
+// OLED_frame_begin() and OLED_frame_end(), then all pages are sent in one single
+// transmission without setting the cursor position for each page. Partial
+// updates of a rectangle (columns x0..x1, pages p0..p1) work the same way by using
+// OLED_window_begin(x0, x1, p0, p1) instead, each page then holds x1-x0+1 bytes.
+//
+// If OLED_DIFF is enabled, each page is split into 16-byte segments and a checksum
+// of each segment is kept. Segments which did not change since the last frame are
+// not transmitted. One page per frame is always sent completely, so a checksum
+// collision can't leave stale pixels on the screen for long.
+//
+// If OLED_CRC is enabled, the bytes composed between OLED_window_begin() and
+// OLED_frame_end() are hashed, OLED_crc then holds the CRC-32 of the frame (of all
+// 1024 bytes for a full screen update). Input replays compare frames by it.
+//
+// If OLED_SCROLL is enabled, the scroll engine of the SSD1306 moves bands of pages
+// horizontally. The controller shifts its display RAM for that, so the column
+// offset of each page is kept and the runs of a composed page are sent to the
+// shifted columns: what is composed at column x lands at x + offset, and the
+// segment checksums stay valid. OLED_scroll_step(p0, p1, dir) moves pages p0..p1
+// by one column (content scroll 0x2C/0x2D of the SSD1306B, ten bytes on the bus
+// per step, at least two display frames apart). OLED_scroll_start(p0, p1, dir,
+// speed) starts the continuous scroll (0x26/0x27, diagonal 0x29/0x2A with a
+// vertical offset of one row per step), which runs without any bus traffic at
+// speed display frames per step. Its steps follow the clock of the controller,
+// so their number isn't known: the pages of the band belong to the controller,
+// composed pages in it are not sent until OLED_scroll_stop(), which resets the
+// band to offset 0; the next frame sends it completely. OLED_fill() and
+// OLED_draw_bmp() write the display RAM directly and ignore the offsets.
+//
+// Full screen images can be stored run-length encoded. OLED_rle_start(img) sets
+// up the decoder, OLED_rle_page(len) then decodes the next len bytes straight
+// into the page buffer between OLED_page_start() and OLED_page_end(), so no frame
+// buffer is needed and decoding overlaps with the transfer of the last page.
+// The image is a sequence of blocks, each starting with a control byte c:
+//   c = 0x00..0x7F: c+1 literal bytes follow
+//   c = 0x80..0xFF: the following byte is repeated c-0x7E times (2..129)
+// A full screen image holds 1024 bytes in page order. Use software/tools/rle_image.py
+// to convert a raw bitmap array.
+//
+// References:
+// -----------
+// - TinyOLEDdemo: https://github.com/wagiminator/attiny13-tinyoleddemo
+// - Neven Boyanov: https://github.com/tinusaur/ssd1306xled
+// - Stephen Denne: https://github.com/datacute/Tiny4kOLED
+//
+// 2022 by Stefan Wagner: https://github.com/wagiminator
+
+#include "oled_min.h"
+#include "prof.h"
+#include "latency.h"
+
+// OLED initialisation sequence (one transfer of command bytes)
+const uint8_t OLED_INIT_CMD[] = {
+  OLED_MULTIPLEX,   0x3F,                 // set multiplex ratio  
+  OLED_CHARGEPUMP,  0x14,                 // set DC-DC enable  
+  OLED_MEMORYMODE,  0x00,                 // set horizontal addressing mode
+  OLED_COLUMNS,     0x00, 0x7F,           // set start and end column
+  OLED_PAGES,       0x00, 0x3F,           // set start and end page
+  OLED_COMPINS,     0x12,                 // set com pins
+  OLED_XFLIP, OLED_YFLIP,                 // flip screen
+  OLED_DISPLAY_ON                         // display on
+};
+
+// OLED send initialisation sequence
+static void OLED_setup(void) {
+  BUS_command();                          // start command bytes
+  BUS_writeBuffer((uint8_t*)OLED_INIT_CMD, sizeof(OLED_INIT_CMD)); // send and stop
+}
+
+// OLED init function
+void OLED_init(void) {
+  BUS_init();                             // initialize the interface first
+  OLED_setup();
+}
+
+// Start sending data
+void OLED_data_start(void) {
+  BUS_data();                             // start display data
+}
+
+// Start sending command
+void OLED_command_start(void) {
+  BUS_command();                          // start command bytes
+}
+
+// OLED send command
+void OLED_send_command(uint8_t cmd) {
+  BUS_command();                          // start command bytes
+  BUS_write(cmd);                         // send command
+  BUS_stop();                             // stop transmission
+}
+
+// OLED set contrast
+void OLED_contrast(uint8_t c) {
+  BUS_command();                          // start command bytes
+  BUS_write(OLED_CONTRAST);               // set contrast
+  BUS_write(c);
+  BUS_stop();                             // stop transmission
+}
+
+// OLED set cursor position
+void OLED_setpos(uint8_t x, uint8_t y) {
+  OLED_window(x, 127, y, 7);              // window from cursor to end of screen
+}
+
+// OLED set address window (columns x0..x1, pages p0..p1)
+void OLED_window(uint8_t x0, uint8_t x1, uint8_t p0, uint8_t p1) {
+  BUS_command();                          // start command bytes
+  BUS_write(OLED_COLUMNS);                // set start and end column
+  BUS_write(x0);
+  BUS_write(x1);
+  BUS_write(OLED_PAGES);                  // set start and end page
+  BUS_write(p0);
+  BUS_write(p1);
+  BUS_stop();                             // stop transmission
+}
+
+// OLED draw bitmap
+void OLED_draw_bmp(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1, const uint8_t* bmp) {
+  OLED_invalidate();                      // segment checksums are void now
+  for(uint8_t y = y0; y < y1; y++) {
+    OLED_setpos(x0, y);
+    BUS_data();
+    for(uint8_t x = x0; x < x1; x++)
+      BUS_write(*bmp++);
+    BUS_stop();
+  }
+}
+
+// OLED page buffers
+#if BUS_DMA > 0
+uint8_t  OLED_pagebuf[2][128] __attribute__((aligned(4)));  // compose one, send other
+#else
+uint8_t  OLED_pagebuf[1][128] __attribute__((aligned(4)));  // single buffer
+#endif
+uint8_t* OLED_pageptr;                    // page buffer write pointer
+uint8_t  OLED_pagesel;                    // page buffer currently being composed
+uint8_t  OLED_pagey;                      // page number currently being composed
+uint8_t  OLED_inframe;                    // 1: frame transmission is open
+#if BUS_QUEUE > 0
+uint16_t OLED_pagefence[2];               // queue tickets of page buffers
+#endif
+
+#if OLED_DIFF > 0
+// CRC-8 (polynomial 0x07) nibble table for segment checksums
+const uint8_t OLED_CRC_TAB[] = {
+  0x00, 0x07, 0x0E, 0x09, 0x1C, 0x1B, 0x12, 0x15,
+  0x38, 0x3F, 0x36, 0x31, 0x24, 0x23, 0x2A, 0x2D
+};
+
+uint8_t  OLED_segsum[8][8];               // checksum of each segment [page][segment]
+uint8_t  OLED_segvalid[8];                // valid checksum flags (bit = segment)
+uint8_t  OLED_winx;                       // first column of the current window
+uint8_t  OLED_refresh;                    // page to be refreshed completely
+#endif
+
+#if OLED_SCROLL > 0
+uint8_t  OLED_scrollx[8];                 // column offset of each page
+uint8_t  OLED_scrolling;                  // pages of the continuous scroll (bit = page)
+#endif
+
+#if OLED_CRC > 0
+// CRC-32 (reflected polynomial 0xEDB88320) nibble table for frame hashes
+const uint32_t OLED_CRC32_TAB[] = {
+  0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+  0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+};
+
+uint32_t OLED_crc;                        // CRC-32 of the last composed frame
+uint32_t OLED_crcval;                     // CRC register of the frame being composed
+
+// OLED hash composed page
+static void OLED_hash(const uint8_t* buf, uint8_t len) {
+  uint32_t c = OLED_crcval;
+  while(len--) {
+    c ^= *buf++;
+    c  = (c >> 4) ^ OLED_CRC32_TAB[c & 15];
+    c  = (c >> 4) ^ OLED_CRC32_TAB[c & 15];
+  }
+  OLED_crcval = c;
+}
+#define OLED_hash_begin()   OLED_crcval = 0xFFFFFFFF
+#define OLED_hash_end()     OLED_crc = ~OLED_crcval
+#else
+#define OLED_hash(buf, len)
+#define OLED_hash_begin()
+#define OLED_hash_end()
+#endif
+
+// OLED start composing page y
+void OLED_page_start(uint8_t y) {
+  #if BUS_QUEUE > 0
+  PROF_begin(PROF_I2C);
+  BUS_wait(OLED_pagefence[OLED_pagesel]); // wait until page buffer is free
+  PROF_end();
+  #endif
+  OLED_pagey   = y;
+  OLED_pageptr = OLED_pagebuf[OLED_pagesel];
+}
+
+// OLED set up the bus and the display again after a bus failure
+static void OLED_recover(void) {
+  PROF_begin(PROF_I2C);
+  BUS_recover();                          // free the bus, init the interface again
+  OLED_setup();                           // (the display may have been reset)
+  #if OLED_SCROLL > 0
+  OLED_send_command(OLED_SCROLL_OFF);     // no scroll, all pages unshifted
+  for(uint8_t p=0; p<8; p++) OLED_scrollx[p] = 0;
+  OLED_scrolling = 0;
+  #endif
+  PROF_end();
+  OLED_invalidate();                      // display RAM unknown: send everything
+}
+
+#if OLED_DIFF > 0
+// OLED invalidate all segment checksums (screen was written directly)
+void OLED_invalidate(void) {
+  for(uint8_t i=0; i<8; i++) OLED_segvalid[i] = 0;
+}
+
+// OLED set segment checksums of window filled with pattern p (columns x0..x1, pages p0..p1)
+static void OLED_fill_sums(uint8_t x0, uint8_t x1, uint8_t p0, uint8_t p1, uint8_t p) {
+  uint8_t chk = 0;
+  for(uint8_t i=16; i; i--) {             // checksum of 16 pattern bytes
+    chk ^= p;
+    chk  = (chk << 4) ^ OLED_CRC_TAB[chk >> 4];
+    chk  = (chk << 4) ^ OLED_CRC_TAB[chk >> 4];
+  }
+  for(; p0 <= p1; p0++) {
+    for(uint8_t seg=0; seg<8; seg++) {
+      uint8_t x    = seg << 4;
+      uint8_t mask = 1 << seg;
+      if((x1 < x) || (x0 > x + 15)) continue;   // segment not touched
+      if((x0 <= x) && (x1 >= x + 15)) {   // segment completely filled?
+        OLED_segsum[p0][seg] = chk;
+        OLED_segvalid[p0]   |= mask;
+      }
+      else OLED_segvalid[p0] &= ~mask;    // partially filled -> unknown
+    }
+    #if OLED_SCROLL > 0
+    if(OLED_scrollx[p0] || (OLED_scrolling & (1 << p0)))
+      OLED_segvalid[p0] = 0;              // fill went to the unshifted columns
+    #endif
+  }
+}
+
+// OLED send bytes to display RAM columns x0..x1 of the composed page
+static void OLED_page_write(uint8_t* buf, uint8_t x0, uint8_t x1) {
+  OLED_window(x0, x1, OLED_pagey, OLED_pagey); // waits for last transfer to finish
+  OLED_data_start();
+  BUS_writeBuffer(buf, x1 - x0 + 1);
+}
+
+// OLED send part of the composed page (columns x0..x1)
+void OLED_page_send_run(uint8_t* buf, uint8_t x0, uint8_t x1) {
+  buf += x0 - OLED_winx;
+  LAT_changed();
+  PROF_begin(PROF_I2C);
+  #if OLED_SCROLL > 0
+  x0 = (x0 + OLED_scrollx[OLED_pagey]) & 127; // columns in the shifted display RAM
+  x1 = (x1 + OLED_scrollx[OLED_pagey]) & 127;
+  if(x1 < x0) {                           // run wraps around the right edge?
+    OLED_page_write(buf, x0, 127);
+    buf += 128 - x0;
+    x0   = 0;
+  }
+  #endif
+  OLED_page_write(buf, x0, x1);
+  PROF_end();
+}
+
+// OLED send changed segments of composed page (in the background if DMA is enabled)
+void OLED_page_end(void) {
+  uint8_t* buf   = OLED_pagebuf[OLED_pagesel];
+  uint8_t* sum   = OLED_segsum[OLED_pagey];
+  uint8_t  x     = OLED_winx;             // column of current segment start
+  uint8_t  end   = OLED_winx + (OLED_pageptr - buf); // column after last byte
+  uint8_t  run   = 0;                     // start column of unsent run
+  uint8_t  inrun = 0;                     // 1: unsent run is open
+  OLED_hash(buf, end - OLED_winx);
+  if(OLED_pagey == OLED_refresh) OLED_segvalid[OLED_pagey] = 0;
+  #if OLED_SCROLL > 0
+  if(OLED_scrolling & (1 << OLED_pagey)) { // page belongs to the scroll engine?
+    OLED_segvalid[OLED_pagey] = 0;        // -> send nothing, all of it after the stop
+    x = end;
+  }
+  #endif
+  while(x < end) {
+    uint8_t seg  = x >> 4;
+    uint8_t mask = 1 << seg;
+    uint8_t next = (seg + 1) << 4;
+    uint8_t changed = 1;
+    if(next > end) next = end;
+    if(!(x & 15) && (next - x == 16)) {   // segment completely within window?
+      uint8_t* ptr = buf + x - OLED_winx;
+      uint8_t  chk = 0;
+      for(uint8_t i=16; i; i--) {
+        chk ^= *ptr++;
+        chk  = (chk << 4) ^ OLED_CRC_TAB[chk >> 4];
+        chk  = (chk << 4) ^ OLED_CRC_TAB[chk >> 4];
+      }
+      if((OLED_segvalid[OLED_pagey] & mask) && (sum[seg] == chk)) changed = 0;
+      sum[seg] = chk;
+      OLED_segvalid[OLED_pagey] |= mask;
+    }
+    else OLED_segvalid[OLED_pagey] &= ~mask; // partial segment -> can't compare
+    if(changed) {
+      if(!inrun) run = x;
+      inrun = 1;
+    }
+    else if(inrun) {
+      OLED_page_send_run(buf, run, x - 1);
+      inrun = 0;
+    }
+    x = next;
+  }
+  if(inrun) OLED_page_send_run(buf, run, end - 1);
+  #if BUS_QUEUE > 0
+  OLED_pagefence[OLED_pagesel] = BUS_fence();
+  #endif
+  #if BUS_DMA > 0
+  OLED_pagesel ^= 1;                      // swap page buffers
+  #endif
+}
+
+// OLED start frame of window (only changed segments will be sent)
+void OLED_window_begin(uint8_t x0, uint8_t x1, uint8_t p0, uint8_t p1) {
+  if(BUS_failed()) OLED_recover();        // last frame was dropped
+  LAT_frame_begin();
+  OLED_winx    = x0;
+  OLED_inframe = 1;
+  OLED_hash_begin();
+}
+
+// OLED end frame
+void OLED_frame_end(void) {
+  OLED_hash_end();
+  OLED_winx    = 0;
+  OLED_inframe = 0;
+  OLED_refresh = (OLED_refresh + 1) & 7;  // next page to be refreshed completely
+  LAT_frame_end();
+}
+
+#else
+// OLED send composed page (in the background if DMA is enabled)
+void OLED_page_end(void) {
+  uint8_t* buf = OLED_pagebuf[OLED_pagesel];
+  OLED_hash(buf, OLED_pageptr - buf);
+  LAT_changed();
+  PROF_begin(PROF_I2C);
+  if(OLED_inframe) {                      // within frame transmission?
+    #if BUS_QUEUE == 0
+    BUS_DMA_wait();                       // -> wait for last page to be sent
+    #endif
+    BUS_streamBuffer(buf, OLED_pageptr - buf);
+  }
+  else {                                  // single page transmission
+    OLED_setpos(0, OLED_pagey);           // -> waits for last transfer to finish
+    OLED_data_start();
+    BUS_writeBuffer(buf, OLED_pageptr - buf);
+  }
+  PROF_end();
+  #if BUS_QUEUE > 0
+  OLED_pagefence[OLED_pagesel] = BUS_fence();
+  #endif
+  #if BUS_DMA > 0
+  OLED_pagesel ^= 1;                      // swap page buffers
+  #endif
+}
+
+// OLED start frame transmission of window (all pages in one transaction)
+void OLED_window_begin(uint8_t x0, uint8_t x1, uint8_t p0, uint8_t p1) {
+  if(BUS_failed()) OLED_recover();        // last frame was dropped
+  OLED_window(x0, x1, p0, p1);            // set address window
+  OLED_data_start();                      // start data transmission
+  LAT_frame_begin();
+  OLED_inframe = 1;
+  OLED_hash_begin();
+}
+
+// OLED end frame transmission
+void OLED_frame_end(void) {
+  PROF_begin(PROF_I2C);
+  #if BUS_QUEUE == 0
+  BUS_DMA_wait();                         // wait for last page to be sent
+  #endif
+  BUS_stop();                             // stop transmission
+  PROF_end();
+  OLED_inframe = 0;
+  OLED_hash_end();
+  LAT_frame_end();
+}
+#endif
+
+// OLED fill window (columns x0..x1, pages p0..p1) with pattern p
+void OLED_fill_window(uint8_t x0, uint8_t x1, uint8_t p0, uint8_t p1, uint8_t p) {
+  if(BUS_failed()) OLED_recover();        // set up again after a bus failure
+  #if OLED_DIFF > 0
+  OLED_fill_sums(x0, x1, p0, p1, p);      // the screen is known afterwards
+  #endif
+  OLED_window(x0, x1, p0, p1);            // set address window
+  BUS_data();                             // start display data
+  BUS_fill(p, (uint16_t)(x1 - x0 + 1) * (p1 - p0 + 1)); // send pattern and stop
+}
+
+// OLED fill screen
+void OLED_fill(uint8_t p) {
+  OLED_fill_window(0, 127, 0, 7, p);
+}
+
+#if OLED_SCROLL > 0
+// OLED move pages p0..p1 by one column (dir: OLED_SCROLL_RIGHT or OLED_SCROLL_LEFT)
+void OLED_scroll_step(uint8_t p0, uint8_t p1, uint8_t dir) {
+  if(OLED_scrolling) OLED_scroll_stop();  // (content scroll only while stopped)
+  BUS_command();                          // start command bytes
+  BUS_write(dir - OLED_SCROLL_RIGHT + OLED_SCROLL_STEP_R);
+  BUS_write(0x00);                        // dummy
+  BUS_write(p0);                          // start page
+  BUS_write(0x01);                        // dummy
+  BUS_write(p1);                          // end page
+  BUS_write(0x00);                        // dummy
+  BUS_write(0x00);                        // start column
+  BUS_write(0x7F);                        // end column
+  BUS_stop();                             // stop transmission
+  for(; p0 <= p1; p0++)
+    OLED_scrollx[p0] = (OLED_scrollx[p0] + (dir == OLED_SCROLL_RIGHT ? 1 : -1)) & 127;
+}
+
+// OLED start continuous scroll of pages p0..p1 (dir: OLED_SCROLL_RIGHT/LEFT/UPRIGHT/
+// UPLEFT, speed: OLED_SCROLL_2..OLED_SCROLL_256)
+void OLED_scroll_start(uint8_t p0, uint8_t p1, uint8_t dir, uint8_t speed) {
+  OLED_scroll_stop();                     // (setup only while stopped)
+  BUS_command();                          // start command bytes
+  if(dir >= OLED_SCROLL_UPRIGHT) {        // diagonal: rows of the band move up
+    BUS_write(OLED_SCROLL_AREA);
+    BUS_write(p0 << 3);                   // fixed rows above
+    BUS_write((p1 - p0 + 1) << 3);        // rows of the band
+  }
+  BUS_write(dir);                         // set up scroll
+  BUS_write(0x00);                        // dummy
+  BUS_write(p0);                          // start page
+  BUS_write(speed);                       // frames per step
+  BUS_write(p1);                          // end page
+  if(dir >= OLED_SCROLL_UPRIGHT) BUS_write(0x01); // one row per step
+  else {
+    BUS_write(0x00);                      // dummy
+    BUS_write(0xFF);                      // dummy
+  }
+  BUS_write(OLED_SCROLL_ON);              // activate scroll
+  BUS_stop();                             // stop transmission
+  for(; p0 <= p1; p0++) OLED_scrolling |= 1 << p0;
+}
+
+// OLED stop continuous scroll, its band gets sent completely by the next frame
+void OLED_scroll_stop(void) {
+  BUS_command();                          // start command bytes
+  BUS_write(OLED_SCROLL_OFF);             // deactivate scroll
+  BUS_write(OLED_STARTLINE);              // undo vertical offset of diagonal scroll
+  BUS_stop();                             // stop transmission
+  for(uint8_t p=0; p<8; p++) {
+    if(OLED_scrolling & (1 << p)) {
+      OLED_scrollx[p]  = 0;
+      OLED_segvalid[p]  = 0;
+    }
+  }
+  OLED_scrolling = 0;
+}
+#endif
+
+// OLED run-length decoder state
+const uint8_t* OLED_rleptr;               // next byte of encoded image
+uint8_t  OLED_rlecnt;                     // bytes left in current block
+uint8_t  OLED_rleval;                     // value of repeat block
+uint8_t  OLED_rlelit;                     // 1: literal block, 0: repeat block
+
+// OLED start decoding image
+void OLED_rle_start(const uint8_t* img) {
+  OLED_rleptr = img;
+  OLED_rlecnt = 0;
+}
+
+// OLED decode next len bytes of image into page buffer
+void OLED_rle_page(uint8_t len) {
+  PROF_begin(PROF_COMPOSE);
+  while(len--) {
+    if(!OLED_rlecnt) {                    // next block
+      uint8_t c   = *OLED_rleptr++;
+      OLED_rlelit = !(c & 0x80);
+      if(OLED_rlelit) OLED_rlecnt = c + 1;
+      else {
+        OLED_rlecnt = c - 0x7E;
+        OLED_rleval = *OLED_rleptr++;
+      }
+    }
+    OLED_page_send(OLED_rlelit ? *OLED_rleptr++ : OLED_rleval);
+    OLED_rlecnt--;
+  }
+  PROF_end();
+}
@@ -0,0 +1,193 @@
+// ===================================================================================
+// SSD1306 128x64 Pixels OLED Minimal Functions                               * v2.0 *
+// ===================================================================================
+//
+// Collection of the most necessary functions for controlling an SSD1306 128x64 pixels
+// OLED on I2C or 4-wire SPI (OLED_BUS in oled_bus.h).
+//
+// Screen updates are composed page by page into a page buffer with OLED_page_start(),
+// OLED_page_send() and OLED_page_end(). If DMA is enabled in the bus driver, two page
+// buffers are used, so the next page can be composed while the last one is still
+// being transferred in the background. Full screen updates should be enclosed by
+// OLED_frame_begin() and OLED_frame_end(), then all pages are sent in one single
+// transmission without setting the cursor position for each page. Partial
+// updates of a rectangle (columns x0..x1, pages p0..p1) work the same way by using
+// OLED_window_begin(x0, x1, p0, p1) instead, each page then holds x1-x0+1 bytes.
+//
+// If OLED_DIFF is enabled, each page is split into 16-byte segments and a checksum
+// of each segment is kept. Segments which did not change since the last frame are
+// not transmitted. One page per frame is always sent completely, so a checksum
+// collision can't leave stale pixels on the screen for long.
+//
+// OLED_fill(p) sets the whole screen to the byte p, OLED_fill_window(x0, x1, p0,
+// p1, p) a rectangle. The pattern is sent by one fill transfer of the bus driver
+// (DMA without memory increment over a single byte if enabled), no page buffer is
+// composed. With OLED_DIFF the checksums of the filled segments are set, so the
+// next frame only sends what differs from the fill.
+//
+// If OLED_CRC is enabled, the bytes composed between OLED_window_begin() and
+// OLED_frame_end() are hashed, OLED_crc then holds the CRC-32 of the frame (of all
+// 1024 bytes for a full screen update). Input replays compare frames by it. The
+// latency meter (LAT_ENABLE in latency.h) tags frames the same way, a frame
+// without a sent segment doesn't count as a change of the screen.
+//
+// If the bus fails (I2C_TIMEOUT in i2c_tx.h, e.g. the display was unplugged), the
+// rest of the frame is dropped: its transfers return at once, the game loop goes on.
+// The next OLED_window_begin() or OLED_fill_window() recovers the bus, sends the
+// initialisation sequence again and voids all segment checksums, so that frame is
+// sent completely. The counters are in BUS_errors and BUS_recoveries.
+//
+// OLED_contrast(c) sets the contrast (0x7F after reset). OLED_display_off() puts the
+// panel to sleep (a few uA), the display RAM is kept for OLED_display_on().
+//
+// If OLED_SCROLL is enabled, the scroll engine of the SSD1306 moves bands of pages
+// horizontally. The controller shifts its display RAM for that, so the column
+// offset of each page is kept and the runs of a composed page are sent to the
+// shifted columns: what is composed at column x lands at x + offset, and the
+// segment checksums stay valid. OLED_scroll_step(p0, p1, dir) moves pages p0..p1
+// by one column (content scroll 0x2C/0x2D of the SSD1306B, ten bytes on the bus
+// per step, at least two display frames apart). OLED_scroll_start(p0, p1, dir,
+// speed) starts the continuous scroll (0x26/0x27, diagonal 0x29/0x2A with a
+// vertical offset of one row per step), which runs without any bus traffic at
+// speed display frames per step. Its steps follow the clock of the controller,
+// so their number isn't known: the pages of the band belong to the controller,
+// composed pages in it are not sent until OLED_scroll_stop(), which resets the
+// band to offset 0; the next frame sends it completely. OLED_fill(),
+// OLED_fill_window() and OLED_draw_bmp() write the display RAM directly and ignore
+// the offsets.
+//
+// Full screen images can be stored run-length encoded. OLED_rle_start(img) sets
+// up the decoder, OLED_rle_page(len) then decodes the next len bytes straight
+// into the page buffer between OLED_page_start() and OLED_page_end(), so no frame
+// buffer is needed and decoding overlaps with the transfer of the last page.
+// The image is a sequence of blocks, each starting with a control byte c:
+//   c = 0x00..0x7F: c+1 literal bytes follow
+//   c = 0x80..0xFF: the following byte is repeated c-0x7E times (2..129)
+// A full screen image holds 1024 bytes in page order. Use software/tools/rle_image.py
+// to convert a raw bitmap array.
+//
+// References:
+// -----------
+// - TinyOLEDdemo: https://github.com/wagiminator/attiny13-tinyoleddemo
+// - Neven Boyanov: https://github.com/tinusaur/ssd1306xled
+// - Stephen Denne: https://github.com/datacute/Tiny4kOLED
+//
+// 2022 by Stefan Wagner: https://github.com/wagiminator
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "oled_bus.h"
+
+// OLED parameters
+#ifndef OLED_DIFF
+#define OLED_DIFF         1       // 1: only send segments which have changed
+#endif
+#ifndef OLED_CRC
+#define OLED_CRC          0       // 1: CRC-32 of each composed frame in OLED_crc
+#endif
+#ifndef OLED_SCROLL
+#define OLED_SCROLL       1       // 1: hardware scrolling of page bands
+#endif
+
+#if OLED_SCROLL > 0 && OLED_DIFF == 0
+  #error "oled_min.h: OLED_SCROLL needs OLED_DIFF (pages are sent in runs)"
+#endif
+
+// OLED commands
+#define OLED_COLUMN_LOW   0x00    // set lower 4 bits of start column (0x00 - 0x0F)
+#define OLED_COLUMN_HIGH  0x10    // set higher 4 bits of start column (0x10 - 0x1F)
+#define OLED_MEMORYMODE   0x20    // set memory addressing mode (following byte)
+#define OLED_COLUMNS      0x21    // set start and end column (following 2 bytes)
+#define OLED_PAGES        0x22    // set start and end page (following 2 bytes)
+#define OLED_SCROLL_RIGHT 0x26    // set up right scroll (following 6 bytes)
+#define OLED_SCROLL_LEFT  0x27    // set up left scroll (following 6 bytes)
+#define OLED_SCROLL_UPRIGHT 0x29  // set up up + right scroll (following 5 bytes)
+#define OLED_SCROLL_UPLEFT  0x2A  // set up up + left scroll (following 5 bytes)
+#define OLED_SCROLL_STEP_R  0x2C  // scroll right by one column (following 7 bytes)
+#define OLED_SCROLL_STEP_L  0x2D  // scroll left by one column (following 7 bytes)
+#define OLED_SCROLL_OFF   0x2E    // deactivate scroll command
+#define OLED_SCROLL_ON    0x2F    // activate scroll command
+#define OLED_STARTLINE    0x40    // set display start line (0x40-0x7F = 0-63)
+#define OLED_CONTRAST     0x81    // set display contrast (following byte)
+#define OLED_CHARGEPUMP   0x8D    // (following byte - 0x14:enable, 0x10: disable)
+#define OLED_XFLIP_OFF    0xA0    // don't flip display horizontally
+#define OLED_XFLIP        0xA1    // flip display horizontally
+#define OLED_INVERT_OFF   0xA6    // set non-inverted display
+#define OLED_INVERT       0xA7    // set inverse display
+#define OLED_SCROLL_AREA  0xA3    // set vertical scroll area (following 2 bytes)
+#define OLED_MULTIPLEX    0xA8    // set multiplex ratio (following byte)
+#define OLED_DISPLAY_OFF  0xAE    // set display off (sleep mode)
+#define OLED_DISPLAY_ON   0xAF    // set display on
+#define OLED_PAGE         0xB0    // set start page (following byte)
+#define OLED_YFLIP_OFF    0xC0    // don't flip display vertically
+#define OLED_YFLIP        0xC8    // flip display vertically
+#define OLED_OFFSET       0xD3    // set display offset (y-scroll: following byte)
+#define OLED_COMPINS      0xDA    // set COM pin config (following byte)
+
+// Scroll speeds (display frames per step, the codes of the setup commands)
+#define OLED_SCROLL_2     7
+#define OLED_SCROLL_3     4
+#define OLED_SCROLL_4     5
+#define OLED_SCROLL_5     0
+#define OLED_SCROLL_25    6
+#define OLED_SCROLL_64    1
+#define OLED_SCROLL_128   2
+#define OLED_SCROLL_256   3
+
+// Macros
+#define OLED_send_byte(b)   BUS_write(b)
+#define OLED_data_stop      BUS_stop
+#define OLED_command_stop   BUS_stop
+#define OLED_page_send(b)   (*OLED_pageptr++ = (b))
+#define OLED_frame_begin()  OLED_window_begin(0, 127, 0, 7)
+#if OLED_DIFF == 0
+  #define OLED_invalidate()
+#endif
+#if OLED_CRC == 0
+  #define OLED_crc          0
+#endif
+
+// Page buffer write pointer
+extern uint8_t* OLED_pageptr;
+
+#if OLED_CRC > 0
+// CRC-32 of the last composed frame
+extern uint32_t OLED_crc;
+#endif
+
+// Functions
+void OLED_init(void);
+void OLED_data_start(void);
+void OLED_command_start(void);
+void OLED_send_command(uint8_t cmd);
+void OLED_contrast(uint8_t c);
+void OLED_setpos(uint8_t x, uint8_t y);
+void OLED_window(uint8_t x0, uint8_t x1, uint8_t p0, uint8_t p1);
+void OLED_fill(uint8_t p);
+void OLED_fill_window(uint8_t x0, uint8_t x1, uint8_t p0, uint8_t p1, uint8_t p);
+void OLED_draw_bmp(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1, const uint8_t* bmp);
+void OLED_page_start(uint8_t y);
+void OLED_page_end(void);
+void OLED_window_begin(uint8_t x0, uint8_t x1, uint8_t p0, uint8_t p1);
+void OLED_frame_end(void);
+void OLED_rle_start(const uint8_t* img);
+void OLED_rle_page(uint8_t len);
+#if OLED_DIFF > 0
+void OLED_invalidate(void);
+#endif
+#if OLED_SCROLL > 0
+void OLED_scroll_step(uint8_t p0, uint8_t p1, uint8_t dir);
+void OLED_scroll_start(uint8_t p0, uint8_t p1, uint8_t dir, uint8_t speed);
+void OLED_scroll_stop(void);
+#endif
+
+#define OLED_display_off()  OLED_send_command(OLED_DISPLAY_OFF)
+#define OLED_display_on()   OLED_send_command(OLED_DISPLAY_ON)
+
+#ifdef __cplusplus
+};
+#endif
@@ -0,0 +1,156 @@
+// ===================================================================================
+// Frame Profiler for CH32V003                                                * v1.2 *
+// ===================================================================================
+// 2023 by Stefan Wagner:   https://github.com/wagiminator
+
+#include "prof.h"
+#include "telemetry.h"
+#include "oled_bus.h"
+#include "latency.h"
+
+#if PROF_ENABLE > 0
+
+PROF_STAT PROF_result[PROF_PHASES + 1];   // min/avg/max of the last window
+uint16_t  PROF_hist[8];                   // ticks by busy time
+uint8_t   PROF_fps;                       // rendered frames per second
+uint16_t  PROF_bus_errors;                // display bus failures so far
+uint16_t  PROF_bus_recoveries;            // display bus recoveries so far
+
+// Upper bounds of the histogram bins in ms (last bin: everything above)
+const uint8_t PROF_HIST_MS[7] = {4, 8, 16, 25, 33, 50, 66};
+
+// 3x5 pixels digits of the overlay
+const uint8_t PROF_DIGITS[] = {
+  0x1F, 0x11, 0x1F,  0x12, 0x1F, 0x10,  0x1D, 0x15, 0x17,  0x15, 0x15, 0x1F,
+  0x07, 0x04, 0x1F,  0x17, 0x15, 0x1D,  0x1F, 0x15, 0x1D,  0x01, 0x01, 0x1F,
+  0x1F, 0x15, 0x1F,  0x17, 0x15, 0x1F
+};
+
+uint32_t  PROF_tick[PROF_PHASES];         // counts of the current tick
+PROF_STAT PROF_acc[PROF_PHASES + 1] = {   // min/sum/max of the current window
+  [0 ... PROF_PHASES] = {0xFFFFFFFF, 0, 0}
+};
+uint8_t   PROF_stack[PROF_DEPTH];         // enclosing phases
+uint8_t   PROF_sp;                        // nesting level
+uint8_t   PROF_phase;                     // active phase
+uint32_t  PROF_start;                     // SysTick count the active phase started at
+uint8_t   PROF_count;                     // ticks in the current window
+uint8_t   PROF_renders;                   // rendered frames in the current window
+uint32_t  PROF_wstart;                    // SysTick count the window started at
+uint8_t   PROF_ovl[4];                    // overlay digits
+
+// Charge time since the last switch to the active phase
+static void PROF_charge(void) {
+  uint32_t now = STK->CNT;
+  PROF_tick[PROF_phase] += now - PROF_start;
+  PROF_start = now;
+}
+
+// Enter phase
+void PROF_begin(uint8_t phase) {
+  INT_ATOMIC_BLOCK {
+    PROF_charge();
+    if(PROF_sp < PROF_DEPTH) PROF_stack[PROF_sp++] = PROF_phase;
+    PROF_phase = phase;
+  }
+}
+
+// Return to enclosing phase
+void PROF_end(void) {
+  INT_ATOMIC_BLOCK {
+    PROF_charge();
+    PROF_phase = PROF_sp ? PROF_stack[--PROF_sp] : PROF_LOGIC;
+  }
+}
+
+// Charge interrupt time to phase and take it out of the interrupted one
+void PROF_irq(uint8_t phase, uint32_t start) {
+  uint32_t t = STK->CNT - start;
+  PROF_tick[phase] += t;
+  PROF_start += t;
+}
+
+// Add tick value to window statistics
+static void PROF_add(PROF_STAT* s, uint32_t t) {
+  if(t < s->min) s->min = t;
+  if(t > s->max) s->max = t;
+  s->avg += t;
+}
+
+// End of tick
+void PROF_frame(uint8_t rendered) {
+  uint32_t busy = 0;
+  uint8_t  i;
+  INT_ATOMIC_BLOCK {
+    PROF_charge();
+    TLM_frame(rendered, PROF_tick, PROF_PHASES);
+    for(i=0; i<PROF_PHASES; i++) {
+      PROF_add(&PROF_acc[i], PROF_tick[i]);
+      if(i != PROF_IDLE) busy += PROF_tick[i];
+      PROF_tick[i] = 0;
+    }
+  }
+  PROF_add(&PROF_acc[PROF_PHASES], busy);
+  for(i=0; (i<7) && (busy > PROF_HIST_MS[i] * DLY_MS_TIME); i++);
+  PROF_hist[i]++;
+  PROF_renders += rendered;
+
+  // End of window: publish results and restart
+  if(++PROF_count >= PROF_WINDOW) {
+    uint32_t now = STK->CNT;
+    uint32_t ms;
+    for(i=0; i<=PROF_PHASES; i++) {
+      PROF_result[i].min = PROF_acc[i].min;
+      PROF_result[i].avg = PROF_acc[i].avg / PROF_WINDOW;
+      PROF_result[i].max = PROF_acc[i].max;
+      PROF_acc[i].min = 0xFFFFFFFF;
+      PROF_acc[i].avg = 0;
+      PROF_acc[i].max = 0;
+    }
+    PROF_fps = (uint32_t)PROF_renders * STK_FREQ / (now - PROF_wstart);
+    ms = PROF_result[PROF_PHASES].avg / DLY_MS_TIME;
+    if(ms > 99) ms = 99;
+    PROF_ovl[0] = ms / 10;
+    PROF_ovl[1] = ms % 10;
+    PROF_ovl[2] = (PROF_fps > 99) ? 9 : PROF_fps / 10;
+    PROF_ovl[3] = (PROF_fps > 99) ? 9 : PROF_fps % 10;
+    PROF_count   = 0;
+    PROF_renders = 0;
+    PROF_wstart  = now;
+    if(PROF_bus_errors != BUS_errors) {
+      PROF_bus_errors = BUS_errors;
+      TLM_counter(TLM_ID_BUS_ERR, PROF_bus_errors);
+    }
+    if(PROF_bus_recoveries != BUS_recoveries) {
+      PROF_bus_recoveries = BUS_recoveries;
+      TLM_counter(TLM_ID_BUS_REC, PROF_bus_recoveries);
+    }
+  }
+}
+
+// Draw "ms fps" (page 0) or the latency "avg p99" (page 1, LAT_ENABLE) into the
+// composed span of page y (columns x0..x1):
+// five cells of 4 columns (digit, digit, gap, digit, digit)
+void PROF_overlay(uint8_t* buf, uint8_t x0, uint8_t x1, uint8_t y) {
+  #if PROF_OVERLAY > 0
+  uint8_t* d = PROF_ovl;
+  uint8_t  x;
+  #if LAT_ENABLE > 0
+  if(y == 1) d = LAT_ovl;
+  else
+  #endif
+  if(y) return;
+  if(x1 < PROF_OVL_X) return;
+  if(x1 > PROF_OVL_X + 19) x1 = PROF_OVL_X + 19;
+  for(x = (x0 > PROF_OVL_X) ? x0 : PROF_OVL_X; x <= x1; x++) {
+    uint8_t cell = (x - PROF_OVL_X) >> 2;
+    uint8_t col  = (x - PROF_OVL_X) & 3;
+    uint8_t v    = 0;
+    if((cell != 2) && (col != 3))
+      v = PROF_DIGITS[d[(cell > 2) ? cell - 1 : cell] * 3 + col] << 1;
+    buf[x - x0] = v;
+  }
+  #endif
+}
+
+#endif
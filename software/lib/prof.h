@@ -0,0 +1,100 @@
+// ===================================================================================
+// Frame Profiler for CH32V003                                                * v1.2 *
+// ===================================================================================
+//
+// Measures where the time of each game loop tick goes, in SysTick counts. The time
+// is charged to the phase that is active; phases nest, so the I2C waits inside a
+// screen update count as I2C and not as compose:
+//
+//   PROF_LOGIC     everything outside of the other phases
+//   PROF_INPUT     joypad sampling (JOY_poll)
+//   PROF_COMPOSE   composing pages (compositor, image decoder)
+//   PROF_I2C       waiting for and queueing I2C transfers
+//   PROF_SOUND     sound queue and sound interrupt
+//   PROF_IDLE      waiting for the next tick
+//
+// Interrupt time measured with PROF_IRQ_BEGIN()/PROF_IRQ_END() is taken out of the
+// interrupted phase. After every PROF_WINDOW ticks, PROF_result[] holds min/avg/max
+// of every phase per tick, PROF_result[PROF_PHASES] those of the busy time of a tick
+// (all but idle). PROF_hist[] counts ticks by busy time (bounds in PROF_HIST_MS),
+// PROF_fps is the number of rendered frames per second.
+//
+// PROF_bus_errors and PROF_bus_recoveries are the failures and recoveries of the
+// display bus so far (BUS_errors and BUS_recoveries of oled_bus.h, taken at the end
+// of each window). A change is sent as counter TLM_ID_BUS_ERR or TLM_ID_BUS_REC.
+//
+// If PROF_OVERLAY is set, LAYER_compose() draws busy ms and fps of the last window
+// in the top right corner of the screen, with the latency meter (latency.h) its avg
+// and p99 in ms below. All hooks compile to nothing if PROF_ENABLE is 0.
+//
+// Functions available:
+// --------------------
+// PROF_begin(phase)        enter phase (up to PROF_DEPTH levels)
+// PROF_end()               return to the enclosing phase
+// PROF_IRQ_BEGIN()         start of interrupt handler
+// PROF_IRQ_END(phase)      end of interrupt handler, charge its time to phase
+// PROF_frame(rendered)     end of tick, rendered: 1 if the screen was updated
+// PROF_overlay(buf, x0, x1, y)  draw overlay into composed span
+//
+// 2023 by Stefan Wagner:   https://github.com/wagiminator
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "system.h"
+
+// Profiler options
+#ifndef PROF_ENABLE
+#define PROF_ENABLE   0           // 1: profiler hooks are compiled in
+#endif
+#ifndef PROF_OVERLAY
+#define PROF_OVERLAY  1           // 1: draw overlay (if profiler is enabled)
+#endif
+#ifndef PROF_WINDOW
+#define PROF_WINDOW   32          // ticks per result window (power of 2)
+#endif
+#define PROF_DEPTH    4           // max nesting of phases
+#define PROF_OVL_X    108         // first column of the overlay (page 0)
+
+// Phases
+enum {PROF_LOGIC, PROF_INPUT, PROF_COMPOSE, PROF_I2C, PROF_SOUND, PROF_IDLE, PROF_PHASES};
+
+#if PROF_ENABLE > 0
+
+// Results of the last window (SysTick counts per tick)
+typedef struct {
+  uint32_t min, avg, max;
+} PROF_STAT;
+
+extern PROF_STAT PROF_result[PROF_PHASES + 1];
+extern uint16_t  PROF_hist[8];
+extern uint8_t   PROF_fps;
+extern uint16_t  PROF_bus_errors;
+extern uint16_t  PROF_bus_recoveries;
+
+void PROF_begin(uint8_t phase);
+void PROF_end(void);
+void PROF_irq(uint8_t phase, uint32_t start);
+void PROF_frame(uint8_t rendered);
+void PROF_overlay(uint8_t* buf, uint8_t x0, uint8_t x1, uint8_t y);
+
+#define PROF_IRQ_BEGIN()    uint32_t PROF_irqstart = STK->CNT
+#define PROF_IRQ_END(phase) PROF_irq(phase, PROF_irqstart)
+
+#else
+
+#define PROF_begin(phase)
+#define PROF_end()
+#define PROF_IRQ_BEGIN()
+#define PROF_IRQ_END(phase)
+#define PROF_frame(rendered)
+#define PROF_overlay(buf, x0, x1, y)
+
+#endif
+
+#ifdef __cplusplus
+};
+#endif
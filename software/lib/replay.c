@@ -0,0 +1,148 @@
+// ===================================================================================
+// Input Recorder and Replay for CH32V003                                     * v1.0 *
+// ===================================================================================
+// 2023 by Stefan Wagner:   https://github.com/wagiminator
+
+#include "replay.h"
+
+#if REC_MODE > 0
+
+#include "uart_tx.h"
+#include "telemetry.h"
+
+uint8_t  REC_val[REC_KINDS];          // value of the current run of each kind
+uint32_t REC_cnt[REC_KINDS];          // reads of the current run (recording: so far,
+                                      // replay: left)
+uint32_t REC_tick;                    // ticks since REC_init()
+
+// Send record, wait for room in the UART buffer
+static void REC_send(uint8_t type, const uint8_t* payload, uint8_t len) {
+  uint8_t rec[3 + 2 * REC_BATCH + 1];
+  uint8_t i, sum;
+  rec[0] = TLM_SYNC;
+  rec[1] = type;
+  rec[2] = len;
+  sum = type + len;
+  for(i=0; i<len; i++) sum += rec[3 + i] = payload[i];
+  rec[3 + len] = sum;
+  while(!UART_write(rec, len + 4));
+}
+
+#if REC_MODE & 1
+uint8_t  REC_recording;               // 1: recorder is running
+uint8_t  REC_runs[2 * REC_BATCH];     // finished runs not sent yet
+uint8_t  REC_nruns;                   // number of runs in REC_runs
+
+// Send finished runs
+static void REC_flush(void) {
+  if(!REC_nruns) return;
+  REC_send(TLM_RUNS, REC_runs, REC_nruns << 1);
+  REC_nruns = 0;
+}
+
+// Close the current run of a kind, one pair per m << 3e part of its length
+static void REC_close(uint8_t kind) {
+  uint32_t n = REC_cnt[kind];
+  while(n) {
+    uint8_t e = 0, s = 0;
+    while((n >> s) >= 32 && e < 7) {
+      e++;
+      s += 3;
+    }
+    uint32_t m = n >> s;
+    if(m > 31) m = 31;
+    REC_runs[REC_nruns << 1]       = kind << 6 | REC_val[kind];
+    REC_runs[(REC_nruns << 1) + 1] = e << 5 | m;
+    if(++REC_nruns >= REC_BATCH) REC_flush();
+    n -= m << s;
+  }
+  REC_cnt[kind] = 0;
+}
+#endif
+
+#if REC_MODE & 2
+#ifdef SIM
+const uint8_t* REC_data;              // set by the simulator ("-r")
+#else
+#include "replay_data.h"
+const uint8_t* REC_data = REC_DATA;
+#endif
+const uint8_t* REC_ptr[REC_KINDS];    // next pair of each kind, 0 at the end
+
+// Fetch next run of a kind, returns 0 at the end of the recording
+static uint8_t REC_next(uint8_t kind) {
+  const uint8_t* p = REC_ptr[kind];
+  while(p[1]) {
+    if((p[0] >> 6) == kind) {
+      uint8_t e = p[1] >> 5;
+      REC_val[kind] = p[0] & 0x3F;
+      REC_cnt[kind] = (uint32_t)(p[1] & 31) << ((e << 1) + e);
+      REC_ptr[kind] = p + 2;
+      return 1;
+    }
+    p += 2;
+  }
+  REC_ptr[kind] = 0;                  // used up: live inputs again
+  return 0;
+}
+#endif
+
+// Start replay if there is a recording, otherwise start recording
+void REC_init(uint16_t* seed) {
+  uint8_t s[2];
+  #if REC_MODE & 2
+  if(REC_data) {
+    *seed = REC_data[0] | (uint16_t)REC_data[1] << 8;
+    for(uint8_t k=0; k<REC_KINDS; k++) REC_ptr[k] = REC_data + 2;
+  }
+  #endif
+  #if REC_MODE & 1
+  if(!REC_replaying()) REC_recording = 1;
+  #endif
+  s[0] = *seed;
+  s[1] = *seed >> 8;
+  UART_init();
+  REC_send(TLM_SEED, s, 2);
+}
+
+// Input value read by the game
+uint8_t REC_input(uint8_t kind, uint8_t value) {
+  #if REC_MODE & 2
+  if(REC_ptr[kind] && (REC_cnt[kind] || REC_next(kind))) {
+    REC_cnt[kind]--;
+    return REC_val[kind];
+  }
+  #endif
+  #if REC_MODE & 1
+  if(REC_recording) {
+    if(REC_cnt[kind] && ((value != REC_val[kind]) || !~REC_cnt[kind])) REC_close(kind);
+    REC_val[kind] = value;
+    REC_cnt[kind]++;
+  }
+  #endif
+  return value;
+}
+
+// End of tick: send hash of a rendered frame
+void REC_frame(uint8_t rendered, uint32_t crc) {
+  if(rendered) {
+    uint8_t h[8] = {REC_tick, REC_tick >> 8, REC_tick >> 16, REC_tick >> 24,
+                    crc, crc >> 8, crc >> 16, crc >> 24};
+    #if REC_MODE & 1
+    REC_flush();                      // (keeps runs and hashes in order)
+    #endif
+    REC_send(TLM_HASH, h, 8);
+  }
+  REC_tick++;
+}
+
+// Send all runs including the current ones
+void REC_end(void) {
+  #if REC_MODE & 1
+  if(!REC_recording) return;
+  for(uint8_t k=0; k<REC_KINDS; k++) if(REC_cnt[k]) REC_close(k);
+  REC_flush();
+  #endif
+}
+
+#endif
@@ -0,0 +1,93 @@
+// ===================================================================================
+// Input Recorder and Replay for CH32V003                                     * v1.0 *
+// ===================================================================================
+//
+// Makes runs of a game repeatable, so two builds can be compared frame by frame.
+// Every input the game takes (button reads, clicks, joypad snapshots of
+// JOY_poll()) passes through REC_input(). Each of these three kinds of reads is
+// run-length encoded on its own, so the runs stay long although the reads of a
+// game loop tick alternate between them:
+//
+// - Record (REC_MODE 1, "make record"): the values are run-length encoded and sent
+//   via UART on PD5 as telemetry records (see telemetry.h).
+// - Replay (REC_MODE 2, "make replay"): the values are taken from REC_DATA[] in
+//   replay_data.h instead of the joypad, JOY_random() gets the recorded seed.
+//   When the recording is used up, the live inputs take over again.
+//
+// Both modes send the seed of JOY_random() and a hash of every rendered frame.
+//
+// Since reads, not times, are replayed, a game takes exactly the same course as
+// long as its logic is unchanged, no matter how fast the compositor or the I2C
+// driver is. The tick scheduler renders every JOY_FRAME_RENDER-th tick without
+// skipping frames on overrun, so the frame hashes of two runs match tick by tick.
+// The hash is the CRC-32 of the bytes composed for the frame (OLED_CRC in
+// oled_min.h), i.e. of all 1024 bytes of a full screen update.
+//
+//   TLM_SEED     u16 seed of JOY_random()
+//   TLM_RUNS     u8 kind << 6 | value, u8 count of each run of equal values of
+//                one kind; runs are sent when they end
+//
+// A count byte e << 5 | m stands for m << 3e reads, so a button that is polled in
+// a tight loop while a title screen waits takes a few pairs, not thousands; a
+// run is split into as many pairs as its length needs.
+//   TLM_HASH     u32 tick, u32 CRC-32 of the frame composed in this tick
+//
+// Runs are sent in batches of REC_BATCH; the recorder waits for room in the UART
+// buffer rather than losing any. software/tools/replay_tool.py turns a recorded
+// stream into a recording file (u16 seed, pairs, 0, 0) and that into
+// replay_data.h, the host simulator replays the file directly ("-r").
+//
+// Functions available:
+// --------------------
+// REC_init(&seed)          start recording / replay, seed: JOY_random() state
+// REC_input(kind, value)   input value (0..63) of a read of kind REC_ACT, REC_CLICK
+//                          or REC_PAD by the game, returns the value to use
+// REC_frame(rendered, crc) end of a tick, crc: hash of the frame if rendered
+// REC_end()                send the pending runs (end of recording)
+// REC_replaying()          1 if a recording is replayed
+//
+// 2023 by Stefan Wagner:   https://github.com/wagiminator
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "system.h"
+
+#ifndef REC_MODE
+#define REC_MODE      0           // 0: off, 1: record, 2: replay, 3: both (host)
+#endif
+#define REC_BATCH     16          // runs per TLM_RUNS record
+
+// Kinds of reads
+enum {REC_ACT, REC_CLICK, REC_PAD, REC_KINDS};
+
+#if REC_MODE > 0
+
+void REC_init(uint16_t* seed);
+uint8_t REC_input(uint8_t kind, uint8_t value);
+void REC_frame(uint8_t rendered, uint32_t crc);
+void REC_end(void);
+
+#if REC_MODE & 2
+extern const uint8_t* REC_data;   // recording (seed, pairs), 0 if none
+#define REC_replaying()           (REC_data != 0)
+#else
+#define REC_replaying()           0
+#endif
+
+#else
+
+#define REC_init(seed)
+#define REC_input(kind, value)    (value)
+#define REC_frame(rendered, crc)
+#define REC_end()
+#define REC_replaying()           0
+
+#endif
+
+#ifdef __cplusplus
+};
+#endif
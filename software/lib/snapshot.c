@@ -0,0 +1,106 @@
+// ===================================================================================
+// Game State Snapshot in Flash for CH32V003                                  * v1.0 *
+// ===================================================================================
+// 2023 by Stefan Wagner:   https://github.com/wagiminator
+
+#include "snapshot.h"
+
+#if SNAP_ENABLE > 0
+
+#define SNAP_MAX      (SNAP_PAGES * KV_PAGE - SNAP_HEAD)  // max size of the state
+
+// Flash pages of the slot
+#ifdef SIM
+volatile uint8_t SNAP_flash[SNAP_PAGES][KV_PAGE];   // loaded/saved by the simulator ("-k")
+const uint16_t   SNAP_flash_size = sizeof(SNAP_flash);
+#else
+volatile uint8_t SNAP_flash[SNAP_PAGES][KV_PAGE] __attribute__((section(".snapshot"), aligned(KV_PAGE)));
+extern uint8_t _sinit[];                            // image of the program in flash:
+extern uint8_t _ramfunc_lma[], _ramfunc_vma[], _eramfunc[];  // (linker script)
+#endif
+
+// State block (symbols of the linker script, on the host of the linker)
+extern uint8_t __start_snapstate[] __attribute__((weak));
+extern uint8_t __stop_snapstate[]  __attribute__((weak));
+#define SNAP_state    __start_snapstate
+#define SNAP_len()    ((uint16_t)(__stop_snapstate - __start_snapstate))
+
+// Slot as one array of bytes
+#define SNAP_slot     ((volatile uint8_t*)SNAP_flash)
+
+// CRC-16 (polynomial 0x1021) of one more byte
+static uint16_t SNAP_crc(uint16_t crc, uint8_t b) {
+  crc ^= (uint16_t)b << 8;
+  for(uint8_t i=0; i<8; i++) crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+  return crc;
+}
+
+// Build of the firmware: CRC-16 of its image in flash (code, constants, initial
+// values of .data and the RAM functions, which come last), on the host a constant
+static uint16_t SNAP_build(void) {
+  uint16_t crc = 0xFFFF;
+  #ifndef SIM
+  const uint8_t* b;
+  for(b = _sinit; b < _ramfunc_lma + (_eramfunc - _ramfunc_vma); b++) crc = SNAP_crc(crc, *b);
+  #endif
+  return crc;
+}
+
+// Erase the pages of the slot that aren't erased yet
+void SNAP_clear(void) {
+  uint8_t p, i;
+  for(p=0; p<SNAP_PAGES; p++) {
+    for(i=0; i<KV_PAGE && SNAP_flash[p][i] == 0xFF; i++);
+    if(i < KV_PAGE) KV_page_erase(SNAP_flash[p]);
+  }
+}
+
+// Save the state, the page with the header last
+uint8_t SNAP_save(uint8_t game, uint8_t version) {
+  uint32_t page[KV_PAGE/4];
+  uint8_t* b   = (uint8_t*)page;
+  uint16_t len = SNAP_len(), crc = 0xFFFF, build, n;
+  uint8_t  head[SNAP_HEAD], p, i;
+  if(len > SNAP_MAX) return 0;
+  for(n=0; n<len; n++) crc = SNAP_crc(crc, SNAP_state[n]);
+  build = SNAP_build();
+  head[0] = 'S';
+  head[1] = game;
+  head[2] = version;
+  head[3] = 0xFF;
+  head[4] = len;
+  head[5] = len >> 8;
+  head[6] = build;
+  head[7] = build >> 8;
+  head[8] = crc;
+  head[9] = crc >> 8;
+  SNAP_clear();
+  p = (len + SNAP_HEAD - 1) / KV_PAGE;
+  while(1) {
+    for(i=0; i<KV_PAGE; i++) {
+      n = p * KV_PAGE + i;
+      if(n < SNAP_HEAD) b[i] = head[n];
+      else if((n -= SNAP_HEAD) < len) b[i] = SNAP_state[n];
+      else b[i] = 0xFF;
+    }
+    KV_page_program(SNAP_flash[p], page);
+    if(!p) break;
+    p--;
+  }
+  return 1;
+}
+
+// Restore a snapshot of the game and version, the slot is erased afterwards
+uint8_t SNAP_load(uint8_t game, uint8_t version) {
+  uint16_t len = SNAP_len(), crc = 0xFFFF, n;
+  if(SNAP_slot[0] != 'S' || SNAP_slot[1] != game || SNAP_slot[2] != version) return 0;
+  if((SNAP_slot[4] | (uint16_t)SNAP_slot[5] << 8) != len || len > SNAP_MAX) return 0;
+  for(n=0; n<len; n++) crc = SNAP_crc(crc, SNAP_slot[SNAP_HEAD + n]);
+  if((SNAP_slot[8] | (uint16_t)SNAP_slot[9] << 8) != crc) return 0;
+  if((SNAP_slot[6] | (uint16_t)SNAP_slot[7] << 8) != SNAP_build()) return 0;
+  for(n=0; n<len; n++) SNAP_state[n] = SNAP_slot[SNAP_HEAD + n];
+  SNAP_clear();
+  return 1;
+}
+
+#endif
@@ -0,0 +1,96 @@
+// ===================================================================================
+// Game State Snapshot in Flash for CH32V003                                  * v1.0 *
+// ===================================================================================
+//
+// Suspend and resume: SNAP_save() copies the state of a running game into the
+// SNAP_PAGES 64-byte pages of the snapshot slot in flash, SNAP_load() copies it
+// back after the next power-up, so the game goes on where it was left instead
+// of starting over with its intro.
+//
+// The state is every variable the game marks with SNAP_STATE. The linker puts
+// them side by side into one block of RAM (.bss.snapshot in the linker script),
+// which is saved and restored as a whole. They are zeroed at startup like all
+// of .bss, so a SNAP_STATE variable can't have an initializer, and pointers
+// into flash or RAM should be set again by the game after a resume rather than
+// kept in the state.
+//
+// The slot starts with a header, followed by the state:
+//
+//   u8 'S', u8 game, u8 version, u8 0xFF, u16 length, u16 build, u16 CRC
+//
+// game and version are given by the game (bump the version when its state
+// changes), length is the size of the state block, build is the CRC-16 of the
+// program image in flash (code, constants and the initial values of .data, so
+// another build of the firmware has another one, even if it has the same size),
+// CRC is the CRC-16 of the state (both CCITT polynomial 0x1021). A snapshot is
+// only loaded if all of them match. SNAP_save() computes the build, SNAP_load()
+// only once the other fields match (some 60ms at 12MHz for 14K of flash). The
+// pages of the state are programmed first and the header last, so a save torn
+// by a power loss leaves no header. SNAP_load() erases the slot, a snapshot is
+// resumed once.
+//
+// The pages are reserved by the .snapshot section in the linker script, in
+// front of the key-value store (flash_kv.h, whose page functions are used). ld
+// fails if the state doesn't fit into the slot. The CPU stalls while a page is
+// programmed or erased (code runs from flash), a save takes a few milliseconds
+// per page. A chip erase clears the slot.
+//
+// Functions available:
+// --------------------
+// SNAP_save(game, version) save the state, returns 1 if done
+// SNAP_load(game, version) restore a snapshot of this game and version, returns 1
+//                          if it is restored (the state is unchanged otherwise)
+// SNAP_clear()             erase the slot
+//
+// 2023 by Stefan Wagner:   https://github.com/wagiminator
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "system.h"
+#include "flash_kv.h"
+
+// Snapshot parameters
+#ifndef SNAP_ENABLE
+#define SNAP_ENABLE   1           // 0: no suspend/resume, 1: state saved to flash
+#endif
+#ifndef SNAP_PAGES
+#define SNAP_PAGES    2           // pages of the slot (64 bytes each, header: 10 bytes)
+#endif
+#ifndef SNAP_HOLD
+#define SNAP_HOLD     3000        // ms the suspend gesture is held (JOY_SNAP_DIRS in joypad.h)
+#endif
+#ifndef SNAP_PVD
+#define SNAP_PVD      1           // 1: suspend as well when VDD drops below 2.7V
+#endif
+#ifndef SNAP_PVD_MS
+#define SNAP_PVD_MS   200         // ms VDD stays below it before the suspend (dips pass)
+#endif
+
+#define SNAP_HEAD     10          // header size in bytes
+
+// State variables (one block, see above); on the host without the alignment of
+// arrays to 32 bytes, which would pad the block between the game and the driver
+#ifdef SIM
+#define SNAP_STATE    __attribute__((section("snapstate"), aligned(1)))
+#else
+#define SNAP_STATE    __attribute__((section(".bss.snapshot")))
+#endif
+
+// Snapshot functions
+#if SNAP_ENABLE > 0
+uint8_t SNAP_save(uint8_t game, uint8_t version);         // save state
+uint8_t SNAP_load(uint8_t game, uint8_t version);         // restore state
+void SNAP_clear(void);                                    // erase slot
+#else
+#define SNAP_save(game, version)  0
+#define SNAP_load(game, version)  0
+#define SNAP_clear()
+#endif
+
+#ifdef __cplusplus
+};
+#endif
@@ -0,0 +1,148 @@
+// ===================================================================================
+// Basic SPI Master Functions (write only) for SSD1306 on CH32V003            * v1.1 *
+// ===================================================================================
+// 2023 by Stefan Wagner:   https://github.com/wagiminator
+
+#include "spi_tx.h"
+
+#if SPI_SINK > 0
+volatile uint32_t SPI_bytes;                      // number of bytes sent
+#define SPI_count(n)            SPI_bytes += (n)
+#else
+#define SPI_count(n)
+#endif
+
+#if SPI_SINK == 2
+// ===================================================================================
+// Null Sink (benchmark builds): bytes are counted, but not sent
+// ===================================================================================
+void SPI_init(void) {}
+void SPI_setClock(void) {}
+void SPI_command(void) {}
+void SPI_data(void) {}
+void SPI_write(uint8_t data) { SPI_count(1); }
+void SPI_writeBuffer(uint8_t* buf, uint16_t len) { SPI_count(len); }
+void SPI_fill(uint8_t p, uint16_t len) { SPI_count(len); }
+void SPI_flush(void) {}
+
+#else
+
+// Baud rate bits for the current system clock (SCK = CLK_freq() / 2^(BR+1))
+static uint16_t SPI_BR(void) {
+  uint16_t br = 0;
+  while((br < 7) && ((CLK_freq() >> (br + 1)) > SPI_CLKRATE)) br++;
+  return br << 3;
+}
+
+// Init SPI
+void SPI_init(void) {
+  // Enable GPIO port C and SPI module
+  RCC->APB2PCENR |= RCC_AFIOEN | RCC_IOPCEN | RCC_SPI1EN;
+
+  // Set pins PC5 (SCK) and PC6 (MOSI) to alternate output, control pins to output
+  PIN_alternate(PC5);
+  PIN_alternate(PC6);
+  PIN_low(SPI_PIN_CS);    PIN_output(SPI_PIN_CS);   // display is the only device
+  PIN_low(SPI_PIN_DC);    PIN_output(SPI_PIN_DC);
+  PIN_low(SPI_PIN_RES);   PIN_output(SPI_PIN_RES);  // reset the display
+  DLY_us(10);
+  PIN_high(SPI_PIN_RES);
+  DLY_us(10);
+
+  // Master, mode 0, transmit only, software slave select
+  SPI1->CTLR1 = SPI_CTLR1_MSTR | SPI_CTLR1_SSM | SPI_CTLR1_SSI
+              | SPI_CTLR1_BIDIMODE | SPI_CTLR1_BIDIOE
+              | SPI_BR();
+  SPI1->CTLR1 |= SPI_CTLR1_SPE;
+
+  #if SPI_DMA > 0
+  // Setup DMA Channel 3 (polled, no interrupt)
+  RCC->AHBPCENR |= RCC_DMA1EN;                    // enable DMA module clock
+  SPI1->CTLR2 = SPI_CTLR2_TXDMAEN;                // DMA request on TXE
+  DMA1_Channel3->PADDR = (uint32_t)&SPI1->DATAR;  // peripheral address
+  DMA1_Channel3->CFGR  = DMA_CFGR3_MINC           // increment memory address
+                       | DMA_CFGR3_DIR;           // memory to SPI
+  DMA1->INTFCR         = DMA_CTCIF3;              // clear transfer complete flag
+  #endif
+}
+
+// Wait until the last byte is shifted out
+void SPI_flush(void) {
+  #if SPI_DMA > 0
+  if(DMA1_Channel3->CFGR & DMA_CFGR3_EN) {
+    while(!(DMA1->INTFR & DMA_TCIF3));            // wait for DMA
+    DMA1_Channel3->CFGR &= ~DMA_CFGR3_EN;         // disable DMA channel
+    DMA1->INTFCR = DMA_CTCIF3;                    // clear transfer complete flag
+  }
+  #endif
+  while(!(SPI1->STATR & SPI_STATR_TXE));          // wait for last byte in shift register
+  while(SPI1->STATR & SPI_STATR_BSY);             // wait until it is sent
+}
+
+// Set clock rate for the current system clock (waits for the bus)
+void SPI_setClock(void) {
+  SPI_flush();
+  SPI1->CTLR1 &= ~SPI_CTLR1_SPE;                  // clock can only be set when disabled
+  SPI1->CTLR1  = (SPI1->CTLR1 & ~SPI_CTLR1_BR) | SPI_BR();
+  SPI1->CTLR1 |= SPI_CTLR1_SPE;
+}
+
+// Start command bytes (D/C is sampled with the last bit of each byte)
+void SPI_command(void) {
+  SPI_flush();
+  PIN_low(SPI_PIN_DC);
+}
+
+// Start display data
+void SPI_data(void) {
+  SPI_flush();
+  PIN_high(SPI_PIN_DC);
+}
+
+// Send one byte
+void SPI_write(uint8_t data) {
+  #if SPI_DMA > 0
+  if(DMA1_Channel3->CFGR & DMA_CFGR3_EN) SPI_flush();
+  #endif
+  while(!(SPI1->STATR & SPI_STATR_TXE));          // wait for free transmit buffer
+  SPI1->DATAR = data;
+  SPI_count(1);
+}
+
+// Send buffer
+void SPI_writeBuffer(uint8_t* buf, uint16_t len) {
+  #if SPI_DMA > 0
+  SPI_flush();                                    // previous transfer must be done
+  DMA1_Channel3->CNTR  = len;                     // number of bytes to be transfered
+  DMA1_Channel3->MADDR = (uint32_t)buf;           // memory address
+  DMA1_Channel3->CFGR |= DMA_CFGR3_MINC           // increment memory address
+                       | DMA_CFGR3_EN;            // enable DMA channel
+  #else
+  for(uint16_t i=0; i<len; i++) {
+    while(!(SPI1->STATR & SPI_STATR_TXE));
+    SPI1->DATAR = buf[i];
+  }
+  #endif
+  SPI_count(len);
+}
+
+// Send len copies of byte p
+void SPI_fill(uint8_t p, uint16_t len) {
+  #if SPI_DMA > 0
+  static uint8_t pat;                             // source of the transfer
+  SPI_flush();                                    // previous transfer must be done
+  pat = p;
+  DMA1_Channel3->CNTR  = len;                     // number of bytes to be transfered
+  DMA1_Channel3->MADDR = (uint32_t)&pat;          // memory address
+  DMA1_Channel3->CFGR  = (DMA1_Channel3->CFGR & ~DMA_CFGR3_MINC) // fixed source byte
+                       | DMA_CFGR3_EN;            // enable DMA channel
+  #else
+  for(uint16_t i=0; i<len; i++) {
+    while(!(SPI1->STATR & SPI_STATR_TXE));
+    SPI1->DATAR = p;
+  }
+  #endif
+  SPI_count(len);
+}
+
+#endif
@@ -0,0 +1,93 @@
+// ===================================================================================
+// Basic SPI Master Functions (write only) for SSD1306 on CH32V003            * v1.1 *
+// ===================================================================================
+//
+// Functions available:
+// --------------------
+// SPI_init()               Init SPI1 with defined clock rate, reset the display
+// SPI_setClock()           Set clock rate again after a system clock switch
+// SPI_command()            Start sending command bytes (D/C low)
+// SPI_data()               Start sending display data (D/C high)
+// SPI_write(b)             Send one byte
+// SPI_stop()               End of transmission (nothing to do, CS stays low)
+// SPI_writeBuffer(buf,len) Send buffer (*buf) with length (len) via SPI/DMA
+// SPI_streamBuffer(buf,len) Same as SPI_writeBuffer() (there is no stop on SPI)
+// SPI_fill(p,len)          Send len copies of byte p via SPI/DMA
+// SPI_DMA_busy()           Check if DMA transfer is in progress
+// SPI_flush()              Wait until the last byte is shifted out
+// SPI_bytes                Number of bytes sent (if SPI_SINK > 0)
+//
+// 4-wire SPI interface of SSD1306 modules: SCK on PC5 and MOSI on PC6 (SPI1,
+// transmit only), D/C, CS and RES on the pins defined below. The controller takes
+// the D/C line with the last bit of each byte, so SPI_command() and SPI_data()
+// wait until everything before is sent. CS is held low, the module is the only
+// device on the bus. The SCK divider is the smallest power of two from 2 that
+// keeps the clock at or below SPI_CLKRATE (10MHz max for the SSD1306).
+//
+// If SPI_DMA is enabled, SPI_writeBuffer() returns immediately, the transfer runs
+// in the background (DMA1 channel 3, polled, no interrupt). The buffer must not
+// be altered until the next SPI function returned or SPI_DMA_busy() is cleared.
+// SPI_fill() runs the DMA without memory increment over one pattern byte kept by
+// the driver.
+//
+// SPI_SINK is meant for benchmark builds like I2C_SINK in i2c_tx.h: with 1 all
+// bytes are counted in SPI_bytes, with 2 they are only counted and the bus isn't
+// touched at all.
+//
+// 2023 by Stefan Wagner:   https://github.com/wagiminator
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "system.h"
+#include "gpio.h"
+
+// SPI Parameters
+#ifndef SPI_CLKRATE
+#define SPI_CLKRATE   8000000   // max SPI clock rate (Hz)
+#endif
+#ifndef SPI_DMA
+#define SPI_DMA       1         // 0: blocking transfers only, 1: enable DMA transfers
+#endif
+#ifndef SPI_PIN_DC
+#define SPI_PIN_DC    PC2       // pin connected to D/C of the display
+#endif
+#ifndef SPI_PIN_CS
+#define SPI_PIN_CS    PC1       // pin connected to CS of the display
+#endif
+#ifndef SPI_PIN_RES
+#define SPI_PIN_RES   PC3       // pin connected to RES of the display
+#endif
+#ifndef SPI_SINK
+#define SPI_SINK      0         // 0: bus, 1: bus and byte count, 2: byte count only
+#endif
+
+// SPI Functions
+void SPI_init(void);            // SPI init function
+void SPI_setClock(void);        // set clock rate for the current CLK_freq()
+void SPI_command(void);         // start command bytes
+void SPI_data(void);            // start display data
+void SPI_write(uint8_t data);   // send one byte
+void SPI_writeBuffer(uint8_t* buf, uint16_t len);  // send buffer
+void SPI_fill(uint8_t p, uint16_t len);            // send len copies of p
+void SPI_flush(void);           // wait until the last byte is sent
+
+#define SPI_stop()
+#define SPI_streamBuffer(buf, len)  SPI_writeBuffer(buf, len)
+
+#if SPI_SINK > 0
+extern volatile uint32_t SPI_bytes; // number of bytes sent
+#endif
+
+#if SPI_SINK == 2 || SPI_DMA == 0
+  #define SPI_DMA_busy() 0
+#else
+  #define SPI_DMA_busy() ((DMA1_Channel3->CFGR & DMA_CFGR3_EN) && !(DMA1->INTFR & DMA_TCIF3))
+#endif
+
+#ifdef __cplusplus
+};
+#endif
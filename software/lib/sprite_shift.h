@@ -0,0 +1,50 @@
+// ===================================================================================
+// Pre-Shifted Sprite Tables for SSD1306 OLED Pages                           * v1.0 *
+// ===================================================================================
+//
+// A sprite byte drawn at a vertical offset d (0..7) inside a page is split into
+// the part that stays in page y (byte << d) and the part that spills into page
+// y+1 (byte >> (8 - d)). Both parts together are just the byte shifted into a
+// 16-bit word, so a pre-shifted table stores one uint16_t per byte and offset:
+//
+//   low byte:  pixels in page y        SPRITE_UP(pair)
+//   high byte: pixels in page y+1      SPRITE_DOWN(pair)
+//
+// The tables are generated at compile time from the same byte list as the raw
+// sprite. Write the sprite data as a list macro and expand it twice:
+//
+//   #define HERO(B) B(0x1C) B(0x3E) B(0x7F) B(0x3E)
+//   const uint8_t  hero[]            = { HERO(SPRITE_RAW) };
+//   const uint16_t hero_shifted[][8] = { HERO(SPRITE_SHIFTED) };
+//
+// The pair of byte i at offset d is then hero_shifted[i][d]. Each expanded byte
+// costs 16 bytes of flash, so every game selects the expanded sprites with its
+// own flash budget switch.
+//
+// 2023 by Stefan Wagner:   https://github.com/wagiminator
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+// Shift byte b down by d pixels into a page pair
+#define SPRITE_SHIFT(b, d)  ((uint16_t)((uint16_t)(b) << (d)))
+
+// Split page pair
+#define SPRITE_UP(pair)     ((uint8_t)(pair))
+#define SPRITE_DOWN(pair)   ((uint8_t)((pair) >> 8))
+
+// List element expanders
+#define SPRITE_RAW(b)       (b),
+#define SPRITE_SHIFTED(b)   { SPRITE_SHIFT(b, 0), SPRITE_SHIFT(b, 1), \
+                              SPRITE_SHIFT(b, 2), SPRITE_SHIFT(b, 3), \
+                              SPRITE_SHIFT(b, 4), SPRITE_SHIFT(b, 5), \
+                              SPRITE_SHIFT(b, 6), SPRITE_SHIFT(b, 7) },
+
+#ifdef __cplusplus
+};
+#endif
@@ -1,5 +1,5 @@
 // ===================================================================================
-// Basic System Functions for CH32V003                                        * v1.6 *
+// Basic System Functions for CH32V003                                        * v2.4 *
 // ===================================================================================
 //
 // This file must be included!!!!
@@ -18,6 +18,9 @@
 // ===================================================================================
 void SYS_init(void) {
   // Init system clock
+  #if SYS_STARTUP_PROF > 0
+  STARTUP_clk = STK->CNT;                                   // SysTick changes its clock
+  #endif
   #if SYS_CLK_INIT > 0
   #if F_CPU > 24000000
   FLASH->ACTLR = FLASH_ACTLR_LATENCY_1;                     // 1 cycle latency
@@ -34,6 +37,7 @@ void SYS_init(void) {
   #if SYS_GPIO_EN > 0
     RCC->APB2PCENR |= RCC_IOPAEN | RCC_IOPCEN | RCC_IOPDEN;
   #endif
+  STARTUP_mark(STARTUP_CLOCK);
 }
 
 // ===================================================================================
@@ -87,6 +91,32 @@ void CLK_reset(void) {
   FLASH->ACTLR = FLASH_ACTLR_LATENCY_0;                         // no flash wait states
 }
 
+#if SYS_CLK_PROFILES > 0
+uint8_t CLK_profile;
+
+// Switch between 48MHz (HSI with PLL) and 6MHz (HSI / 4), SysTick stays at 6MHz
+void CLK_setProfile(uint8_t p) {
+  if(p == CLK_FAST) {
+    if(!PLL_ready()) {
+      PLL_setHSI();
+      PLL_enable();                                             // PLL keeps running in
+      while(!PLL_ready());                                      // the slow profile
+    }
+    FLASH->ACTLR = FLASH_ACTLR_LATENCY_1;                       // 1 cycle latency
+    STK->CTLR   &= ~STK_CTLR_STCLK;                             // SysTick @ HCLK/8
+    RCC->CFGR0   = (RCC->CFGR0 & ~(RCC_HPRE | RCC_SW)) | RCC_HPRE_DIV1 | RCC_SW_PLL;
+    while((RCC->CFGR0 & RCC_SWS) != RCC_SWS_PLL);               // wait till PLL is used
+  }
+  else {
+    RCC->CFGR0   = (RCC->CFGR0 & ~(RCC_HPRE | RCC_SW)) | RCC_HPRE_DIV4 | RCC_SW_HSI;
+    while(RCC->CFGR0 & RCC_SWS);                                // wait till HSI is used
+    STK->CTLR   |= STK_CTLR_STCLK;                              // SysTick @ HCLK
+    FLASH->ACTLR = FLASH_ACTLR_LATENCY_0;                       // no flash wait states
+  }
+  CLK_profile = p;
+}
+#endif
+
 // Setup pin PC4 for MCO (output, push-pull, 50MHz, auxiliary)
 void MCO_init(void) {
   RCC->APB2PCENR |= RCC_AFIOEN | RCC_IOPCEN;
@@ -103,6 +133,148 @@ void DLY_ticks(uint32_t n) {
   while(((int32_t)(STK->CNT - end)) < 0);
 }
 
+// ===================================================================================
+// Timed Task (TSK) Functions
+// ===================================================================================
+#if SYS_TASKS > 0
+struct {
+  uint32_t due;                                                 // SYSTICK count to call at
+  TSK_FUNC fn;                                                  // 0: slot is free
+  void*    ctx;
+} TSK_slot[SYS_TASKS];
+
+// Call fn(ctx) once in ms milliseconds, returns task id or TSK_NONE
+uint8_t TSK_after(uint16_t ms, TSK_FUNC fn, void* ctx) {
+  uint8_t i;
+  for(i=0; i<SYS_TASKS; i++) {
+    if(!TSK_slot[i].fn) {
+      TSK_slot[i].due = STK->CNT + (uint32_t)ms * DLY_MS_TIME;
+      TSK_slot[i].ctx = ctx;
+      TSK_slot[i].fn  = fn;
+      return i;
+    }
+  }
+  return TSK_NONE;
+}
+
+// Cancel waiting task
+void TSK_cancel(uint8_t id) {
+  if(id < SYS_TASKS) TSK_slot[id].fn = 0;
+}
+
+// Check if task is still waiting
+uint8_t TSK_pending(uint8_t id) {
+  return (id < SYS_TASKS) && TSK_slot[id].fn;
+}
+
+// Call all tasks that are due, the slot is freed before the call
+void TSK_run(void) {
+  uint8_t i;
+  RAM_check();
+  for(i=0; i<SYS_TASKS; i++) {
+    TSK_FUNC fn = TSK_slot[i].fn;
+    if(fn && ((int32_t)(STK->CNT - TSK_slot[i].due)) >= 0) {
+      TSK_slot[i].fn = 0;
+      fn(TSK_slot[i].ctx);
+    }
+  }
+}
+#else
+void TSK_run(void) {RAM_check();}
+#endif
+
+// Wait until SYSTICK count t, running due tasks meanwhile
+void TSK_until(uint32_t t) {
+  while(((int32_t)(STK->CNT - t)) < 0) TSK_run();
+}
+
+// SYSTICK count the next task is due at, t if none is due before
+uint32_t TSK_next(uint32_t t) {
+  #if SYS_TASKS > 0
+  uint8_t i;
+  for(i=0; i<SYS_TASKS; i++) {
+    if(TSK_slot[i].fn && ((int32_t)(TSK_slot[i].due - t)) < 0) t = TSK_slot[i].due;
+  }
+  #endif
+  return t;
+}
+
+// Wait until SYSTICK count t, sleeping until the next task is due
+void TSK_idle(uint32_t t) {
+  while(((int32_t)(STK->CNT - t)) < 0) {
+    TSK_run();
+    SLEEP_until(TSK_next(t));
+  }
+}
+
+// ===================================================================================
+// RAM Usage (RAM) Functions
+// ===================================================================================
+extern uint32_t _ebss;
+extern uint32_t _eusrstack;
+
+// Bytes of RAM between the end of .bss and the top of RAM
+uint16_t RAM_stackSize(void) {
+  return (uint8_t*)&_eusrstack - (uint8_t*)&_ebss;
+}
+
+// Bytes of stack space that still hold the paint (0 if not painted)
+uint16_t RAM_stackFree(void) {
+  uint32_t* p = &_ebss;
+  while((p < &_eusrstack) && (*p == RAM_PAINT)) p++;
+  return (uint8_t*)p - (uint8_t*)&_ebss;
+}
+
+// Check if the guard words above .bss are intact
+uint8_t RAM_guardOK(void) {
+  #if SYS_STACK_GUARD > 0
+  uint8_t i;
+  for(i=0; i<SYS_STACK_GUARD; i++) if((&_ebss)[i] != RAM_PAINT) return 0;
+  #endif
+  return 1;
+}
+
+// Stack ran into the guard words, spin forever (games may override)
+__attribute__((weak)) void RAM_overflow(void) {
+  while(1);
+}
+
+// ===================================================================================
+// Mode Overlay Arena (ARENA) Functions
+// ===================================================================================
+#if SYS_ARENA_SIZE > 0
+uint32_t ARENA_buf[(SYS_ARENA_SIZE + 3) >> 2];
+uint8_t  ARENA_active;
+
+// Hand the arena over to a mode, its overlay starts cleared
+void ARENA_enter(uint8_t mode) {
+  uint16_t i;
+  for(i=0; i<sizeof(ARENA_buf)/4; i++) ARENA_buf[i] = 0;
+  ARENA_active = mode;
+}
+
+// Overlay used while the arena belongs to another mode, spin forever (games may override)
+__attribute__((weak)) void ARENA_fault(void) {
+  while(1);
+}
+#endif
+
+// ===================================================================================
+// Startup Profiler (STARTUP) Functions
+// ===================================================================================
+#if SYS_STARTUP_PROF > 0
+uint32_t STARTUP_us[STARTUP_STAGES];
+uint32_t STARTUP_clk;
+
+// Time stamp the end of a startup stage in us since reset
+void STARTUP_mark(uint8_t stage) {
+  uint32_t t = STK->CNT;
+  if(!STARTUP_clk) t /= STARTUP_RESET_MHZ;                      // still on the reset clock
+  else t = STARTUP_clk / STARTUP_RESET_MHZ + (t - STARTUP_clk) / DLY_US_TIME;
+  if(stage < STARTUP_STAGES) STARTUP_us[stage] = t;
+}
+#endif
+
 // ===================================================================================
 // Bootloader (BOOT) Functions
 // ===================================================================================
@@ -199,6 +371,33 @@ void STDBY_WFE_now(void) {
   PWR->CTLR   &= ~PWR_CTLR_PDDS;        // disable PDDS again
 }
 
+// Sleep until SYSTICK count t or the next interrupt. Interrupts are disabled while
+// the compare is set up, so one that comes before the WFI still wakes the core
+// (it stays pending) and its handler runs afterwards.
+#if SYS_TICK_SLEEP > 0
+void SLEEP_until(uint32_t t) {
+  INT_disable();
+  STK->CMP   = t;
+  STK->SR    = 0;
+  STK->CTLR |= STK_CTLR_STIE;           // compare interrupt wakes the core at t
+  NVIC_EnableIRQ(SysTicK_IRQn);
+  if(((int32_t)(STK->CNT - t)) < 0) SLEEP_WFI_now();
+  STK->CTLR &= ~STK_CTLR_STIE;
+  STK->SR    = 0;
+  INT_enable();
+}
+
+// SysTick compare interrupt: only wakes the core
+void SysTick_Handler(void) {
+  STK->CTLR &= ~STK_CTLR_STIE;
+  STK->SR    = 0;
+}
+#else
+void SLEEP_until(uint32_t t) {
+  while(((int32_t)(STK->CNT - t)) < 0);
+}
+#endif
+
 // ===================================================================================
 // C++ Support
 // Based on CNLohr ch32v003fun: https://github.com/cnlohr/ch32v003fun
@@ -224,10 +423,12 @@ void __libc_init_array(void) {
 // Based on CNLohr ch32v003fun: https://github.com/cnlohr/ch32v003fun
 // ===================================================================================
 extern uint32_t _sbss;
-extern uint32_t _ebss;
 extern uint32_t _data_lma;
 extern uint32_t _data_vma;
 extern uint32_t _edata;
+extern uint32_t _ramfunc_lma;
+extern uint32_t _ramfunc_vma;
+extern uint32_t _eramfunc;
 
 // Prototypes
 int main(void)                __attribute__((section(".text.main"), used));
@@ -246,7 +447,9 @@ void default_handler(void)    { while(1); }
 #define DUMMY_HANDLER __attribute__((section(".text.vector_handler"), weak, alias("default_handler"), used))
 DUMMY_HANDLER void NMI_Handler(void);
 DUMMY_HANDLER void HardFault_Handler(void);
+#if SYS_TICK_SLEEP == 0
 DUMMY_HANDLER void SysTick_Handler(void);
+#endif
 DUMMY_HANDLER void SW_Handler(void);
 DUMMY_HANDLER void WWDG_IRQHandler(void);
 DUMMY_HANDLER void PVD_IRQHandler(void);
@@ -344,17 +547,42 @@ void reset_handler(void) {
     : : [main] "r" (main) : "a0", "a1" , "memory"
   );
 
+  // Start SysTick on the reset clock for the startup profiler
+  #if SYS_STARTUP_PROF > 0
+  uint32_t t;
+  STK->CNT  = 0;
+  STK->CTLR = STK_CTLR_STE | STK_CTLR_STCLK;
+  #endif
+
   // Copy data from FLASH to RAM
   src = &_data_lma;
   dst = &_data_vma;
   while(dst < &_edata) *dst++ = *src++;
 
+  // Copy functions to be run from RAM
+  src = &_ramfunc_lma;
+  dst = &_ramfunc_vma;
+  while(dst < &_eramfunc) *dst++ = *src++;
+  #if SYS_STARTUP_PROF > 0
+  t = STK->CNT;                                             // (.bss is cleared next)
+  #endif
+
   // Clear uninitialized variables
   #if SYS_CLEAR_BSS > 0
   dst = &_sbss;
   while(dst < &_ebss) *dst++ = 0;
   #endif
 
+  // Paint stack space for the high-water mark (stack is still empty here)
+  #if SYS_STACK_PAINT > 0 || SYS_STACK_GUARD > 0
+  dst = &_ebss;
+  while(dst < &_eusrstack) *dst++ = RAM_PAINT;
+  #endif
+  #if SYS_STARTUP_PROF > 0
+  STARTUP_us[STARTUP_DATA] = t / STARTUP_RESET_MHZ;
+  STARTUP_mark(STARTUP_BSS);
+  #endif
+
   // C++ Support
   #ifdef __cplusplus
   __libc_init_array();
@@ -1,5 +1,5 @@
 // ===================================================================================
-// Basic System Functions for CH32V003                                        * v1.6 *
+// Basic System Functions for CH32V003                                        * v2.4 *
 // ===================================================================================
 //
 // This file must be included!!! The system configuration and the system clock are 
@@ -33,6 +33,16 @@
 // PLL_setHSI()             set HSI as PLL input (PLL muste be disabled)
 // PLL_setHSE()             set HSE as PLL input (PLL muste be disabled)
 //
+// Clock profiles (with SYS_CLK_PROFILES):
+// CLK_setProfile(p)        switch to CLK_FAST (48MHz, HSI with PLL) or CLK_SLOW (6MHz)
+// CLK_profile              active profile
+// CLK_freq()               current system clock frequency (F_CPU without profiles)
+//
+// The profiles keep SysTick at STK_FREQ = 6MHz (HCLK/8 at 48MHz, HCLK at 6MHz), so
+// all delays, task times and time stamps stay valid across a switch. Peripheral
+// dividers derived from CLK_freq() must be set again after a switch (e.g.
+// I2C_setClock(), UART_setClock()); the joypad engine does this in JOY_clock().
+//
 // MCO_init()               init clock output to pin PC4
 // MCO_setSYS()             output SYS_CLK on pin PC4
 // MCO_setHSI()             output internal oscillator on pin PC4
@@ -45,6 +55,80 @@
 // DLY_us(n)                delay n microseconds
 // DLY_ms(n)                delay n milliseconds
 //
+// Timed task (TSK) functions available:
+// -------------------------------------
+// TSK_after(n, fn, ctx)    call fn(ctx) once in n milliseconds, returns task id
+// TSK_cancel(id)           cancel waiting task
+// TSK_pending(id)          check if task is still waiting
+// TSK_run()                call all tasks that are due
+// TSK_until(t)             wait until SYSTICK count t, running due tasks
+// TSK_delay(n)             delay n milliseconds, running due tasks
+// TSK_idle(t)              like TSK_until(t), but sleeping between the due tasks
+// TSK_next(t)              SYSTICK count the next task is due at (at most t)
+//
+// Tasks are cooperative: they are called from TSK_run() in the main loop (or
+// while waiting in TSK_until/TSK_delay/TSK_idle), never from an interrupt. A task that
+// repeats re-arms itself with TSK_after(). SYS_TASKS sets the number of slots.
+//
+// RAM usage (RAM) functions available:
+// -------------------------------------
+// RAM_stackSize()          bytes of RAM between .bss and the top (stack space)
+// RAM_stackFree()          bytes of stack space never used since startup
+// RAM_stackUsed()          stack high-water mark in bytes since startup
+// RAM_guardOK()            check if the guard words above .bss are intact
+// RAMFUNC                  attribute: run this function from SRAM (.ramfunc)
+//
+// Functions marked RAMFUNC are copied from flash into the .ramfunc section at
+// startup together with .data and run without flash wait states (1 cycle per
+// fetch at 48MHz). Each costs its size in RAM on top of .data/.bss ("make ram"
+// lists them), so it is meant for a few hundred bytes of the hottest loops and
+// interrupt handlers; the drivers offer it as an option (I2C_IN_RAM, ...).
+//
+// With SYS_STACK_PAINT the startup code fills the stack space with RAM_PAINT before
+// main() is called, RAM_stackFree() counts the words that still hold it, starting
+// at the end of .bss. SYS_STACK_GUARD n sets the lowest n of these words aside as
+// guard (and paints as well): TSK_run() calls RAM_overflow() as soon as one of
+// them is overwritten, i.e. while the stack still has n words left before it runs
+// into .bss. RAM_overflow() is weak and spins forever unless the game provides its
+// own. "make ram" lists the static allocations (.data/.bss) and the stack space.
+//
+// Mode overlay arena (ARENA) functions available:
+// -----------------------------------------------
+// ARENA_OVERLAY(m, t, f)   define accessor f() to the arena as type t for mode m
+// ARENA_enter(m)           hand the arena over to mode m, cleared to zero
+// ARENA_mode()             mode the arena belongs to (0: none)
+//
+// The arena is SYS_ARENA_SIZE bytes of RAM (32-bit aligned) that the mutually
+// exclusive modes of a game (title, gameplay, score screen, ...) share for their
+// scratch buffers. Every mode lays its buffers out in a struct or union of its own
+// and gets a typed accessor to it; all overlays start at the beginning of the
+// arena, so the arena only needs to be as big as the largest of them. An overlay
+// that does not fit stops the compiler (negative array size "f_fits_arena"):
+//
+//   enum {MODE_TITLE = 1, MODE_PLAY};
+//   struct title_s {uint8_t text[512];};
+//   struct play_s  {uint8_t frame[1024]; uint16_t sums[16];};
+//   ARENA_OVERLAY(MODE_TITLE, struct title_s, TITLE)
+//   ARENA_OVERLAY(MODE_PLAY,  struct play_s,  PLAY)
+//   ...
+//   ARENA_enter(MODE_PLAY); PLAY()->sums[0] = 1;
+//
+// With SYS_ARENA_CHECK the accessors call ARENA_fault() (weak, spins forever) if
+// they are used while the arena belongs to another mode. Stop any DMA transfer
+// from or into an overlay before leaving its mode.
+//
+// Startup profiler (STARTUP) functions available (with SYS_STARTUP_PROF):
+// ------------------------------------------------------------------------
+// STARTUP_mark(stage)      time stamp the end of a startup stage
+// STARTUP_us[stage]        time stamps in us since reset_handler (0: not reached)
+//
+// The startup code marks STARTUP_DATA (.data and .ramfunc copied), STARTUP_BSS
+// (.bss cleared, stack painted) and STARTUP_CLOCK (system clock and SysTick set
+// up), the application its own stages from STARTUP_USER on (STARTUP_STAGES in
+// all). SysTick is started first thing in reset_handler and counts the reset
+// clock (HSI / 3 = 8MHz) until SYS_init() switches to the system clock. The time
+// from power-up to reset_handler (supply ramp, POR) is not included.
+//
 // Reset (RST) and Bootloader (BOOT) functions available:
 // ------------------------------------------------------
 // BOOT_now()               conduct software reset and jump to bootloader
@@ -87,6 +171,12 @@
 //
 // SLEEP_ms(n)              put device into SLEEP for n milliseconds (uses AWU)
 // STDBY_ms(n)              put device into STANDBY for n milliseconds (uses AWU)
+// SLEEP_until(t)           sleep until SYSTICK count t or the next interrupt
+//
+// SLEEP_until() wakes itself with the SysTick compare interrupt (SYS_TICK_SLEEP),
+// so the time stamps keep running. Any other interrupt ends it early, callers
+// loop on their own condition. Standby stops SysTick and the PLL: after a
+// STDBY_..._now() the clock has to be set up again (CLK_init()) if it uses the PLL.
 //
 // Programmable Voltage Detector (PVD) functions available:
 // --------------------------------------------------------
@@ -107,6 +197,29 @@
 // INT_disable()            global interrupt disable
 // INT_ATOMIC_BLOCK { }     execute block without being interrupted
 //
+// VTF_enable(n, IRQn, fn)  serve interrupt IRQn by handler fn via VTF slot n (0, 1)
+// VTF_disable(n)           serve the interrupt of VTF slot n via vector table again
+//
+// A VTF (vector table free) interrupt jumps straight to the handler address held
+// in its slot instead of fetching it from the vector table in flash first. The
+// hardware prologue (HPE, enabled by the startup code) saves the caller-saved
+// registers in both cases. There are only two slots, so they go to the
+// interrupts that fire most often. A fast handler is an ordinary interrupt
+// handler; keep it short, ideally a leaf function, so the compiler has little
+// else to save:
+//
+//   void TIM1_UP_IRQHandler(void) __attribute__((interrupt));
+//   void TIM1_UP_IRQHandler(void) {
+//     TIM1->INTFR = ~TIM_UIF;                // clear the flag first
+//     ...                                    // few and small calls
+//   }
+//   ...
+//   VTF_enable(1, TIM1_UP_IRQn, TIM1_UP_IRQHandler);
+//   NVIC_EnableIRQ(TIM1_UP_IRQn);
+//
+// The drivers take their slot from an option (-1: vector table), e.g. I2C_VTF in
+// i2c_tx.h for the display and JOY_SND_VTF/JOY_PIN_VTF in joypad.h.
+//
 // References:
 // -----------
 // - CNLohr ch32v003fun: https://github.com/cnlohr/ch32v003fun
@@ -120,17 +233,54 @@
 extern "C" {
 #endif
 
+#include "config.h"                 // options of the firmware (in its src folder)
 #include "ch32v003.h"
 
 // ===================================================================================
 // System Options (set "1" to activate)
 // ===================================================================================
+#ifndef SYS_CLK_INIT
 #define SYS_CLK_INIT      1         // 1: init system clock on startup
+#endif
+#ifndef SYS_TICK_INIT
 #define SYS_TICK_INIT     1         // 1: init and start SYSTICK on startup
+#endif
+#ifndef SYS_GPIO_EN
 #define SYS_GPIO_EN       1         // 1: enable GPIO ports on startup
+#endif
+#ifndef SYS_CLEAR_BSS
 #define SYS_CLEAR_BSS     1         // 1: clear uninitialized variables
+#endif
+#ifndef SYS_USE_VECTORS
 #define SYS_USE_VECTORS   1         // 1: create interrupt vector table
+#endif
+#ifndef SYS_USE_HSE
 #define SYS_USE_HSE       0         // 1: use external crystal
+#endif
+#ifndef SYS_TASKS
+#define SYS_TASKS         4         // number of timed task slots
+#endif
+#ifndef SYS_TICK_SLEEP
+#define SYS_TICK_SLEEP    1         // 1: SLEEP_until() and TSK_idle() sleep (SysTick IRQ)
+#endif
+#ifndef SYS_STARTUP_PROF
+#define SYS_STARTUP_PROF  0         // 1: time stamp the startup stages (STARTUP_us[])
+#endif
+#ifndef SYS_CLK_PROFILES
+#define SYS_CLK_PROFILES  0         // 1: runtime clock profiles 48MHz / 6MHz (F_CPU unused)
+#endif
+#ifndef SYS_STACK_PAINT
+#define SYS_STACK_PAINT   0         // 1: paint stack space on startup (high-water mark)
+#endif
+#ifndef SYS_STACK_GUARD
+#define SYS_STACK_GUARD   0         // n>0: check n guard words above .bss in TSK_run()
+#endif
+#ifndef SYS_ARENA_SIZE
+#define SYS_ARENA_SIZE    0         // bytes of the mode overlay arena (0: no arena)
+#endif
+#ifndef SYS_ARENA_CHECK
+#define SYS_ARENA_CHECK   0         // 1: overlay accessors check the arena's mode
+#endif
 
 // ===================================================================================
 // Sytem Clock Defines
@@ -190,6 +340,23 @@ extern "C" {
   #endif
 #endif
 
+// Clock profiles
+enum {CLK_FAST, CLK_SLOW};
+#if SYS_CLK_PROFILES > 0
+  #if SYS_USE_HSE > 0
+    #error Clock profiles run on the internal oscillator (SYS_USE_HSE must be 0)!
+  #endif
+  #undef  CLK_init
+  #define CLK_init()      CLK_setProfile(CLK_FAST)
+  #define CLK_freq()      ((CLK_profile == CLK_FAST) ? 48000000 : 6000000)
+  #define STK_FREQ        6000000   // SysTick frequency in both profiles
+  extern uint8_t CLK_profile;
+  void CLK_setProfile(uint8_t p);
+#else
+  #define CLK_freq()      (F_CPU)
+  #define STK_FREQ        F_CPU
+#endif
+
 // ===================================================================================
 // System Clock Functions
 // ===================================================================================
@@ -234,13 +401,84 @@ void MCO_init(void);                                    // init clock output to
 // ===================================================================================
 // Delay (DLY) Functions
 // ===================================================================================
+#if SYS_CLK_PROFILES > 0
+#define STK_init()        STK->CTLR = STK_CTLR_STE | ((CLK_profile == CLK_SLOW) ? STK_CTLR_STCLK : 0)
+#else
 #define STK_init()        STK->CTLR = STK_CTLR_STE | STK_CTLR_STCLK // init SYSTICK @ F_CPU
-#define DLY_US_TIME       (F_CPU / 1000000)             // system ticks per us
-#define DLY_MS_TIME       (F_CPU / 1000)                // system ticks per ms
+#endif
+#define DLY_US_TIME       (STK_FREQ / 1000000)          // system ticks per us
+#define DLY_MS_TIME       (STK_FREQ / 1000)             // system ticks per ms
 #define DLY_us(n)         DLY_ticks((n) * DLY_US_TIME)  // delay n microseconds
 #define DLY_ms(n)         DLY_ticks((n) * DLY_MS_TIME)  // delay n milliseconds
 void DLY_ticks(uint32_t n);                             // delay n system ticks
 
+// ===================================================================================
+// Timed Task (TSK) Functions
+// ===================================================================================
+#define TSK_NONE          0xFF                          // no free task slot
+typedef void (*TSK_FUNC)(void* ctx);                    // task function
+uint8_t TSK_after(uint16_t ms, TSK_FUNC fn, void* ctx); // call fn(ctx) in ms milliseconds
+void TSK_cancel(uint8_t id);                            // cancel waiting task
+uint8_t TSK_pending(uint8_t id);                        // check if task is waiting
+void TSK_run(void);                                     // call due tasks
+void TSK_until(uint32_t t);                             // wait until SYSTICK count t
+#define TSK_delay(n)      TSK_until(STK->CNT + (uint32_t)(n) * DLY_MS_TIME)
+void TSK_idle(uint32_t t);                              // sleep until SYSTICK count t
+uint32_t TSK_next(uint32_t t);                          // next due time, at most t
+
+// ===================================================================================
+// RAM Usage (RAM) Functions
+// ===================================================================================
+#define RAM_PAINT         0xA5A5A5A5                    // stack paint pattern
+uint16_t RAM_stackSize(void);                           // stack space in bytes
+uint16_t RAM_stackFree(void);                           // never used stack bytes
+#define RAM_stackUsed()   (RAM_stackSize() - RAM_stackFree())
+uint8_t RAM_guardOK(void);                              // guard words intact?
+void RAM_overflow(void);                                // called if guard is hit
+#define RAMFUNC           __attribute__((section(".ramfunc"), noinline))
+
+#if SYS_STACK_GUARD > 0
+#define RAM_check()       if(!RAM_guardOK()) RAM_overflow()
+#else
+#define RAM_check()
+#endif
+
+// ===================================================================================
+// Mode Overlay Arena (ARENA) Functions
+// ===================================================================================
+#if SYS_ARENA_SIZE > 0
+extern uint32_t ARENA_buf[(SYS_ARENA_SIZE + 3) >> 2];   // the arena, 32-bit aligned
+extern uint8_t  ARENA_active;                           // mode the arena belongs to
+void ARENA_enter(uint8_t mode);                         // hand arena over to mode
+void ARENA_fault(void);                                 // overlay used in wrong mode
+#define ARENA_mode()      (ARENA_active)
+
+#if SYS_ARENA_CHECK > 0
+#define ARENA_CHECK(m)    if(ARENA_active != (m)) ARENA_fault()
+#else
+#define ARENA_CHECK(m)
+#endif
+
+#define ARENA_OVERLAY(m, t, f) \
+  typedef char f##_fits_arena[(sizeof(t) <= sizeof(ARENA_buf)) ? 1 : -1]; \
+  static inline t* f(void) {ARENA_CHECK(m); return (t*)ARENA_buf;}
+#endif
+
+// ===================================================================================
+// Startup Profiler (STARTUP) Functions
+// ===================================================================================
+#define STARTUP_STAGES    8                             // number of time stamps
+#define STARTUP_RESET_MHZ 8                             // SysTick clock after reset
+enum {STARTUP_DATA, STARTUP_BSS, STARTUP_CLOCK, STARTUP_USER};
+
+#if SYS_STARTUP_PROF > 0
+extern uint32_t STARTUP_us[STARTUP_STAGES];             // time stamps in us
+extern uint32_t STARTUP_clk;                            // SysTick count at clock switch
+void STARTUP_mark(uint8_t stage);                       // time stamp end of stage
+#else
+#define STARTUP_mark(stage)
+#endif
+
 // ===================================================================================
 // Reset (RST) Functions
 // ===================================================================================
@@ -309,6 +547,11 @@ void STDBY_WFE_now(void);   // put device into standby (deep sleep), wake up eve
 #define SLEEP_ms(n)           {AWU_start(n); SLEEP_WFE_now(); AWU_stop();}
 #define STDBY_ms(n)           {AWU_start(n); STDBY_WFE_now(); AWU_stop();}
 
+void SLEEP_until(uint32_t t); // sleep until SYSTICK count t or the next interrupt
+#if SYS_TICK_SLEEP > 0
+void SysTick_Handler(void) __attribute__((interrupt));
+#endif
+
 // ===================================================================================
 // Programmable Voltage Detector (PVD) Functions
 // ===================================================================================
@@ -340,6 +583,9 @@ void STDBY_WFE_now(void);   // put device into standby (deep sleep), wake up eve
 #define INT_ATOMIC_BLOCK      for(INT_ATOMIC_RESTORE, __ToDo = 1; __ToDo; __ToDo = 0)
 #define INT_ATOMIC_RESTORE    uint32_t __reg_save __attribute__((__cleanup__(__iRestore))) = __iSave()
 
+#define VTF_enable(n, irq, fn) SetVTFIRQ((uint32_t)(fn), irq, n, ENABLE)
+#define VTF_disable(n)        NVIC->VTFADDR[n] &= ~(uint32_t)1
+
 // Save interrupt status and disable interrupts
 static inline uint32_t __iSave(void) {
   uint32_t result, temp;
@@ -0,0 +1,117 @@
+// ===================================================================================
+// Binary Telemetry Records over UART for CH32V003                            * v1.2 *
+// ===================================================================================
+// 2023 by Stefan Wagner:   https://github.com/wagiminator
+
+#include "telemetry.h"
+
+#if TLM_ENABLE > 0
+
+#include "uart_tx.h"
+#include "prof.h"
+
+uint8_t           TLM_rec[3 + 3 + 2 * 8 + 1]; // record being assembled
+uint8_t           TLM_len;                    // payload bytes in TLM_rec
+uint16_t          TLM_tick;                   // tick number of the next frame record
+volatile uint16_t TLM_dropped;                // records dropped since the last report
+
+// Start record
+static void TLM_begin(uint8_t type) {
+  TLM_rec[0] = TLM_SYNC;
+  TLM_rec[1] = type;
+  TLM_len    = 0;
+}
+
+// Append little-endian value of n bytes
+static void TLM_put(uint32_t v, uint8_t n) {
+  while(n--) {
+    TLM_rec[3 + TLM_len++] = v;
+    v >>= 8;
+  }
+}
+
+// Add checksum and queue record, report earlier drops first
+static void TLM_send(void) {
+  uint8_t i, sum;
+  TLM_rec[2] = TLM_len;
+  sum = TLM_rec[1] + TLM_len;
+  for(i=0; i<TLM_len; i++) sum += TLM_rec[3 + i];
+  TLM_rec[3 + TLM_len] = sum;
+  if(TLM_dropped) {
+    uint8_t d[6] = {TLM_SYNC, TLM_DROP, 2, TLM_dropped, TLM_dropped >> 8};
+    d[5] = TLM_DROP + 2 + d[3] + d[4];
+    if(UART_write(d, 6)) TLM_dropped = 0;
+    else {
+      TLM_dropped++;
+      return;
+    }
+  }
+  if(!UART_write(TLM_rec, TLM_len + 4)) TLM_dropped++;
+}
+
+// Init UART, send info record
+void TLM_init(void) {
+  UART_init();
+  INT_ATOMIC_BLOCK {
+    TLM_begin(TLM_INFO);
+    TLM_put(STK_FREQ, 4);
+    TLM_put(TLM_TIME_SHIFT, 1);
+    TLM_put((PROF_ENABLE > 0) ? PROF_PHASES : 0, 1);
+    TLM_send();
+  }
+}
+
+// Frame record: tick number, rendered flag, phase times
+void TLM_frame(uint8_t rendered, const uint32_t* t, uint8_t n) {
+  INT_ATOMIC_BLOCK {
+    TLM_begin(TLM_FRAME);
+    TLM_put(TLM_tick++, 2);
+    TLM_put(rendered, 1);
+    if(n > 8) n = 8;
+    while(n--) {
+      uint32_t v = *t++ >> TLM_TIME_SHIFT;
+      TLM_put((v > 0xFFFF) ? 0xFFFF : v, 2);
+    }
+    TLM_send();
+  }
+  #if SYS_STACK_PAINT > 0 || SYS_STACK_GUARD > 0
+  if(!(TLM_tick & 0xFF)) TLM_counter(TLM_ID_STACK, RAM_stackUsed());
+  #endif
+}
+
+// Input record
+void TLM_input(uint8_t type, uint8_t dirs, uint32_t time) {
+  INT_ATOMIC_BLOCK {
+    TLM_begin(TLM_INPUT);
+    TLM_put(type, 1);
+    TLM_put(dirs, 1);
+    TLM_put(time >> TLM_TIME_SHIFT, 4);
+    TLM_send();
+  }
+}
+
+// Counter record
+void TLM_counter(uint8_t id, uint32_t value) {
+  INT_ATOMIC_BLOCK {
+    TLM_begin(TLM_COUNTER);
+    TLM_put(id, 1);
+    TLM_put(value, 4);
+    TLM_send();
+  }
+}
+
+// Startup records: stage and time stamp of every stage that was reached
+void TLM_startup(const uint32_t* us, uint8_t n) {
+  uint8_t i;
+  for(i=0; i<n; i++) {
+    if(!us[i]) continue;
+    INT_ATOMIC_BLOCK {
+      TLM_begin(TLM_STARTUP);
+      TLM_put(i, 1);
+      TLM_put(us[i], 4);
+      TLM_send();
+    }
+  }
+}
+
+#endif
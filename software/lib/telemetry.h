@@ -0,0 +1,91 @@
+// ===================================================================================
+// Binary Telemetry Records over UART for CH32V003                            * v1.5 *
+// ===================================================================================
+//
+// Streams frame timings, input events and game state counters as compact binary
+// records via the non-blocking UART driver (uart_tx). Under load records are
+// dropped, never waited for; the number of dropped records is reported in a
+// TLM_DROP record as soon as there is room again. Every record is framed as
+//
+//   0xA5, type, len, payload[len], sum       sum = type + len + payload (mod 256)
+//
+// all multi-byte values little-endian, times in SysTick counts >> TLM_TIME_SHIFT:
+//
+//   TLM_INFO     u32 STK_FREQ, u8 TLM_TIME_SHIFT, u8 phases    (sent by TLM_init)
+//   TLM_FRAME    u16 tick, u8 rendered, u16 phase time[n]   (n = 0 w/o profiler)
+//   TLM_INPUT    u8 event type, u8 dirs, u32 time
+//   TLM_COUNTER  u8 id, u32 value
+//   TLM_DROP     u16 number of records dropped before this one
+//   TLM_BENCH    benchmark result, see bench.h
+//   TLM_SEED, TLM_RUNS, TLM_HASH   input recording and frame hashes, see replay.h
+//   TLM_STARTUP  u8 stage, u32 time stamp in us since reset (SYS_STARTUP_PROF)
+//
+// With SYS_STACK_PAINT (system.h) every 256th frame record is followed by the
+// stack high-water mark as counter TLM_ID_STACK. Drivers with grayscale send the
+// bitplane frames of the last second as counter TLM_ID_GRAY. The profiler sends the
+// failures and recoveries of the display bus as TLM_ID_BUS_ERR and TLM_ID_BUS_REC,
+// the latency meter its results as TLM_ID_LAT_MIN.._LOST (latency.h), the battery
+// governor a new level and the supply voltage (mV) as TLM_ID_BAT_LEVEL and
+// TLM_ID_BAT_MV (battery.h).
+//
+// software/tools/telemetry_decode.py decodes the stream on the host. All hooks
+// compile to nothing if TLM_ENABLE is 0.
+//
+// Functions available:
+// --------------------
+// TLM_init()                     init UART, send TLM_INFO
+// TLM_frame(rendered, t, n)      end of tick, t: n phase times (or NULL, 0)
+// TLM_input(type, dirs, time)    input event (time in SysTick counts)
+// TLM_counter(id, value)         game state counter
+// TLM_startup(us, n)             n startup time stamps (one record each)
+//
+// 2023 by Stefan Wagner:   https://github.com/wagiminator
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "system.h"
+
+// Telemetry options
+#ifndef TLM_ENABLE
+#define TLM_ENABLE      0         // 1: send telemetry records via UART (PD5)
+#endif
+#ifndef TLM_TIME_SHIFT
+#define TLM_TIME_SHIFT  4         // times are sent in SysTick counts >> this
+#endif
+
+// Record types
+#define TLM_SYNC        0xA5
+enum {TLM_NONE, TLM_INFO, TLM_FRAME, TLM_INPUT, TLM_COUNTER, TLM_DROP, TLM_BENCH,
+      TLM_SEED, TLM_RUNS, TLM_HASH, TLM_STARTUP};
+
+// Counter ids (games may add their own from TLM_ID_USER on)
+enum {TLM_ID_SCORE, TLM_ID_LINES, TLM_ID_LEVEL, TLM_ID_LIVES, TLM_ID_STACK,
+      TLM_ID_GRAY, TLM_ID_BUS_ERR, TLM_ID_BUS_REC, TLM_ID_LAT_MIN, TLM_ID_LAT_AVG,
+      TLM_ID_LAT_P99, TLM_ID_LAT_MAX, TLM_ID_LAT_LOST, TLM_ID_BAT_LEVEL, TLM_ID_BAT_MV,
+      TLM_ID_USER = 16};
+
+#if TLM_ENABLE > 0
+
+void TLM_init(void);
+void TLM_frame(uint8_t rendered, const uint32_t* t, uint8_t n);
+void TLM_input(uint8_t type, uint8_t dirs, uint32_t time);
+void TLM_counter(uint8_t id, uint32_t value);
+void TLM_startup(const uint32_t* us, uint8_t n);
+
+#else
+
+#define TLM_init()
+#define TLM_frame(rendered, t, n)
+#define TLM_input(type, dirs, time)
+#define TLM_counter(id, value)
+#define TLM_startup(us, n)
+
+#endif
+
+#ifdef __cplusplus
+};
+#endif
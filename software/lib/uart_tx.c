@@ -0,0 +1,136 @@
+// ===================================================================================
+// Basic UART Transmit Functions with DMA Ring Buffer for CH32V003            * v1.2 *
+// ===================================================================================
+// 2023 by Stefan Wagner:   https://github.com/wagiminator
+
+#include "uart_tx.h"
+
+uint8_t           UART_buf[UART_BUF_LEN];   // ring buffer
+volatile uint8_t  UART_head;                // write count (free running)
+volatile uint8_t  UART_tail;                // read count (free running)
+volatile uint8_t  UART_dmalen;              // bytes of running DMA transfer (0: idle)
+volatile uint16_t UART_dropped;             // number of dropped writes
+
+#if UART_RX > 0
+uint8_t           UART_rx_buf[UART_RX_LEN]; // receive ring
+volatile uint8_t  UART_rx_head;             // write count (free running)
+volatile uint8_t  UART_rx_tail;             // read count (free running)
+volatile uint32_t UART_rx_time;             // SysTick count of the last received byte
+#endif
+
+// Init USART1 transmitter and DMA channel 4
+void UART_init(void) {
+  // Enable GPIO port D, USART1 and DMA module
+  RCC->APB2PCENR |= RCC_AFIOEN | RCC_IOPDEN | RCC_USART1EN;
+  RCC->AHBPCENR  |= RCC_DMA1EN;
+
+  #if UART_RX > 0
+  // Set pin PD5 (TX/RX) to output, open-drain, 10MHz, multiplex
+  GPIOD->CFGLR = (GPIOD->CFGLR & ~((uint32_t)0b1111<<(5<<2))) | ((uint32_t)0b1101<<(5<<2));
+
+  // Setup USART1: 8N1, half-duplex, DMA requests for TX, interrupt for RX
+  USART1->BRR   = ((CLK_freq() << 1) / UART_BAUD + 1) >> 1;
+  USART1->CTLR3 = USART_CTLR3_DMAT | USART_CTLR3_HDSEL;
+  USART1->CTLR1 = USART_CTLR1_TE | USART_CTLR1_RE | USART_CTLR1_RXNEIE | USART_CTLR1_UE;
+  NVIC_EnableIRQ(USART1_IRQn);
+  #else
+  // Set pin PD5 (TX) to output, push-pull, 10MHz, multiplex
+  GPIOD->CFGLR = (GPIOD->CFGLR & ~((uint32_t)0b1111<<(5<<2))) | ((uint32_t)0b1001<<(5<<2));
+
+  // Setup USART1: 8N1, transmitter only, DMA requests
+  USART1->BRR   = ((CLK_freq() << 1) / UART_BAUD + 1) >> 1;
+  USART1->CTLR3 = USART_CTLR3_DMAT;
+  USART1->CTLR1 = USART_CTLR1_TE | USART_CTLR1_UE;
+  #endif
+
+  // Setup DMA channel 4
+  DMA1_Channel4->PADDR = (uint32_t)&USART1->DATAR;  // peripheral address
+  DMA1_Channel4->CFGR  = DMA_CFG4_MINC              // increment memory address
+                       | DMA_CFG4_DIR               // memory to USART
+                       | DMA_CFG4_TCIE;             // transfer complete interrupt enable
+  DMA1->INTFCR         = DMA_CGIF4;                 // clear interrupt flags
+  NVIC_EnableIRQ(DMA1_Channel4_IRQn);               // enable the DMA IRQ
+}
+
+// Wait until all queued bytes are sent
+void UART_flush(void) {
+  if(!(USART1->CTLR1 & USART_CTLR1_UE)) return;     // not in use
+  while((UART_head != UART_tail) || !(USART1->STATR & USART_STATR_TC));
+}
+
+// Set baud rate for the current system clock
+void UART_setClock(void) {
+  USART1->BRR   = ((CLK_freq() << 1) / UART_BAUD + 1) >> 1;
+}
+
+// Start DMA transfer of the next contiguous chunk (DMA must be idle)
+static void UART_kick(void) {
+  uint8_t used = UART_head - UART_tail;
+  uint8_t pos  = UART_tail & (UART_BUF_LEN - 1);
+  uint8_t len  = UART_BUF_LEN - pos;
+  if(!used) return;
+  if(len > used) len = used;
+  DMA1_Channel4->CFGR &= ~DMA_CFG4_EN;
+  DMA1_Channel4->MADDR = (uint32_t)&UART_buf[pos];
+  DMA1_Channel4->CNTR  = len;
+  UART_dmalen          = len;
+  DMA1_Channel4->CFGR |=  DMA_CFG4_EN;
+}
+
+// Free bytes in ring buffer
+uint8_t UART_free(void) {
+  return UART_BUF_LEN - (uint8_t)(UART_head - UART_tail);
+}
+
+// Queue bytes, returns 0 if they don't fit
+uint8_t UART_write(const uint8_t* buf, uint8_t len) {
+  uint8_t result = 0;
+  INT_ATOMIC_BLOCK {
+    if(UART_free() >= len) {
+      while(len--) UART_buf[UART_head++ & (UART_BUF_LEN - 1)] = *buf++;
+      if(!UART_dmalen) UART_kick();
+      result = 1;
+    }
+    else UART_dropped++;
+  }
+  return result;
+}
+
+// Interrupt service routine: chunk sent, start the next one
+void DMA1_Channel4_IRQHandler(void) __attribute__((interrupt));
+void DMA1_Channel4_IRQHandler(void) {
+  DMA1->INTFCR = DMA_CGIF4;
+  UART_tail   += UART_dmalen;
+  UART_dmalen  = 0;
+  UART_kick();
+}
+
+#if UART_RX > 0
+// Fetch the oldest received byte, returns 0 if there is none
+uint8_t UART_read(uint8_t* b) {
+  if(UART_rx_head == UART_rx_tail) return 0;
+  *b = UART_rx_buf[UART_rx_tail & (UART_RX_LEN - 1)];
+  UART_rx_tail++;
+  return 1;
+}
+
+// Send bytes now and wait until they are out, the receiver is off meanwhile
+void UART_send(const uint8_t* buf, uint8_t len) {
+  UART_flush();
+  USART1->CTLR1 &= ~USART_CTLR1_RE;
+  while(!UART_write(buf, len));
+  UART_flush();
+  USART1->CTLR1 |=  USART_CTLR1_RE;
+}
+
+// Interrupt service routine: byte received (or overrun)
+void USART1_IRQHandler(void) __attribute__((interrupt));
+void USART1_IRQHandler(void) {
+  uint8_t b;
+  (void)USART1->STATR;                              // (STATR, DATAR: clears overrun)
+  b = USART1->DATAR;
+  UART_rx_time = STK->CNT;
+  if((uint8_t)(UART_rx_head - UART_rx_tail) < UART_RX_LEN)
+    UART_rx_buf[UART_rx_head++ & (UART_RX_LEN - 1)] = b;
+}
+#endif
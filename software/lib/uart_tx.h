@@ -0,0 +1,72 @@
+// ===================================================================================
+// Basic UART Transmit Functions with DMA Ring Buffer for CH32V003            * v1.2 *
+// ===================================================================================
+//
+// Functions available:
+// --------------------
+// UART_init()              Init USART1 transmitter (8N1, UART_BAUD) and DMA
+// UART_flush()             Wait until all queued bytes are sent
+// UART_setClock()          Set baud rate again after a system clock switch
+// UART_write(buf, len)     Queue len bytes, returns 0 if they don't fit (dropped)
+// UART_free()              Number of free bytes in the ring buffer
+// UART_dropped             Number of writes dropped since the last reset of it
+//
+// With UART_RX (half-duplex receiver):
+// UART_read(&b)            Fetch the oldest received byte, returns 0 if there is none
+// UART_send(buf, len)      Send bytes now and wait until they are out (receiver off)
+// UART_rx_time             SysTick count of the last received byte
+//
+// UART_write() never waits: the bytes are copied into a ring buffer and DMA channel
+// 4 sends them in the background, one contiguous chunk per transfer. If the buffer
+// can't take all bytes of a write, none of them are queued and UART_dropped is
+// incremented, so a record is either sent completely or not at all.
+//
+// TX pin is PD5 (default mapping), RX is not used. With UART_RX the USART runs in
+// half-duplex mode on PD5 alone (open-drain, one wire to another console, e.g. the
+// link cable of link.h): received bytes are put into a ring of UART_RX_LEN bytes
+// by the RXNE interrupt, UART_send() switches the receiver off while it sends,
+// so a console doesn't read its own bytes back. A full ring drops new bytes.
+//
+// 2023 by Stefan Wagner:   https://github.com/wagiminator
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "system.h"
+
+// UART Parameters
+#ifndef UART_BAUD
+#define UART_BAUD     460800    // baud rate
+#endif
+#ifndef UART_BUF_LEN
+#define UART_BUF_LEN  128       // length of ring buffer (power of 2, max 128)
+#endif
+#ifndef UART_RX
+#if LINK_MODE > 0
+#define UART_RX       1         // (the link cable needs the receiver)
+#else
+#define UART_RX       0         // 0: transmit only, 1: half-duplex with receiver
+#endif
+#endif
+#define UART_RX_LEN   16        // length of receive ring (power of 2)
+
+// UART Functions
+void UART_init(void);                               // init USART1 TX with DMA
+void UART_flush(void);                              // wait until all is sent
+void UART_setClock(void);                           // baud rate for CLK_freq()
+uint8_t UART_write(const uint8_t* buf, uint8_t len); // queue bytes (non-blocking)
+uint8_t UART_free(void);                            // free bytes in ring buffer
+extern volatile uint16_t UART_dropped;              // number of dropped writes
+
+#if UART_RX > 0
+uint8_t UART_read(uint8_t* b);                      // fetch received byte
+void UART_send(const uint8_t* buf, uint8_t len);    // send now, receiver off
+extern volatile uint32_t UART_rx_time;              // time of the last received byte
+#endif
+
+#ifdef __cplusplus
+};
+#endif
@@ -29,6 +29,10 @@
 #include "driver.h"
 #include "spritebank.h"
 
+// Snapshot of the game (SNAP_STATE variables, see snapshot.h)
+#define SNAP_GAME   'A'
+#define SNAP_VER    1
+
 // ===================================================================================
 // Function Prototypes
 // ===================================================================================
@@ -36,7 +40,11 @@ void RsVarNewGame(GROUPE *VAR);
 void PLAYMUSIC(void);
 uint8_t BallMissing(GROUPE *VAR);
 uint8_t CheckLevelEnded(GROUPE *VAR);
+void UpdateBalls(GROUPE *VAR);
 void UpdateBall(GROUPE *VAR);
+void SwapBall(uint8_t i,GROUPE *VAR);
+uint8_t BallsInPlay(GROUPE *VAR);
+void SplitBall(GROUPE *VAR);
 void RecupeBALLPosForSIM(GROUPE *VAR);
 void TestMoveBALL(GROUPE *VAR);
 void SimulMove(uint8_t Sim,GROUPE *VAR);
@@ -48,12 +56,21 @@ uint8_t RecupeYPositionOnGrid(GROUPE *VAR);
 uint8_t CheckCollisionWithTRACKBAR(GROUPE *VAR);
 void WriteBallMove(GROUPE *VAR);
 void Tiny_Flip(uint8_t render0_picture1,GROUPE *VAR);
-uint8_t PannelLevel(uint8_t X,uint8_t Y,GROUPE *VAR);
+void FlipWindow(int16_t X0,int16_t X1,int16_t P0,int16_t P1,GROUPE *VAR);
+void FlipDirty(GROUPE *VAR);
+void DirtyBlock(uint8_t Px,uint8_t Py,GROUPE *VAR);
+void FlipBall(BALLSTATE *B,GROUPE *VAR);
+uint8_t BallShift(BALLSTATE *B);
+void SyncDrawn(GROUPE *VAR);
+void LayerInit(void);
+void LayerUpdate(uint8_t render0_picture1,GROUPE *VAR);
+uint8_t PannelLevel(uint8_t X,uint8_t Y,void *ctx);
 uint8_t Block(uint8_t X,uint8_t Y,GROUPE *VAR);
 uint8_t RecupeDecalageY(uint8_t Valeur);
-uint8_t Ball(uint8_t X,uint8_t Y,GROUPE *VAR);
+uint8_t Ball(uint8_t X,uint8_t Y,BALLSTATE *B);
 uint8_t SplitSpriteDecalageY(uint8_t decalage,uint8_t Input,uint8_t UPorDOWN);
 uint8_t TrackBar(uint8_t X,uint8_t Y,GROUPE *VAR);
+uint8_t CheckCollisionWithTRACKBAR2(GROUPE *VAR);
 uint8_t PannelLive(uint8_t X,uint8_t Y,GROUPE *VAR);
 uint8_t background(uint8_t X,uint8_t Y);
 void LoadLevel(uint8_t Level,GROUPE *VAR);
@@ -64,44 +81,58 @@ void ResetBall(GROUPE *VAR);
 // Main Function
 // ===================================================================================
 int main(void) {
+  static GROUPE VARIABLE SNAP_STATE;
+
 // Setup
   JOY_init();
+  LayerInit();
+  if(JOY_resume(SNAP_GAME, SNAP_VER)) {      // suspended game: straight back in
+    VARIABLE.Coop = 0;                        // (link play isn't suspended)
+    Tiny_Flip(0, &VARIABLE);
+    goto RESUME;
+  }
 
 // Loop
   while(1) {
-    GROUPE VARIABLE;
   NEWGAME:
     Tiny_Flip(1, &VARIABLE);
-    while(!JOY_act_pressed());
+    while(!JOY_act_pressed()) JOY_idle(JOY_IDLE_POLL);
+    JOY_idle_wake();
     RsVarNewGame(&VARIABLE);
+    VARIABLE.Coop = JOY_link_start();
     Tiny_Flip(2,&VARIABLE);
     PLAYMUSIC();
     LoadLevel(VARIABLE.LEVEL - 1, &VARIABLE);
     goto ONE;
   NEXTLEVEL:
-    JOY_sound(60,100);
-    JOY_sound(80,100);
-    JOY_sound(100,100);
-    JOY_sound(120,100);
-    JOY_sound(140,100);
+    JOY_sfx(SFX_NEXTLEVEL);
     if(VARIABLE.LEVELSPEED>8) VARIABLE.LEVELSPEED=VARIABLE.LEVELSPEED - 2;
     Tiny_Flip(2, &VARIABLE);
     JOY_DLY_ms(400);
     ResetVar(&VARIABLE);
     VARIABLE.LEVEL++;
+    VARIABLE.LEVELBCD=BCD_inc(VARIABLE.LEVELBCD);
+    TLM_counter(TLM_ID_LEVEL, VARIABLE.LEVEL);
     goto ONE;
   RESTARTLEVEL:
-    JOY_sound(200,100);
-    JOY_sound(150,100);
-    JOY_sound(100,100);
-    JOY_sound(50,100);
-    if(VARIABLE.live > 0) VARIABLE.live--;
-    else goto NEWGAME;
+    JOY_sfx(SFX_LOST);
+    if(VARIABLE.live > 0) {
+      VARIABLE.live--;
+      TLM_counter(TLM_ID_LIVES, VARIABLE.live);
+    }
+    else {
+      JOY_link_stop();
+      goto NEWGAME;
+    }
   ONE:
     ResetBall(&VARIABLE);
+    Tiny_Flip(0, &VARIABLE);
+  RESUME:
+    JOY_frame_start();
     while(1) {
       if(VARIABLE.Frame % 8 == 0) {
-        if(JOY_down_pressed()) {
+        uint8_t Pad = JOY_player_dirs(0);
+        if(Pad & JOY_DOWN) {
           if(VARIABLE.TrackBaryDecal < 7) {
             if(VARIABLE.TrackBaryDecal + (VARIABLE.TrackBary * 8 ) < 44) { 
               VARIABLE.TrackBaryDecal++;
@@ -112,7 +143,7 @@ int main(void) {
             VARIABLE.TrackBary++;
           }
         }
-        if(JOY_up_pressed()) {
+        if(Pad & JOY_UP) {
           if(VARIABLE.TrackBaryDecal > 0) {
             if(VARIABLE.TrackBaryDecal + (VARIABLE.TrackBary * 8) > 4) {
               VARIABLE.TrackBaryDecal--;
@@ -123,14 +154,24 @@ int main(void) {
             VARIABLE.TrackBary--;
           }
         }
-        if((VARIABLE.launch == 0) && (JOY_act_pressed())) VARIABLE.launch = 1;
+        if((VARIABLE.launch == 0) && (JOY_player_act(0))) VARIABLE.launch = 1;
+        if(VARIABLE.Coop) {
+          if(!JOY_linked()) {
+            VARIABLE.Coop = 0;                    // link lost: play on alone
+            FlipWindow(99, 102, 0, 7, &VARIABLE);
+          }
+          Pad = JOY_player_dirs(1);
+          if((Pad & JOY_DOWN) && (VARIABLE.Track2y < 44)) VARIABLE.Track2y++;
+          if((Pad & JOY_UP) && (VARIABLE.Track2y > 4)) VARIABLE.Track2y--;
+          if((VARIABLE.launch == 0) && (JOY_player_act(1))) VARIABLE.launch = 1;
+        }
         if(VARIABLE.launch == 0) {
-          VARIABLE.Ballypos = ((VARIABLE.TrackBary * 8) + VARIABLE.TrackBaryDecal) + 10;
-          VARIABLE.SIMBallypos = VARIABLE.Ballypos;
+          VARIABLE.Balls[0].Pos.y = FX_from(((VARIABLE.TrackBary * 8) + VARIABLE.TrackBaryDecal) + 10);
+          VARIABLE.SIMPos.y = VARIABLE.Balls[0].Pos.y;
         }
       }
-      if((VARIABLE.Frame%VARIABLE.LEVELSPEED == 0)) UpdateBall(&VARIABLE);
-      if(VARIABLE.Frame % 32 == 0) Tiny_Flip(0, &VARIABLE);
+      if((FM_mod_small(VARIABLE.Frame, VARIABLE.LEVELSPEED) == 0)) UpdateBalls(&VARIABLE);
+      if(JOY_frame_render) FlipDirty(&VARIABLE);
       if(VARIABLE.Frame == 48) {
         if(VARIABLE.ANIMREFLECT < 3) VARIABLE.ANIMREFLECT++;
         if(BallMissing(&VARIABLE)) goto RESTARTLEVEL;
@@ -138,7 +179,7 @@ int main(void) {
       }
       if(VARIABLE.Frame < 64) VARIABLE.Frame++;
       else VARIABLE.Frame = 1;
-      JOY_SLOWDOWN();
+      JOY_frame_wait();
     }
   }
 }
@@ -149,8 +190,10 @@ int main(void) {
 void RsVarNewGame(GROUPE *VAR){
 VAR->LEVELSPEED=16;
 VAR->LEVEL=1;
+VAR->LEVELBCD=1;
 VAR->live=3;
 VAR->ANIMREFLECT=0;
+VAR->Frame=1;
 LoadLevel(0,VAR);
 }
 
@@ -159,18 +202,53 @@ for (uint8_t t=0;t<92;t=t+2){
 JOY_sound((Music1[t]),((Music1[t+1])-100));
 }}
 
+// a ball that left the playfield is out of play, the level restarts when all are
 uint8_t BallMissing(GROUPE *VAR){
-if (VAR->Ballxpos<0) {return 1;}
-return 0; 
+uint8_t i;
+for(i=0;i<=MULTI_BALLS;i++){
+if ((VAR->Balls[i].On)&&(VAR->Balls[i].Pos.x<0)) {VAR->Balls[i].On=0;}
+}
+if (VAR->Balls[0].On) {return 0;}
+for(i=1;i<=MULTI_BALLS;i++){
+if (VAR->Balls[i].On) {SwapBall(i,VAR);return 0;}
+}
+return 1; 
 }
 
 uint8_t CheckLevelEnded(GROUPE *VAR){
-uint8_t h,v,res=1;
-for(v=0;v<5;v++){
-for(h=0;h<6;h++){
-if ((VAR->BlocsGrid[h][v]!=255)&&(VAR->BlocsGrid[h][v]!=5)) {res=0;}
-}}
-return res;
+return (VAR->BlocsLeft==0);
+}
+
+// move every ball in play: each one in turn takes the place of Balls[0]
+void UpdateBalls(GROUPE *VAR){
+UpdateBall(VAR);
+for (uint8_t i=1;i<=MULTI_BALLS;i++){
+if (VAR->Balls[i].On) {SwapBall(i,VAR);UpdateBall(VAR);SwapBall(i,VAR);}
+}
+if (VAR->BrickHits>=MULTI_BALL_HITS) {SplitBall(VAR);}
+}
+
+void SwapBall(uint8_t i,GROUPE *VAR){
+BALLSTATE T=VAR->Balls[0];
+VAR->Balls[0]=VAR->Balls[i];
+VAR->Balls[i]=T;
+}
+
+uint8_t BallsInPlay(GROUPE *VAR){
+uint8_t n=0;
+for (uint8_t i=0;i<=MULTI_BALLS;i++) {n+=VAR->Balls[i].On;}
+return n;
+}
+
+// power-up: the extra balls start where the ball is, at other angles
+void SplitBall(GROUPE *VAR){
+VAR->BrickHits=0;
+for (uint8_t i=1;i<=MULTI_BALLS;i++){
+VAR->Balls[i]=VAR->Balls[0];
+VAR->Balls[i].Speed.y=(i&1)?-VAR->Balls[0].Speed.y:FX_half(VAR->Balls[0].Speed.y);
+VAR->Balls[i].DrawnOn=0;
+}
+if (MULTI_BALLS) {JOY_sound(180,30);JOY_sound(240,30);}
 }
 
 void UpdateBall(GROUPE *VAR){
@@ -187,34 +265,32 @@ WriteBallMove(VAR);
 }
 
 void RecupeBALLPosForSIM(GROUPE *VAR){
-VAR->SIMBallxpos=VAR->Ballxpos;
-VAR->SIMBallypos=VAR->Ballypos;
-VAR->SIMBallSpeedx=VAR->BallSpeedx;
-VAR->SIMBallSpeedy=VAR->BallSpeedy;
+VAR->SIMPos=VAR->Balls[0].Pos;
+VAR->SIMSpeed=VAR->Balls[0].Speed;
 }
 
 void TestMoveBALL(GROUPE *VAR){
-VAR->SIMBallxpos=VAR->SIMBallxpos+VAR->SIMBallSpeedx;
-VAR->SIMBallypos=VAR->SIMBallypos+VAR->SIMBallSpeedy;
+FX_move(&VAR->SIMPos,&VAR->SIMSpeed);
 }
 
 void SimulMove(uint8_t Sim,GROUPE *VAR){
 switch(Sim){
-  case (0):VAR->SIMBallSpeedx=VAR->BallSpeedx;VAR->SIMBallSpeedy=VAR->BallSpeedy;break;
-  case (1):VAR->SIMBallSpeedx=-VAR->BallSpeedx;VAR->SIMBallSpeedy=VAR->BallSpeedy;break;
-  case (2):VAR->SIMBallSpeedx=VAR->BallSpeedx;VAR->SIMBallSpeedy=-VAR->BallSpeedy;break;
-  case (3):VAR->SIMBallSpeedx=-VAR->BallSpeedx;VAR->SIMBallSpeedy=-VAR->BallSpeedy;break;
-  case (4):VAR->SIMBallSpeedx=-VAR->BallSpeedy;VAR->SIMBallSpeedy=-VAR->BallSpeedx;break;
-  case (5):VAR->SIMBallxpos=VAR->Ballxpos+1;VAR->SIMBallypos=VAR->Ballypos;VAR->SIMBallSpeedx=-1;VAR->SIMBallSpeedy=1;break;
-  case (6):VAR->SIMBallxpos=VAR->Ballxpos+1;VAR->SIMBallypos=VAR->Ballypos;VAR->SIMBallSpeedx=-1;VAR->SIMBallSpeedy=-1;break;
+  case (0):VAR->SIMSpeed=VAR->Balls[0].Speed;break;
+  case (1):VAR->SIMSpeed=VAR->Balls[0].Speed;FX_reflect_x(&VAR->SIMSpeed);break;
+  case (2):VAR->SIMSpeed=VAR->Balls[0].Speed;FX_reflect_y(&VAR->SIMSpeed);break;
+  case (3):VAR->SIMSpeed=VAR->Balls[0].Speed;FX_reflect_x(&VAR->SIMSpeed);FX_reflect_y(&VAR->SIMSpeed);break;
+  case (4):VAR->SIMSpeed.x=-VAR->Balls[0].Speed.y;VAR->SIMSpeed.y=-VAR->Balls[0].Speed.x;break;
+  case (5):VAR->SIMPos.x=VAR->Balls[0].Pos.x+FX_ONE;VAR->SIMPos.y=VAR->Balls[0].Pos.y;VAR->SIMSpeed.x=-FX_ONE;VAR->SIMSpeed.y=FX_ONE;break;
+  case (6):VAR->SIMPos.x=VAR->Balls[0].Pos.x+FX_ONE;VAR->SIMPos.y=VAR->Balls[0].Pos.y;VAR->SIMSpeed.x=-FX_ONE;VAR->SIMSpeed.y=-FX_ONE;break;
   default:break;
 }}
 
 uint8_t CheckCollisionBall(GROUPE *VAR){
-if (VAR->SIMBallxpos>106) {return 1;}
-if (VAR->SIMBallypos>59) {return 1;}
-if (VAR->SIMBallypos<4) {return 1;}
+if (VAR->SIMPos.x>FX_from(106)) {return 1;}
+if (VAR->SIMPos.y>FX_from(59)) {return 1;}
+if (VAR->SIMPos.y<FX_from(4)) {return 1;}
 if (CheckCollisionWithTRACKBAR(VAR)) {JOY_sound(60,10);return 1;}
+if ((VAR->Coop)&&(CheckCollisionWithTRACKBAR2(VAR))) {JOY_sound(60,10);return 1;}
 if (CheckCollisionWithBLOCK(VAR)) {return 1;}
 return 0;
 }
@@ -222,10 +298,13 @@ return 0;
 uint8_t CheckCollisionWithBLOCK(GROUPE *VAR){
 RecupePositionOnGrid(VAR);
 if ((VAR->Px==255)||(VAR->Py==255)) {return 0;}
+if ((VAR->BlocsAlive[VAR->Py]&(1<<VAR->Px))==0) {return 0;}
 if (VAR->BlocsGrid[VAR->Py][VAR->Px]==5) {JOY_sound(210,50);VAR->ANIMREFLECT=0;return 1;}
-if (VAR->BlocsGrid[VAR->Py][VAR->Px]==255) {return 0;}
 JOY_sound(150,10);
-VAR->BlocsGrid[VAR->Py][VAR->Px]=255;
+VAR->BlocsAlive[VAR->Py]&=~(1<<VAR->Px);
+VAR->BlocsLeft--;
+if (BallsInPlay(VAR)==1) {VAR->BrickHits++;}
+DirtyBlock(VAR->Px,VAR->Py,VAR);
 return 1;
 }
 
@@ -234,105 +313,189 @@ VAR->Px=RecupeXPositionOnGrid(VAR);
 VAR->Py=RecupeYPositionOnGrid(VAR);
 }
 
+// brick cell of the ball: columns 66..95 and rows 8..54 (BRICK_COL, BRICK_ROW)
 uint8_t RecupeXPositionOnGrid(GROUPE *VAR){
-if ((VAR->SIMBallxpos>=66)&&(VAR->SIMBallxpos<72))  return 0;
-else if ((VAR->SIMBallxpos>=72)&&(VAR->SIMBallxpos<78)) return 1;
-else if ((VAR->SIMBallxpos>=78)&&(VAR->SIMBallxpos<84)) return 2;
-else if ((VAR->SIMBallxpos>=84)&&(VAR->SIMBallxpos<90))  return 3;
-else if ((VAR->SIMBallxpos>=90)&&(VAR->SIMBallxpos<96))  return 4;  
-return 255;
+int16_t X=FX_int(VAR->SIMPos.x)-66;
+if ((X<0)||(X>=30)) return 255;
+return BRICK_COL[X];
 }
 
 uint8_t RecupeYPositionOnGrid(GROUPE *VAR){
-if ((VAR->SIMBallypos>=8)&&(VAR->SIMBallypos<16)) return 0;
-else if ((VAR->SIMBallypos>=16)&&(VAR->SIMBallypos<23))  return 1;
-else if ((VAR->SIMBallypos>=23)&&(VAR->SIMBallypos<31))  return 2;
-else if ((VAR->SIMBallypos>=31)&&(VAR->SIMBallypos<40))  return 3;
-else if ((VAR->SIMBallypos>=40)&&(VAR->SIMBallypos<48))  return 4; 
-else if ((VAR->SIMBallypos>=48)&&(VAR->SIMBallypos<55))  return 5;   
-return 255;
+int16_t Y=FX_int(VAR->SIMPos.y)-8;
+if ((Y<0)||(Y>=47)) return 255;
+return BRICK_ROW[Y];
 }
 
 uint8_t CheckCollisionWithTRACKBAR(GROUPE *VAR){
 uint8_t TRACK=(VAR->TrackBary*8)+VAR->TrackBaryDecal;
-if ((VAR->SIMBallxpos>6)||(VAR->SIMBallxpos<5)) {return 0;}
-if (TRACK>VAR->SIMBallypos) {return 0;}
-if ((TRACK+16)<VAR->SIMBallypos) {return 0;}
-VAR->TrackAngleOut=(((VAR->SIMBallypos-TRACK)*200)/16)-100;
+if ((VAR->SIMPos.x>FX_from(6))||(VAR->SIMPos.x<FX_from(5))) {return 0;}
+if (FX_from(TRACK)>VAR->SIMPos.y) {return 0;}
+if (FX_from(TRACK+16)<VAR->SIMPos.y) {return 0;}
+VAR->TrackAngleOut=((VAR->SIMPos.y-FX_from(TRACK))>>3)-FX_ONE;   // -1..+1 px over the paddle
+return 1;
+}
+
+// second paddle (link play) at x 99..102, the mirror image of the first one
+uint8_t CheckCollisionWithTRACKBAR2(GROUPE *VAR){
+uint8_t TRACK=VAR->Track2y;
+if ((VAR->SIMPos.x>FX_from(99))||(VAR->SIMPos.x<FX_from(98))) {return 0;}
+if (FX_from(TRACK)>VAR->SIMPos.y) {return 0;}
+if (FX_from(TRACK+16)<VAR->SIMPos.y) {return 0;}
+VAR->TrackAngleOut=((VAR->SIMPos.y-FX_from(TRACK))>>3)-FX_ONE;
 return 1;
 }
 
 void WriteBallMove(GROUPE *VAR){
-float CORECTIONY=(VAR->SIMBallSpeedy)+(VAR->TrackAngleOut/100.00);
-if (CORECTIONY<-1) {CORECTIONY=-1;}
-if (CORECTIONY>1) {CORECTIONY=1;}
-VAR->Ballxpos=VAR->SIMBallxpos;
-VAR->Ballypos=VAR->SIMBallypos;
-VAR->BallSpeedx=VAR->SIMBallSpeedx;
-VAR->BallSpeedy=CORECTIONY;
-VAR->BALLyDecal=RecupeDecalageY(VAR->Ballypos-1);
-VAR->Ypos=((VAR->Ballypos-1)/8);
+VAR->Balls[0].Pos=VAR->SIMPos;
+VAR->Balls[0].Speed.x=VAR->SIMSpeed.x;
+VAR->Balls[0].Speed.y=FX_clamp(VAR->SIMSpeed.y+VAR->TrackAngleOut,-FX_ONE,FX_ONE);
+VAR->Balls[0].BALLyDecal=RecupeDecalageY(FX_int(VAR->Balls[0].Pos.y)-1);
+VAR->Balls[0].Ypos=((FX_int(VAR->Balls[0].Pos.y)-1)>>3);
 }
 
 void Tiny_Flip(uint8_t render0_picture1,GROUPE *VAR){
-  uint8_t y,x; 
+  uint8_t y; 
+  LayerUpdate(render0_picture1,VAR);
+  if(render0_picture1==1) JOY_OLED_rle_start(MAIN);
+  JOY_OLED_frame_begin();
   for(y = 0; y < 8; y++) { 
     JOY_OLED_data_start(y);
-    for(x = 0; x < 128; x++) {
-      if(render0_picture1==0)
-        JOY_OLED_send(Block(x,y,VAR)|Ball(x,y,VAR)|TrackBar(x,y,VAR)|background(x,y)|PannelLive(x,y,VAR)|PannelLevel(x,y,VAR));
-      else if(render0_picture1==1)
-        JOY_OLED_send((MAIN[x+(y*128)]));
-      else if(render0_picture1==2)
-        JOY_OLED_send(background(x,y));
+    if(render0_picture1==1) {
+      JOY_OLED_rle_page(128);
     }
+    else JOY_OLED_compose(y,0,127,VAR);
+    JOY_OLED_end();
+  }
+  JOY_OLED_frame_end();
+  if(render0_picture1==0) SyncDrawn(VAR);
+}
+
+// flip a window of the game screen, clipped to the screen
+void FlipWindow(int16_t X0,int16_t X1,int16_t P0,int16_t P1,GROUPE *VAR){
+  uint8_t y;
+  if(X0<0) X0=0;
+  if(X1>127) X1=127;
+  if(P0<0) P0=0;
+  if(P1>7) P1=7;
+  if((X0>X1)||(P0>P1)) return;
+  LayerUpdate(0,VAR);
+  JOY_OLED_window_begin(X0,X1,P0,P1);
+  for(y = P0; y <= P1; y++) {
+    JOY_OLED_data_start(y);
+    JOY_OLED_compose(y,X0,X1,VAR);
     JOY_OLED_end();
   }
+  JOY_OLED_frame_end();
+}
+
+// flip what changed since the last flip: the old and new footprint of each
+// ball, the old and new paddle span and the brick cells that were hit
+void FlipDirty(GROUPE *VAR){
+  uint8_t TRACK=(VAR->TrackBary*8)+VAR->TrackBaryDecal;
+  if(VAR->ANIMREFLECT!=VAR->DrawnReflect) {
+    VAR->DirtyX0=67;VAR->DirtyX1=96;VAR->DirtyP0=1;VAR->DirtyP1=6;
+  }
+  if(VAR->DirtyX0<=VAR->DirtyX1) FlipWindow(VAR->DirtyX0,VAR->DirtyX1,VAR->DirtyP0,VAR->DirtyP1,VAR);
+  for(uint8_t i=0;i<=MULTI_BALLS;i++) FlipBall(&VAR->Balls[i],VAR);
+  if(TRACK!=VAR->DrawnTrack) {
+    FlipWindow(3,6,((TRACK<VAR->DrawnTrack)?TRACK:VAR->DrawnTrack)>>3,(((TRACK>VAR->DrawnTrack)?TRACK:VAR->DrawnTrack)+15)>>3,VAR);
+  }
+  TRACK=VAR->Track2y;
+  if(VAR->Coop&&(TRACK!=VAR->DrawnTrack2)) {
+    FlipWindow(99,102,((TRACK<VAR->DrawnTrack2)?TRACK:VAR->DrawnTrack2)>>3,(((TRACK>VAR->DrawnTrack2)?TRACK:VAR->DrawnTrack2)+15)>>3,VAR);
+  }
+  SyncDrawn(VAR);
+}
+
+// flip the footprint of a ball where it was last drawn and where it is now
+void FlipBall(BALLSTATE *B,GROUPE *VAR){
+  int16_t BX=FX_int(B->Pos.x)-1;
+  int16_t X0=127,X1=0,P0=7,P1=0;
+  if(B->On==B->DrawnOn) {
+    if(!B->On) return;
+    if((BX==B->DrawnBallx)&&(B->Ypos==B->DrawnYpos)&&(BallShift(B)==B->DrawnShift)) return;
+  }
+  if(B->On) {X0=BX;X1=BX+3;P0=B->Ypos;P1=B->Ypos+1;}
+  if(B->DrawnOn) {
+    if(B->DrawnBallx<X0) X0=B->DrawnBallx;
+    if(B->DrawnBallx+3>X1) X1=B->DrawnBallx+3;
+    if(B->DrawnYpos<P0) P0=B->DrawnYpos;
+    if(B->DrawnYpos+1>P1) P1=B->DrawnYpos+1;
+  }
+  FlipWindow(X0,X1,P0,P1,VAR);
+}
+
+// brick Px/Py of BlocsGrid has changed (Block() draws row Py in page Py+1)
+void DirtyBlock(uint8_t Px,uint8_t Py,GROUPE *VAR){
+  uint8_t X0=67+(Px*6);
+  if(VAR->DirtyX0>VAR->DirtyX1) {
+    VAR->DirtyX0=X0;VAR->DirtyX1=X0+5;VAR->DirtyP0=Py+1;VAR->DirtyP1=Py+1;
+    return;
+  }
+  if(X0<VAR->DirtyX0) VAR->DirtyX0=X0;
+  if(X0+5>VAR->DirtyX1) VAR->DirtyX1=X0+5;
+  if(Py+1<VAR->DirtyP0) VAR->DirtyP0=Py+1;
+  if(Py+1>VAR->DirtyP1) VAR->DirtyP1=Py+1;
+}
+
+// vertical shift of the ball sprite as Ball() draws it (0: not shifted)
+uint8_t BallShift(BALLSTATE *B){
+  if(B->BALLyDecal==0) return 0;
+  return RecupeDecalageY(FX_int(B->Pos.y)-1)|8;
+}
+
+void SyncDrawn(GROUPE *VAR){
+  for(uint8_t i=0;i<=MULTI_BALLS;i++) {
+    BALLSTATE *B=&VAR->Balls[i];
+    B->DrawnOn=B->On;
+    B->DrawnBallx=FX_int(B->Pos.x)-1;
+    B->DrawnYpos=B->Ypos;
+    B->DrawnShift=BallShift(B);
+  }
+  VAR->DrawnTrack=(VAR->TrackBary*8)+VAR->TrackBaryDecal;
+  VAR->DrawnReflect=VAR->ANIMREFLECT;
+  VAR->DrawnTrack2=VAR->Track2y;
+  VAR->DirtyX0=255;VAR->DirtyX1=0;
 }
 
-uint8_t PannelLevel(uint8_t X,uint8_t Y,GROUPE *VAR){
-if ((Y<5)||(Y>6)||(X<117)||(X>123)) return 0x00;
-#define VAl10 (VAR->LEVEL/10)
-#define VAl01 (VAR->LEVEL-(VAl10*10))
+// (PannelLevel and Block are only called within their layer boxes)
+uint8_t PannelLevel(uint8_t X,uint8_t Y,void *ctx){
+GROUPE *VAR=(GROUPE*)ctx;
+#define VAl10 BCD_digit(VAR->LEVELBCD,1)
+#define VAl01 BCD_digit(VAR->LEVELBCD,0)
 if (Y==5) {return ((DIGITAL[(X-117)+(VAl10*7)]));}
 else if (Y==6) {return ((DIGITAL[(X-117)+(VAl01*7)]));}
 return 0x00;
 }
 
 uint8_t Block(uint8_t X,uint8_t Y,GROUPE *VAR){
-uint8_t XValue=255;
-if ((X>=67)&&(X<97)&&(Y>=1)&&(Y<=6)) {
-if ((X>=67)&&(X<73)) XValue=0;
-else if ((X>=73)&&(X<79)) XValue=1;
-else if ((X>=79)&&(X<85)) XValue=2;
-else if ((X>=85)&&(X<91)) XValue=3;
-else if ((X>=91)&&(X<97)) XValue=4;
-if (XValue==255) return 0x00;
-//uint8_t XValue=((X-67)/6);
-if (VAR->BlocsGrid[(Y-1)][XValue]==255) return 0x00;
-if (VAR->BlocsGrid[(Y-1)][XValue]==5) {return (BLOCKREFLECT[((X-67)-(XValue*6))+(VAR->ANIMREFLECT*6)])|(BLOCK[((X-67)-(XValue*6))+((VAR->BlocsGrid[(Y-1)][XValue])*6)]);}
-return (BLOCK[((X-67)-(XValue*6))+((VAR->BlocsGrid[(Y-1)][XValue])*6)]);
-}return 0x00;}
+uint8_t XValue=BRICK_COL[X-67];
+if ((VAR->BlocsAlive[Y-1]&(1<<XValue))==0) return 0x00;
+uint8_t TYPE=VAR->BlocsGrid[(Y-1)][XValue];
+uint8_t XOFS=(X-67)-(XValue*6);
+if (TYPE==5) {return (BLOCKREFLECT[XOFS+(VAR->ANIMREFLECT*6)])|(BLOCK[XOFS+(TYPE*6)]);}
+return (BLOCK[XOFS+(TYPE*6)]);
+}
 
 uint8_t RecupeDecalageY(uint8_t Valeur){
 while(Valeur>7){Valeur=Valeur-8;}
 return Valeur;
 }
 
-uint8_t Ball(uint8_t X,uint8_t Y,GROUPE *VAR){
-#define BALLXPOS (VAR->Ballxpos-1)
-#define BALLYPOS (VAR->Ballypos-1)
- if (Y<VAR->Ypos) return 0x00;
- if (Y>(VAR->Ypos+1)) return 0x00;
+uint8_t Ball(uint8_t X,uint8_t Y,BALLSTATE *B){
+#define BALLXPOS (FX_int(B->Pos.x)-1)
+#define BALLYPOS (FX_int(B->Pos.y)-1)
+ if (Y<B->Ypos) return 0x00;
+ if (Y>(B->Ypos+1)) return 0x00;
  if ((X-(uint8_t)(BALLXPOS))<0) return 0x00;
  if (X<BALLXPOS) return 0x00;
  if (X>BALLXPOS+2) return 0x00;
-if (VAR->BALLyDecal==0)  {
-if (Y==VAR->Ypos ) {return ((BALL[(X-(uint8_t)(BALLXPOS))]));}
+if (B->BALLyDecal==0)  {
+if (Y==B->Ypos ) {return ((BALL[(X-(uint8_t)(BALLXPOS))]));}
   }else{
 uint8_t DECAL=RecupeDecalageY(BALLYPOS);
-if (Y==VAR->Ypos) { return SplitSpriteDecalageY(DECAL,(BALL[(X-(uint8_t)(BALLXPOS))]),1);}
-if (Y==(VAR->Ypos)+1) { return SplitSpriteDecalageY(DECAL,(BALL[(X-(uint8_t)(BALLXPOS))]),0);}
+if (Y==B->Ypos) { return SplitSpriteDecalageY(DECAL,(BALL[(X-(uint8_t)(BALLXPOS))]),1);}
+if (Y==(B->Ypos)+1) { return SplitSpriteDecalageY(DECAL,(BALL[(X-(uint8_t)(BALLXPOS))]),0);}
 }return 0x00;}
 
 uint8_t SplitSpriteDecalageY(uint8_t decalage,uint8_t Input,uint8_t UPorDOWN){
@@ -381,11 +544,103 @@ return ((back_RIGHT[(X-106)+(Y*22)]));
 return 0x00;
 }
 
+enum {L_STATIC=0,L_BALL,L_TRACKBAR,L_BACKGROUND,L_LIVE,L_TRACKBAR2};
+
+void LayerBlock(uint8_t *buf,uint8_t x0,uint8_t x1,uint8_t Y,void *ctx){
+if (((GROUPE*)ctx)->BlocsAlive[Y-1]==0) return;   // (layer is on pages 1..6)
+for(;x0<=x1;x0++) *buf++|=Block(x0,Y,(GROUPE*)ctx);
+}
+
+void LayerBall(uint8_t *buf,uint8_t x0,uint8_t x1,uint8_t Y,void *ctx){
+GROUPE *VAR=(GROUPE*)ctx;
+for(uint8_t i=0;i<=MULTI_BALLS;i++){
+if (VAR->Balls[i].On) {for(uint8_t x=0;x<=x1-x0;x++) buf[x]|=Ball(x0+x,Y,&VAR->Balls[i]);}
+}}
+
+void LayerTrackBar(uint8_t *buf,uint8_t x0,uint8_t x1,uint8_t Y,void *ctx){
+for(;x0<=x1;x0++) *buf++|=TrackBar(x0,Y,(GROUPE*)ctx);
+}
+
+// the 16 pixels of a paddle column, shifted down to the pixel and mirrored
+void LayerTrackBar2(uint8_t *buf,uint8_t x0,uint8_t x1,uint8_t Y,void *ctx){
+uint8_t TRACK=((GROUPE*)ctx)->Track2y;
+uint8_t S=(Y<<3)-TRACK+8;               // (bit of page Y in the shifted column + 8)
+for(;x0<=x1;x0++){
+uint32_t COL=((uint32_t)TRACKBAR[102-x0]|((uint32_t)TRACKBAR[106-x0]<<8))<<8;
+*buf++|=(S<32)?(COL>>S):0;
+}}
+
+void LayerBackground(uint8_t *buf,uint8_t x0,uint8_t x1,uint8_t Y,void *ctx){
+SWIFT_TEXTURE=FM_mod_small(x0,15);      // (texture phase of column x0 in any window)
+for(;x0<=x1;x0++) *buf++|=background(x0,Y);
+}
+
+void LayerPannelLive(uint8_t *buf,uint8_t x0,uint8_t x1,uint8_t Y,void *ctx){
+for(;x0<=x1;x0++) *buf++|=PannelLive(x0,Y,(GROUPE*)ctx);
+}
+
+uint8_t LevelCache[14];
+BCD_HUD LevelHUD={BCD_NONE,117,7,5,6,LevelCache};
+
+void LayerPannelLevel(uint8_t *buf,uint8_t x0,uint8_t x1,uint8_t Y,void *ctx){
+BCD_HUD_span(&LevelHUD,((GROUPE*)ctx)->LEVELBCD,buf,x0,x1,Y,PannelLevel,ctx);
+}
+
+// bricks and level never move: one static layer set (see oled_layer.h)
+#define STATIC_LAYERS(L,y) \
+  L(y,LayerBlock,67,96,1,6) \
+  L(y,LayerPannelLevel,117,123,5,6)
+JOY_LAYER_STATIC(LayerStatic,STATIC_LAYERS)
+
+void LayerInit(void){
+JOY_LAYER_add(L_STATIC,LayerStatic);
+JOY_LAYER_add(L_BALL,LayerBall);
+JOY_LAYER_add(L_TRACKBAR,LayerTrackBar);
+JOY_LAYER_add(L_BACKGROUND,LayerBackground);
+JOY_LAYER_add(L_LIVE,LayerPannelLive);
+JOY_LAYER_add(L_TRACKBAR2,LayerTrackBar2);
+JOY_LAYER_set(L_BACKGROUND,0,127,0,7);
+}
+
+// set bounding boxes of the layers (background only if not in game)
+void LayerUpdate(uint8_t render0_picture1,GROUPE *VAR){
+if (render0_picture1!=0) {
+JOY_LAYER_hide(L_STATIC);
+JOY_LAYER_hide(L_BALL);
+JOY_LAYER_hide(L_TRACKBAR);
+JOY_LAYER_hide(L_LIVE);
+JOY_LAYER_hide(L_TRACKBAR2);
+return;
+}
+JOY_LAYER_set(L_STATIC,67,123,1,6);
+int16_t X0=127,X1=0,P0=7,P1=0;
+for(uint8_t i=0;i<=MULTI_BALLS;i++){
+BALLSTATE *B=&VAR->Balls[i];
+if ((i>0)&&(!B->On)) continue;
+if (FX_int(B->Pos.x)-1<X0) X0=FX_int(B->Pos.x)-1;
+if (FX_int(B->Pos.x)+2>X1) X1=FX_int(B->Pos.x)+2;
+if (B->Ypos<P0) P0=B->Ypos;
+if (B->Ypos+1>P1) P1=B->Ypos+1;
+}
+JOY_LAYER_set(L_BALL,X0,X1,P0,P1);
+JOY_LAYER_set(L_TRACKBAR,3,6,VAR->TrackBary,VAR->TrackBary+2);
+JOY_LAYER_set(L_LIVE,119,121,1,VAR->live);
+if (VAR->Coop) {JOY_LAYER_set(L_TRACKBAR2,99,102,VAR->Track2y>>3,(VAR->Track2y+15)>>3);}
+else {JOY_LAYER_hide(L_TRACKBAR2);}
+}
+
 void LoadLevel(uint8_t Level,GROUPE *VAR){
 uint8_t a,b;
 for(b=0;b<5;b++){
 for(a=0;a<6;a++){
 VAR->BlocsGrid[a][b]=(LEVEL[(Level*30)+b+(a*5)]);
+}}
+VAR->BlocsLeft=0;
+for(a=0;a<6;a++){
+VAR->BlocsAlive[a]=0;
+for(b=0;b<5;b++){
+if (VAR->BlocsGrid[a][b]!=255) {VAR->BlocsAlive[a]|=1<<b;}
+if ((VAR->BlocsGrid[a][b]!=255)&&(VAR->BlocsGrid[a][b]!=5)) {VAR->BlocsLeft++;}
 }}}
 
 void ResetVar(GROUPE *VAR){
@@ -398,18 +653,21 @@ void ResetBall(GROUPE *VAR){
 VAR->ANIMREFLECT=0;
 VAR->TrackBary=2;
 VAR->TrackBaryDecal=4;
-VAR->Ballxpos=8;
-VAR->SIMBallxpos=8;
-VAR->Ballypos=32;
-VAR->SIMBallypos=32;
-VAR->BallSpeedx=1;
-VAR->SIMBallSpeedx=1;
+VAR->Track2y=20;
+VAR->Balls[0].Pos.x=FX_from(8);
+VAR->Balls[0].Pos.y=FX_from(32);
+VAR->Balls[0].Speed.x=FX_ONE;
 if (VAR->Frame>32) {
-VAR->BallSpeedy=.41;
-VAR->SIMBallSpeedy=.41;
+VAR->Balls[0].Speed.y=FX_const(.41);
 }else{
-VAR->BallSpeedy=.47;
-VAR->SIMBallSpeedy=.47;  
+VAR->Balls[0].Speed.y=FX_const(.47);
 }
+VAR->SIMPos=VAR->Balls[0].Pos;
+VAR->SIMSpeed=VAR->Balls[0].Speed;
+VAR->Balls[0].BALLyDecal=RecupeDecalageY(FX_int(VAR->Balls[0].Pos.y)-1);
+VAR->Balls[0].Ypos=((FX_int(VAR->Balls[0].Pos.y)-1)>>3);
+VAR->Balls[0].On=1;
+for (uint8_t i=1;i<=MULTI_BALLS;i++) {VAR->Balls[i].On=0;}
+VAR->BrickHits=0;
 VAR->launch=0;
 }
@@ -0,0 +1,25 @@
+// Glyph tables of this firmware for glyph.c, generated by tools/glyph_subset.py
+// from font_5x8.h - do not edit, run "make glyphs" instead
+// 12 of 96 glyphs in 2 runs, 66 instead of 484 bytes:
+// /0123456789S
+
+#pragma once
+
+#include <stdint.h>
+
+const uint8_t GLYPH_runs[] = { 47, 11, 83, 1, 0, 0 };
+
+const uint8_t GLYPH_font[] = {
+  0x20, 0x10, 0x08, 0x04, 0x02,  // /
+  0x3E, 0x51, 0x49, 0x45, 0x3E,  // 0
+  0x00, 0x42, 0x7F, 0x40, 0x00,  // 1
+  0x42, 0x61, 0x51, 0x49, 0x46,  // 2
+  0x21, 0x41, 0x45, 0x4B, 0x31,  // 3
+  0x18, 0x14, 0x12, 0x7F, 0x10,  // 4
+  0x27, 0x45, 0x45, 0x45, 0x39,  // 5
+  0x3C, 0x4A, 0x49, 0x49, 0x30,  // 6
+  0x01, 0x71, 0x09, 0x05, 0x03,  // 7
+  0x36, 0x49, 0x49, 0x49, 0x36,  // 8
+  0x06, 0x49, 0x49, 0x29, 0x1E,  // 9
+  0x46, 0x49, 0x49, 0x49, 0x31,  // S
+};
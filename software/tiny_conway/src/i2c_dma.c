@@ -1,13 +1,67 @@
 // ===================================================================================
-// Basic I2C Master Functions with DMA for TX for CH32V003                    * v1.0 *
+// Basic I2C Master Functions with DMA for TX for CH32V003                    * v1.4 *
 // ===================================================================================
 // 2023 by Stefan Wagner:   https://github.com/wagiminator
 
 #include "i2c_dma.h"
 
+// Hot functions, run from SRAM if enabled
+#if I2C_IN_RAM > 0
+  #define I2C_HOT     RAMFUNC
+#else
+  #define I2C_HOT
+#endif
+
+// Pins of the bus (for the recovery)
+#if I2C_MAP == 1
+  #define I2C_GPIO    GPIOD
+  #define I2C_SDA     0
+  #define I2C_SCL     1
+#elif I2C_MAP == 2
+  #define I2C_GPIO    GPIOC
+  #define I2C_SDA     6
+  #define I2C_SCL     5
+#else
+  #define I2C_GPIO    GPIOC
+  #define I2C_SDA     1
+  #define I2C_SCL     2
+#endif
+
 // Read/write flag
 uint8_t I2C_rwflag;
 
+// Bus failures
+volatile uint8_t  I2C_error;                      // 1: bus has failed
+volatile uint16_t I2C_errors;                     // number of bus failures
+uint16_t          I2C_recoveries;                 // number of bus recoveries
+
+// Progress watch of a wait
+typedef struct {
+  uint32_t since;                                 // SysTick count of the last progress
+  uint32_t mark;                                  // DMA count seen then
+} I2C_WATCH;
+
+// Check wait for timeout, returns 1 if the bus has failed
+static uint8_t I2C_expired(I2C_WATCH* w) {
+  uint32_t now = STK->CNT;
+  if(I2C_error) return 1;
+  if(w->mark != DMA1_Channel6->CNTR) {            // first check or progress?
+    w->mark  = DMA1_Channel6->CNTR;
+    w->since = now;
+    return 0;
+  }
+  if((now - w->since) < (uint32_t)I2C_TIMEOUT * DLY_US_TIME) return 0;
+  I2C1->CTLR2         &= ~I2C_CTLR2_DMAEN;        // give up: disable DMA request
+  DMA1_Channel6->CFGR &= ~DMA_CFG6_EN;            // disable DMA channel
+  DMA1->INTFCR         = DMA_CGIF6;               // clear interrupt flags
+  I2C_error = 1;
+  I2C_errors++;
+  return 1;
+}
+
+// Wait until cond is true, give up after I2C_TIMEOUT us without progress
+#define I2C_until(cond) for(I2C_WATCH w_ = {0, 0xFFFFFFFF}; !(cond) && !I2C_expired(&w_); )
+
 // Init I2C
 void I2C_init(void) {
   // Setup GPIO pins
@@ -57,20 +111,23 @@ void I2C_init(void) {
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wunused-variable"
 void I2C_start(uint8_t addr) {
-  while(I2C1->STAR2 & I2C_STAR2_BUSY);            // wait until bus ready
+  I2C_rwflag = addr & 1;                          // set read/write flag
+  I2C_until(!(I2C1->STAR2 & I2C_STAR2_BUSY));     // wait until bus ready
+  if(I2C_error) return;                           // (bus has failed)
   I2C1->CTLR1 |= I2C_CTLR1_START                  // set START condition
                | I2C_CTLR1_ACK;                   // set ACK
-  while(!(I2C1->STAR1 & I2C_STAR1_SB));           // wait for START generated
+  I2C_until(I2C1->STAR1 & I2C_STAR1_SB);          // wait for START generated
+  if(I2C_error) return;
   I2C1->DATAR = addr;                             // send slave address + R/W bit
-  while(!(I2C1->STAR1 & I2C_STAR1_ADDR));         // wait for address transmitted
+  I2C_until(I2C1->STAR1 & I2C_STAR1_ADDR);        // wait for address transmitted
   uint16_t reg = I2C1->STAR2;                     // clear flags
-  I2C_rwflag = addr & 1;                          // set read/write flag
 }
 #pragma GCC diagnostic pop
 
 // Send data byte via I2C bus
-void I2C_write(uint8_t data) {
-  while(!(I2C1->STAR1 & I2C_STAR1_TXE));          // wait for last byte transmitted
+I2C_HOT void I2C_write(uint8_t data) {
+  I2C_until(I2C1->STAR1 & I2C_STAR1_TXE);         // wait for last byte transmitted
+  if(I2C_error) return;                           // (bus has failed)
   I2C1->DATAR = data;                             // send data byte
 }
 
@@ -80,32 +137,82 @@ uint8_t I2C_read(uint8_t ack) {
     I2C1->CTLR1 &= ~I2C_CTLR1_ACK;                // -> set NAK
     I2C1->CTLR1 |=  I2C_CTLR1_STOP;               // -> set STOP condition
   }
-  while(!(I2C1->STAR1 & I2C_STAR1_RXNE));         // wait for data byte received
+  I2C_until(I2C1->STAR1 & I2C_STAR1_RXNE);        // wait for data byte received
   return I2C1->DATAR;                             // return received data byte
 }
 
 // Stop I2C transmission
 void I2C_stop(void) {
   if(!I2C_rwflag) {                               // only if not already stopped
-    while(!(I2C1->STAR1 & I2C_STAR1_BTF));        // wait for last byte transmitted
-    I2C1->CTLR1 |= I2C_CTLR1_STOP;                // set STOP condition
+    I2C_until(I2C1->STAR1 & I2C_STAR1_BTF);       // wait for last byte transmitted
+    if(!I2C_error) I2C1->CTLR1 |= I2C_CTLR1_STOP; // set STOP condition
   }
 }
 
 // Send data buffer via I2C bus using DMA
 void I2C_writeBuffer(uint8_t* buf, uint16_t len) {
+  if(I2C_error) return;                           // bus has failed
   DMA1_Channel6->CNTR  = len;                     // number of bytes to be transfered
   DMA1_Channel6->MADDR = (uint32_t)buf;           // memory address
   DMA1_Channel6->CFGR |= DMA_CFG6_EN;             // enable DMA channel
   I2C1->CTLR2         |= I2C_CTLR2_DMAEN;         // enable DMA request
 }
 
+// Wait until DMA transfer and I2C transmission are complete
+void I2C_wait(void) {
+  I2C_until(!I2C_busy());                         // DMA disabled and STOP sent?
+}
+
+// Wait until at most n buffer bytes are pending
+void I2C_drain(uint16_t n) {
+  I2C_until(I2C_pending() <= n);
+}
+
 // Interrupt service routine
-void DMA1_Channel6_IRQHandler(void) __attribute__((interrupt));
+void DMA1_Channel6_IRQHandler(void) __attribute__((interrupt)) I2C_HOT;
 void DMA1_Channel6_IRQHandler(void) {
   I2C1->CTLR2         &= ~I2C_CTLR2_DMAEN;        // disable DMA request
   DMA1_Channel6->CFGR &= ~DMA_CFG6_EN;            // disable DMA channel
   DMA1->INTFCR         = DMA_CGIF6;               // clear interrupt flags
-  while(!(I2C1->STAR1 & I2C_STAR1_BTF));          // wait for last byte transmitted
-  I2C1->CTLR1         |= I2C_CTLR1_STOP;          // set STOP condition
+  I2C_until(I2C1->STAR1 & I2C_STAR1_BTF);         // wait for last byte transmitted
+  if(!I2C_error) I2C1->CTLR1 |= I2C_CTLR1_STOP;   // set STOP condition
+}
+
+// Free the bus and init I2C again after a failure
+void I2C_recover(void) {
+  uint8_t i;
+  I2C1->CTLR2         &= ~I2C_CTLR2_DMAEN;        // make sure the DMA is stopped
+  DMA1_Channel6->CFGR &= ~DMA_CFG6_EN;
+  I2C1->CTLR1          = 0;                       // disable I2C
+
+  // Set SDA and SCL to output, open-drain, 10MHz, released (high)
+  I2C_GPIO->BSHR  = ((uint32_t)1<<I2C_SDA) | ((uint32_t)1<<I2C_SCL);
+  I2C_GPIO->CFGLR = (I2C_GPIO->CFGLR & ~(((uint32_t)0b1111<<(I2C_SDA<<2)) | ((uint32_t)0b1111<<(I2C_SCL<<2))))
+                                     |  (((uint32_t)0b0101<<(I2C_SDA<<2)) | ((uint32_t)0b0101<<(I2C_SCL<<2)));
+  DLY_us(5);
+
+  // Clock out up to 9 SCL pulses (100kHz) until the slave releases SDA
+  for(i=0; (i<9) && !(I2C_GPIO->INDR & ((uint32_t)1<<I2C_SDA)); i++) {
+    I2C_GPIO->BCR  = (uint32_t)1<<I2C_SCL;        // SCL low
+    DLY_us(5);
+    I2C_GPIO->BSHR = (uint32_t)1<<I2C_SCL;        // SCL high
+    DLY_us(5);
+  }
+
+  // STOP condition: SDA rises while SCL is high
+  I2C_GPIO->BCR  = (uint32_t)1<<I2C_SCL;          // SCL low
+  DLY_us(5);
+  I2C_GPIO->BCR  = (uint32_t)1<<I2C_SDA;          // SDA low
+  DLY_us(5);
+  I2C_GPIO->BSHR = (uint32_t)1<<I2C_SCL;          // SCL high
+  DLY_us(5);
+  I2C_GPIO->BSHR = (uint32_t)1<<I2C_SDA;          // SDA high
+  DLY_us(5);
+
+  // Reset I2C module and init it again (pins back to I2C)
+  RCC->APB1PRSTR |=  RCC_I2C1RST;
+  RCC->APB1PRSTR &= ~RCC_I2C1RST;
+  I2C_init();
+  I2C_error = 0;
+  I2C_recoveries++;
 }
@@ -1,5 +1,5 @@
 // ===================================================================================
-// Basic I2C Master Functions with DMA for TX for CH32V003                    * v1.0 *
+// Basic I2C Master Functions with DMA for TX for CH32V003                    * v1.4 *
 // ===================================================================================
 //
 // Functions available:
@@ -10,6 +10,27 @@
 // I2C_read(ack)            I2C receive one data byte (set ack=0 for last byte)
 // I2C_stop()               I2C stop transmission
 // I2C_writeBuffer(buf,len) Send buffer (*buf) with length (len) via I2C/DMA and stop
+// I2C_busy()               Check if DMA transfer or I2C transmission is in progress
+// I2C_wait()               Wait until DMA transfer and I2C transmission are complete
+// I2C_pending()            Number of buffer bytes not yet read by the DMA
+// I2C_drain(n)             Wait until at most n buffer bytes are pending
+// I2C_recover()            Free the bus and init I2C again after a failure
+// I2C_error                1 if the bus has failed (a wait timed out)
+// I2C_errors               Number of bus failures so far
+// I2C_recoveries           Number of bus recoveries so far
+//
+// I2C_writeBuffer() returns immediately while the DMA reads the buffer in the
+// background. Do not modify the buffer before I2C_busy() returns false or
+// I2C_wait() has returned.
+//
+// Every wait gives up after I2C_TIMEOUT microseconds without progress (e.g. the
+// display was unplugged or holds SDA low). Then I2C_error is set, the DMA is
+// stopped and all functions return at once until I2C_recover() clocks out up to 9
+// SCL pulses and a STOP condition, resets the I2C module and inits it again. The
+// display has to be initialized again afterwards.
+//
+// With I2C_IN_RAM the DMA interrupt handler and I2C_write() run from SRAM
+// (RAMFUNC, see system.h), without the flash wait state at 48MHz.
 //
 // I2C pin mapping (set below in I2C parameters):
 // ----------------------------------------------
@@ -31,6 +52,8 @@ extern "C" {
 // I2C Parameters
 #define I2C_CLKRATE   400000    // I2C bus clock rate (Hz)
 #define I2C_MAP       0         // I2C pin mapping (see above)
+#define I2C_IN_RAM    0         // 1: run hot functions from SRAM (.ramfunc)
+#define I2C_TIMEOUT   2000      // us without progress until the bus fails
 
 // Interrupt enable check
 #if SYS_USE_VECTORS == 0
@@ -44,8 +67,19 @@ void I2C_stop(void);              // I2C stop transmission
 void I2C_write(uint8_t data);     // I2C transmit one data byte via I2C
 uint8_t I2C_read(uint8_t ack);    // I2C receive one data byte from the slave
 void I2C_writeBuffer(uint8_t* buf, uint16_t len);
+void I2C_wait(void);              // wait until DMA and I2C transmission are complete
+void I2C_drain(uint16_t n);       // wait until at most n buffer bytes are pending
+void I2C_recover(void);           // free the bus and init I2C again after a failure
+
+extern volatile uint8_t  I2C_error;       // 1: bus has failed
+extern volatile uint16_t I2C_errors;      // number of bus failures
+extern uint16_t          I2C_recoveries;  // number of bus recoveries
+
+// Check if DMA transfer or I2C transmission is in progress
+#define I2C_busy()  ((DMA1_Channel6->CFGR & DMA_CFG6_EN) || (I2C1->STAR2 & I2C_STAR2_BUSY))
 
-#define I2C_busy()  (I2C1->STAR2 & I2C_STAR2_BUSY)  // check if I2C is busy
+// Number of buffer bytes not yet read by the DMA
+#define I2C_pending() (DMA1_Channel6->CNTR)
 
 #ifdef __cplusplus
 };
@@ -1,6 +1,6 @@
 // ===================================================================================
 // Project:   Conway's Game of Life for CH32V003 and SSD1306 128x64 Pixels I2C OLED
-// Version:   v1.0
+// Version:   v1.2
 // Year:      2023
 // Author:    Stefan Wagner
 // Github:    https://github.com/wagiminator
@@ -24,11 +24,33 @@
 //   - Each cell with two or three neighbors survives.
 // - For a space that is empty or unpopulated:
 //   - Each cell with three neighbors becomes populated.
+// These are the rules B3/S23 (birth with 3 neighbors, survival with 2 or 3), further
+// Life-like rules (HighLife, Day & Night, Seeds, Morley) are in LIFE_RULES. Hold the
+// ACT key for a second to switch to the next one.
 //
 // Connect an SSD1306 128x64 Pixels I2C OLED to PC1 (SDA) and PC2 (SCL). 
 // The implementation utilizes DMA for data transfer to the OLED while simultaneously 
-// computing the next game step. Press the ACT key connected to PA2 to restart the
-// game.
+// computing the next game step. Only regions of the universe which are still
+// changing are calculated, when the board has become stable (still lifes and
+// blinkers only) it is re-seeded automatically. By default the next generation is written back
+// into the screen buffer page by page right behind the DMA, only two page rows are
+// kept as a copy. Alternatively (LIFE_INPLACE 0) two screen buffers are used
+// alternately: the next generation is calculated into the buffer that is not being
+// transmitted.
+// The static title line is sent only once, afterwards the OLED window is limited
+// to the 128x56 pixels of the universe. Press the ACT key connected to PA2 to restart the
+// game with the next scene.
+//
+// Scenes: the first one seeds random cells, the others load patterns from the
+// pattern library in flash (glider gun, methuselahs, spaceships), which are
+// stored in the RLE format of Life programs and placed at fixed positions. They
+// run the same way from every start, e.g. as long workloads for benchmarks
+// (LIFE_SCENE selects the scene after power-up).
+//
+// With LIFE_STEPS > 1 only every n-th generation is displayed, the others are
+// calculated without waiting for the display. With LIFE_GPS the right part of the
+// title line shows the generations per second (of the last second), which is the
+// throughput of the kernel as soon as the display no longer limits it.
 //
 // References:
 // -----------
@@ -49,11 +71,43 @@
 #include "system.h"               // system functions
 #include "i2c_dma.h"              // I2C functions with DMA
 #include "gpio.h"                 // GPIO/ADC functions
+#include "fast_math.h"            // division-free integer helpers
+#include "glyph.h"                // text renderer (counter)
 
 #define GAME_START    0xBEEFAFFE  // define 32-bit game start code
 #define PIN_ACT       PA2         // pin connected to ACT butoon, active low
+#define LIFE_INPLACE  1           // 0: ping-pong buffers, 1: in-place update (saves RAM)
+#define LIFE_STABLE   100         // re-seed after board is stable for n generations
+#define LIFE_KEY      0x9E3779B9  // hash key increment per word
+#define LIFE_STEPS    1           // generations per displayed frame
+#define LIFE_GPS      1           // 1: show generations per second in title line
+#define LIFE_SCENE    0           // scene after power-up (0: random, see LIFE_SCENES)
+#define LIFE_HOLD     1000        // ms ACT is held to switch to the next rule
+
+#if LIFE_INPLACE > 0
+uint32_t page1[224];              // screen buffer (updated in place), 32-bit aligned
+uint32_t row_first[32];           // saved first page row of current generation
+uint32_t row_save[32];            // saved previous page row of current generation
+uint32_t* scr_src = page1;        // current generation
+uint32_t* scr_dst = page1;        // next generation (same buffer)
+#else
+uint32_t page1[224], page2[224];  // double screen buffer (ping-pong), 32-bit aligned
+uint32_t* scr_src = page1;        // current generation (being transmitted)
+uint32_t* scr_dst = page2;        // next generation (being calculated)
+#endif
 
-uint8_t page1[1024], page2[896];  // double screen buffer
+uint16_t life_chg[7];             // tiles changed in last generation (bit n: columns 8n..8n+7)
+uint32_t life_hash[2];            // board hash of current and previous generation
+uint8_t  life_stable;             // number of generations the board has been stable
+uint8_t  life_scene = LIFE_SCENE; // current scene
+uint8_t  life_rule;               // current rule (index of LIFE_RULES)
+
+#if LIFE_GPS > 0
+uint16_t life_gens;               // generations calculated in this second
+uint32_t life_second;             // SysTick count this second started at
+uint8_t  life_gpsbuf[56];         // right part of the title line: "nnnnn/S"
+uint8_t  life_gpsnew;             // 1: counter has to be sent
+#endif
 
 const uint8_t GAME_TEXT[] = {
   0x00, 0x3E, 0x41, 0x41, 0x41, 0x22, 0x00, 0x3E, 0x41, 0x41, 0x41, 0x3E,
@@ -66,7 +120,7 @@ const uint8_t GAME_TEXT[] = {
   0x00, 0x3E, 0x41, 0x41, 0x41, 0x3E, 0x00, 0x7F, 0x09, 0x09, 0x09, 0x01,
   0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7F, 0x40, 0x40, 0x40, 0x40,
   0x00, 0x00, 0x41, 0x7F, 0x41, 0x00, 0x00, 0x7F, 0x09, 0x09, 0x09, 0x01,
-  0x00, 0x7F, 0x49, 0x49, 0x49, 0x41
+  0x00, 0x7F, 0x49, 0x49, 0x49, 0x41, 0x00, 0x00
 };
 
 // ===================================================================================
@@ -90,58 +144,410 @@ const uint8_t OLED_INIT_CMD[] = {
   0xAF                            // display on
 };
 
+// OLED window for the universe (below the title line)
+const uint8_t OLED_FIELD_CMD[] = {
+  0x21, 0x00, 0x7F,               // set start and end column
+  0x22, 0x01, 0x07                // set start and end page
+};
+
+#if LIFE_GPS > 0
+// OLED window for the counter (right part of the title line)
+const uint8_t OLED_GPS_CMD[] = {
+  0x21, 0x48, 0x7F,               // set start and end column
+  0x22, 0x00, 0x00                // set start and end page
+};
+
+#define GPS_TITLE     54          // "GAME OF LIFE" in GAME_TEXT (72 columns)
+#endif
+
 // ===================================================================================
 // Pseudo Random Number Generator
 // ===================================================================================
-uint32_t random(uint32_t max) {
+uint8_t random(uint8_t max) {
   static uint32_t rnval = GAME_START;
   rnval = rnval << 16 | (rnval << 1 ^ rnval << 2) >> 16;
-  return(rnval % max);
+  return FM_below(rnval, max);
 }
 
+// ===================================================================================
+// Pattern Library
+// ===================================================================================
+
+// The patterns are stored like in the RLE files of Life programs: "b" is a dead
+// cell, "o" a living one, "$" ends a row, "!" the pattern. A number in front
+// repeats the item. Living cells are set, the rest of the board is left as is.
+const char LIFE_GLIDER[] = "bob$2bo$3o!";
+const char LIFE_LWSS[]   = "bo2bo$o$o3bo$4o!";
+const char LIFE_GOSPER[] = "24bo$22bobo$12b2o6b2o12b2o$11bo3bo4b2o12b2o$2o8bo5bo3b2o$"
+                           "2o8bo3bob2o4bobo$10bo5bo7bo$11bo3bo$12b2o!";
+const char LIFE_RPENTO[] = "b2o$2o$bo!";
+const char LIFE_ACORN[]  = "bo$3bo$2o2b3o!";
+const char LIFE_DIEHARD[] = "6bo$2o$bo3b3o!";
+
+// Pattern at position x, y
+typedef struct {
+  uint8_t x, y;
+  const char* rle;
+} LIFE_PLACE;
+
+// Scenes (lists of patterns, ended by rle 0)
+const LIFE_PLACE LIFE_SCENE_GUN[] = {
+  {2, 2, LIFE_GOSPER}, {0, 0, 0}
+};
+const LIFE_PLACE LIFE_SCENE_METHUSELAHS[] = {
+  {20, 26, LIFE_RPENTO}, {60, 27, LIFE_ACORN}, {100, 26, LIFE_DIEHARD}, {0, 0, 0}
+};
+const LIFE_PLACE LIFE_SCENE_FLEET[] = {
+  {4, 4, LIFE_GLIDER}, {24, 12, LIFE_GLIDER}, {44, 20, LIFE_GLIDER},
+  {10, 40, LIFE_LWSS}, {70, 30, LIFE_LWSS}, {90, 6, LIFE_LWSS}, {0, 0, 0}
+};
+const LIFE_PLACE* const LIFE_SCENES[] = {
+  0,                              // random cells
+  LIFE_SCENE_GUN,                 // Gosper glider gun
+  LIFE_SCENE_METHUSELAHS,         // R-pentomino, acorn, diehard
+  LIFE_SCENE_FLEET                // gliders and lightweight spaceships
+};
+#define LIFE_SCENE_CNT  (sizeof(LIFE_SCENES) / sizeof(LIFE_SCENES[0]))
+
+// ===================================================================================
+// Rules
+// ===================================================================================
+
+// A rule is given by the digits of its B/S rulestring, e.g. LIFE_RULE(36, 23) for
+// B36/S23: bit n of birth is set if a dead cell with n neighbors is born, bit n of
+// survive if a living one with n neighbors survives. The masks are constants, the
+// kernel is built once per rule with them (the digit 0 can't be given).
+typedef struct {
+  uint16_t birth, survive;
+} LIFE_RULE_T;
+
+#define LIFE_DIG(n, p)  (((n) / (p)) ? 1 << ((n) / (p) % 10) : 0)
+#define LIFE_MASK(n)    (LIFE_DIG(n, 1)     | LIFE_DIG(n, 10)     | LIFE_DIG(n, 100)     \
+                       | LIFE_DIG(n, 1000)  | LIFE_DIG(n, 10000)  | LIFE_DIG(n, 100000)  \
+                       | LIFE_DIG(n, 1000000) | LIFE_DIG(n, 10000000))
+#define LIFE_RULE(b, s) {LIFE_MASK(b + 0), LIFE_MASK(s + 0)}
+
+static const LIFE_RULE_T LIFE_RULES[] = {
+  LIFE_RULE(3, 23),               // B3/S23:       Conway's Life
+  LIFE_RULE(36, 23),              // B36/S23:      HighLife (replicators)
+  LIFE_RULE(3678, 34678),         // B3678/S34678: Day & Night (dense)
+  LIFE_RULE(368, 245),            // B368/S245:    Morley (moving patterns)
+  LIFE_RULE(2, )                  // B2/S:         Seeds (explosive, no survival)
+};
+#define LIFE_RULE_CNT   (sizeof(LIFE_RULES) / sizeof(LIFE_RULES[0]))
+
 // ===================================================================================
 // Conway's Game of Life
 // ===================================================================================
 
-// Get pixel from source screen buffer
-uint8_t getpixel(uint8_t xpos, uint8_t ypos) {
-  xpos &= 127;
-  if(ypos == 56)  ypos = 0;
-  if(ypos == 255) ypos = 55;
-  return((page1[((uint16_t)ypos >> 3) * 128 + 128 + xpos] >> (ypos & 7)) & 1);
-}
+// The screen buffer is organized in pages like the OLED memory: each byte holds
+// eight vertically arranged cells of one column. The kernel reads the buffer in
+// 32-bit words, so each word contains 4 columns x 8 rows = 32 cells, which are
+// evaluated simultaneously using bitwise full adders. Each page row consists of
+// 32 words, the universe of 7 page rows.
+//
+// In in-place mode (LIFE_INPLACE) the new generation is written straight back
+// into the screen buffer. Only the original contents of the previous page row
+// and of the first page row (needed for the wrap around) are kept in a copy.
+// A page row is not overwritten before the DMA has transmitted it, so the
+// calculation follows the DMA without tearing.
+//
+// The universe is divided into tiles of 8x8 cells (one page row, 8 columns). Only
+// tiles which changed in the last generation or border such a tile are calculated,
+// page rows without any active tile are skipped entirely. A hash of the board is
+// updated with every changed word. If nothing changed (period 1) or the hash equals
+// the one of the generation before last (period 2), the board is considered stable.
 
 // Set pixel on destination screen buffer
 void setpixel(uint8_t xpos, uint8_t ypos) {
-  page2[((uint16_t)ypos >> 3) * 128 + xpos] |= ((uint8_t)1 << (ypos & 7));
+  ((uint8_t*)scr_dst)[((uint16_t)ypos >> 3) * 128 + xpos] |= ((uint8_t)1 << (ypos & 7));
 }
 
-// Calculate next game step
-void calculate(void) {
-  for(uint16_t i=0; i<896; i++) page2[i] = 0;
-  for(uint8_t y=0; y<56; y++) {
-    for(uint8_t x=0; x<128; x++) {
-      uint8_t neighbors = getpixel(x-1, y-1) \
-                        + getpixel(x  , y-1) \
-                        + getpixel(x+1, y-1) \
-                        + getpixel(x-1, y  ) \
-                        + getpixel(x+1, y  ) \
-                        + getpixel(x-1, y+1) \
-                        + getpixel(x  , y+1) \
-                        + getpixel(x+1, y+1);
-      if((getpixel(x,y) == 1) && (neighbors >= 2) && (neighbors <= 3)) setpixel(x,y);
-      if((getpixel(x,y) == 0) && (neighbors == 3)) setpixel(x,y);
+// Load RLE pattern with its top left corner at x0, y0 (wraps around)
+void loadpattern(uint8_t x0, uint8_t y0, const char* rle) {
+  uint8_t x = x0, y = y0, n = 0;
+  char c;
+  while((c = *rle++) && (c != '!')) {
+    if((c >= '0') && (c <= '9')) {        // repeat count
+      n = n * 10 + c - '0';
+      continue;
+    }
+    if(!n) n = 1;
+    if(c == '$') {                        // end of row(s)
+      y += n;
+      x  = x0;
+    }
+    else if((c == 'b') || (c == 'o')) {   // dead or living cells
+      for(; n; n--, x++) {
+        if(c == 'o') setpixel(x & 127, FM_mod_small(y, 56));
+      }
+    }
+    n = 0;
+  }
+}
+
+// Vertical sum (0..3) of each cell and its upper and lower neighbors as 2 bit-slices
+// (a: word of page above, c: word of current page, b: word of page below)
+static inline void vsum(uint32_t a, uint32_t c, uint32_t b, uint32_t* s0, uint32_t* s1) {
+  uint32_t up = (c << 1 & 0xFEFEFEFE) | (a >> 7 & 0x01010101);  // cells at y-1
+  uint32_t dn = (c >> 1 & 0x7F7F7F7F) | (b << 7 & 0x80808080);  // cells at y+1
+  uint32_t x  = up ^ dn;
+  *s0 = x ^ c;                            // sum bit 0
+  *s1 = (up & dn) | (x & c);              // sum bit 1
+}
+
+// Mix function for board hash
+static inline uint32_t hmix(uint32_t x) {
+  x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+  return x;
+}
+
+// Next generation of 32 cells (m) from the sums T (0..9) of their 3x3 blocks as
+// bit-slices t0..t3: a dead cell (T neighbors) is born if bit T of birth is set, a
+// living one (T-1 neighbors) survives if bit T-1 of survive is set. With constant
+// masks only the terms of the rule are left, for B3/S23: T == 3 or (T == 4 and
+// cell alive).
+static inline __attribute__((always_inline))
+uint32_t life_eval(uint32_t t0, uint32_t t1, uint32_t t2, uint32_t t3, uint32_t m,
+                   uint16_t birth, uint16_t survive) {
+  const uint32_t lo[4] = {~t1 & ~t0, ~t1 & t0, t1 & ~t0, t1 & t0};  // T & 3
+  const uint32_t hi[3] = {~t3 & ~t2, ~t3 & t2, t3};                 // T >> 2
+  uint32_t w = 0;
+  #pragma GCC unroll 10
+  for(uint8_t t=0; t<10; t++) {
+    uint8_t  b = (birth >> t) & 1;
+    uint8_t  s = t && ((survive >> (t - 1)) & 1);
+    uint32_t d = lo[t & 3] & hi[t >> 2];  // cells with T == t
+    if(b && s)  w |= d;
+    else if(b)  w |= d & ~m;
+    else if(s)  w |= d & m;
+  }
+  return w;
+}
+
+// Calculate next game step with the rule birth/survive
+// The sum T of the 3x3 block around each cell (including the cell itself) is
+// calculated, the rule decides by T and the cell if it lives in the next generation.
+static inline __attribute__((always_inline))
+void life_step(uint16_t birth, uint16_t survive) {
+  uint32_t ls0, ls1, cs0, cs1, rs0, rs1;  // vertical sums of left, center, right word
+  uint32_t fs0, fs1;                      // vertical sums of first word (wrap around)
+  uint32_t key  = 0;                      // hash key of current word
+  uint32_t hash = life_hash[0];           // board hash
+  uint16_t act[7];                        // active tiles
+  uint16_t any  = 0;                      // any tile changed
+
+  // Mark tiles which changed or border a changed tile
+  for(uint8_t p=0; p<7; p++) {
+    uint16_t m = life_chg[p ? p - 1 : 6] | life_chg[p] | life_chg[p < 6 ? p + 1 : 0];
+    act[p] = m | (m << 1 | m >> 15) | (m >> 1 | m << 15);
+  }
+
+  #if LIFE_INPLACE > 0
+  const uint32_t* prev  = scr_src + 6 * 32;              // original of page above
+  const uint32_t* first = scr_src;                       // original of first page
+  #endif
+
+  for(uint8_t p=0; p<7; p++) {
+    const uint32_t* c = scr_src + p * 32;                // current page
+    uint32_t* d = scr_dst + p * 32;                      // destination page
+    uint16_t chg = 0;                                    // changed tiles of this page
+
+    // Skip page row without active tiles
+    if(!act[p]) {
+      #if LIFE_INPLACE > 0
+      prev = c;                                          // page remains unchanged
+      #else
+      for(uint8_t i=0; i<32; i++) d[i] = c[i];           // copy page
+      #endif
+      life_chg[p] = 0;
+      key += LIFE_KEY << 5;
+      continue;
+    }
+
+    #if LIFE_INPLACE > 0
+    const uint32_t* a = prev;                            // page above (original)
+    const uint32_t* b = (p < 6) ? c + 32 : first;        // page below (original)
+    uint32_t* s = p ? row_save : row_first;              // save original page
+    I2C_drain(896 - 128 * (p + 1));                      // wait for page transmitted
+    #else
+    const uint32_t* a = scr_src + (p ? p - 1 : 6) * 32;  // page above (wrap around)
+    const uint32_t* b = scr_src + (p < 6 ? p + 1 : 0) * 32;  // page below (wrap around)
+    #endif
+    vsum(a[31], c[31], b[31], &ls0, &ls1);
+    vsum(a[0],  c[0],  b[0],  &cs0, &cs1);
+    fs0 = cs0; fs1 = cs1;
+    for(uint8_t i=0; i<32; i++) {
+      if(i < 31) vsum(a[i+1], c[i+1], b[i+1], &rs0, &rs1);
+      else {rs0 = fs0; rs1 = fs1;}        // wrap around to first word
+
+      uint32_t m = c[i];                  // current word
+      uint32_t w = m;                     // next generation of word
+      #if LIFE_INPLACE > 0
+      s[i] = m;                           // a[i] is not needed anymore
+      #endif
+
+      if(act[p] & ((uint16_t)1 << (i >> 1))) {
+        // Vertical sums of left and right neighbor columns
+        uint32_t l0 = cs0 << 8 | ls0 >> 24;
+        uint32_t l1 = cs1 << 8 | ls1 >> 24;
+        uint32_t r0 = cs0 >> 8 | rs0 << 24;
+        uint32_t r1 = cs1 >> 8 | rs1 << 24;
+
+        // X = L + R (0..6)
+        uint32_t k  = l0 & r0;
+        uint32_t x0 = l0 ^ r0;
+        uint32_t x1 = l1 ^ r1 ^ k;
+        uint32_t x2 = (l1 & r1) | (k & (l1 ^ r1));
+
+        // T = X + C (0..9)
+        k = x0 & cs0;
+        uint32_t t0 = x0 ^ cs0;
+        uint32_t t1 = x1 ^ cs1 ^ k;
+        k = (x1 & cs1) | (k & (x1 ^ cs1));
+        uint32_t t2 = x2 ^ k;
+        uint32_t t3 = x2 & k;
+
+        // Next generation by the rule
+        w = life_eval(t0, t1, t2, t3, m, birth, survive);
+        if(w != m) {
+          chg  |= (uint16_t)1 << (i >> 1);
+          hash += hmix(w + key) - hmix(m + key);
+        }
+      }
+      d[i] = w;
+      key += LIFE_KEY;
+
+      ls0 = cs0; ls1 = cs1;
+      cs0 = rs0; cs1 = rs1;
     }
+
+    #if LIFE_INPLACE > 0
+    prev = s;
+    if(!p) first = row_first;
+    #endif
+    life_chg[p] = chg;
+    any |= chg;
+  }
+
+  // Check if board is stable (period 1 or 2)
+  if(!any || hash == life_hash[1]) life_stable++;
+  else life_stable = 0;
+  life_hash[1] = life_hash[0];
+  life_hash[0] = hash;
+}
+
+// Calculate next game step with the current rule (one kernel per rule)
+#define LIFE_CASE(i) case i: life_step(LIFE_RULES[i].birth, LIFE_RULES[i].survive); break
+void calculate(void) {
+  switch(life_rule) {
+    LIFE_CASE(1);
+    LIFE_CASE(2);
+    LIFE_CASE(3);
+    LIFE_CASE(4);
+    default: life_step(LIFE_RULES[0].birth, LIFE_RULES[0].survive); break;
   }
-  for(uint16_t i=0; i<896; i++) page1[i + 128] = page2[i];
+}
+_Static_assert(LIFE_RULE_CNT == 5, "LIFE_RULES: one case per rule in calculate()");
+
+// Init OLED, send title line once and set OLED window to the universe
+void OLED_init(void) {
+  I2C_start(OLED_ADDR);                   // start transmission to OLED
+  I2C_write(OLED_CMD_MODE);               // set command mode
+  I2C_writeBuffer((uint8_t*)OLED_INIT_CMD, sizeof(OLED_INIT_CMD)); // send init sequence
+  I2C_start(OLED_ADDR);                   // start transmission to OLED
+  I2C_write(OLED_DAT_MODE);               // set data mode
+  #if LIFE_GPS > 0
+  I2C_writeBuffer((uint8_t*)GAME_TEXT + GPS_TITLE, 72);    // send "GAME OF LIFE"
+  life_gpsnew = 1;                        // counter follows with the next frame
+  #else
+  I2C_writeBuffer((uint8_t*)GAME_TEXT, sizeof(GAME_TEXT)); // send title line
+  #endif
+  I2C_start(OLED_ADDR);                   // start transmission to OLED
+  I2C_write(OLED_CMD_MODE);               // set command mode
+  I2C_writeBuffer((uint8_t*)OLED_FIELD_CMD, sizeof(OLED_FIELD_CMD)); // set window
 }
 
-// Setupt start screen
+#if LIFE_GPS > 0
+// Count generation, compose counter once per second
+void gps_count(void) {
+  uint32_t t = STK->CNT - life_second;
+  life_gens++;
+  if(t < 1000 * DLY_MS_TIME) return;
+  uint32_t gps = (uint32_t)life_gens * 1000 / (t / DLY_MS_TIME); // (once a second)
+  uint8_t  d[5], lead = 1;
+  uint8_t* p = life_gpsbuf + 56 - 42;     // five digits and "/S"
+  FM_split10((gps > 65535) ? 65535 : gps, d, 5);
+  for(uint8_t i=0; i<5; i++) {
+    if(d[4 - i] || (i == 4)) lead = 0;
+    p = GLYPH_put(p, lead ? ' ' : '0' + d[4 - i]);  // (leading zeros blank)
+  }
+  GLYPH_print(p, "/S");
+  life_gens   = 0;
+  life_second = STK->CNT;
+  life_gpsnew = 1;
+}
+
+// Send counter to the right part of the title line, set window to the universe
+void gps_send(void) {
+  I2C_start(OLED_ADDR);                   // start transmission to OLED
+  I2C_write(OLED_CMD_MODE);               // set command mode
+  I2C_writeBuffer((uint8_t*)OLED_GPS_CMD, sizeof(OLED_GPS_CMD));     // set window
+  I2C_start(OLED_ADDR);                   // start transmission to OLED
+  I2C_write(OLED_DAT_MODE);               // set data mode
+  I2C_writeBuffer(life_gpsbuf, sizeof(life_gpsbuf));                 // send counter
+  I2C_start(OLED_ADDR);                   // start transmission to OLED
+  I2C_write(OLED_CMD_MODE);               // set command mode
+  I2C_writeBuffer((uint8_t*)OLED_FIELD_CMD, sizeof(OLED_FIELD_CMD)); // set window
+  life_gpsnew = 0;
+}
+#endif
+
+// Make the new generation the current one without displaying it
+void skip(void) {
+  #if LIFE_INPLACE == 0
+  I2C_wait();                             // the old buffer is still being transmitted
+  uint32_t* tmp = scr_src;
+  scr_src = scr_dst;                      // new generation becomes current
+  scr_dst = tmp;                          // old buffer is free for next generation
+  #endif
+}
+
+// Swap screen buffers and transmit the new generation
+void flip(void) {
+  I2C_wait();                             // wait until current buffer is transmitted
+  if(I2C_error) {                         // bus has failed (generation was dropped)?
+    I2C_recover();                        // -> free the bus, init I2C again
+    OLED_init();                          // -> display may have been reset
+  }
+  #if LIFE_GPS > 0
+  if(life_gpsnew) gps_send();             // counter changed?
+  #endif
+  #if LIFE_INPLACE == 0
+  uint32_t* tmp = scr_src;
+  scr_src = scr_dst;                      // new generation becomes current
+  scr_dst = tmp;                          // old buffer is free for next generation
+  #endif
+  I2C_start(OLED_ADDR);                   // start transmission to OLED
+  I2C_write(OLED_DAT_MODE);               // set data mode
+  I2C_writeBuffer((uint8_t*)scr_src, 896);          // send screen buffer using DMA
+}
+
+// Setupt start screen of the current scene
 void GAME_init(void) {
-  for(uint16_t i=0; i<896; i++) page2[i] = 0;
-  for(uint16_t i=768; i; i--) setpixel(random(128), random(56));
-  for(uint16_t i=0; i<896; i++) page1[i + 128] = page2[i];
-  for(uint16_t i=0; i<sizeof(GAME_TEXT); i++) page1[i] = GAME_TEXT[i];
+  #if LIFE_INPLACE > 0
+  I2C_wait();                             // wait until buffer is transmitted
+  #endif
+  uint32_t key = 0;
+  const LIFE_PLACE* s = LIFE_SCENES[life_scene];
+  for(uint8_t i=0; i<224; i++) scr_dst[i] = 0;
+  if(!s) for(uint16_t i=768; i; i--) setpixel(random(128), random(56));
+  else   for(; s->rle; s++) loadpattern(s->x, s->y, s->rle);
+  life_hash[0] = 0;
+  for(uint8_t i=0; i<224; i++, key += LIFE_KEY) life_hash[0] += hmix(scr_dst[i] + key);
+  life_hash[1] = ~life_hash[0];
+  for(uint8_t i=0; i<7; i++) life_chg[i] = 0xFFFF;      // all tiles active
+  life_stable  = 0;
 }
 
 // ===================================================================================
@@ -156,16 +562,39 @@ int main(void) {
 
   // Init OLED
   I2C_init();                             // initialize I2C first
-  I2C_start(OLED_ADDR);                   // start transmission to OLED
-  I2C_write(OLED_CMD_MODE);               // set command mode
-  I2C_writeBuffer((uint8_t*)OLED_INIT_CMD, sizeof(OLED_INIT_CMD)); // send init sequence
+  OLED_init();                            // init OLED, title line and window
+  flip();                                 // show start screen
 
   // Loop
+  uint8_t  key = 2;                       // ACT: 0 released, 1 pressed, 2 held
+  uint32_t keytime = 0;                   // SysTick count ACT was pressed at
   while(1) {
-    if(!PIN_read(PIN_ACT)) GAME_init();   // re-setup start screen if ACT button pressed
-    else calculate();                     // else calculate next game step
-    I2C_start(OLED_ADDR);                 // start transmission to OLED
-    I2C_write(OLED_DAT_MODE);             // set data mode
-    I2C_writeBuffer(page1, 1024);         // send screen buffer using DMA
+    if(PIN_read(PIN_ACT)) {               // ACT released?
+      if(key == 1) {                      // -> after a short press: next scene
+        if(++life_scene >= LIFE_SCENE_CNT) life_scene = 0;
+        life_stable = LIFE_STABLE;
+      }
+      key = 0;
+    }
+    else if(!key) {                       // ACT pressed?
+      key = 1;
+      keytime = STK->CNT;
+    }
+    else if((key == 1) && (STK->CNT - keytime >= (uint32_t)LIFE_HOLD * DLY_MS_TIME)) {
+      key = 2;                            // ACT held: next rule, scene restarts
+      if(++life_rule >= LIFE_RULE_CNT) life_rule = 0;
+      life_stable = LIFE_STABLE;
+    }
+    if(life_stable >= LIFE_STABLE)
+      GAME_init();                        // re-setup start screen if next scene or stable
+    else for(uint8_t i=0; i<LIFE_STEPS; i++) {
+      if(i) skip();                       // (generation not displayed)
+      calculate();                        // else calculate next generation
+      #if LIFE_GPS > 0
+      gps_count();
+      #endif
+      if(life_stable >= LIFE_STABLE) break;
+    }
+    flip();                               // swap buffers and send new generation
   }
 }
@@ -33,20 +33,47 @@
 // ===================================================================================
 // Global Variables
 // ===================================================================================
-uint8_t Live = 0;
-uint8_t ShieldRemoved = 0;
-uint8_t MONSTERrest = 0;
-uint8_t LEVELS = 0;
-uint8_t SpeedShootMonster = 0;
-uint8_t ShipDead = 0;
-uint8_t ShipPos = 56;
+uint8_t Live SNAP_STATE;
+uint8_t ShieldRemoved SNAP_STATE;
+uint8_t MONSTERrest SNAP_STATE;
+uint8_t LEVELS SNAP_STATE;
+uint8_t SpeedShootMonster SNAP_STATE;
+uint8_t ShipDead SNAP_STATE;
+uint8_t ShipPos SNAP_STATE;
+int8_t  MyShootY = -1;
 
 #define SHOOTS 2
 
+// Shields: SPACE.Shield[] holds a bit per column (bit 15: leftmost), the shape
+// of a column is ShieldShape[] on page SHIELD_ROW
+#define SHIELDS     3
+#define SHIELD_X    19
+#define SHIELD_GAP  35
+#define SHIELD_W    16
+#define SHIELD_ROW  6
+#define SHIELD_X1   (SHIELD_X + (SHIELDS - 1) * SHIELD_GAP + SHIELD_W - 1)
+
+// Snapshot of the game (SNAP_STATE variables, see snapshot.h)
+#define SNAP_GAME   'I'
+#define SNAP_VER    3
+
+// Formation strips: the monster rows as they are on the screen without the
+// vertical offset DecalageY8 (applied when a strip is copied to a page). A row
+// is rendered again when it is marked in MonsterStripDirty (bit y: row y), i.e.
+// when a monster of it is hit or explodes and on each march step (animation).
+uint8_t MonsterStrip[4][6 * 14] LAYER_ALIGN;
+uint8_t MonsterStripDirty = 0x0F;
+#define MONSTER_STRIP_ALL   0x0F
+
+// Pixel rows of the shots (bolts in the upper or lower half of a page)
+#define MYSHOOTROW(s)       ((MyShootY << 3) + ((s)->MyShootBallFrame ? 0 : 4))
+#define MONSTERSHOOTROW(s)  ((s)->MonsterShoot[1] << 2)
+
 // ===================================================================================
 // Function Prototypes
 // ===================================================================================
 void LoadMonstersLevels(int8_t Levels, SPACE *space);
+uint8_t LastLevel(void);
 void SnD(int8_t Sp_, uint8_t SN);
 void SpeedControle(SPACE *space);
 void GRIDMonsterFloorY(SPACE *space);
@@ -57,39 +84,41 @@ void UFOUpdate(SPACE *space);
 void ShipDestroyByMonster(SPACE *space);
 void MonsterShootupdate(SPACE *space);
 void MonsterShootGenerate(SPACE *space);
-uint8_t MonsterShoot(uint8_t x, uint8_t y, SPACE *space);
+uint8_t ShieldColumn(uint8_t x, uint8_t *shield);
 uint8_t ShieldDestroy(uint8_t Origine, uint8_t VarX, uint8_t VarY, SPACE *space);
-void ShieldDestroyWrite(uint8_t BOOLWRITE, uint8_t line, SPACE *space, uint8_t Origine);
-uint8_t MyShield(uint8_t x, uint8_t y, SPACE *space);
-uint8_t ShieldBlitz(uint8_t Part, uint8_t LineSH);
-uint8_t BOOLREAD(uint8_t SHnum, uint8_t LineSH, SPACE *space);
 void RemoveExplodOnMonsterGrid(SPACE *space);
 uint8_t background(uint8_t x, uint8_t y, SPACE *space);
 uint8_t Vesso(uint8_t x, uint8_t y, SPACE *space);
 void UFO_Attack_Check(uint8_t x, SPACE *space);
-uint8_t MyShoot(uint8_t x, uint8_t y, SPACE *space);
+void MyShootUpdate(SPACE *space);
 void Monster_Attack_Check(SPACE *space);
-int8_t OuDansLaGrilleMonster(uint8_t x, uint8_t y, SPACE *space);
-uint8_t SplitSpriteDecalageY(uint8_t Input, uint8_t UPorDOWN, SPACE *space);
-uint8_t Murge_Split_UP_DOWN(uint8_t x, SPACE *space);
-uint8_t WriteMonster14(uint8_t x);
-uint8_t Monster(uint8_t x, uint8_t y, SPACE *space);
+void MonsterStripUpdate(SPACE *space);
 uint8_t MonsterRefreshMove(SPACE *space);
 void VarResetNewLevel(SPACE *space);
+void LayerInit(void);
+void LayerUpdate(SPACE *space);
 
 // ===================================================================================
 // Main Function
 // ===================================================================================
 int main(void) {
+  static uint8_t Decompte SNAP_STATE;
+  static uint8_t VarPot SNAP_STATE;
+  static uint8_t MyShootReady SNAP_STATE;
+  static SPACE space SNAP_STATE;
+
   // Setup
   JOY_init();
+  LayerInit();
+  if(JOY_resume(SNAP_GAME, SNAP_VER)) {      // suspended game: straight back in
+    Tiny_Flip(0, &space);
+    goto RESUME;
+  }
 
   // Loop
   while(1) {
-    uint8_t Decompte = 0;
-    uint8_t VarPot;
-    uint8_t MyShootReady = SHOOTS;
-    SPACE space;
+    Decompte = 0;
+    MyShootReady = SHOOTS;
 
   NEWGAME:
     Live = 3;
@@ -97,9 +126,11 @@ int main(void) {
     Tiny_Flip(1, &space);
     while(1) {
       if(JOY_act_pressed()) {
-        JOY_sound(100, 125); JOY_sound(50, 125);
+        JOY_idle_wake();
+        JOY_sfx(SFX_START);
         goto BYPASS2;
       }
+      JOY_idle(JOY_IDLE_POLL);
     }
 
   NEWLEVEL:
@@ -110,11 +141,14 @@ int main(void) {
     SpeedControle(&space);
     VarPot = 54;
     ShipPos = 56;
-    space.ScrBackV=(ShipPos / 14) + 52;
+    space.ScrBackV=FM_div14(ShipPos) + 52;
     goto Bypass;
 
   RestartLevel:
-    if(Live > 0) Live--;
+    if(Live > 0) {
+      Live--;
+      TLM_counter(TLM_ID_LIVES, Live);
+    }
     else goto NEWGAME;
 
   Bypass:
@@ -122,50 +156,55 @@ int main(void) {
     Decompte = 0;
     Tiny_Flip(0, &space);
     JOY_DLY_ms(1000);
+
+  RESUME:
+    JOY_gray_start(&space);
+    JOY_frame_start();
     while(1) {
       if(MONSTERrest == 0) { 
-        JOY_sound(110, 255); JOY_DLY_ms(40); JOY_sound(130, 255); JOY_DLY_ms(40);
-        JOY_sound(100, 255); JOY_DLY_ms(40); JOY_sound(1, 155);   JOY_DLY_ms(20);
-        JOY_sound(60, 255);  JOY_sound(60, 255);
-        if(LEVELS < 9) LEVELS++;
+        JOY_sfx(SFX_LEVEL);
+        if(LEVELS < LastLevel()) LEVELS++;
         goto NEWLEVEL;
       }
       if((((space.MonsterGroupeYpos) + (space.MonsterFloorMax + 1)) == 7) && (Decompte == 0)) ShipDead = 1;
-      if(SpeedShootMonster <= 9 - LEVELS) SpeedShootMonster++;
+      if(SpeedShootMonster <= (LEVELS < 9 ? 9 - LEVELS : 0)) SpeedShootMonster++;
       else {SpeedShootMonster = 0; MonsterShootGenerate(&space);}
-      space.ScrBackV = (ShipPos / 14) + 52;
-      Tiny_Flip(0, &space);
+      space.ScrBackV = FM_div14(ShipPos) + 52;
+      if(JOY_frame_render) Tiny_Flip(0, &space);
       space.oneFrame = !space.oneFrame;
       RemoveExplodOnMonsterGrid(&space);
       MonsterShootupdate(&space);
       UFOUpdate(&space);
       if(((space.MonsterGroupeXpos >= 26) && (space.MonsterGroupeXpos <= 28))
         && (space.MonsterGroupeYpos == 2) && (space.DecalageY8 == 4)) space.UFOxPos = 127;
-      if(VarPot > (ShipPos + 2)) ShipPos = ShipPos + ((VarPot - ShipPos) / 3);
-      if(VarPot < (ShipPos - 2)) ShipPos = ShipPos - ((ShipPos - VarPot) / 3);
+      if(VarPot > (ShipPos + 2)) ShipPos = ShipPos + FM_div3(VarPot - ShipPos);
+      if(VarPot < (ShipPos - 2)) ShipPos = ShipPos - FM_div3(ShipPos - VarPot);
       if(ShipDead != 1) {
         if(space.frame < space.frameMax) space.frame++;
         else {
           GRIDMonsterFloorY(&space);
           space.anim = !space.anim;
+          MonsterStripDirty = MONSTER_STRIP_ALL;
           if(space.anim == 0) SnD(space.UFOxPos, 200);
           else SnD(space.UFOxPos, 100);
           MonsterRefreshMove(&space);
           space.frame = 0;
         }
 
+        JOY_poll();
         if(JOY_left_pressed()) {
           if(VarPot > 5) VarPot = VarPot - 6;
         }
         if(JOY_right_pressed()) {
           if(VarPot < 108) VarPot = VarPot + 6;
         }
-        if((JOY_act_pressed()) && (MyShootReady == SHOOTS)) {
-          JOY_sound(200, 4); MyShootReady = 0; space.MyShootBall = 6; space.MyShootBallxpos = ShipPos + 6;
+        uint8_t Fire = JOY_act_clicked();       // also catches presses shorter than a frame
+        if((JOY_act_pressed() || Fire) && (MyShootReady == SHOOTS)) {
+          JOY_sfx(SFX_SHOT); MyShootReady = 0; space.MyShootBall = 6; space.MyShootBallxpos = ShipPos + 6;
         }
       }
       else {
-        JOY_sound(80, 1); JOY_sound(100, 1); 
+        JOY_sfx(SFX_DEAD);
         Decompte++;
         if(Decompte >= 30) {
           JOY_DLY_ms(600);
@@ -176,7 +215,7 @@ int main(void) {
       if(space.MyShootBall == -1) {
         if(MyShootReady<SHOOTS) MyShootReady++;
       }
-    JOY_SLOWDOWN();
+    JOY_frame_wait();
     }
   }
 }
@@ -184,40 +223,52 @@ int main(void) {
 // ===================================================================================
 // Functions
 // ===================================================================================
+uint8_t LastLevel(void) {
+  uint16_t extra = JOY_ASSET_size(A_LEVELS) / 24;
+  if(extra > 127 - LEVELS_FLASH) extra = 127 - LEVELS_FLASH; // (Levels is an int8_t)
+  return LEVELS_FLASH - 1 + extra;
+}
+
 void LoadMonstersLevels(int8_t Levels, SPACE *space) {
+  int8_t grid[24];
+  const int8_t *level = &MonstersLevels[Levels * 24];
   uint8_t x, y;
+  if(Levels >= LEVELS_FLASH) {
+    if(JOY_ASSET_read(A_LEVELS, (Levels - LEVELS_FLASH) * 24, grid, 24) == 24) level = grid;
+    else level = &MonstersLevels[(LEVELS_FLASH - 1) * 24];
+  }
   for(y=0; y<5; y++) {
+    space->MonsterAlive[y] = 0;
     for(x=0; x<6; x++) {
-      if(y!=4) space->MonsterGrid[y][x] = MonstersLevels[(Levels * 24) + (y * 6) + x];
+      if(y!=4) space->MonsterGrid[y][x] = level[(y * 6) + x];
       else     space->MonsterGrid[y][x] = -1;
+      if(space->MonsterGrid[y][x] != -1) space->MonsterAlive[y] |= 1 << x;
     }
+    space->MonsterUsed[y] = space->MonsterAlive[y];
   }
+  MonsterStripDirty = MONSTER_STRIP_ALL;
 }
 
 void SnD(int8_t Sp_, uint8_t SN) {
-  if(Sp_ != -120) {JOY_sound(220, 8); JOY_sound(200, 4);}
+  if(Sp_ != -120) JOY_sfx(SFX_SAUCER);
   else JOY_sound(SN, 1);
 }
 
 void SpeedControle(SPACE *space) {
-  uint8_t xx, yy;
+  uint8_t yy, bits;
   MONSTERrest = 0;
   for(yy=0; yy<4; yy++) {
-    for(xx=0; xx<6; xx++) {
-      if((space->MonsterGrid[yy][xx] != -1) && ((space->MonsterGrid[yy][xx] <=5 ))) MONSTERrest++;
-    }
+    for(bits = space->MonsterAlive[yy]; bits; bits &= bits - 1) MONSTERrest++;
   }
   space->frameMax = (MONSTERrest >> 3);
 }
 
 // Thanks to Sven Bruns for informing me of an error in this function!
 void GRIDMonsterFloorY(SPACE *space) {
-  uint8_t y,x;
+  uint8_t y;
   space->MonsterFloorMax = 3;
   for(y=0; y<4; y++) {
-    for(x=0; x<6; x++) {
-      if(space->MonsterGrid[3-y][x] != -1) return;
-    }
+    if(space->MonsterUsed[3-y]) return;
     space->MonsterFloorMax = space->MonsterFloorMax - 1;
   }
 }
@@ -231,39 +282,26 @@ uint8_t LivePrint(uint8_t x, uint8_t y) {
 }
 
 void Tiny_Flip(uint8_t render0_picture1, SPACE *space) {
-  uint8_t y, x; 
-  uint8_t MYSHIELD = 0x00;
+  uint8_t y; 
+  if(render0_picture1 == 0) {
+    MyShootUpdate(space);
+    LayerUpdate(space);
+  }
+  else JOY_OLED_rle_start(intro);
+  JOY_OLED_frame_begin();
   for(y=0; y<8; y++) {
     JOY_OLED_data_start(y);
-    for(x=0; x<128; x++) {
-      if(render0_picture1 == 0) {
-        if(ShieldRemoved == 0) MYSHIELD = MyShield(x, y, space);
-        else MYSHIELD = 0x00;
-        JOY_OLED_send( background(x, y, space)
-                       | LivePrint(x, y) 
-                       | Vesso(x, y, space)
-                       | UFOWrite(x, y, space)
-                       | Monster(x, y, space)
-                       | MyShoot(x, y, space)
-                       | MonsterShoot(x, y, space)
-                       | MYSHIELD);
-      }
-      else JOY_OLED_send(intro[x + (y * 128)]);
-    }
-    if(render0_picture1 == 0) {
-      if(ShieldRemoved == 0) ShieldDestroy(0, space->MyShootBallxpos, space->MyShootBall, space);
-    }
+    if(render0_picture1 == 0) JOY_OLED_compose(y, 0, 127, space);
+    else JOY_OLED_rle_page(128);
     JOY_OLED_end();
   }
+  JOY_OLED_frame_end();
   if(render0_picture1 == 0) {
     if(!(space->MonsterGroupeYpos < (2 + (4 - (space->MonsterFloorMax + 1))))) {
       if(ShieldRemoved != 1) {
-        space->Shield[0] = 0x00;
-        space->Shield[1] = 0x00;
-        space->Shield[2] = 0x00;
-        space->Shield[3] = 0x00;
-        space->Shield[4] = 0x00;
-        space->Shield[5] = 0x00;
+        space->Shield[0] = 0;
+        space->Shield[1] = 0;
+        space->Shield[2] = 0;
         ShieldRemoved = 1;
       }
     }
@@ -301,164 +339,48 @@ void MonsterShootupdate(SPACE *space) {
 }
 
 void MonsterShootGenerate(SPACE *space) {
-  uint8_t a = JOY_random() % 3; 
-  uint8_t b = JOY_random() % 6; 
+  uint8_t a = FM_below(JOY_random(), 3);
+  uint8_t b = FM_below(JOY_random(), 6);
   if(b >= 5) b = 5;
   if(space->MonsterShoot[1] == 16) {
-    if(space->MonsterGrid[a][b] != -1) {
+    if(space->MonsterUsed[a] & (1 << b)) {
       space->MonsterShoot[0] = (space->MonsterGroupeXpos + 7) + (b * 14);
       space->MonsterShoot[1] = ((space->MonsterGroupeYpos + a) * 2) + 1;
     }
   }
 }
 
-uint8_t MonsterShoot(uint8_t x, uint8_t y, SPACE *space) {
-  if(((space->MonsterShoot[1] >> 1) == y) && (space->MonsterShoot[0] == x)) {
-    if((space->MonsterShoot[1] & 1) == 0) return 0b00001111;
-    else return 0b11110000;
-  }
-  return 0x00;
+// Shield at or left of x, returns the column of x in it (SHIELD_W or more: gap)
+uint8_t ShieldColumn(uint8_t x, uint8_t *shield) {
+  uint8_t col = x - SHIELD_X;
+  for(*shield=0; (col >= SHIELD_GAP) && (*shield < SHIELDS - 1); (*shield)++) col -= SHIELD_GAP;
+  return col;
 }
 
+// Erode the shield column hit by a shoot, returns 1 if there was one
 uint8_t ShieldDestroy(uint8_t Origine, uint8_t VarX, uint8_t VarY, SPACE *space) {
-  #define OFFSETXSHIELD -1
-  if(VarY == 6) {
-    if((VarX >= 20 + OFFSETXSHIELD) && (VarX <= 27 + OFFSETXSHIELD)) {
-      if(BOOLREAD(0, VarX - (20 + OFFSETXSHIELD), space)) {
-        ShieldDestroyWrite(0, VarX - (20 + OFFSETXSHIELD), space, Origine);
-        return 1;
-      }
-    }
-    if((VarX >= 28 + OFFSETXSHIELD) && (VarX <= 35 + OFFSETXSHIELD)) {
-      if(BOOLREAD(1, VarX - (28 + OFFSETXSHIELD), space)) {
-        ShieldDestroyWrite(1, VarX - (28 + OFFSETXSHIELD), space, Origine);
-        return 1;
-      }
-    }
-    if((VarX >= 55 + OFFSETXSHIELD) && (VarX <= 62 + OFFSETXSHIELD)) {
-      if(BOOLREAD(2, VarX - (55 + OFFSETXSHIELD), space)) {
-        ShieldDestroyWrite(2, VarX - (55 + OFFSETXSHIELD), space, Origine);
-        return 1;
-      }
-    }
-    if((VarX >= 63 + OFFSETXSHIELD) && (VarX <= 70 + OFFSETXSHIELD)) {
-      if(BOOLREAD(3, VarX - (63 + OFFSETXSHIELD), space)) {
-        ShieldDestroyWrite(3, VarX - (63 + OFFSETXSHIELD), space, Origine);
-        return 1;
-      }
-    }
-    if((VarX >= 90 + OFFSETXSHIELD) && (VarX <= 97 + OFFSETXSHIELD)) {
-      if(BOOLREAD(4, VarX - (90 + OFFSETXSHIELD), space)) {
-        ShieldDestroyWrite(4, VarX - (90 + OFFSETXSHIELD), space, Origine);
-        return 1;
-      }
-    }
-    if((VarX >= 98 + OFFSETXSHIELD) && (VarX <= 105 + OFFSETXSHIELD)) {
-      if(BOOLREAD(5, VarX - (98 + OFFSETXSHIELD), space)) {
-        ShieldDestroyWrite(5, VarX - (98 + OFFSETXSHIELD), space, Origine);
-        return 1;
-      }
-    }
-  }
-  return 0;
-}
-
-void ShieldDestroyWrite(uint8_t BOOLWRITE, uint8_t line, SPACE *space, uint8_t Origine) {
-  switch(line) {
-    case 0:
-      space->Shield[BOOLWRITE] = space->Shield[BOOLWRITE] - 128;
-      if(Origine == 0) space->MyShootBall = -1;
-      break;
-    case 1:
-      space->Shield[BOOLWRITE] = space->Shield[BOOLWRITE] - 64;
-      if(Origine == 0) space->MyShootBall = -1;
-      break;
-    case 2:
-      space->Shield[BOOLWRITE] = space->Shield[BOOLWRITE] - 32;
-      if(Origine == 0) space->MyShootBall = -1;
-      break;
-    case 3:
-      space->Shield[BOOLWRITE] = space->Shield[BOOLWRITE] - 16;
-      if(Origine == 0) space->MyShootBall = -1;
-      break;
-    case 4:
-      space->Shield[BOOLWRITE] = space->Shield[BOOLWRITE] - 8;
-      if(Origine == 0) space->MyShootBall = -1;
-      break;
-    case 5:
-      space->Shield[BOOLWRITE] = space->Shield[BOOLWRITE] - 4;
-      if(Origine == 0) space->MyShootBall = -1;
-      break;
-    case 6:
-      space->Shield[BOOLWRITE] = space->Shield[BOOLWRITE] - 2;
-      if(Origine == 0) space->MyShootBall = -1;
-      break;
-    case 7:
-      space->Shield[BOOLWRITE] = space->Shield[BOOLWRITE] - 1;
-      if(Origine == 0) space->MyShootBall = -1;
-      break;
-    default:
-      break;
-  }
-}
-
-uint8_t MyShield(uint8_t x, uint8_t y, SPACE *space) {
-  #define OFFSETXSHIELD -1
-  if(y != 6) return 0x00;
-  if((x >= 20 + OFFSETXSHIELD) && (x <= 27 + OFFSETXSHIELD)) {
-    if(BOOLREAD(0, x - (20 + OFFSETXSHIELD), space)) return ShieldBlitz(0, x - (20 + OFFSETXSHIELD));
-    else return 0x00;
-  }
-  if((x >= 28 + OFFSETXSHIELD) && (x <= 35 + OFFSETXSHIELD)) {
-    if(BOOLREAD(1, x - (28 + OFFSETXSHIELD), space)) return ShieldBlitz(1, x - (28 + OFFSETXSHIELD));
-    else return 0x00;
-  }
-  if((x >= 55 + OFFSETXSHIELD) && (x <= 62 + OFFSETXSHIELD)) {
-    if(BOOLREAD(2, x - (55 + OFFSETXSHIELD), space)) return ShieldBlitz(0, x - (55 + OFFSETXSHIELD));
-    else return 0x00;
-  }
-  if((x >= 63 + OFFSETXSHIELD) && (x <= 70 + OFFSETXSHIELD)) {
-    if(BOOLREAD(3, x - (63 + OFFSETXSHIELD), space)) return ShieldBlitz(1, x - (63 + OFFSETXSHIELD));
-    else return 0x00;
-  }
-  if((x >= 90 + OFFSETXSHIELD) && (x <= 97 + OFFSETXSHIELD)) {
-    if(BOOLREAD(4, x - (90 + OFFSETXSHIELD), space)) return ShieldBlitz(0, x - (90 + OFFSETXSHIELD));
-    else return 0x00;
-  }
-  if((x >= 98 + OFFSETXSHIELD) && (x <= 105 + OFFSETXSHIELD)) {
-    if(BOOLREAD(5, x - (98 + OFFSETXSHIELD), space)) return ShieldBlitz(1, x - (98 + OFFSETXSHIELD));
-    else return 0x00;
-  }
-  return 0x00;
-}
-
-uint8_t ShieldBlitz(uint8_t Part, uint8_t LineSH) {
-  uint8_t Var0 = 0;
-  switch(LineSH) {
-    case 0: if(Part == 0) Var0 = 0b11110000; else Var0 = 0b00001111; break;
-    case 1: if(Part == 0) Var0 = 0b11111100; else Var0 = 0b00001111; break;
-    case 2:
-    case 3:
-    case 4:
-    case 5: Var0 = 0b00001111; break;
-    case 6: if(Part == 1) Var0 = 0b11111100; else Var0 = 0b00001111; break;
-    case 7: if(Part == 1) Var0 = 0b11110000; else Var0 = 0b00001111; break;
-    default: Var0 = 0b00000000; break;
-  }
-  return Var0;
-}
-
-uint8_t BOOLREAD(uint8_t SHnum, uint8_t LineSH, SPACE *space) {
-  uint8_t Var0 = 0b10000000 >> LineSH;
-  return((space->Shield[SHnum] & Var0) != 0);
+  uint8_t  s, col = ShieldColumn(VarX, &s);
+  uint16_t bit;
+  if((VarY != SHIELD_ROW) || (col >= SHIELD_W)) return 0;
+  bit = 0x8000 >> col;
+  if(!(space->Shield[s] & bit)) return 0;
+  space->Shield[s] &= ~bit;
+  if(Origine == 0) space->MyShootBall = -1;
+  return 1;
 }
 
 void RemoveExplodOnMonsterGrid(SPACE *space) {
-  uint8_t x, y;
+  uint8_t x, y, bits;
   for(y=0; y<=3; y++) {
-    for(x=0; x<=5; x++) {
-      if(space->MonsterGrid[y][x] >= 11) space->MonsterGrid[y][x] = -1; 
-      if(space->MonsterGrid[y][x] >= 8)  space->MonsterGrid[y][x] = space->MonsterGrid[y][x] + 1;
+    bits = space->MonsterUsed[y] & ~space->MonsterAlive[y]; // exploding monsters
+    if(bits) MonsterStripDirty |= 1 << y;
+    for(x=0; bits; x++, bits >>= 1) {
+      if(!(bits & 1)) continue;
+      if(space->MonsterGrid[y][x] >= 11) {
+        space->MonsterGrid[y][x] = -1;
+        space->MonsterUsed[y] &= ~(1 << x);
+      }
+      else space->MonsterGrid[y][x] = space->MonsterGrid[y][x] + 1;
     }
   }
 }
@@ -480,23 +402,23 @@ uint8_t Vesso(uint8_t x, uint8_t y, SPACE *space) {
 void UFO_Attack_Check(uint8_t x, SPACE *space) {
   if(space->MyShootBall == 0) {
     if((space->MyShootBallxpos >= space->UFOxPos) && (space->MyShootBallxpos <= space->UFOxPos + 14)) {
-      for(x=1; x<100; x++) JOY_sound(x, 1);
+      JOY_sfx(SFX_UFO);
       if(Live < 3) Live++;
       space->UFOxPos =- 120;
     }
   }
 }
 
-uint8_t MyShoot(uint8_t x, uint8_t y, SPACE *space) {
-  if((space->MyShootBallxpos == x) && (y == space->MyShootBall)) {
-    if(space->MyShootBall > -1) space->MyShootBallFrame = !space->MyShootBallFrame;
-    else return 0x00;
-    if(space->MyShootBallFrame == 1) space->MyShootBall--;
-    Monster_Attack_Check(space);
-    UFO_Attack_Check(x, space);
-    return SHOOT[space->MyShootBallFrame];
-  }
-  return 0x00;
+// Move my shoot and check its collisions once per frame before rendering.
+// The shoot is drawn on the page it was on before it moved.
+void MyShootUpdate(SPACE *space) {
+  if(ShieldRemoved == 0) ShieldDestroy(0, space->MyShootBallxpos, space->MyShootBall, space);
+  MyShootY = space->MyShootBall;
+  if(MyShootY < 0) return;
+  space->MyShootBallFrame = !space->MyShootBallFrame;
+  if(space->MyShootBallFrame == 1) space->MyShootBall--;
+  Monster_Attack_Check(space);
+  UFO_Attack_Check(space->MyShootBallxpos, space);
 }
 
 void Monster_Attack_Check(SPACE *space) {
@@ -510,82 +432,42 @@ void Monster_Attack_Check(SPACE *space) {
   if((MYSHOOTX >= Xmouin) && (MYSHOOTX <= XPlus) && (MYSHOOTY >= Ymouin) && (MYSHOOTY <= YPlus)) {
     //enter in the monster zone
     Vary = (MYSHOOTY - Ymouin + 4) >> 3;
-    Varx = (MYSHOOTX - Xmouin + 7) / 14;
+    Varx = FM_div14(MYSHOOTX - Xmouin + 7);
     if(Varx < 0) Varx = 0;
     if(Vary < 0) Vary = 0;
     if(Varx > 5) return;
     if(Vary > 3) return;
-    if((space->MonsterGrid[Vary][Varx] > -1) && (space->MonsterGrid[Vary][Varx] < 6)) {
-      JOY_sound(50, 10);
+    if(space->MonsterAlive[Vary] & (1 << Varx)) {
+      JOY_sfx(SFX_HIT);
       space->MonsterGrid[Vary][Varx] = 8;
+      MonsterStripDirty |= 1 << Vary;
+      space->MonsterAlive[Vary] &= ~(1 << Varx);
       space->MyShootBall = -1;
-      SpeedControle(space);
+      MONSTERrest--;
+      space->frameMax = (MONSTERrest >> 3);
     }
     //fin monster zone
   }
 }
 
-int8_t OuDansLaGrilleMonster(uint8_t x, uint8_t y, SPACE *space) {
-  if(x < space->MonsterGroupeXpos) return -1;
-  if(y < space->MonsterGroupeYpos) return -1;
-  space->PositionDansGrilleMonsterX = (x - space->MonsterGroupeXpos) / 14;
-  space->PositionDansGrilleMonsterY = (y - space->MonsterGroupeYpos);
-  if(space->PositionDansGrilleMonsterX > 5) return -1;
-  if(space->PositionDansGrilleMonsterY > 4) return -1;
-  return 0;
-}
-
-uint8_t SplitSpriteDecalageY(uint8_t Input, uint8_t UPorDOWN, SPACE *space) {
-  if(UPorDOWN) return(Input << space->DecalageY8);
-  else return(Input >> (8 - space->DecalageY8));
-}
-
-uint8_t Murge_Split_UP_DOWN(uint8_t x, SPACE *space) {
-  int8_t SpriteType = -1;
-  int8_t ANIMs = -1;
-  uint8_t Murge1 = 0;
-  uint8_t Murge2 = 0;
-  if(space->DecalageY8 == 0) {
-    SpriteType = space->MonsterGrid[space->PositionDansGrilleMonsterY][space->PositionDansGrilleMonsterX];
-    if(SpriteType < 8) ANIMs = space->anim * 14;
-    else ANIMs = 0;
-    if(SpriteType == -1) return 0x00;
-    return Monsters[(WriteMonster14(x - space->MonsterGroupeXpos) + SpriteType * 14) + ANIMs];
-  }
-  else {
-    //debut
-    if(space->PositionDansGrilleMonsterY == 0) {
-      SpriteType = space->MonsterGrid[space->PositionDansGrilleMonsterY][space->PositionDansGrilleMonsterX];
-      if(SpriteType < 8) ANIMs = space->anim * 14;
-      else ANIMs = 0;
-      if(SpriteType != -1) Murge2 = SplitSpriteDecalageY(Monsters[(WriteMonster14(x - space->MonsterGroupeXpos) + SpriteType * 14) + ANIMs], 1, space);
-      else Murge2 = 0x00;
-      return Murge2;
+// Render the formation rows marked in MonsterStripDirty into their strips
+void MonsterStripUpdate(SPACE *space) {
+  uint8_t row, col, dx, *strip;
+  int8_t  type;
+  const uint8_t *sprite;
+  for(row=0; MonsterStripDirty; row++, MonsterStripDirty >>= 1) {
+    if(!(MonsterStripDirty & 1)) continue;
+    strip = MonsterStrip[row];
+    for(col=0; col<6; col++, strip += 14) {
+      type = space->MonsterGrid[row][col];
+      if(type < 0) {
+        for(dx=0; dx<14; dx++) strip[dx] = 0;
+        continue;
+      }
+      sprite = &Monsters[type * 14 + ((type < 8) ? space->anim * 14 : 0)];
+      for(dx=0; dx<14; dx++) strip[dx] = sprite[dx];
     }
-    else {
-      SpriteType = space->MonsterGrid[space->PositionDansGrilleMonsterY - 1][space->PositionDansGrilleMonsterX];
-      if(SpriteType < 8) ANIMs = space->anim * 14;
-      else ANIMs = 0;
-      if(SpriteType != -1) Murge1 = SplitSpriteDecalageY(Monsters[(WriteMonster14(x - space->MonsterGroupeXpos) + SpriteType * 14) + ANIMs], 0, space);
-      else Murge1 = 0x00;
-      SpriteType = space->MonsterGrid[space->PositionDansGrilleMonsterY][space->PositionDansGrilleMonsterX];
-      if(SpriteType < 8) ANIMs = space->anim * 14;
-      else ANIMs = 0;
-      if(SpriteType != -1) Murge2 = SplitSpriteDecalageY(Monsters[(WriteMonster14(x - space->MonsterGroupeXpos) + SpriteType * 14) + ANIMs], 1, space);
-      else Murge2 = 0x00;
-      return(Murge1 | Murge2);
-    }  
-  } //fin
-}
-
-uint8_t WriteMonster14(uint8_t x) {
-  while(x >= 14) x -= 14;
-  return x;
-}
-
-uint8_t Monster(uint8_t x, uint8_t y, SPACE *space) {
-  if(OuDansLaGrilleMonster(x, y, space) != -1) return  Murge_Split_UP_DOWN(x, space);
-  return 0x00;
+  }
 }
 
 uint8_t MonsterRefreshMove(SPACE *space) {
@@ -627,17 +509,100 @@ uint8_t MonsterRefreshMove(SPACE *space) {
   }
 }
 
+enum {L_BACKGROUND = 0, L_LIVE, L_VESSO, L_UFO, L_MONSTER, L_MYSHOOT, L_MONSTERSHOOT, L_SHIELD};
+
+void LayerBackground(uint8_t *buf, uint8_t x0, uint8_t x1, uint8_t y, void *ctx) {
+  for(; x0<=x1; x0++) *buf++ |= background(x0, y, (SPACE *)ctx);
+}
+
+void LayerLive(uint8_t *buf, uint8_t x0, uint8_t x1, uint8_t y, void *ctx) {
+  for(; x0<=x1; x0++) *buf++ |= LivePrint(x0, y);
+}
+
+void LayerVesso(uint8_t *buf, uint8_t x0, uint8_t x1, uint8_t y, void *ctx) {
+  for(; x0<=x1; x0++) *buf++ |= Vesso(x0, y, (SPACE *)ctx);
+}
+
+void LayerUFO(uint8_t *buf, uint8_t x0, uint8_t x1, uint8_t y, void *ctx) {
+  for(; x0<=x1; x0++) *buf++ |= UFOWrite(x0, y, (SPACE *)ctx);
+}
+
+// Copy the formation strips along the span, the lower part of the row above
+// is shifted in when the formation is between pages
+void LayerMonster(uint8_t *buf, uint8_t x0, uint8_t x1, uint8_t y, void *ctx) {
+  SPACE  *space = (SPACE *)ctx;
+  uint8_t row   = y - space->MonsterGroupeYpos;
+  uint8_t d     = space->DecalageY8;
+  uint8_t dx    = x0 - space->MonsterGroupeXpos;
+  uint8_t n     = x1 - x0 + 1;
+  if(dx >= 6 * 14) return;
+  if(n > 6 * 14 - dx) n = 6 * 14 - dx;
+  if(row < 4)  JOY_LAYER_or(buf, &MonsterStrip[row][dx], n, d);
+  if(row && d) JOY_LAYER_or(buf, &MonsterStrip[row - 1][dx], n, d - 8);
+}
+
+void LayerMyShoot(uint8_t *buf, uint8_t x0, uint8_t x1, uint8_t y, void *ctx) {
+  SPACE *space = (SPACE *)ctx;
+  JOY_LAYER_blit(buf, x0, x1, y, &BOLT, space->MyShootBallxpos, MYSHOOTROW(space));
+}
+
+void LayerMonsterShoot(uint8_t *buf, uint8_t x0, uint8_t x1, uint8_t y, void *ctx) {
+  SPACE *space = (SPACE *)ctx;
+  JOY_LAYER_blit(buf, x0, x1, y, &BOLT, space->MonsterShoot[0], MONSTERSHOOTROW(space));
+}
+
+// Walk the shield columns along the span (page SHIELD_ROW only)
+void LayerShield(uint8_t *buf, uint8_t x0, uint8_t x1, uint8_t y, void *ctx) {
+  SPACE  *space = (SPACE *)ctx;
+  uint8_t s, col = ShieldColumn(x0, &s);
+  for(; x0<=x1; x0++, buf++) {
+    if((col < SHIELD_W) && (space->Shield[s] & (0x8000 >> col))) *buf |= ShieldShape[col];
+    if(++col == SHIELD_GAP) {
+      col = 0;
+      if(++s == SHIELDS) break;
+    }
+  }
+}
+
+void LayerInit(void) {
+  JOY_LAYER_add(L_BACKGROUND,   LayerBackground);
+  JOY_LAYER_add(L_LIVE,         LayerLive);
+  JOY_LAYER_add(L_VESSO,        LayerVesso);
+  JOY_LAYER_add(L_UFO,          LayerUFO);
+  JOY_LAYER_add(L_MONSTER,      LayerMonster);
+  JOY_LAYER_add(L_MYSHOOT,      LayerMyShoot);
+  JOY_LAYER_add(L_MONSTERSHOOT, LayerMonsterShoot);
+  JOY_LAYER_add(L_SHIELD,       LayerShield);
+  JOY_LAYER_set(L_BACKGROUND, 0, 127, 0, 7);
+  #if JOY_GRAY > 0
+  JOY_LAYER_shade(L_BACKGROUND, LAYER_DIM);
+  #endif
+}
+
+// Set bounding boxes of the layers for the next frame
+void LayerUpdate(SPACE *space) {
+  MonsterStripUpdate(space);
+  JOY_LAYER_set(L_LIVE, 0, (5 * Live) - 1, 7, 7);
+  JOY_LAYER_set(L_VESSO, ShipPos, ShipPos + 12, 7, 7);
+  if(space->UFOxPos != -120) JOY_LAYER_set(L_UFO, space->UFOxPos, space->UFOxPos + 14, 0, 0);
+  else JOY_LAYER_hide(L_UFO);
+  JOY_LAYER_set(L_MONSTER, space->MonsterGroupeXpos, space->MonsterGroupeXpos + 83,
+                space->MonsterGroupeYpos, space->MonsterGroupeYpos + 4);
+  if(MyShootY >= 0) JOY_LAYER_place(L_MYSHOOT, &BOLT, space->MyShootBallxpos, MYSHOOTROW(space));
+  else JOY_LAYER_hide(L_MYSHOOT);
+  JOY_LAYER_place(L_MONSTERSHOOT, &BOLT, space->MonsterShoot[0], MONSTERSHOOTROW(space));
+  if(ShieldRemoved == 0) JOY_LAYER_set(L_SHIELD, SHIELD_X, SHIELD_X1, SHIELD_ROW, SHIELD_ROW);
+  else JOY_LAYER_hide(L_SHIELD);
+}
+
 void VarResetNewLevel(SPACE *space) {
   ShieldRemoved = 0;
   SpeedShootMonster = 0;
   MONSTERrest = 24;
   LoadMonstersLevels(LEVELS, space);
-  space->Shield[0] = 255;
-  space->Shield[1] = 255;
-  space->Shield[2] = 255;
-  space->Shield[3] = 255;
-  space->Shield[4] = 255;
-  space->Shield[5] = 255;
+  space->Shield[0] = 0xFFFF;
+  space->Shield[1] = 0xFFFF;
+  space->Shield[2] = 0xFFFF;
   space->MonsterShoot[0] = 16;
   space->MonsterShoot[1] = 16;
   space->UFOxPos = -120;
@@ -647,8 +612,6 @@ void VarResetNewLevel(SPACE *space) {
   space->MyShootBallFrame = 0;
   space->anim = 0;
   space->frame = 0;
-  space->PositionDansGrilleMonsterX = 0;
-  space->PositionDansGrilleMonsterY = 0;
   space->MonsterFloorMax = 3;
   space->MonsterOffsetGauche = 0;
   space->MonsterOffsetDroite = 44;
@@ -25,20 +25,22 @@
 extern "C" {
 #endif
 
+#include "sprite_shift.h"
+
 typedef struct SPACE {
   int8_t UFOxPos;
   uint8_t oneFrame;
   uint8_t MonsterShoot[2];
   int8_t MonsterGrid[5][6];
-  uint8_t Shield[6];                         
+  uint8_t MonsterAlive[5];                  // bit x: living monster in column x
+  uint8_t MonsterUsed[5];                   // bit x: living or exploding monster
+  uint16_t Shield[3];                       // bit 15-x: column x of a shield is up
   uint8_t ScrBackV;
   int8_t MyShootBall;
   uint8_t MyShootBallxpos;
   uint8_t MyShootBallFrame;
   uint8_t anim;
   uint8_t frame;
-  uint8_t PositionDansGrilleMonsterX;
-  uint8_t PositionDansGrilleMonsterY;
   uint8_t MonsterFloorMax;
   uint8_t MonsterOffsetGauche;
   uint8_t MonsterOffsetDroite;
@@ -49,6 +51,11 @@ typedef struct SPACE {
   uint8_t Direction;
 } SPACE;
 
+// Monster grids of the levels (4 rows of 6, -1: empty), the ones of the EEPROM
+// image (asset A_LEVELS, 24 bytes each) follow the LEVELS_FLASH in flash
+#define LEVELS_FLASH 10
+#define A_LEVELS     0
+
 const int8_t MonstersLevels[] = {
   0,0,0,0,0,0,2,2,2,2,2,2,4,4,4,4,4,4,4,4,4,4,4,4,
   4,4,4,4,4,4,4,2,0,0,2,4,4,2,0,0,2,4,4,4,4,4,4,4,
@@ -66,22 +73,30 @@ const uint8_t LIVE[] = {
   0x80, 0xC0, 0x80, 0x00, 0x00, 0x80, 0xC0, 0x80, 0x00, 0x00, 0x80, 0xC0, 0x80, 0x00, 0x00
 };
 
-const uint8_t SHOOT[] = {
-  0b11110000, 0b00001111
+// Shots: a bolt of four pixels, drawn in half-page steps
+const uint8_t BOLT_DATA[] = {
+  0b00001111
 };
-
-const uint8_t Monsters[] = {
-  0x00, 0x00, 0x00, 0x58, 0xBC, 0x16, 0x3F, 0x3F, 0x16, 0xBC, 0x58, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x98, 0x5C, 0xB6, 0x5F, 0x5F, 0xB6, 0x5C, 0x98, 0x00, 0x00, 0x00, 0x00, 0x70, 0x18, 0x7D,
-  0xB6, 0xBC, 0x3C, 0x3C, 0xBC, 0xB6, 0x7D, 0x18, 0x70, 0x00, 0x00, 0x1E, 0xB8, 0x7D, 0x36, 0x3C,
-  0x3C, 0x3C, 0x3C, 0x36, 0x7D, 0xB8, 0x1E, 0x00, 0x00, 0x9C, 0x9E, 0x5E, 0x76, 0x37, 0x5F, 0x5F,
-  0x37, 0x76, 0x5E, 0x9E, 0x9C, 0x00, 0x00, 0x1C, 0x5E, 0xFE, 0xB6, 0x37, 0x5F, 0x5F, 0x37, 0xB6,
-  0xFE, 0x5E, 0x1C, 0x00, 0x00, 0x40, 0x60, 0xF0, 0x50, 0x78, 0x58, 0x58, 0x78, 0x50, 0xF0, 0x60,
-  0x40, 0x00, 0x00, 0x40, 0x60, 0xD0, 0x70, 0x58, 0x78, 0x78, 0x58, 0x70, 0xD0, 0x60, 0x40, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x24, 0x18, 0x18, 0x24, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x81, 0x00, 0x24, 0x18, 0x18, 0x24, 0x00, 0x81, 0x00, 0x00, 0x00, 0x00, 0x00, 0x24, 0x81,
-  0x18, 0x24, 0x5A, 0x5A, 0x24, 0x18, 0x81, 0x24, 0x00, 0x00, 0x42, 0x00, 0x24, 0x81, 0x4A, 0x3C,
-  0xA4, 0x25, 0x3C, 0x4A, 0x81, 0x24, 0x00, 0x42
+const SPRITE BOLT = { 1, 1, BOLT_DATA, 0 };
+
+#define MONSTERS(B) \
+  B(0x00) B(0x00) B(0x00) B(0x58) B(0xBC) B(0x16) B(0x3F) B(0x3F) B(0x16) B(0xBC) B(0x58) B(0x00) B(0x00) B(0x00) B(0x00) B(0x00) \
+  B(0x00) B(0x98) B(0x5C) B(0xB6) B(0x5F) B(0x5F) B(0xB6) B(0x5C) B(0x98) B(0x00) B(0x00) B(0x00) B(0x00) B(0x70) B(0x18) B(0x7D) \
+  B(0xB6) B(0xBC) B(0x3C) B(0x3C) B(0xBC) B(0xB6) B(0x7D) B(0x18) B(0x70) B(0x00) B(0x00) B(0x1E) B(0xB8) B(0x7D) B(0x36) B(0x3C) \
+  B(0x3C) B(0x3C) B(0x3C) B(0x36) B(0x7D) B(0xB8) B(0x1E) B(0x00) B(0x00) B(0x9C) B(0x9E) B(0x5E) B(0x76) B(0x37) B(0x5F) B(0x5F) \
+  B(0x37) B(0x76) B(0x5E) B(0x9E) B(0x9C) B(0x00) B(0x00) B(0x1C) B(0x5E) B(0xFE) B(0xB6) B(0x37) B(0x5F) B(0x5F) B(0x37) B(0xB6) \
+  B(0xFE) B(0x5E) B(0x1C) B(0x00) B(0x00) B(0x40) B(0x60) B(0xF0) B(0x50) B(0x78) B(0x58) B(0x58) B(0x78) B(0x50) B(0xF0) B(0x60) \
+  B(0x40) B(0x00) B(0x00) B(0x40) B(0x60) B(0xD0) B(0x70) B(0x58) B(0x78) B(0x78) B(0x58) B(0x70) B(0xD0) B(0x60) B(0x40) B(0x00) \
+  B(0x00) B(0x00) B(0x00) B(0x00) B(0x00) B(0x24) B(0x18) B(0x18) B(0x24) B(0x00) B(0x00) B(0x00) B(0x00) B(0x00) B(0x00) B(0x00) \
+  B(0x00) B(0x81) B(0x00) B(0x24) B(0x18) B(0x18) B(0x24) B(0x00) B(0x81) B(0x00) B(0x00) B(0x00) B(0x00) B(0x00) B(0x24) B(0x81) \
+  B(0x18) B(0x24) B(0x5A) B(0x5A) B(0x24) B(0x18) B(0x81) B(0x24) B(0x00) B(0x00) B(0x42) B(0x00) B(0x24) B(0x81) B(0x4A) B(0x3C) \
+  B(0xA4) B(0x25) B(0x3C) B(0x4A) B(0x81) B(0x24) B(0x00) B(0x42)
+
+const uint8_t Monsters[] = { MONSTERS(SPRITE_RAW) };
+
+const uint8_t ShieldShape[16] = {
+  0xF0, 0xFC, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F,
+  0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0xFC, 0xF0
 };
 
 const uint8_t vesso[] = {
@@ -157,61 +172,59 @@ const uint8_t back[] = {
 };
 
 
+// run-length encoded (606 bytes), see OLED_rle_page()
 const uint8_t intro[] = {
-  0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-  0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x80,0xC0,0xE0,0xE0,0xE0,0xF0,0xF0,0xF0,
-  0xF0,0xF0,0xF0,0xF0,0xF0,0xF0,0xF0,0xE0,0xC0,0xC0,0xE0,0xF0,0xF0,0xF0,0xF0,0xF0,0xF0,0xF0,0xF0,0xF0,
-  0xE0,0xE0,0xF0,0xF0,0xF0,0xF0,0xF0,0xF0,0xF0,0xF0,0xF0,0xF0,0xF0,0xF0,0xE0,0xE0,0xF0,0xF0,0xF0,0xF0,
-  0xF0,0xF0,0xF0,0xF0,0xF0,0xE0,0xC0,0xC0,0xE0,0xF0,0xF0,0xF0,0xF0,0xF0,0xE0,0xE0,0xC0,0x80,0x00,0x00,
-  0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-  0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-  0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x78,0x9C,0x1E,0x1F,
-  0x1F,0x1F,0x1F,0x1F,0x1F,0x1F,0x1F,0x1F,0x1F,0x1F,0x1F,0x3F,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0x1F,
-  0x1F,0x1F,0x1F,0x1F,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,
-  0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0x3F,0x3F,0x3F,0x3F,0x3F,0x3F,0xFF,0xFF,
-  0xFF,0xFF,0xFF,0xFF,0xFF,0x3F,0x3F,0x3E,0x3C,0x38,0xB0,0x60,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-  0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-  0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-  0x00,0x00,0x00,0x00,0x00,0x01,0x02,0x06,0x04,0x04,0x04,0xFC,0x00,0x00,0x00,0x00,0x00,0xFC,0xFC,0xFC,
-  0xFC,0xFF,0xFF,0xFF,0x7F,0x1F,0xFF,0x04,0x04,0x04,0x04,0x04,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0x07,
-  0x07,0x07,0x07,0x07,0x0F,0x07,0x07,0x07,0x07,0x07,0x07,0x0F,0x0F,0x1F,0x7F,0xFF,0xFF,0xFF,0xFF,0xFF,
-  0xFF,0xFC,0x00,0x00,0x00,0x00,0x01,0xFF,0x7F,0x3F,0x1F,0x07,0x80,0x40,0x20,0x18,0x0E,0x03,0x01,0x00,
-  0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-  0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-  0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x03,
-  0x7C,0x80,0x00,0x00,0x00,0x03,0x7F,0xFF,0xFF,0xFF,0x1F,0x03,0x00,0x00,0x07,0xF8,0x00,0x00,0x00,0x00,
-  0x07,0xFF,0xFF,0x0F,0xFF,0xFF,0x7F,0x00,0x00,0x00,0x00,0x80,0x7E,0x07,0x7F,0xFF,0xFF,0xFF,0x7E,0x00,
-  0x00,0x00,0x80,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0x7E,0x00,0x00,0x00,0x00,0xC0,0x30,0x18,0x06,0x03,
-  0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-  0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xC0,0xE0,0xF0,0xF8,0xFC,0xFE,0xFE,
-  0xFE,0xFE,0xFE,0xFE,0xFE,0xFC,0xFE,0xFE,0xFE,0xFE,0xFE,0xFE,0xFC,0xF0,0xEE,0xFE,0xFE,0xFE,0xFE,0xFE,
-  0xFE,0xFE,0xFE,0xFE,0xFE,0xFC,0xF8,0xF8,0xFE,0xFF,0xC0,0xC0,0xC0,0xC0,0xC0,0xFF,0xFF,0xE1,0xC0,0xC0,
-  0xF8,0xF8,0xF8,0xFF,0xC0,0xC0,0xC0,0xC0,0xC0,0xFF,0xFF,0xF0,0xFF,0xFF,0xC0,0xC0,0xC0,0xC0,0xC0,0xFF,
-  0xF8,0xF8,0xF8,0xFF,0xFF,0xFF,0xC0,0xC0,0xC0,0xC0,0xFF,0xF8,0xFF,0xFF,0xDF,0xC7,0xC1,0xC0,0xC0,0xC0,
-  0xF8,0xF6,0xE1,0xF8,0xF8,0xF8,0xF8,0xF8,0xF8,0xF8,0xF8,0xFE,0xFE,0xFE,0xFE,0xFE,0xFE,0xFC,0xF0,0xE0,
-  0xF0,0xF0,0xF8,0xFC,0xFC,0xFE,0xFE,0xFE,0xFE,0xFE,0xFE,0xFE,0xFE,0xF8,0xE0,0xE0,0xC0,0x00,0x00,0x00,
-  0x07,0x0F,0x79,0xE1,0xC1,0x01,0x03,0x0F,0x3F,0xFF,0xFF,0xF9,0xC3,0x83,0x07,0x0F,0x1F,0x7F,0xFF,0xFF,
-  0xF3,0x83,0x03,0x03,0x03,0x3F,0xFF,0xFF,0xFB,0xC3,0x03,0x03,0x07,0x0F,0x7F,0xFF,0xFF,0xFF,0xE1,0x01,
-  0x01,0x01,0x01,0x03,0xFF,0xFF,0xFF,0xFF,0xFF,0x03,0x03,0x03,0x03,0x01,0x01,0x01,0x01,0x0F,0xFF,0xFF,
-  0xFF,0xFF,0xFF,0x03,0x03,0x03,0x03,0x03,0xF3,0xF3,0xF3,0xF3,0x03,0x03,0x07,0x0F,0x0F,0xFF,0xFF,0xFF,
-  0xFF,0x03,0x03,0x03,0x03,0x83,0xF3,0xF3,0xF3,0xF3,0xF3,0xF3,0xF3,0xFF,0xFF,0xFF,0x1F,0x03,0x01,0x01,
-  0x81,0xF1,0xF1,0xF3,0xF3,0x03,0x03,0x03,0x03,0x8F,0xFF,0xFF,0xFF,0x7F,0x1F,0x0F,0x0F,0x87,0xE3,0xF3,
-  0xF1,0x31,0x01,0x01,0x01,0x81,0xE7,0x7E,0x00,0x00,0x00,0x00,0x03,0x07,0x1C,0x38,0xE0,0x80,0x03,0x07,
-  0x1F,0x7F,0xFE,0xF0,0xE0,0x80,0x00,0x01,0x07,0x07,0xCE,0x80,0x00,0x00,0x00,0x07,0x3F,0xFF,0xFF,0xFC,
-  0xF0,0xC0,0x00,0x03,0x0F,0x3F,0xFF,0xF8,0x80,0x00,0x00,0x00,0x3F,0xFF,0xFF,0xFF,0xFF,0x00,0x00,0x00,
-  0x00,0xFE,0xFC,0xE0,0x00,0x00,0x03,0xFF,0xFF,0xFF,0xFF,0xFF,0x00,0x00,0x00,0x00,0xFF,0xFF,0xFF,0x0F,
-  0x00,0x00,0x00,0x00,0xF8,0xFF,0xFF,0x0F,0x00,0x00,0x00,0x00,0xC0,0xCF,0xCF,0xCF,0xCF,0xCF,0xFF,0xFF,
-  0xFF,0x3F,0x07,0x01,0x00,0x00,0x80,0x9E,0x9F,0x1F,0x0F,0x61,0xE0,0xF0,0xF0,0xFC,0xFF,0xFF,0xEF,0x83,
-  0x80,0x80,0x80,0x98,0x1E,0x1F,0x1E,0x1F,0xF6,0xE6,0x06,0x06,0x06,0x07,0x01,0x00,0x70,0x80,0x70,0x00,
-  0x80,0x00,0xA8,0xA8,0xF9,0x03,0x0F,0x1C,0x70,0xE0,0x81,0x83,0x8F,0xBF,0xFE,0xF8,0xE0,0x80,0x81,0x8F,
-  0x9F,0xFE,0xDC,0x30,0xE0,0xC0,0x83,0x9F,0xFF,0xCF,0x1F,0x7C,0xE0,0xC0,0x81,0x83,0x83,0x80,0x80,0x80,
-  0x80,0xFF,0xFF,0x0F,0xFF,0x80,0x80,0x80,0x80,0xF3,0x13,0x13,0xF0,0x80,0x80,0x80,0x9F,0xFF,0xFF,0xFF,
-  0x80,0x80,0x80,0xBC,0xBF,0xBF,0xBF,0x80,0x80,0xC0,0xE0,0x7F,0xFF,0xFF,0x87,0x80,0x80,0x80,0x80,0xBE,
-  0xBF,0xBF,0xBF,0xBF,0xFF,0xFF,0xFF,0x9F,0x83,0x80,0x80,0xF0,0xFE,0xFF,0xFF,0x8F,0x81,0x80,0xE0,0xF0,
-  0x3E,0xFF,0xDF,0x87,0x87,0x87,0x97,0x9F,0x9F,0xDF,0xC7,0xE1,0x60,0x38,0x1C,0x0E,0x03,0x01,0x00,0x00,
-  0x00,0x00,0x00,0x00
+  0x9E, 0x00, 0x01, 0x80, 0xC0, 0x81, 0xE0, 0x88, 0xF0, 0x03, 0xE0, 0xC0, 0xC0, 0xE0, 0x87, 0xF0,
+  0x80, 0xE0, 0x8A, 0xF0, 0x80, 0xE0, 0x87, 0xF0, 0x03, 0xE0, 0xC0, 0xC0, 0xE0, 0x83, 0xF0, 0x80,
+  0xE0, 0x01, 0xC0, 0x80, 0xB8, 0x00, 0x02, 0x78, 0x9C, 0x1E, 0x8A, 0x1F, 0x00, 0x3F, 0x85, 0xFF,
+  0x83, 0x1F, 0x9A, 0xFF, 0x84, 0x3F, 0x85, 0xFF, 0x80, 0x3F, 0x04, 0x3E, 0x3C, 0x38, 0xB0, 0x60,
+  0xB3, 0x00, 0x02, 0x01, 0x02, 0x06, 0x81, 0x04, 0x00, 0xFC, 0x83, 0x00, 0x82, 0xFC, 0x81, 0xFF,
+  0x02, 0x7F, 0x1F, 0xFF, 0x83, 0x04, 0x85, 0xFF, 0x83, 0x07, 0x00, 0x0F, 0x84, 0x07, 0x80, 0x0F,
+  0x01, 0x1F, 0x7F, 0x84, 0xFF, 0x00, 0xFC, 0x82, 0x00, 0x0C, 0x01, 0xFF, 0x7F, 0x3F, 0x1F, 0x07,
+  0x80, 0x40, 0x20, 0x18, 0x0E, 0x03, 0x01, 0xBA, 0x00, 0x02, 0x03, 0x7C, 0x80, 0x81, 0x00, 0x01,
+  0x03, 0x7F, 0x81, 0xFF, 0x05, 0x1F, 0x03, 0x00, 0x00, 0x07, 0xF8, 0x82, 0x00, 0x06, 0x07, 0xFF,
+  0xFF, 0x0F, 0xFF, 0xFF, 0x7F, 0x82, 0x00, 0x03, 0x80, 0x7E, 0x07, 0x7F, 0x81, 0xFF, 0x00, 0x7E,
+  0x81, 0x00, 0x00, 0x80, 0x85, 0xFF, 0x00, 0x7E, 0x82, 0x00, 0x04, 0xC0, 0x30, 0x18, 0x06, 0x03,
+  0x9F, 0x00, 0x04, 0xC0, 0xE0, 0xF0, 0xF8, 0xFC, 0x85, 0xFE, 0x00, 0xFC, 0x84, 0xFE, 0x02, 0xFC,
+  0xF0, 0xEE, 0x88, 0xFE, 0x04, 0xFC, 0xF8, 0xF8, 0xFE, 0xFF, 0x83, 0xC0, 0x80, 0xFF, 0x02, 0xE1,
+  0xC0, 0xC0, 0x81, 0xF8, 0x00, 0xFF, 0x83, 0xC0, 0x80, 0xFF, 0x02, 0xF0, 0xFF, 0xFF, 0x83, 0xC0,
+  0x00, 0xFF, 0x81, 0xF8, 0x81, 0xFF, 0x82, 0xC0, 0x06, 0xFF, 0xF8, 0xFF, 0xFF, 0xDF, 0xC7, 0xC1,
+  0x81, 0xC0, 0x02, 0xF8, 0xF6, 0xE1, 0x86, 0xF8, 0x84, 0xFE, 0x07, 0xFC, 0xF0, 0xE0, 0xF0, 0xF0,
+  0xF8, 0xFC, 0xFC, 0x86, 0xFE, 0x03, 0xF8, 0xE0, 0xE0, 0xC0, 0x81, 0x00, 0x15, 0x07, 0x0F, 0x79,
+  0xE1, 0xC1, 0x01, 0x03, 0x0F, 0x3F, 0xFF, 0xFF, 0xF9, 0xC3, 0x83, 0x07, 0x0F, 0x1F, 0x7F, 0xFF,
+  0xFF, 0xF3, 0x83, 0x81, 0x03, 0x09, 0x3F, 0xFF, 0xFF, 0xFB, 0xC3, 0x03, 0x03, 0x07, 0x0F, 0x7F,
+  0x81, 0xFF, 0x00, 0xE1, 0x82, 0x01, 0x00, 0x03, 0x83, 0xFF, 0x82, 0x03, 0x82, 0x01, 0x00, 0x0F,
+  0x83, 0xFF, 0x83, 0x03, 0x82, 0xF3, 0x80, 0x03, 0x02, 0x07, 0x0F, 0x0F, 0x82, 0xFF, 0x82, 0x03,
+  0x00, 0x83, 0x85, 0xF3, 0x81, 0xFF, 0x08, 0x1F, 0x03, 0x01, 0x01, 0x81, 0xF1, 0xF1, 0xF3, 0xF3,
+  0x82, 0x03, 0x00, 0x8F, 0x81, 0xFF, 0x08, 0x7F, 0x1F, 0x0F, 0x0F, 0x87, 0xE3, 0xF3, 0xF1, 0x31,
+  0x81, 0x01, 0x02, 0x81, 0xE7, 0x7E, 0x82, 0x00, 0x13, 0x03, 0x07, 0x1C, 0x38, 0xE0, 0x80, 0x03,
+  0x07, 0x1F, 0x7F, 0xFE, 0xF0, 0xE0, 0x80, 0x00, 0x01, 0x07, 0x07, 0xCE, 0x80, 0x81, 0x00, 0x0D,
+  0x07, 0x3F, 0xFF, 0xFF, 0xFC, 0xF0, 0xC0, 0x00, 0x03, 0x0F, 0x3F, 0xFF, 0xF8, 0x80, 0x81, 0x00,
+  0x00, 0x3F, 0x82, 0xFF, 0x82, 0x00, 0x05, 0xFE, 0xFC, 0xE0, 0x00, 0x00, 0x03, 0x83, 0xFF, 0x82,
+  0x00, 0x81, 0xFF, 0x00, 0x0F, 0x82, 0x00, 0x03, 0xF8, 0xFF, 0xFF, 0x0F, 0x82, 0x00, 0x00, 0xC0,
+  0x83, 0xCF, 0x81, 0xFF, 0x12, 0x3F, 0x07, 0x01, 0x00, 0x00, 0x80, 0x9E, 0x9F, 0x1F, 0x0F, 0x61,
+  0xE0, 0xF0, 0xF0, 0xFC, 0xFF, 0xFF, 0xEF, 0x83, 0x81, 0x80, 0x06, 0x98, 0x1E, 0x1F, 0x1E, 0x1F,
+  0xF6, 0xE6, 0x81, 0x06, 0x2B, 0x07, 0x01, 0x00, 0x70, 0x80, 0x70, 0x00, 0x80, 0x00, 0xA8, 0xA8,
+  0xF9, 0x03, 0x0F, 0x1C, 0x70, 0xE0, 0x81, 0x83, 0x8F, 0xBF, 0xFE, 0xF8, 0xE0, 0x80, 0x81, 0x8F,
+  0x9F, 0xFE, 0xDC, 0x30, 0xE0, 0xC0, 0x83, 0x9F, 0xFF, 0xCF, 0x1F, 0x7C, 0xE0, 0xC0, 0x81, 0x83,
+  0x83, 0x82, 0x80, 0x80, 0xFF, 0x01, 0x0F, 0xFF, 0x82, 0x80, 0x03, 0xF3, 0x13, 0x13, 0xF0, 0x81,
+  0x80, 0x00, 0x9F, 0x81, 0xFF, 0x81, 0x80, 0x00, 0xBC, 0x81, 0xBF, 0x80, 0x80, 0x05, 0xC0, 0xE0,
+  0x7F, 0xFF, 0xFF, 0x87, 0x82, 0x80, 0x00, 0xBE, 0x82, 0xBF, 0x81, 0xFF, 0x0F, 0x9F, 0x83, 0x80,
+  0x80, 0xF0, 0xFE, 0xFF, 0xFF, 0x8F, 0x81, 0x80, 0xE0, 0xF0, 0x3E, 0xFF, 0xDF, 0x81, 0x87, 0x0B,
+  0x97, 0x9F, 0x9F, 0xDF, 0xC7, 0xE1, 0x60, 0x38, 0x1C, 0x0E, 0x03, 0x01, 0x84, 0x00
 };
 
+// Sound effects, see JOY_sfx()
+const uint8_t SFX_START[] = {3, SFX_NOTE(100, 125), SFX_NOTE(50, 125), SFX_END};
+const uint8_t SFX_LEVEL[] = {3, SFX_NOTE(110, 255), SFX_REST_MS(40), SFX_NOTE(130, 255), SFX_REST_MS(40),
+                                SFX_NOTE(100, 255), SFX_REST_MS(40), SFX_NOTE(1, 155),   SFX_REST_MS(20),
+                                SFX_NOTE(60, 255),  SFX_NOTE(60, 255), SFX_END};
+const uint8_t SFX_SHOT[]  = {2, SFX_NOTE(200, 4), SFX_END};
+const uint8_t SFX_HIT[]   = {2, SFX_NOTE(50, 10), SFX_END};
+const uint8_t SFX_SAUCER[]= {0, SFX_NOTE(220, 8), SFX_NOTE(200, 4), SFX_END};
+const uint8_t SFX_UFO[]   = {3, SFX_LOOP(99), SFX_SLIDE(1, 1, 1), SFX_NEXT, SFX_END};
+const uint8_t SFX_DEAD[]  = {1, SFX_NOTE(80, 1), SFX_NOTE(100, 1), SFX_END};
+
 #ifdef __cplusplus
 };
 #endif
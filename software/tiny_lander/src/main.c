@@ -32,15 +32,18 @@
 #include "driver.h"
 #include "spritebank.h"
 
+// Snapshot of the game (SNAP_STATE variables, see snapshot.h)
+#define SNAP_GAME   'L'
+#define SNAP_VER    1
+
 // ===================================================================================
 // Function Prototypes
 // ===================================================================================
 void initGame(GAME * game);
-void showAllScoresAndBonuses(GAME *game, DIGITAL *score, DIGITAL *velX, DIGITAL *velY);
+void showAllScoresAndBonuses(GAME *game, DIGITAL *score);
 void changeSpeed(GAME * game);
 void moveShip(GAME * game);
-void fillData(long myValue, DIGITAL * data);
-void SetLandingMap(uint8_t level, GAME *game);
+void SetLandingMap(const uint8_t *map, GAME *game);
 uint8_t ScoreDisplay(uint8_t x, uint8_t y, DIGITAL * score);
 uint8_t VelocityDisplay(uint8_t x, uint8_t y, DIGITAL * velocity, uint8_t horizontal);
 uint8_t DashboardDisplay(uint8_t x, uint8_t y, GAME * game);
@@ -50,70 +53,78 @@ uint8_t FuelDisplay(uint8_t x, uint8_t y, GAME * game);
 uint8_t GameDisplay(uint8_t x, uint8_t y, GAME * game);
 uint8_t StarsDisplay(uint8_t x, uint8_t y, GAME * game);
 uint8_t LivesDisplay(uint8_t x, uint8_t y, GAME * game);
-void Tiny_Flip(uint8_t mode, GAME * game, DIGITAL * score, DIGITAL * velX, DIGITAL * velY);
-
-void INTROJOY_sound(void);
-void VICTORYJOY_sound(void);
-void ALERTJOY_sound(void);
-void HAPPYJOY_sound(void);
-void SPLITDIGITS(uint16_t val, uint8_t *digits);
-uint8_t GETLANDSCAPE(uint8_t x, uint8_t y, uint8_t level, GAME *game);
+uint8_t HudUpdate(GAME * game, DIGITAL * score);
+void Tiny_Flip(uint8_t mode, GAME * game, DIGITAL * score);
+void LayerInit(void);
+void LayerUpdate(uint8_t mode);
+
+void SetLandscape(const uint8_t *map, const uint8_t *roof, GAME *game);
+uint8_t GETLANDSCAPE(uint8_t x, uint8_t y, GAME *game);
 void SETNEXTLEVEL(uint8_t level, GAME *game);
 
 // ===================================================================================
 // Main Function
 // ===================================================================================
 int main(void) {
+  static DIGITAL score SNAP_STATE;
+  static GAME game SNAP_STATE;
+
   // Setup
   JOY_init();
+  LayerInit();
   //JOY_OLED_fill(0x00);
+  if (JOY_resume(SNAP_GAME, SNAP_VER)) {     // suspended game: straight back in
+    Tiny_Flip(0, &game, &score);
+    goto RESUME;
+  }
 
   // Loop
   while(1) {
-    DIGITAL score;
-    DIGITAL velX;
-    DIGITAL velY;
-    GAME game;
-
   BEGIN:
     game.Level = 1;
     game.Score = 0;
+    score.D = 0;
+    score.IsNegative = false;
     game.Lives = 4;
+    JOY_event_flush();
+    // the title is sent once, then scrolled by the display without bus traffic
+    Tiny_Flip(1, &game, &score);
+    JOY_OLED_scroll_start(0, 7, OLED_SCROLL_LEFT, OLED_SCROLL_5);
     while(1) {
-      Tiny_Flip(1, &game, &score, &velX, &velY);
-      if (JOY_act_pressed()) {
+      if (JOY_act_clicked()) {
+        JOY_OLED_scroll_stop();
+        JOY_idle_wake();
+        JOY_poll();
         if (JOY_up_pressed()){ 
           game.Level = 10;
-          ALERTJOY_sound();
+          JOY_sfx(SFX_ALERT);
         }
         else if (JOY_down_pressed()) {
           game.Lives = 255;
-          ALERTJOY_sound();
-        }
-        else {
-          JOY_sound(100, 125);
-          JOY_sound(50, 125);
+          JOY_sfx(SFX_ALERT);
         }
-
+        else JOY_sfx(SFX_START);
+        JOY_sound_wait();
         goto START;
       }
+      JOY_idle(JOY_IDLE_POLL);
     }
 
   START:
     initGame(&game);
-    INTROJOY_sound();
+    JOY_sfx(SFX_INTRO);
+  RESUME:
+    JOY_frame_start();
     while(1) {
-      fillData(game.Score, &score);
-      fillData(game.velocityX, &velX);
-      fillData(game.velocityY, &velY);
       moveShip(&game);
       changeSpeed(&game);
 
-      Tiny_Flip(0, &game, &score, &velX, &velY);
+      if (JOY_frame_render)
+        Tiny_Flip(0, &game, &score);
       if (game.EndCounter > 8) {
         if (game.HasLanded)
         {
-          showAllScoresAndBonuses(&game, &score, &velX, &velY);
+          showAllScoresAndBonuses(&game, &score);
           JOY_DLY_ms(500);
           goto START;
         }
@@ -130,7 +141,7 @@ int main(void) {
         game.EndCounter++;
       if (game.HasLanded)
         game.EndCounter = 10;
-      JOY_SLOWDOWN();
+      JOY_frame_wait();
     }
   }
 }
@@ -142,10 +153,8 @@ void initGame(GAME * game)
 {
   SETNEXTLEVEL(game->Level, game);
 
-  game->velocityY = 0;
-  game->velocityX = 0;
-  game->velXCounter = 0;
-  game->velYCounter = 0;
+  game->Vel.x = 0;
+  game->Vel.y = 0;
   game->ShipExplode = 0;
   game->Toggle = true;
   game->Collision = false;
@@ -154,25 +163,26 @@ void initGame(GAME * game)
   game->Stars = 0;
 }
 
-void showAllScoresAndBonuses(GAME *game, DIGITAL *score, DIGITAL *velX, DIGITAL *velY)
+void showAllScoresAndBonuses(GAME *game, DIGITAL *score)
 {
-  VICTORYJOY_sound();
+  JOY_sfx(SFX_VICTORY);
   game->Level++;
+  TLM_counter(TLM_ID_LEVEL, game->Level);
   JOY_DLY_ms (1000);
   uint8_t bonusPoints = 0;
 
   // add bonus points
-  if ((abs(game->velocityY)) <= BONUSSPEED2)
+  if (FX_abs(game->Vel.y) <= VELO(BONUSSPEED2))
     bonusPoints++;
-  if ((abs(game->velocityY)) <= BONUSSPEED1)
+  if (FX_abs(game->Vel.y) <= VELO(BONUSSPEED1))
     bonusPoints++;
   if (game->Fuel >= game->FuelBonus)
     bonusPoints++;
 
   for (game->Stars = 1; game->Stars <= bonusPoints; game->Stars++)
   {
-    Tiny_Flip(2, game, score, velX, velY);
-    HAPPYJOY_sound();
+    Tiny_Flip(2, game, score);
+    JOY_sfx(SFX_HAPPY);
     JOY_DLY_ms(500);
   }
   game->Stars--;
@@ -181,14 +191,15 @@ void showAllScoresAndBonuses(GAME *game, DIGITAL *score, DIGITAL *velX, DIGITAL
   while (game->Score < newScore)
   {
     game->Score++;
-    fillData(game->Score, score);
-    Tiny_Flip(2, game, score, velX, velY);
+    score->D = BCD_inc(score->D);
+    Tiny_Flip(2, game, score);
     JOY_sound(129, 2);
   }
 }
 
 void changeSpeed(GAME * game)
 {
+  JOY_poll();
   game->ThrustLEFT = JOY_left_pressed();
   game->ThrustRIGHT = JOY_right_pressed();
   game->ThrustUP = JOY_act_pressed();
@@ -197,30 +208,22 @@ void changeSpeed(GAME * game)
   if (game->ThrustLEFT && game->Fuel > 0)
   {
     game->Fuel -= (FULLTHRUST / 2);
-    game->velocityX += TrustX;
-    if ((game->velocityX) > VLimit)
-      game->velocityX  = VLimit;
+    FX_accel(&game->Vel.x, VELO(TrustX), VELO(VLimit));
   }
   else if (game->ThrustRIGHT && game->Fuel > 0)
   {
     game->Fuel -= (FULLTHRUST / 2);
-    game->velocityX -= TrustX;
-    if ((game->velocityX) < -VLimit)
-      game->velocityX  = -VLimit;
+    FX_accel(&game->Vel.x, -VELO(TrustX), VELO(VLimit));
   }
 
   if (game->ThrustUP && game->Fuel > 0)
   {
     game->Fuel -= (FULLTHRUST * 2);
-    game->velocityY += TrustY;
-    if ((game->velocityY) > VLimit)
-      game->velocityY  = VLimit;
+    FX_accel(&game->Vel.y, -VELO(TrustY), VELO(VLimit));
   }
   else
   {
-    game->velocityY -= (GRAVITYDECY);
-    if ((game->velocityY) < -VLimit)
-      game->velocityY  = -VLimit;
+    FX_accel(&game->Vel.y, VELO(GRAVITYDECY), VELO(VLimit));
   }
 
   if ((game->Fuel) <= 0)
@@ -231,45 +234,13 @@ void moveShip(GAME * game)
 {
   if (game->ShipExplode > 0 || game->Collision || game->HasLanded) return;
 
-  game->velXCounter += abs(game->velocityX);
-  game->velYCounter += abs(game->velocityY);
-
-  if ((game->velXCounter) >= MoveX) {
-    game->velXCounter = 0;
-    if ((game->velocityX) > 0)
-      game->ShipPosX += 1;
-    if ((game->velocityX) < 0)
-      game->ShipPosX -= 1;
-  }
-
-  if (game->velYCounter >= MoveY) {
-    uint8_t inc = (abs(game->velocityY) / ACCELERATOR) + 1;
-    (game->velYCounter) = 0;
-    if ((game->velocityY) > 0)
-      game->ShipPosY -= inc;
-    if (game->velocityY < 0)
-      game->ShipPosY += inc;
-  }
+  FX_move(&game->Pos, &game->Vel);
 
   // boundaries....
-  if (game->ShipPosX > 121)
-  {
-    game->ShipPosX = 121;
-  }
-  else if (game->ShipPosX < 23)
-  {
-    game->ShipPosX = 23;
-  }
-  if (game->ShipPosY > 55)
-  {
-    game->ShipPosY = 55;
-  }
-}
-
-void fillData(long myValue, DIGITAL * data)
-{
-  SPLITDIGITS(abs(myValue), data->D);
-  data->IsNegative = (myValue < 0);
+  game->Pos.x = FX_clamp(game->Pos.x, FX_from(23), FX_from(121));
+  game->Pos.y = FX_clamp(game->Pos.y, 0, FX_from(55));
+  game->ShipPosX = FX_int(game->Pos.x);
+  game->ShipPosY = FX_int(game->Pos.y);
 }
 
 uint8_t ScoreDisplay(uint8_t x, uint8_t y, DIGITAL * score) {
@@ -279,7 +250,7 @@ uint8_t ScoreDisplay(uint8_t x, uint8_t y, DIGITAL * score) {
   }
   // show all of the file digits
   uint8_t part =  (x - SCOREOFFSET) / (DIGITSIZE);
-  return (DIGITS[x - SCOREOFFSET - (DIGITSIZE * part) + (score->D[(SCOREDIGITS - 1) - part] * DIGITSIZE)]);
+  return (BCD_glyph(DIGITS, DIGITSIZE, score->D, (SCOREDIGITS - 1) - part)[x - SCOREOFFSET - (DIGITSIZE * part)]);
 }
 
 uint8_t VelocityDisplay(uint8_t x, uint8_t y, DIGITAL * velocity, uint8_t horizontal)
@@ -298,7 +269,7 @@ uint8_t VelocityDisplay(uint8_t x, uint8_t y, DIGITAL * velocity, uint8_t horizo
   }
   // show just 3 digits
   uint8_t part =  ((x - VELOOFFSET) / (DIGITSIZE));
-  return (DIGITS[x - VELOOFFSET - (DIGITSIZE * part) + (velocity->D[(VELODIGITS - 1) - part] * DIGITSIZE)]);
+  return (BCD_glyph(DIGITS, DIGITSIZE, velocity->D, (VELODIGITS - 1) - part)[x - VELOOFFSET - (DIGITSIZE * part)]);
 }
 
 uint8_t DashboardDisplay(uint8_t x, uint8_t y, GAME * game)
@@ -356,13 +327,22 @@ uint8_t getLanderSprite(uint8_t x, uint8_t y, GAME * game)
     return (sprite |= (LANDER[(x - game->ShipPosX) + 7]));
 }
 
+// number of fuel bars shown + 1, the first one stays until the tank is empty
+uint8_t FuelBars(GAME * game)
+{
+  // max fuel = 15.000 Liter - each liter = 1 fuel-bar we have 15 bars
+  uint8_t bars = FM_div1000(game->Fuel) + 1;
+  if (game->Fuel > 0 && bars < 2)
+    bars = 2;
+  return bars;
+}
+
 uint8_t FuelDisplay(uint8_t x, uint8_t y, GAME * game)
 {
   if (y != 6) return 0x00;
   if (x > 4 && x <= 19)
   {
-    // max fuel = 15.000 Liter - each liter = 1 fuel-bar we have 15 bars
-    if ((game->Fuel / 1000) + 1 > x - 4 || ((x - 4 == 1) && game->Fuel > 0))
+    if (FuelBars(game) > x - 4)
       return 0xF8;
     else
       return 0x00;
@@ -381,7 +361,7 @@ uint8_t GameDisplay(uint8_t x, uint8_t y, GAME * game)
       frame = 0xFF;
     else
       // draw the map from the coordinates given by the GAMEMAP
-      frame = GETLANDSCAPE(x - offset, y, ((game->Level - 1) * 2), game);
+      frame = GETLANDSCAPE(x - offset, y, game);
 
     uint8_t ship = LanderDisplay(x, y, game);
 
@@ -389,7 +369,7 @@ uint8_t GameDisplay(uint8_t x, uint8_t y, GAME * game)
     {
       if (ship != 0 && (0xFC | ship) != (0xFC + ship))
       {
-        if (abs(game->velocityY) <= LANDINGSPEED && (game->ShipPosX >= game->LandingPadLEFT + offset) && (game->ShipPosX + 7 <= game->LandingPadRIGHT + offset) )
+        if (FX_abs(game->Vel.y) <= VELO(LANDINGSPEED) && (game->ShipPosX >= game->LandingPadLEFT + offset) && (game->ShipPosX + 7 <= game->LandingPadRIGHT + offset) )
         {
           game->HasLanded = true;
           return frame | ship;
@@ -445,13 +425,13 @@ uint8_t StarsDisplay(uint8_t x, uint8_t y, GAME * game)
   {
     if (x > offset &&  x < (offset + 72))
     {
-      if (game->Stars > (x - offset) / 24)
+      if (game->Stars > FM_div24(x - offset))
       {
-        return (STARFULL[((x - offset) % 24) + ((y - 2) * 24)] );
+        return (STARFULL[FM_mod24(x - offset) + ((y - 2) * 24)] );
       }
       else
       {
-        return (STAROUTLINE[((x - offset) % 24) + ((y - 2) * 24)] );
+        return (STAROUTLINE[FM_mod24(x - offset) + ((y - 2) * 24)] );
       }
     }
   }
@@ -463,34 +443,194 @@ uint8_t LivesDisplay(uint8_t x, uint8_t y, GAME * game)
   const uint8_t offset = 1;
   if (y == 7 && x >= offset && x < (4 * 5) + offset)
   {
-    if (game->Lives > (x - offset) / 5)
-      return (LIVE[(x - offset) % 5]);
+    if (game->Lives > FM_div5(x - offset))
+      return (LIVE[FM_mod5(x - offset)]);
   }
   return 0x00;
 }
 
-void Tiny_Flip(uint8_t mode, GAME * game, DIGITAL * score, DIGITAL * velX, DIGITAL * velY) {
-  uint8_t y, x;
+// The dashboard (HUD, columns 0..HUDWIDTH-1) is composed into HudStrip, which
+// the L_HUD layer copies. HudUpdate() compares the values shown with the ones
+// of the game and redraws only the cells that changed: a digit or the sign of
+// the score and the velocities, the fuel bars between the old and the new
+// level, the lives. Frames without a change only send the window right of it.
+#define HUDWIDTH 23
+
+uint8_t  HudStrip[8][HUDWIDTH + 1] LAYER_ALIGN;   // (rows of 24: words line up)
+uint8_t  HudShown;                  // 0: compose and send the whole dashboard
+uint16_t HudBus;                    // BUS_recoveries when it was sent
+DIGITAL  HudScore;                  // values shown
+DIGITAL  HudVel[2];
+uint16_t HudVelKey[2];              // velocity in display units | sign << 15
+uint8_t  HudFuel;
+uint8_t  HudLives;
+
+uint8_t HudDisplay(uint8_t x, uint8_t y, GAME * game)
+{
+  return DashboardDisplay(x, y, game) | ScoreDisplay(x, y, &HudScore)
+       | VelocityDisplay(x, y, &HudVel[0], 1) | VelocityDisplay(x, y, &HudVel[1], 0)
+       | FuelDisplay(x, y, game) | LivesDisplay(x, y, game);
+}
+
+void HudCells(uint8_t x0, uint8_t x1, uint8_t y, GAME * game)
+{
+  for (; x0 <= x1; x0++) HudStrip[y][x0] = HudDisplay(x0, y, game);
+}
+
+// redraw the digits of a field of n digits from x0 (the last one is digit 0)
+// which are set in diff
+void HudDigits(BCD diff, uint8_t x0, uint8_t n, uint8_t y, GAME * game)
+{
+  uint8_t x = x0 + (n - 1) * DIGITSIZE;
+  for (; n && diff; n--, diff >>= 4, x -= DIGITSIZE)
+    if (diff & 0x0F)
+      HudCells(x, x + DIGITSIZE - 1, y, game);
+}
+
+// take velocity v (0: x on page 4, 1: y on page 5), returns 1 if it changed
+uint8_t HudVelocity(FX v, uint8_t i, uint8_t redraw, GAME * game)
+{
+  uint16_t key = (FX_abs(v) >> VELOSHIFT) | ((uint16_t)(v < 0) << 15);
+  uint16_t sign = (key ^ HudVelKey[i]) & 0x8000;
+  BCD d, diff;
+  if (key == HudVelKey[i]) return 0;
+  d = BCD_from(key & 0x7FFF);
+  diff = d ^ HudVel[i].D;
+  HudVelKey[i] = key;
+  HudVel[i].D = d;
+  HudVel[i].IsNegative = key >> 15;
+  if (redraw)
+  {
+    if (sign)
+      HudCells(VELOOFFSET, VELOOFFSET + DIGITSIZE - 1, 4 + i, game);
+    HudDigits(diff, VELOOFFSET + DIGITSIZE, VELODIGITS - 1, 4 + i, game);
+  }
+  return 1;
+}
+
+// bring the dashboard up to date, returns 1 if it has to be sent
+uint8_t HudUpdate(GAME * game, DIGITAL * score)
+{
+  uint8_t redraw  = HudShown && (HudBus == BUS_recoveries);
+  uint8_t changed = 0;
+  uint8_t n, lo, hi;
+
+  if (score->D != HudScore.D)
+  {
+    BCD diff = score->D ^ HudScore.D;
+    HudScore.D = score->D;
+    if (redraw)
+      HudDigits(diff, SCOREOFFSET, SCOREDIGITS, 1, game);
+    changed = 1;
+  }
+  changed |= HudVelocity(game->Vel.x, 0, redraw, game);
+  changed |= HudVelocity(-game->Vel.y, 1, redraw, game);
+
+  n = FuelBars(game);
+  if (n != HudFuel)
+  {
+    lo = (n < HudFuel) ? n : HudFuel;
+    hi = (n < HudFuel) ? HudFuel : n;
+    if (lo < 1) lo = 1;
+    if (hi > 16) hi = 16;
+    HudFuel = n;
+    if (redraw && lo < hi)
+      HudCells(lo + 4, hi + 3, 6, game);
+    changed = 1;
+  }
+
+  n = (game->Lives < 4) ? game->Lives : 4;
+  if (n != HudLives)
+  {
+    lo = (n < HudLives) ? n : HudLives;
+    hi = (n < HudLives) ? HudLives : n;
+    HudLives = n;
+    if (redraw)
+      HudCells(1 + lo * 5, hi * 5, 7, game);
+    changed = 1;
+  }
+
+  if (!redraw)
+  {
+    for (n = 0; n < 8; n++)
+      HudCells(0, HUDWIDTH - 1, n, game);
+    HudShown = 1;
+    HudBus = BUS_recoveries;
+    changed = 1;
+  }
+  return changed;
+}
+
+// data handed to the screen layers
+typedef struct SCREEN {
+  GAME * game;
+  DIGITAL * score;
+} SCREEN;
+
+void Tiny_Flip(uint8_t mode, GAME * game, DIGITAL * score) {
+  uint8_t y;
+  uint8_t x0 = 0;
+  SCREEN screen = {game, score};
+  LayerUpdate(mode);
+  if (mode == 1)
+    HudShown = 0;                     // the title covers the dashboard
+  else if (!HudUpdate(game, score))
+    x0 = HUDWIDTH;                    // dashboard unchanged: send the rest
+  // the title of the EEPROM image (asset A_TITLE, 1024 bytes) replaces INTRO
+  uint8_t eetitle = (mode == 1) && (JOY_ASSET_size(A_TITLE) >= 1024);
+  if (mode == 1) JOY_OLED_rle_start(INTRO);
+  if (x0)
+    JOY_OLED_window_begin(x0, 127, 0, 7);
+  else
+    JOY_OLED_frame_begin();
   for (y = 0; y < 8; y++)
   {
     JOY_OLED_data_start(y);
-    for (x = 0; x < 128; x++)
-    {
-      if (mode == 0) {
-        JOY_OLED_send(GameDisplay(x, y, game) | LivesDisplay(x, y, game) | DashboardDisplay(x, y, game) | ScoreDisplay(x, y, score) | VelocityDisplay(x, y, velX, 1) | VelocityDisplay(x, y, velY, 0) | FuelDisplay(x, y, game));
-      } else if (mode == 1) {
-        JOY_OLED_send((INTRO[x + (y * 128)]));
-      }
-      else if (mode == 2)
-      {
-        JOY_OLED_send(StarsDisplay ( x, y, game) | LivesDisplay(x, y, game) | DashboardDisplay(x, y, game) | ScoreDisplay(x, y, score) | VelocityDisplay(x, y, velX, 1) | VelocityDisplay(x, y, velY, 0) | FuelDisplay(x, y, game));
-      }
-    }
+    if (eetitle)
+      JOY_ASSET_page(A_TITLE, y * 128, 128);
+    else if (mode == 1)
+      JOY_OLED_rle_page(128);
+    else
+      JOY_OLED_compose(y, x0, 127, &screen);
     JOY_OLED_end();
   }
+  JOY_OLED_frame_end();
 }
 
-void SetLandingMap(uint8_t level, GAME *game)
+enum {L_GAME = 0, L_STARS, L_HUD};
+
+void LayerGame(uint8_t *buf, uint8_t x0, uint8_t x1, uint8_t y, void *ctx) {
+  for (; x0 <= x1; x0++) *buf++ |= GameDisplay(x0, y, ((SCREEN *)ctx)->game);
+}
+
+void LayerStars(uint8_t *buf, uint8_t x0, uint8_t x1, uint8_t y, void *ctx) {
+  for (; x0 <= x1; x0++) *buf++ |= StarsDisplay(x0, y, ((SCREEN *)ctx)->game);
+}
+
+void LayerHud(uint8_t *buf, uint8_t x0, uint8_t x1, uint8_t y, void *ctx) {
+  JOY_LAYER_or(buf, &HudStrip[y][x0], x1 - x0 + 1, 0);
+}
+
+void LayerInit(void) {
+  JOY_LAYER_add(L_GAME,      LayerGame);
+  JOY_LAYER_add(L_STARS,     LayerStars);
+  JOY_LAYER_add(L_HUD,       LayerHud);
+  JOY_LAYER_set(L_HUD,       0, HUDWIDTH - 1, 0, 7);
+}
+
+// show either the landscape (mode 0) or the stars (mode 2) right of the dashboard
+void LayerUpdate(uint8_t mode) {
+  if (mode == 0) {
+    JOY_LAYER_set(L_GAME, 23, 127, 0, 7);
+    JOY_LAYER_hide(L_STARS);
+  }
+  else {
+    JOY_LAYER_hide(L_GAME);
+    JOY_LAYER_set(L_STARS, 23, 127, 0, 7);
+  }
+}
+
+void SetLandingMap(const uint8_t *map, GAME *game)
 {
   uint8_t i;
   uint8_t prev;
@@ -498,7 +638,7 @@ void SetLandingMap(uint8_t level, GAME *game)
   game->LandingPadRIGHT = 255;
   for (i = 0; i < 27; i++)
   {
-    uint8_t val = (GAMEMAP[(level - 1) * 2][i]);
+    uint8_t val = map[i];
 
     if ((prev == 0 && (val != 0 || i == 26)) && game->LandingPadRIGHT == 0)
     {
@@ -515,87 +655,95 @@ void SetLandingMap(uint8_t level, GAME *game)
   }
 }
 
+// the levels of the EEPROM image (asset A_LEVELS) follow the ones in flash, each
+// record holds the GAMELEVEL bytes, then the two GAMEMAP lines of the level
 void SETNEXTLEVEL(uint8_t level, GAME *game)
 {
-  if ( level > NUMOFGAMES)
+  uint8_t rec[LEVELSIZE];
+  const uint8_t *lvl;
+  const uint8_t *map;
+  uint16_t extra = JOY_ASSET_size(A_LEVELS) / LEVELSIZE;
+  if (extra > 254 - NUMOFGAMES)        // (Level++ must not wrap)
+    extra = 254 - NUMOFGAMES;
+  if ( level > NUMOFGAMES + extra)
     level = 1;
+  if (level > NUMOFGAMES &&
+      JOY_ASSET_read(A_LEVELS, (level - NUMOFGAMES - 1) * LEVELSIZE, rec, LEVELSIZE) == LEVELSIZE)
+  {
+    lvl = rec;
+    map = rec + 5;
+  }
+  else
+  {
+    if (level > NUMOFGAMES)
+      level = 1;
+    lvl = GAMELEVEL[level - 1];
+    map = GAMEMAP[(level - 1) * 2];
+  }
   game->Level = level;
-  SetLandingMap(level, game);
-  game->ShipPosX = (GAMELEVEL[level - 1][0]);
-  game->ShipPosY = (GAMELEVEL[level - 1][1]);
-  game->Fuel = 100 * (GAMELEVEL[level - 1][2]);
-  game->LevelScore = (GAMELEVEL[level - 1][3]);
-  game->FuelBonus = 100 * (GAMELEVEL[level - 1][4]);
+  SetLandingMap(map, game);
+  SetLandscape(map, map + 27, game);
+  game->ShipPosX = lvl[0];
+  game->ShipPosY = lvl[1];
+  game->Pos.x = FX_from(game->ShipPosX);
+  game->Pos.y = FX_from(game->ShipPosY);
+  game->Fuel = 100 * lvl[2];
+  game->LevelScore = lvl[3];
+  game->FuelBonus = 100 * lvl[4];
 }
 
-uint8_t GETLANDSCAPE(uint8_t x, uint8_t y, uint8_t level, GAME *game)
+// interpolates the GAMEMAP once per level into a height per column, so the
+// display and collision checks only have to look it up
+void SetLandscape(const uint8_t *map, const uint8_t *roof, GAME *game)
 {
   const uint8_t height = 63;
-  uint8_t frame = 0x00;
-  uint8_t t =  x % 4;
-  uint8_t ind = x / 4;
-  uint8_t val = height - (GAMEMAP[level][ind]);
-  uint8_t valT = height - (GAMEMAP[level + 1][ind]);
-  if (x > 0 && t != 0)
+  uint8_t x;
+  for (x = 0; x < MAPWIDTH; x++)
   {
-    if ( (ind + 1) < 27)
+    uint8_t t = x & 3;
+    uint8_t ind = x >> 2;
+    uint8_t val = height - map[ind];
+    uint8_t valT = height - roof[ind];
+    if (t != 0)
     {
       if (val < height)
-      { uint8_t val2 = height - (GAMEMAP[level][ind + 1]);
+      { uint8_t val2 = height - map[ind + 1];
         val += ((val2 - val) / 4) * ( t);
       }
-      uint8_t valT2 = height - (GAMEMAP[level + 1][ind + 1]);
+      uint8_t valT2 = height - roof[ind + 1];
       valT += ((valT2 - valT) / 4) * ( t);
     }
+    game->Ground[x] = val;
+    game->Roof[x] = valT;
   }
+}
 
-  uint8_t b = val / 8;
-  uint8_t bT = valT / 8;
+uint8_t GETLANDSCAPE(uint8_t x, uint8_t y, GAME *game)
+{
+  const uint8_t height = 63;
+  uint8_t frame = 0x00;
+  uint8_t val = game->Ground[x];
+  uint8_t valT = game->Roof[x];
+  uint8_t b = val >> 3;
+  uint8_t bT = valT >> 3;
   if (b == y)
   {
     // draw the landing-platform
     if (val == height)
-      if (x % 2 == 0)
+      if ((x & 1) == 0)
         frame |= 0xB8;
       else
         frame |= 0x58;
     else
       // draw pixel on the correct height
-      frame |= (0xFF << (val - (b * 8)) ) ;
+      frame |= (0xFF << (val & 7) ) ;
   }
   if (bT == y)
-    frame |= (0xFF >>  (7 - (valT - (bT * 8))));
+    frame |= (0xFF >>  (7 - (valT & 7)));
   if (y > b || y < bT )
     frame |= 0xFF;
 
   return frame;
 }
 
-// splits each digit in it's own byte
-void SPLITDIGITS(uint16_t val, uint8_t *d)
-{
-  d[4] = val / 10000;
-  d[3] = (val - (d[4] * 10000)) / 1000;
-  d[2] = (val - (d[3] * 1000) - (d[4] * 10000)) / 100;
-  d[1] = (val - (d[2] * 100) - (d[3] * 1000) - (d[4] * 10000)) / 10;
-  d[0] = val - (d[1] * 10) - (d[2] * 100) - (d[3] * 1000) - (d[4] * 10000);
-}
-
-void INTROJOY_sound()
-{
-  JOY_sound(80, 55); DLY_ms(20); JOY_sound(90, 55); DLY_ms(20); JOY_sound(100, 55); JOY_sound(115, 255); JOY_sound(115, 255);
-}
-void VICTORYJOY_sound()
-{
-  JOY_sound(111, 100); DLY_ms(20); JOY_sound(111, 90); DLY_ms(20); JOY_sound(144, 255); JOY_sound(144, 255); JOY_sound(144, 255);
-}
 
-void ALERTJOY_sound()
-{
-  JOY_sound(150, 100); DLY_ms(100); JOY_sound(150, 90); DLY_ms(100); JOY_sound(150, 100);
-}
-
-void HAPPYJOY_sound()
-{
-  JOY_sound(75, 90); DLY_ms(10); JOY_sound(114, 90); JOY_sound(121, 90);
-}
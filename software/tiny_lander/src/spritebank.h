@@ -28,17 +28,20 @@ extern "C" {
 #endif
 
 #define NUMOFGAMES 10
-#define VLimit 100
-#define MoveY 35
-#define MoveX 35
+#define LEVELSIZE (5 + 2 * 27) // level record of the EEPROM image: GAMELEVEL, 2 GAMEMAP lines
+#define A_LEVELS 0       // EEPROM assets: extra levels (LEVELSIZE bytes each)
+#define A_TITLE 1        // title screen (1024 bytes)
+#define VLimit 100       // speeds in units of the velocity display
+#define VELOSHIFT 3      // display unit: 8.8 velocity >> VELOSHIFT (1/32 px per tick)
+#define VELO(u) ((FX)((u) << VELOSHIFT))
 #define TrustY 1
 #define TrustX 1
 #define GRAVITYDECY 1
 #define FULLTHRUST 18
-#define ACCELERATOR 45
 #define LANDINGSPEED 35
 #define BONUSSPEED1 13
 #define BONUSSPEED2 24
+#define MAPWIDTH 104     // landscape columns between the border-lines (x = 23..126)
 
 #define DIGITSIZE 4
 #define SCOREOFFSET 1
@@ -114,10 +117,8 @@ typedef struct GAME {
   short Fuel;
   short FuelBonus;
 
-  short velocityY;
-  short velocityX;
-  uint16_t velXCounter;
-  uint16_t velYCounter;
+  FX_VEC Pos;       // 8.8 fixed point (fixed_point.h), ShipPosX/Y is its pixel
+  FX_VEC Vel;       // px per tick, y pointing down
 
   bool Toggle;
   uint8_t ShipExplode;
@@ -129,12 +130,14 @@ typedef struct GAME {
   uint8_t LevelScore;
   uint8_t LandingPadLEFT;
   uint8_t LandingPadRIGHT;
+  uint8_t Ground[MAPWIDTH]; // interpolated landscape height per column (63 = pad)
+  uint8_t Roof[MAPWIDTH];   // interpolated ceiling height per column
 
   uint8_t Lives;
 } GAME;
 
 typedef struct DIGITAL {
-  uint8_t D[5];
+  BCD D;
   bool IsNegative;
 } DIGITAL;
 
@@ -193,73 +196,47 @@ const uint8_t LIVE[] = {
 };
 
 // 'Tiny Lander Intro', 128x64px
+// run-length encoded (432 bytes), see OLED_rle_page()
 const uint8_t INTRO[] = {
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-  0x00, 0x00, 0x00, 0x1e, 0x30, 0x1e, 0x00, 0x00, 0x3e, 0x00, 0x20, 0x00, 0x3e, 0x22, 0x3e, 0x00, 
-  0x00, 0x00, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x00, 0x80, 0x80, 0x80, 0x80, 
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xb8, 0xfc, 0xfc, 0xfc, 0xfc, 0xb8, 0x80, 
-  0x80, 0x80, 0x80, 0x80, 0x80, 0xff, 0x82, 0x80, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-  0x00, 0x00, 0x03, 0x03, 0x03, 0xff, 0xff, 0xff, 0x03, 0x03, 0x03, 0x00, 0xfd, 0xfd, 0xfd, 0xfd, 
-  0x00, 0x00, 0xfc, 0xfc, 0xfc, 0x1c, 0x1c, 0x1c, 0xf8, 0xf8, 0xf0, 0x00, 0x1c, 0xfc, 0xfc, 0xf8, 
-  0x00, 0xc0, 0xfc, 0xfc, 0x3c, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-  0x00, 0x00, 0xe0, 0xf0, 0xf8, 0xfc, 0xfe, 0xff, 0xff, 0x7f, 0x3f, 0x3f, 0x3f, 0x3f, 0x3f, 0x3f, 
-  0x7f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xfe, 0xfc, 0xf8, 0xf0, 0xe0, 0xc0, 
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-  0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 
-  0x00, 0x00, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0x00, 0x00, 0x03, 0x3f, 0xff, 
-  0xf0, 0xff, 0x7f, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-  0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0x81, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-  0x00, 0x00, 0x81, 0xff, 0xff, 0xff, 0xff, 0xff, 0x81, 0x81, 0x81, 0x87, 0xff, 0xff, 0xff, 0xff, 
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x07, 0x07, 0x07, 
-  0x03, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-  0x00, 0x00, 0x03, 0x07, 0x0f, 0x1f, 0x3f, 0x7f, 0xff, 0xfe, 0xfc, 0xfc, 0xfc, 0xfc, 0x7c, 0x7c, 
-  0x7e, 0xff, 0xff, 0x7f, 0x7f, 0x7f, 0x7f, 0xff, 0xff, 0xff, 0x7f, 0x3f, 0x1f, 0x0f, 0x07, 0x03, 
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-  0x00, 0x00, 0x00, 0xf8, 0xf8, 0xf8, 0xf8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0xc0, 0xc0, 
-  0xc0, 0xc0, 0xc0, 0xc0, 0x80, 0x00, 0x00, 0xc0, 0xc0, 0xc0, 0x80, 0x80, 0xc0, 0xc0, 0xc0, 0x80, 
-  0x00, 0x00, 0x00, 0x80, 0x80, 0xc0, 0xc0, 0xc0, 0xf8, 0xf8, 0xf8, 0x00, 0x00, 0x00, 0x80, 0xc0, 
-  0xc0, 0xc0, 0xc0, 0xc0, 0x80, 0x00, 0x00, 0x00, 0xc0, 0xc0, 0xc0, 0x00, 0x80, 0xc0, 0xc0, 0x00, 
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0xe0, 0x78, 
-  0x3e, 0x0f, 0x07, 0x1f, 0x7f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xaf, 0xdf, 
-  0xaf, 0xdf, 0xaf, 0xdf, 0xaf, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x7f, 0x1f, 0x07, 
-  0x0f, 0x1e, 0x78, 0xe0, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-  0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00, 0xc0, 0xe3, 0xf3, 0xf3, 
-  0x38, 0x1c, 0xff, 0xff, 0xff, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x01, 0x01, 0xff, 0xff, 0xff, 
-  0x00, 0x00, 0xff, 0xff, 0xff, 0x03, 0x01, 0x01, 0xff, 0xff, 0xff, 0x00, 0x00, 0xff, 0xff, 0xff, 
-  0x19, 0x18, 0x19, 0x9f, 0x9f, 0x9f, 0x00, 0x00, 0xff, 0xff, 0xff, 0x07, 0x03, 0x03, 0x03, 0x00, 
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0xe0, 0xf8, 0x3e, 0x1f, 0x0d, 0x0c, 
-  0x04, 0x06, 0x06, 0x03, 0x03, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0xc1, 0xf1, 0xff, 0xff, 
-  0xff, 0xff, 0xff, 0xff, 0xf1, 0xc1, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x03, 0x03, 0x06, 
-  0x06, 0x04, 0x0c, 0x0d, 0x1f, 0x3e, 0xf8, 0xe0, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-  0x00, 0x00, 0x00, 0x0f, 0x0f, 0x0f, 0x0f, 0x0e, 0x0e, 0x0e, 0x0e, 0x00, 0x03, 0x07, 0x0f, 0x0f, 
-  0x0c, 0x04, 0x0f, 0x0f, 0x0f, 0x00, 0x00, 0x0f, 0x0f, 0x0f, 0x0f, 0x00, 0x00, 0x0f, 0x0f, 0x0f, 
-  0x00, 0x00, 0x03, 0x07, 0x0f, 0x0e, 0x0c, 0x0c, 0x0f, 0x0f, 0x0f, 0x00, 0x00, 0x03, 0x07, 0x0f, 
-  0x0e, 0x0c, 0x0e, 0x0f, 0x07, 0x03, 0x00, 0x00, 0x0f, 0x0f, 0x0f, 0x00, 0x00, 0x00, 0x00, 0x00, 
-  0x00, 0x00, 0x00, 0x00, 0x04, 0x0c, 0x0c, 0x1c, 0x1e, 0x1f, 0x1f, 0x0c, 0x0c, 0x04, 0x00, 0x00, 
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x01, 0x01, 0x01, 
-  0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-  0x00, 0x00, 0x00, 0x00, 0x04, 0x0c, 0x0c, 0x1f, 0x1f, 0x1e, 0x1c, 0x0c, 0x0c, 0x04, 0x00, 0x00
+  0xE3, 0x00, 0x00, 0x80, 0x8B, 0x00, 0x0B, 0x1E, 0x30, 0x1E, 0x00, 0x00, 0x3E, 0x00, 0x20, 0x00,
+  0x3E, 0x22, 0x3E, 0x81, 0x00, 0x87, 0x80, 0x00, 0x00, 0x82, 0x80, 0xC7, 0x00, 0x00, 0xB8, 0x82,
+  0xFC, 0x00, 0xB8, 0x84, 0x80, 0x03, 0xFF, 0x82, 0x80, 0x80, 0x97, 0x00, 0x81, 0x03, 0x81, 0xFF,
+  0x81, 0x03, 0x00, 0x00, 0x82, 0xFD, 0x80, 0x00, 0x81, 0xFC, 0x81, 0x1C, 0x80, 0xF8, 0x0A, 0xF0,
+  0x00, 0x1C, 0xFC, 0xFC, 0xF8, 0x00, 0xC0, 0xFC, 0xFC, 0x3C, 0xAB, 0x00, 0x07, 0xE0, 0xF0, 0xF8,
+  0xFC, 0xFE, 0xFF, 0xFF, 0x7F, 0x84, 0x3F, 0x00, 0x7F, 0x87, 0xFF, 0x05, 0xFE, 0xFC, 0xF8, 0xF0,
+  0xE0, 0xC0, 0x93, 0x00, 0x81, 0xFF, 0x82, 0x00, 0x82, 0xFF, 0x80, 0x00, 0x81, 0xFF, 0x81, 0x00,
+  0x81, 0xFF, 0x80, 0x00, 0x06, 0x03, 0x3F, 0xFF, 0xF0, 0xFF, 0x7F, 0x03, 0xAC, 0x00, 0x83, 0xFF,
+  0x00, 0x81, 0x88, 0x00, 0x00, 0x81, 0x83, 0xFF, 0x81, 0x81, 0x00, 0x87, 0x82, 0xFF, 0xAB, 0x00,
+  0x81, 0x07, 0x01, 0x03, 0x01, 0xAE, 0x00, 0x07, 0x03, 0x07, 0x0F, 0x1F, 0x3F, 0x7F, 0xFF, 0xFE,
+  0x82, 0xFC, 0x80, 0x7C, 0x02, 0x7E, 0xFF, 0xFF, 0x82, 0x7F, 0x81, 0xFF, 0x05, 0x7F, 0x3F, 0x1F,
+  0x0F, 0x07, 0x03, 0x91, 0x00, 0x82, 0xF8, 0x84, 0x00, 0x00, 0x80, 0x84, 0xC0, 0x02, 0x80, 0x00,
+  0x00, 0x81, 0xC0, 0x80, 0x80, 0x81, 0xC0, 0x00, 0x80, 0x81, 0x00, 0x80, 0x80, 0x81, 0xC0, 0x81,
+  0xF8, 0x81, 0x00, 0x00, 0x80, 0x83, 0xC0, 0x00, 0x80, 0x81, 0x00, 0x81, 0xC0, 0x03, 0x00, 0x80,
+  0xC0, 0xC0, 0x8C, 0x00, 0x07, 0x80, 0xE0, 0x78, 0x3E, 0x0F, 0x07, 0x1F, 0x7F, 0x87, 0xFF, 0x06,
+  0xAF, 0xDF, 0xAF, 0xDF, 0xAF, 0xDF, 0xAF, 0x86, 0xFF, 0x07, 0x7F, 0x1F, 0x07, 0x0F, 0x1E, 0x78,
+  0xE0, 0x80, 0x8C, 0x00, 0x82, 0xFF, 0x83, 0x00, 0x05, 0xC0, 0xE3, 0xF3, 0xF3, 0x38, 0x1C, 0x81,
+  0xFF, 0x80, 0x00, 0x82, 0xFF, 0x80, 0x01, 0x81, 0xFF, 0x80, 0x00, 0x81, 0xFF, 0x02, 0x03, 0x01,
+  0x01, 0x81, 0xFF, 0x80, 0x00, 0x81, 0xFF, 0x02, 0x19, 0x18, 0x19, 0x81, 0x9F, 0x80, 0x00, 0x81,
+  0xFF, 0x00, 0x07, 0x81, 0x03, 0x88, 0x00, 0x0B, 0x80, 0xE0, 0xF8, 0x3E, 0x1F, 0x0D, 0x0C, 0x04,
+  0x06, 0x06, 0x03, 0x03, 0x85, 0x01, 0x01, 0xC1, 0xF1, 0x84, 0xFF, 0x01, 0xF1, 0xC1, 0x85, 0x01,
+  0x80, 0x03, 0x80, 0x06, 0x07, 0x04, 0x0C, 0x0D, 0x1F, 0x3E, 0xF8, 0xE0, 0x80, 0x88, 0x00, 0x82,
+  0x0F, 0x82, 0x0E, 0x06, 0x00, 0x03, 0x07, 0x0F, 0x0F, 0x0C, 0x04, 0x81, 0x0F, 0x80, 0x00, 0x82,
+  0x0F, 0x80, 0x00, 0x81, 0x0F, 0x80, 0x00, 0x05, 0x03, 0x07, 0x0F, 0x0E, 0x0C, 0x0C, 0x81, 0x0F,
+  0x80, 0x00, 0x0A, 0x03, 0x07, 0x0F, 0x0E, 0x0C, 0x0E, 0x0F, 0x07, 0x03, 0x00, 0x00, 0x81, 0x0F,
+  0x87, 0x00, 0x09, 0x04, 0x0C, 0x0C, 0x1C, 0x1E, 0x1F, 0x1F, 0x0C, 0x0C, 0x04, 0x8C, 0x00, 0x88,
+  0x01, 0x8C, 0x00, 0x0B, 0x04, 0x0C, 0x0C, 0x1F, 0x1F, 0x1E, 0x1C, 0x0C, 0x0C, 0x04, 0x00, 0x00
 };
 
+// Sound effects, see JOY_sfx()
+const uint8_t SFX_START[]   = {3, SFX_NOTE(100, 125), SFX_NOTE(50, 125), SFX_END};
+const uint8_t SFX_INTRO[]   = {3, SFX_NOTE(80, 55), SFX_REST_MS(20), SFX_NOTE(90, 55), SFX_REST_MS(20),
+                                  SFX_NOTE(100, 55), SFX_NOTE(115, 255), SFX_NOTE(115, 255), SFX_END};
+const uint8_t SFX_VICTORY[] = {3, SFX_NOTE(111, 100), SFX_REST_MS(20), SFX_NOTE(111, 90), SFX_REST_MS(20),
+                                  SFX_NOTE(144, 255), SFX_NOTE(144, 255), SFX_NOTE(144, 255), SFX_END};
+const uint8_t SFX_ALERT[]   = {3, SFX_NOTE(150, 100), SFX_REST_MS(100), SFX_NOTE(150, 90), SFX_REST_MS(100),
+                                  SFX_NOTE(150, 100), SFX_END};
+const uint8_t SFX_HAPPY[]   = {3, SFX_NOTE(75, 90), SFX_REST_MS(10), SFX_NOTE(114, 90), SFX_NOTE(121, 90), SFX_END};
+
 #ifdef __cplusplus
 };
 #endif
@@ -32,51 +32,69 @@
 // ===================================================================================
 // Global Variables
 // ===================================================================================
-uint8_t LEVELSPEED;
-uint8_t GobbingEND;
-uint8_t LIVE;
-uint8_t INGAME;
-uint8_t Gobeactive;
-uint8_t TimerGobeactive;
-uint8_t add;
-uint8_t dotsMem[9];
-int8_t dotscount;
-uint8_t Frame;
+uint8_t LEVELSPEED SNAP_STATE;
+uint8_t GobbingEND SNAP_STATE;
+uint8_t LIVE SNAP_STATE;
+uint8_t INGAME SNAP_STATE;
+uint8_t Gobeactive SNAP_STATE;
+uint8_t TimerGobeactive SNAP_STATE;
+uint8_t add SNAP_STATE;
+uint8_t dotsMem[8] SNAP_STATE;
+uint8_t Frame SNAP_STATE;
+uint8_t SpriteOrder[5];
+uint8_t LifeBeeps;
 enum {PACMAN=0,FANTOME=1,FRUIT=2};
 
+// Snapshot of the game (SNAP_STATE variables, see snapshot.h)
+#define SNAP_GAME   'P'
+#define SNAP_VER    1
+
 // ===================================================================================
 // Function Prototypes
 // ===================================================================================
 void ResetVar(void);
 void StartGame(PERSONAGE *Sprite);
+void LifeBeep(void *ctx);
 uint8_t CollisionPac2Caracter(PERSONAGE *Sprite);
 void RefreshCaracter(PERSONAGE *Sprite);
 uint8_t CheckCollisionWithBack(uint8_t SpriteCheck,uint8_t HorVcheck,PERSONAGE *Sprite);
 uint8_t RecupeBacktoCompV(uint8_t SpriteCheck,PERSONAGE *Sprite);
 uint8_t Trim(uint8_t Y1orY2,uint8_t TrimValue,uint8_t Decalage);
 uint8_t RecupeBacktoCompH(uint8_t SpriteCheck,PERSONAGE *Sprite);
+uint8_t BackByte(int16_t i);
+uint8_t BackRow(int8_t y,uint8_t x);
+uint8_t GhostTurn(uint8_t t,uint8_t Vertical,PERSONAGE *Sprite);
 void Tiny_Flip(uint8_t render0_picture1,PERSONAGE *Sprite);
+void LayerInit(void);
+void LayerUpdate(PERSONAGE *Sprite);
+void SpriteSort(PERSONAGE *Sprite);
 uint8_t FruitWrite(uint8_t x,uint8_t y);
 uint8_t LiveWrite(uint8_t x,uint8_t y);
-uint8_t DotsWrite(uint8_t x,uint8_t y,PERSONAGE *Sprite);
 uint8_t checkDotPresent(uint8_t  DotsNumber);
 void DotsDestroy(uint8_t DotsNumber);
+uint8_t DotsLeft(void);
+void DotsEat(PERSONAGE *Sprite);
 uint8_t SplitSpriteDecalageY(uint8_t decalage,uint8_t Input,uint8_t UPorDOWN);
-uint8_t SpriteWrite(uint8_t x,uint8_t y,PERSONAGE  *Sprite);
-uint8_t return_if_sprite_present(uint8_t x,PERSONAGE  *Sprite,uint8_t SpriteNumber);
+uint8_t SpriteIndex(uint8_t x,PERSONAGE  *Sprite,uint8_t SpriteNumber);
 uint8_t background(uint8_t x,uint8_t y);
 
 // ===================================================================================
 // Main Function
 // ===================================================================================
 int main(void) {
+  static PERSONAGE Sprite[5] SNAP_STATE;
+
   // Setup
   JOY_init();
+  LayerInit();
+  if(JOY_resume(SNAP_GAME, SNAP_VER)) {      // suspended game: straight back in
+    Tiny_Flip(0, &Sprite[0]);
+    goto RESUME;
+  }
 
   // Loop
   while(1) {
     uint8_t t;
-    PERSONAGE Sprite[5];
   NEWGAME:
     ResetVar();
     LIVE=3;
@@ -87,16 +105,14 @@ int main(void) {
       if((LEVELSPEED==160)||(LEVELSPEED==120)||(LEVELSPEED==80)||(LEVELSPEED==40)||(LEVELSPEED==10)) {    
         if(LIVE < 3) {
           LIVE++; 
-          for(t=0; t<=4; t++) {
-            JOY_sound(80,100);
-            JOY_DLY_ms(300);
-          }
+          LifeBeeps = 5;
+          LifeBeep(0);
         }
       }
     }
   New:
     GobbingEND = (LEVELSPEED / 2);
-    for(t=0; t<9; t++) dotsMem[t]=0xff;
+    for(t=0; t<8; t++) dotsMem[t]=0xff;
   RESTARTLEVEL:
     Gobeactive = 0;
     uint8_t* ptr = (uint8_t*)Sprite;
@@ -124,10 +140,14 @@ int main(void) {
     Sprite[4].x=76;
     Sprite[4].y=5;
     Sprite[4].guber=0;
+  RESUME:
+    JOY_frame_start();
     while(1) {
       //joystick
       if(JOY_act_pressed()) StartGame(&Sprite[0]);
+      else if(!INGAME) JOY_idle(0);           // attract mode: dim, then stand by
       if(INGAME) {
+        JOY_poll();
         if(JOY_left_pressed()) Sprite[0].DirectionV = 0;
         else if(JOY_right_pressed()) Sprite[0].DirectionV = 1;
         if(JOY_down_pressed()) Sprite[0].DirectionH =1 ;
@@ -143,16 +163,17 @@ int main(void) {
       else Frame = 0;
       if(CollisionPac2Caracter(&Sprite[0]) == 0) RefreshCaracter(&Sprite[0]);
       else {
-        JOY_sound(100, 200); JOY_sound(75, 200); JOY_sound(50, 200); JOY_sound(25, 200);
-        JOY_sound(12, 200); JOY_DLY_ms(400);
+        JOY_sfx(SFX_DEATH); JOY_sound_wait(); JOY_DLY_ms(400);
         if(LIVE > 0) {
           LIVE--;
+          TLM_counter(TLM_ID_LIVES, LIVE);
           goto RESTARTLEVEL;
         }
         else goto NEWGAME;
       }
       if(Frame % 2 == 0) {
-        Tiny_Flip(0, &Sprite[0]);
+        if(INGAME) DotsEat(&Sprite[0]);
+        if(JOY_frame_render) Tiny_Flip(0, &Sprite[0]);
         if(INGAME == 1) {
           for(uint8_t t=0; t<=139; t=t+2) {
             JOY_sound((Music[t]) - 8, ((Music[t + 1]) - 100)); 
@@ -161,19 +182,14 @@ int main(void) {
         }
       }
       else {
-        for(t=0; t<63; t++) {
-          if(checkDotPresent(t)) break;
-          else if(t == 62) {
-            for(uint8_t r=0; r<60; r++) {
-              JOY_sound(2 + r, 10); JOY_sound(255 - r, 20);
-            }
-            JOY_DLY_ms(1000);
-            goto NEWLEVEL;
-          }
+        if(!DotsLeft()) {
+          JOY_sfx(SFX_CLEAR); JOY_sound_wait();
+          JOY_DLY_ms(1000);
+          goto NEWLEVEL;
         }
       }
       if((Gobeactive) && (Frame % 2 == 0)) JOY_sound((255 - TimerGobeactive), 1);
-      JOY_SLOWDOWN();
+      JOY_frame_wait();
     }
   }
 }
@@ -189,13 +205,13 @@ Gobeactive=0;
 TimerGobeactive=0;
 add=0;
 INGAME=0;
-for(uint8_t t=0;t<9;t++){
+for(uint8_t t=0;t<8;t++){
 dotsMem[t]=0xff;}
-dotscount=0;
 Frame=0;}
 
 void StartGame(PERSONAGE *Sprite){
 if (INGAME==0) {
+JOY_idle_wake();
 Sprite[1].x=76;
 Sprite[1].y=3;
 Sprite[2].x=75;
@@ -206,6 +222,12 @@ Sprite[4].x=76;
 Sprite[4].y=4;
 INGAME=1;}}
 
+// extra life: 5 beeps 335 ms apart while the game goes on
+void LifeBeep(void *ctx){
+JOY_sound(80,100);
+if (--LifeBeeps) TSK_after(335,LifeBeep,0);
+}
+
 uint8_t CollisionPac2Caracter(PERSONAGE *Sprite){
 uint8_t ReturnCollision=0;
 #define xmax(I) (Sprite[I].x+6)
@@ -215,7 +237,7 @@ uint8_t ReturnCollision=0;
 if ((INGAME)) {    
 for (uint8_t t=1;t<=4;t++){
 if ((xmax(0)<xmin(t))||(xmin(0)>xmax(t))||(ymax(0)<ymin(t))||(ymin(0)>ymax(t))) {}else{ 
-if (Gobeactive) {if (Sprite[t].guber!=1) {JOY_sound(20,100);JOY_sound(2,100);}Sprite[t].guber=1;ReturnCollision=0;}else{ if (Sprite[t].guber==1) {ReturnCollision=0;}else{ReturnCollision=1;}}
+if (Gobeactive) {if (Sprite[t].guber!=1) {JOY_sfx(SFX_GHOST);}Sprite[t].guber=1;ReturnCollision=0;}else{ if (Sprite[t].guber==1) {ReturnCollision=0;}else{ReturnCollision=1;}}
 }}}return ReturnCollision;}
 
 void RefreshCaracter(PERSONAGE *Sprite){
@@ -233,7 +255,7 @@ if ((Sprite[0].y==3)&&(Sprite[0].x==86)){}else{Sprite[t].x--;}
 }else{Sprite[t].x--;}
 }}}
 if (CheckCollisionWithBack(t,1,Sprite)) {
-if (t!=0) {Sprite[t].DirectionV=JOY_random()%2;}else{ Sprite[t].DirectionV=2;}
+if (t!=0) {Sprite[t].DirectionV=GhostTurn(t,0,Sprite);}else{ Sprite[t].DirectionV=2;}
 Sprite[t].x=memx;
 }
 if ((Frame%2==0)||(t==0)||(LEVELSPEED<=160)) {
@@ -241,7 +263,7 @@ if (Sprite[t].DirectionH==1) {if (Sprite[t].Decalagey<7) {Sprite[t].Decalagey++;
 if (Sprite[t].DirectionH==0) {if (Sprite[t].Decalagey>0) {Sprite[t].Decalagey--;}else{Sprite[t].Decalagey=7;Sprite[t].y--;if (Sprite[t].y==-2) {Sprite[t].y=8;}}}
 }
 if (CheckCollisionWithBack(t,0,Sprite)) {
-if (t!=0) {Sprite[t].DirectionH=JOY_random()%2;}else{Sprite[t].DirectionH=2;}
+if (t!=0) {Sprite[t].DirectionH=GhostTurn(t,1,Sprite);}else{Sprite[t].DirectionH=2;}
 Sprite[t].y=memy;
 Sprite[t].Decalagey=memdecalagey;
 }
@@ -284,11 +306,11 @@ uint8_t Y2=Y1;
 #define MAXV (Sprite[SpriteCheck].x+SpriteWide)
 #define MINV (Sprite[SpriteCheck].x)
 if (Sprite[SpriteCheck].DirectionV==1) {
-Y1=(back[((Sprite[SpriteCheck].y)*128)+(MAXV)]);
-Y2=(back[((Sprite[SpriteCheck].y+1)*128)+(MAXV)]);
+Y1=BackByte(((Sprite[SpriteCheck].y)*128)+(MAXV));
+Y2=BackByte(((Sprite[SpriteCheck].y+1)*128)+(MAXV));
 }else if (Sprite[SpriteCheck].DirectionV==0) {
-Y1=(back[((Sprite[SpriteCheck].y)*128)+(MINV)]);
-Y2=(back[((Sprite[SpriteCheck].y+1)*128)+(MINV)]);
+Y1=BackByte(((Sprite[SpriteCheck].y)*128)+(MINV));
+Y2=BackByte(((Sprite[SpriteCheck].y+1)*128)+(MINV));
 }else{Y1=0;Y2=0;}
 //decortique
 Y1=Trim(0,Y1,Sprite[SpriteCheck].Decalagey);
@@ -314,39 +336,150 @@ return 0b01111111>>(8-Decalage);
 }}
 
 uint8_t RecupeBacktoCompH(uint8_t SpriteCheck,PERSONAGE *Sprite){
-uint8_t TempPGMByte;
+uint8_t RECUPE;
+int8_t y=Sprite[SpriteCheck].y;
 if (Sprite[SpriteCheck].DirectionH==0) {
-uint8_t RECUPE=(ScanHRecupe(0,Sprite[SpriteCheck].Decalagey));
-for(uint8_t t=0;t<=6;t++){
-if ((((Sprite[SpriteCheck].y)*128)+(Sprite[SpriteCheck].x+t)>1023)||(((Sprite[SpriteCheck].y)*128)+(Sprite[SpriteCheck].x+t)<0)) {TempPGMByte=0x00;}else{
- TempPGMByte=((back[((Sprite[SpriteCheck].y)*128)+(Sprite[SpriteCheck].x+t)])); 
-}
-#define CHECKCOLLISION ((RECUPE)&(TempPGMByte))
-if  (CHECKCOLLISION!=0) {return 1;}
-}}else if (Sprite[SpriteCheck].DirectionH==1) {
+RECUPE=(ScanHRecupe(0,Sprite[SpriteCheck].Decalagey));
+}else if (Sprite[SpriteCheck].DirectionH==1) {
 uint8_t tadd=0;
 if (Sprite[SpriteCheck].Decalagey>2) { tadd=1;}else{tadd=0;}
-uint8_t RECUPE=(ScanHRecupe(tadd,Sprite[SpriteCheck].Decalagey));
-for(uint8_t t=0;t<=6;t++){
-if (((((Sprite[SpriteCheck].y+tadd)*128)+(Sprite[SpriteCheck].x+t))>1023)||((((Sprite[SpriteCheck].y+tadd)*128)+(Sprite[SpriteCheck].x+t))<0)) {TempPGMByte=0x00;}else{
-TempPGMByte=(back[((Sprite[SpriteCheck].y+tadd)*128)+(Sprite[SpriteCheck].x+t)]);
+RECUPE=(ScanHRecupe(tadd,Sprite[SpriteCheck].Decalagey));
+y=y+tadd;
+}else{return 0;}
+if ((RECUPE)&(BackRow(y,Sprite[SpriteCheck].x))) {return 1;}
+return 0;}
+
+// byte of the maze, outside of the screen is free
+uint8_t BackByte(int16_t i){
+if ((i<0)||(i>1023)) {return 0x00;}
+return back[i];
+}
+
+// maze bytes under the 7 columns of a sprite ORed together
+uint8_t BackRow(int8_t y,uint8_t x){
+int16_t i=(y*128)+x;
+uint8_t OR=0;
+if ((i>=0)&&(i<=1023-6)) {
+const uint8_t *ptr=&back[i];
+OR=ptr[0]|ptr[1]|ptr[2]|ptr[3]|ptr[4]|ptr[5]|ptr[6];
+}else{
+for(uint8_t t=0;t<=6;t++){OR|=BackByte(i+t);}
+}
+return OR;
+}
+
+// new direction of a blocked ghost (0: left/up, 1: right/down): towards Pac-Man,
+// away from him while he is gobbling, home after being eaten, sometimes at random
+uint8_t GhostTurn(uint8_t t,uint8_t Vertical,PERSONAGE *Sprite){
+uint16_t rnd=JOY_random();
+int16_t d;
+if ((rnd&3)==0) {return (rnd>>2)&1;}
+if (Sprite[t].guber==1) {
+if (Vertical) {d=(3*8)-((Sprite[t].y*8)+Sprite[t].Decalagey);}else{d=75-Sprite[t].x;}
+return (d>0);
+}
+if (Vertical) {d=((Sprite[0].y*8)+Sprite[0].Decalagey)-((Sprite[t].y*8)+Sprite[t].Decalagey);}else{d=Sprite[0].x-Sprite[t].x;}
+if (Gobeactive) {return (d<=0);}
+return (d>0);
 }
-#define CHECKCOLLISION2 ((RECUPE)&(TempPGMByte))
-if  (CHECKCOLLISION2!=0) {return 1;}
-}}return 0;}
 
 void Tiny_Flip(uint8_t render0_picture1,PERSONAGE *Sprite){
 uint8_t y,x; 
-dotscount=-1;
+if (render0_picture1==0) LayerUpdate(Sprite);
+JOY_OLED_frame_begin();
 for (y = 0; y < 8; y++){ 
 JOY_OLED_data_start(y);
-for (x = 0; x < 128; x++){
 if (render0_picture1==0) {
-if (INGAME) {JOY_OLED_send(background(x,y)|SpriteWrite(x,y,Sprite)|DotsWrite(x,y,Sprite)|LiveWrite(x,y)|FruitWrite(x,y));}else{
-JOY_OLED_send(0xff-(background(x,y)|SpriteWrite(x,y,Sprite)));
-}}else if (render0_picture1==1){
-JOY_OLED_send((back[x+(y*128)]));}}
+uint8_t *buf=JOY_OLED_compose(y,0,127,Sprite);
+if (!INGAME) {for (x = 0; x < 128; x++){buf[x]=0xff-buf[x];}}
+}else if (render0_picture1==1){
+for (x = 0; x < 128; x++){JOY_OLED_send((back[x+(y*128)]));}}
 JOY_OLED_end();
+}
+JOY_OLED_frame_end();
+}
+
+enum {L_BACKGROUND=0,L_SPRITES,L_DOTS,L_LIVE,L_FRUIT};
+
+void LayerBackground(uint8_t *buf,uint8_t x0,uint8_t x1,uint8_t y,void *ctx){
+JOY_LAYER_or(buf,&BackBlitz[(y*128)+x0],x1-x0+1,0);   // (a row of the maze, word-wide)
+}
+
+// sweep the sprites sorted by x, only the ones overlapping the span are drawn
+void LayerSprites(uint8_t *buf,uint8_t x0,uint8_t x1,uint8_t y,void *ctx){
+PERSONAGE *Sprite=(PERSONAGE*)ctx;
+for (uint8_t k=0;k<5;k++){
+uint8_t n=SpriteOrder[k];
+uint8_t a=Sprite[n].x;
+uint8_t b=a+7;
+uint8_t up;
+if (a>x1) {break;}
+if (b<x0) {continue;}
+if (Sprite[n].y==y) {up=1;}else if (((Sprite[n].y+1)==y)&&(Sprite[n].Decalagey!=0)) {up=0;}else{continue;}
+if (a<x0) {a=x0;}
+if (b>x1) {b=x1;}
+uint8_t i=SpriteIndex(a,Sprite,n);
+if (i==0xff) {continue;}
+uint8_t *p=buf+(a-x0);
+for (;a<=b;a++,i++){
+#if JOY_PRESHIFT > 0
+uint16_t pair=caracters_shifted[i][Sprite[n].Decalagey];
+*p++|=up?SPRITE_UP(pair):SPRITE_DOWN(pair);
+#else
+*p++|=SplitSpriteDecalageY(Sprite[n].Decalagey,caracters[i],up);
+#endif
+}}}
+
+// insertion sort of the sprite numbers by x position
+void SpriteSort(PERSONAGE *Sprite){
+for (uint8_t k=1;k<5;k++){
+uint8_t n=SpriteOrder[k];
+uint8_t j=k;
+while ((j>0)&&(Sprite[SpriteOrder[j-1]].x>Sprite[n].x)) {SpriteOrder[j]=SpriteOrder[j-1];j--;}
+SpriteOrder[j]=n;
+}}
+
+// draw the remaining pellets of the page, power pellets are blinking
+void LayerDots(uint8_t *buf,uint8_t x0,uint8_t x1,uint8_t y,void *ctx){
+uint8_t blink=(((Frame>=6)&&(Frame<=12))||((Frame>=18)&&(Frame<=24)));
+for (uint8_t t=dotsPage[y];t<dotsPage[y+1];t++){
+const uint8_t *dot=&dots[t*3];
+if ((dot[0]<x0)||(dot[0]>x1)) {continue;}
+if (!checkDotPresent(t)) {continue;}
+if ((dot[1]&0x80)&&(blink)) {continue;}
+buf[dot[0]-x0]|=dot[2];
+}}
+
+void LayerLive(uint8_t *buf,uint8_t x0,uint8_t x1,uint8_t y,void *ctx){
+for (;x0<=x1;x0++){*buf++|=LiveWrite(x0,y);}
+}
+
+void LayerFruit(uint8_t *buf,uint8_t x0,uint8_t x1,uint8_t y,void *ctx){
+for (;x0<=x1;x0++){*buf++|=FruitWrite(x0,y);}
+}
+
+void LayerInit(void){
+JOY_LAYER_add(L_BACKGROUND,LayerBackground);
+JOY_LAYER_add(L_SPRITES,LayerSprites);
+JOY_LAYER_add(L_DOTS,LayerDots);
+JOY_LAYER_add(L_LIVE,LayerLive);
+JOY_LAYER_add(L_FRUIT,LayerFruit);
+JOY_LAYER_set(L_BACKGROUND,0,127,0,7);
+JOY_LAYER_set(L_SPRITES,0,127,0,7);
+for (uint8_t n=0;n<5;n++){SpriteOrder[n]=n;}
+}
+
+// sort the sprites, set bounding boxes of dots, lives and fruits only in game
+void LayerUpdate(PERSONAGE *Sprite){
+SpriteSort(Sprite);
+if (INGAME) {
+JOY_LAYER_set(L_DOTS,17,120,1,6);
+JOY_LAYER_set(L_LIVE,0,7,0,LIVE-1);
+JOY_LAYER_set(L_FRUIT,0,7,4,7);
+}else{
+JOY_LAYER_hide(L_DOTS);
+JOY_LAYER_hide(L_LIVE);
+JOY_LAYER_hide(L_FRUIT);
 }}
 
 uint8_t FruitWrite(uint8_t x,uint8_t y){
@@ -361,58 +494,33 @@ uint8_t LiveWrite(uint8_t x,uint8_t y){
 if (y<LIVE) {if (x<=7) {return (caracters[x+(1*8)]);}else{return 0;}
 }return 0x00;}
 
-uint8_t DotsWrite(uint8_t x,uint8_t y,PERSONAGE *Sprite){
-uint8_t Menreturn=0;
-uint8_t mem1=(dots[x+(128*y)]);
-if (mem1!=0b00000000) {
-dotscount++;
- switch(dotscount){
-  case 0:  
-  case 1: 
-  case 12: 
-  case 13: 
-  case 50:
-  case 51:
-  case 62:
-  case 63:Menreturn=1;break;
-  default:Menreturn=0;break;
-}
-if (checkDotPresent(dotscount)==0b00000000) {mem1=0x00;}else{
-if ((Sprite[0].type==PACMAN)&&((Sprite[0].x<x)&&(Sprite[0].x>x-6))&&(((Sprite[0].y==y)&&(Sprite[0].Decalagey<6))||((Sprite[0].y==y-1)&&(Sprite[0].Decalagey>5)))) {DotsDestroy(dotscount);if (Menreturn==1) {TimerGobeactive=LEVELSPEED;Gobeactive=1;}else{JOY_sound(10,10);JOY_sound(50,10);}}
-}}
-if (Menreturn==1) {
-if (((Frame>=6)&&(Frame<=12))||((Frame>=18)&&(Frame<=24))) {
-return 0x00;
-}else{return mem1;}
-}else{return mem1;}}
-
 uint8_t checkDotPresent(uint8_t  DotsNumber){
-uint8_t REST=DotsNumber;
-uint8_t DOTBOOLPOSITION=0;
-DECREASE:
-if (REST>=8) {REST=REST-8;DOTBOOLPOSITION++;goto DECREASE;}
-return ((dotsMem[DOTBOOLPOSITION])&(0b10000000>>REST));
+return ((dotsMem[DotsNumber>>3])&(0b10000000>>(DotsNumber&7)));
 }
 
 void DotsDestroy(uint8_t DotsNumber){
-uint8_t REST=DotsNumber;
-uint8_t DOTBOOLPOSITION=0;
-uint8_t SOUSTRAIRE;
-DECREASE:
-if (REST>=8) {REST=REST-8;DOTBOOLPOSITION=DOTBOOLPOSITION+1;goto DECREASE;}
-switch(REST){
-  case (0):SOUSTRAIRE=0b01111111;break;
-  case (1):SOUSTRAIRE=0b10111111;break;
-  case (2):SOUSTRAIRE=0b11011111;break;
-  case (3):SOUSTRAIRE=0b11101111;break;
-  case (4):SOUSTRAIRE=0b11110111;break;
-  case (5):SOUSTRAIRE=0b11111011;break;
-  case (6):SOUSTRAIRE=0b11111101;break;
-  case (7):SOUSTRAIRE=0b11111110;break;
+dotsMem[DotsNumber>>3]&=~(0b10000000>>(DotsNumber&7));
 }
-dotsMem[DOTBOOLPOSITION]=dotsMem[DOTBOOLPOSITION]&SOUSTRAIRE;
+
+// pellets left to finish the level (the last one was never counted)
+uint8_t DotsLeft(void){
+uint8_t left=dotsMem[7]&0xFE;
+for (uint8_t t=0;t<7;t++){left|=dotsMem[t];}
+return left;
 }
 
+// eat the pellets Pac-Man is on, only his page can hold them
+void DotsEat(PERSONAGE *Sprite){
+if (Sprite[0].type!=PACMAN) {return;}
+int8_t y=(Sprite[0].Decalagey<6)?Sprite[0].y:Sprite[0].y+1;
+if ((y<0)||(y>7)) {return;}
+for (uint8_t t=dotsPage[y];t<dotsPage[y+1];t++){
+uint8_t x=dots[t*3];
+if ((Sprite[0].x<x)&&(Sprite[0].x>x-6)&&(checkDotPresent(t))) {
+DotsDestroy(t);
+if (dots[t*3+1]&0x80) {TimerGobeactive=LEVELSPEED;Gobeactive=1;}else{JOY_sfx(SFX_DOT);}
+}}}
+
 uint8_t SplitSpriteDecalageY(uint8_t decalage,uint8_t Input,uint8_t UPorDOWN){
 if (UPorDOWN) {
 return Input<<decalage;
@@ -420,20 +528,8 @@ return Input<<decalage;
 return Input>>(8-decalage); 
 }}
 
-uint8_t SpriteWrite(uint8_t x,uint8_t y,PERSONAGE  *Sprite){
-uint8_t var1=0;
-uint8_t AddBin=0b00000000;
-while(1){ 
-if (Sprite[var1].y==y) {
-AddBin=AddBin|SplitSpriteDecalageY(Sprite[var1].Decalagey,return_if_sprite_present(x,Sprite,var1),1);
-}else if (((Sprite[var1].y+1)==y)&&(Sprite[var1].Decalagey!=0)) {
-AddBin=AddBin|SplitSpriteDecalageY(Sprite[var1].Decalagey,return_if_sprite_present(x,Sprite,var1),0);
-}
-var1++;
-if (var1==5) {break;}
-}return AddBin;}
-  
-uint8_t return_if_sprite_present(uint8_t x,PERSONAGE  *Sprite,uint8_t SpriteNumber){
+// offset of column x of the sprite in caracters[], 0xff if not present
+uint8_t SpriteIndex(uint8_t x,PERSONAGE  *Sprite,uint8_t SpriteNumber){
 uint8_t ADDgobActive;
 uint8_t ADDGober;
 if  ((x>=Sprite[SpriteNumber].x)&&(x<(Sprite[SpriteNumber].x+8))) { 
@@ -448,9 +544,9 @@ ADDGober=0;
 ADDGober=0;
 ADDgobActive=0;
 }
-if ((INGAME==0)&&(SpriteNumber==0)) {  return 0;}     
-return (caracters[((x-Sprite[SpriteNumber].x)+(8*(Sprite[SpriteNumber].type*12)))+(Sprite[SpriteNumber].anim*8)+(Sprite[SpriteNumber].DirectionAnim*8)+(ADDgobActive)+(ADDGober)]);
-}return 0;}
+if ((INGAME==0)&&(SpriteNumber==0)) {  return 0xff;}     
+return (((x-Sprite[SpriteNumber].x)+(8*(Sprite[SpriteNumber].type*12)))+(Sprite[SpriteNumber].anim*8)+(Sprite[SpriteNumber].DirectionAnim*8)+(ADDgobActive)+(ADDGober));
+}return 0xff;}
 
 uint8_t background(uint8_t x,uint8_t y){
 return (BackBlitz[((y)*128)+((x))]);
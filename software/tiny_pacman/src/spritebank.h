@@ -24,6 +24,8 @@
 extern "C" {
 #endif
 
+#include "sprite_shift.h"
+
 typedef struct PERSONAGE{
 uint8_t anim;
 uint8_t guber;
@@ -50,20 +52,21 @@ const uint8_t  fruits [] = {
 0x38, 0x6C, 0x5C, 0x7C, 0x38, 0x38, 0x10, 0x60, 0x1F, 0x7E, 0x58, 0xB0, 0xE0, 0xE0, 0x40, 0x40
 };
 
-const uint8_t caracters []  = {
-0x1C, 0x3E, 0x7F, 0x7F, 0x7F, 0x36, 0x1C, 0x00, 0x1C, 0x3E, 0x7F, 0x03, 0x7F, 0x36, 0x1C, 0x00,
-0x1C, 0x3E, 0x0F, 0x03, 0x0F, 0x36, 0x1C, 0x00, 0x00, 0x22, 0x63, 0x75, 0x77, 0x3E, 0x1C, 0x00,
-0x14, 0x36, 0x77, 0x75, 0x77, 0x3E, 0x1C, 0x00, 0x1C, 0x3E, 0x7F, 0x7D, 0x7F, 0x3E, 0x1C, 0x00,
-0x1C, 0x3E, 0x7F, 0x7F, 0x7F, 0x36, 0x1C, 0x00, 0x1C, 0x3E, 0x7F, 0x60, 0x7F, 0x36, 0x1C, 0x00,
-0x1C, 0x3E, 0x78, 0x60, 0x78, 0x36, 0x1C, 0x00, 0x1C, 0x3E, 0x7F, 0x7D, 0x7F, 0x3E, 0x1C, 0x00,
-0x1C, 0x3E, 0x77, 0x75, 0x77, 0x36, 0x14, 0x00, 0x1C, 0x3E, 0x77, 0x75, 0x63, 0x22, 0x00, 0x00,
-0x2D, 0x7F, 0x7F, 0x5B, 0x7F, 0x7F, 0x3E, 0x00, 0x5A, 0x7F, 0x7F, 0x5B, 0x7F, 0x7F, 0x3E, 0x00,
-0x2D, 0x7F, 0x7F, 0x7F, 0x6D, 0x7F, 0x3E, 0x00, 0x5A, 0x7F, 0x7F, 0x7F, 0x6D, 0x7F, 0x3E, 0x00,
-0x2D, 0x77, 0x41, 0x65, 0x41, 0x41, 0x3E, 0x00, 0x5A, 0x77, 0x41, 0x65, 0x41, 0x41, 0x3E, 0x00,
-0x2D, 0x77, 0x41, 0x41, 0x53, 0x41, 0x3E, 0x00, 0x5A, 0x77, 0x41, 0x41, 0x53, 0x41, 0x3E, 0x00,
-0x00, 0x00, 0x00, 0x00, 0x24, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x24, 0x00, 0x00, 0x00,
-0x00, 0x00, 0x00, 0x00, 0x12, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x12, 0x00, 0x00, 0x00
-};
+#define CARACTERS(B) \
+B(0x1C) B(0x3E) B(0x7F) B(0x7F) B(0x7F) B(0x36) B(0x1C) B(0x00) B(0x1C) B(0x3E) B(0x7F) B(0x03) B(0x7F) B(0x36) B(0x1C) B(0x00) \
+B(0x1C) B(0x3E) B(0x0F) B(0x03) B(0x0F) B(0x36) B(0x1C) B(0x00) B(0x00) B(0x22) B(0x63) B(0x75) B(0x77) B(0x3E) B(0x1C) B(0x00) \
+B(0x14) B(0x36) B(0x77) B(0x75) B(0x77) B(0x3E) B(0x1C) B(0x00) B(0x1C) B(0x3E) B(0x7F) B(0x7D) B(0x7F) B(0x3E) B(0x1C) B(0x00) \
+B(0x1C) B(0x3E) B(0x7F) B(0x7F) B(0x7F) B(0x36) B(0x1C) B(0x00) B(0x1C) B(0x3E) B(0x7F) B(0x60) B(0x7F) B(0x36) B(0x1C) B(0x00) \
+B(0x1C) B(0x3E) B(0x78) B(0x60) B(0x78) B(0x36) B(0x1C) B(0x00) B(0x1C) B(0x3E) B(0x7F) B(0x7D) B(0x7F) B(0x3E) B(0x1C) B(0x00) \
+B(0x1C) B(0x3E) B(0x77) B(0x75) B(0x77) B(0x36) B(0x14) B(0x00) B(0x1C) B(0x3E) B(0x77) B(0x75) B(0x63) B(0x22) B(0x00) B(0x00) \
+B(0x2D) B(0x7F) B(0x7F) B(0x5B) B(0x7F) B(0x7F) B(0x3E) B(0x00) B(0x5A) B(0x7F) B(0x7F) B(0x5B) B(0x7F) B(0x7F) B(0x3E) B(0x00) \
+B(0x2D) B(0x7F) B(0x7F) B(0x7F) B(0x6D) B(0x7F) B(0x3E) B(0x00) B(0x5A) B(0x7F) B(0x7F) B(0x7F) B(0x6D) B(0x7F) B(0x3E) B(0x00) \
+B(0x2D) B(0x77) B(0x41) B(0x65) B(0x41) B(0x41) B(0x3E) B(0x00) B(0x5A) B(0x77) B(0x41) B(0x65) B(0x41) B(0x41) B(0x3E) B(0x00) \
+B(0x2D) B(0x77) B(0x41) B(0x41) B(0x53) B(0x41) B(0x3E) B(0x00) B(0x5A) B(0x77) B(0x41) B(0x41) B(0x53) B(0x41) B(0x3E) B(0x00) \
+B(0x00) B(0x00) B(0x00) B(0x00) B(0x24) B(0x00) B(0x00) B(0x00) B(0x00) B(0x00) B(0x00) B(0x00) B(0x24) B(0x00) B(0x00) B(0x00) \
+B(0x00) B(0x00) B(0x00) B(0x00) B(0x12) B(0x00) B(0x00) B(0x00) B(0x00) B(0x00) B(0x00) B(0x00) B(0x12) B(0x00) B(0x00) B(0x00)
+
+const uint8_t caracters[] = { CARACTERS(SPRITE_RAW) };
 
 const uint8_t  back [] = {
 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF8, 0xFC, 0x0C, 0xEC, 0x2C, 0x2C,
@@ -132,74 +135,32 @@ const uint8_t  back [] = {
 0x68, 0x68, 0x68, 0x68, 0x68, 0x68, 0x68, 0x68, 0x68, 0x68, 0x68, 0x6F, 0x60, 0x7F, 0x3F, 0x00
 };
 
+// pellets in page order: column, page (bit 7: power pellet), pixels
 const uint8_t  dots [] = {
-0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-0x00, 0x06, 0x06, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00,
-0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00,
-0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00,
-0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00,
-0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x06, 0x06, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-0x00, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x08,
-0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00,
-0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-0x00, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00,
-0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x08,
-0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00,
-0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-0x00, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00,
-0x00, 0x00, 0x00, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x20,
-0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-0x00, 0x00, 0x00, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x20, 0x00, 0x00,
-0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-0x00, 0x40, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-0x00, 0x00, 0x00, 0x40, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x20,
-0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-0x00, 0x00, 0x00, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-0x00, 0x00, 0x00, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x40, 0x00, 0x00,
-0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x40, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-0x00, 0xC0, 0xC0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00,
-0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00,
-0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x00,
-0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x00, 0x00,
-0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xC0, 0xC0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+ 17,0x81,0x06,  18,0x81,0x06,  26,   1,0x02,  35,   1,0x02,
+ 44,   1,0x02,  53,   1,0x02,  62,   1,0x02,  71,   1,0x02,
+ 80,   1,0x02,  89,   1,0x02,  99,   1,0x02, 109,   1,0x02,
+119,0x81,0x06, 120,0x81,0x06,  17,   2,0x04,  35,   2,0x04,
+ 47,   2,0x08,  57,   2,0x08,  67,   2,0x08,  89,   2,0x08,
+ 99,   2,0x08, 109,   2,0x04, 119,   2,0x04,  17,   3,0x08,
+ 26,   3,0x08,  35,   3,0x08,  47,   3,0x08,  57,   3,0x08,
+ 89,   3,0x08,  99,   3,0x08, 109,   3,0x08, 119,   3,0x08,
+ 17,   4,0x20,  26,   4,0x20,  35,   4,0x20,  47,   4,0x20,
+ 57,   4,0x20,  89,   4,0x20,  99,   4,0x20, 109,   4,0x20,
+119,   4,0x20,  17,   5,0x40,  35,   5,0x40,  47,   5,0x20,
+ 57,   5,0x20,  67,   5,0x20,  89,   5,0x20,  99,   5,0x20,
+109,   5,0x40, 119,   5,0x40,  17,0x86,0xC0,  18,0x86,0xC0,
+ 26,   6,0x80,  35,   6,0x80,  44,   6,0x80,  53,   6,0x80,
+ 62,   6,0x80,  71,   6,0x80,  80,   6,0x80,  89,   6,0x80,
+ 99,   6,0x80, 109,   6,0x80, 119,0x86,0xC0, 120,0x86,0xC0
+};
+
+// index of the first pellet of each page (page 8: end of table)
+const uint8_t  dotsPage [] = {
+0,0,14,23,32,41,50,64,64
 };
 
-const uint8_t  BackBlitz [] = {
+const uint8_t  BackBlitz [] LAYER_ALIGN = {
 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF0, 0xF8, 0x1C, 0xCC, 0x2C, 0x2C,
 0x2C, 0x2C, 0x2C, 0x2C, 0x2C, 0x2C, 0x2C, 0x2C, 0x2C, 0x2C, 0x2C, 0x2C, 0x2C, 0x2C, 0x2C, 0x2C,
 0x2C, 0x2C, 0x2C, 0x2C, 0x2C, 0x2C, 0x2C, 0x2C, 0x2C, 0x2C, 0x2C, 0x2C, 0x2C, 0x2C, 0x2C, 0x2C,
@@ -266,6 +227,18 @@ const uint8_t  BackBlitz [] = {
 0x68, 0x68, 0x68, 0x68, 0x68, 0x68, 0x68, 0x68, 0x68, 0x68, 0x68, 0x67, 0x70, 0x3F, 0x1F, 0x00
 };
 
+// Pre-shifted sprites selected by JOY_PRESHIFT
+#if JOY_PRESHIFT > 0
+const uint16_t caracters_shifted[][8] = { CARACTERS(SPRITE_SHIFTED) };
+#endif
+
+// Sound effects, see JOY_sfx()
+const uint8_t SFX_DOT[]   = {1, SFX_NOTE(10, 10), SFX_NOTE(50, 10), SFX_END};
+const uint8_t SFX_GHOST[] = {2, SFX_NOTE(20, 100), SFX_NOTE(2, 100), SFX_END};
+const uint8_t SFX_DEATH[] = {3, SFX_NOTE(100, 200), SFX_NOTE(75, 200), SFX_NOTE(50, 200), SFX_NOTE(25, 200),
+                                SFX_NOTE(12, 200), SFX_END};
+const uint8_t SFX_CLEAR[] = {3, SFX_LOOP(60), SFX_SLIDE(2, 10, 1), SFX_SLIDE(255, 20, -1), SFX_NEXT, SFX_END};
+
 #ifdef __cplusplus
 };
 #endif
@@ -0,0 +1,65 @@
+// ===================================================================================
+// Library Configuration for Tiny Tris                                        * v1.0 *
+// ===================================================================================
+//
+// Options of the shared drivers in software/lib for this firmware. An option set
+// here replaces the default in the header of its driver (see there), options set
+// on the command line by the makefile replace both. The file is included by
+// system.h and oled_bus.h ahead of their options, so the drivers and the firmware
+// are always built with the same settings.
+//
+// 2023 by Stefan Wagner:   https://github.com/wagiminator
+
+#pragma once
+
+#define LAYER_MAX   9     // number of screen layers (oled_layer.h)
+
+// Pin assignments
+#define PIN_ACT     PA2   // pin connected to fire button
+#define PIN_BEEP    PA1   // pin connected to buzzer
+#define PIN_PAD     PC4   // pin conected to direction buttons
+#define PIN_SCL     PC2   // pin connected to OLED (I2C SCL, SPI D/C)
+#define PIN_SDA     PC1   // pin connected to OLED (I2C SDA, SPI CS)
+                          // (display interface: OLED_BUS in oled_bus.h)
+
+// Joypad calibration values (ascending: E, N, NE, S, SE, W, NW, SW)
+#define JOY_N       197   // joypad UP
+#define JOY_NE      259   // joypad UP + RIGHT
+#define JOY_E       90    // joypad RIGHT
+#define JOY_SE      388   // joypad DOWN + RIGHT
+#define JOY_S       346   // joypad DOWN
+#define JOY_SW      616   // joypad DOWN + LEFT
+#define JOY_W       511   // joypad LEFT
+#define JOY_NW      567   // JOYPAD UP + LEFT
+#define JOY_DEV     20    // deviation (points must be > 2 * JOY_DEV apart)
+#define JOY_PAD_CAL 1     // 1: use the calibration stored by the calibrator if found
+#define JOY_BUS_CAL 1     // 1: use the I2C clock rate stored by the calibrator if found
+
+// Sound enable
+#define JOY_SOUND   1     // 0: no sound, 1: with sound
+#define JOY_SND_TIMER 1   // 0: busy loop, 1: played by TIM1 in the background
+#define JOY_SND_SIZE  16  // length of note queue (power of 2)
+#define JOY_SND_VTF   1   // VTF slot of the sound timer interrupt (-1: none)
+
+// Joypad sampling
+#define JOY_PAD_DMA   1   // 0: sample on JOY_poll(), 1: sample in background (DMA)
+#define JOY_PAD_RING  8   // number of background samples (power of 2)
+#define JOY_FAST_BOOT 1   // 1: set up the joypad ADC after the first screen
+
+// Input events
+#define JOY_EVENTS    1   // 0: poll only, 1: button (EXTI) and pad event queue
+#define JOY_EVT_SIZE  8   // length of event queue (power of 2)
+#define JOY_DEBOUNCE  5   // button debounce time in ms
+#define JOY_PIN_VTF   -1  // VTF slot of the button interrupt (-1: none)
+
+// Frame scheduler
+#define JOY_FRAME_US      2000  // logic tick period in us
+#define JOY_FRAME_RENDER  7     // render every n-th tick
+#define JOY_FRAME_LAG     8     // max number of ticks to catch up after an overrun
+
+// Idle manager (waiting screens)
+#define JOY_IDLE_DIM  20  // dim the display after n seconds without input (0: never)
+#define JOY_IDLE_OFF  60  // switch it off after n seconds and stand by (0: never)
+#define JOY_IDLE_LOW  4   // contrast while dimmed (0..255, normal: 127)
+#define JOY_IDLE_AWU  125 // ms between joypad checks in standby
+#define JOY_IDLE_POLL 20  // ms between button reads of a still screen
@@ -2,7 +2,9 @@
 // Tiny Joypad Drivers for CH32V003                                           * v1.0 *
 // ===================================================================================
 //
-// MCU abstraction layer.
+// MCU abstraction layer of the game: the shared engine (joypad.h in software/lib,
+// its pins and tuning for this game in config.h), the display and layer calls
+// of the game and its benchmark script.
 // 2023 by Stefan Wagner:   https://github.com/wagiminator
 
 #pragma once
@@ -12,116 +14,48 @@ extern "C" {
 #endif
 
 #include <stdbool.h>
-#include "system.h"
-#include "gpio.h"
-#include "oled_min.h"
+#include "joypad.h"                // shared engine (see software/lib)
+#include "fast_math.h"
+#include "bcd.h"
+LAYER_TABLE;                      // screen layers
 
-// Pin assignments
-#define PIN_ACT     PA2   // pin connected to fire button
-#define PIN_BEEP    PA1   // pin connected to buzzer
-#define PIN_PAD     PC4   // pin conected to direction buttons
-#define PIN_SCL     PC2   // pin connected to OLED (I2C SCL)
-#define PIN_SDA     PC1   // pin connected to OLED (I2C SDA)
-
-// Joypad calibration values
-#define JOY_N       197   // joypad UP
-#define JOY_NE      259   // joypad UP + RIGHT
-#define JOY_E       90    // joypad RIGHT
-#define JOY_SE      388   // joypad DOWN + RIGHT
-#define JOY_S       346   // joypad DOWN
-#define JOY_SW      616   // joypad DOWN + LEFT
-#define JOY_W       511   // joypad LEFT
-#define JOY_NW      567   // JOYPAD UP + LEFT
-#define JOY_DEV     20    // deviation
-
-// Sound enable
-#define JOY_SOUND   1     // 0: no sound, 1: with sound
-
-// Game slow-down delay
-#define JOY_SLOWDOWN()    //DLY_ms(10)
-
-// Init driver
-static inline void JOY_init(void) {
-  PIN_input_AN(PIN_PAD);
-  PIN_input_PU(PIN_ACT);
-  PIN_output(PIN_BEEP);
-  PIN_high(PIN_BEEP);
-  OLED_init();
-  ADC_init();
-  ADC_input(PIN_PAD);
-}
+// Pre-shifted sprites (flash budget, 16 bytes per sprite byte)
+#define JOY_PRESHIFT  3   // bit 0: font (640), bit 1: blocks (128), bit 2: start (960)
 
 // OLED commands
 #define JOY_OLED_init             OLED_init
-#define JOY_OLED_end              I2C_stop
-#define JOY_OLED_send(b)          I2C_write(b)
+#define JOY_OLED_end              OLED_page_end
+#define JOY_OLED_send(b)          OLED_page_send(b)
 #define JOY_OLED_send_command(c)  OLED_send_command(c)
-#define JOY_OLED_data_start(y)    {OLED_setpos(0,y);OLED_data_start();}
-
-// Buttons
-#define JOY_act_pressed()         (!PIN_read(PIN_ACT))
-#define JOY_act_released()        (PIN_read(PIN_ACT))
-#define JOY_pad_pressed()         (ADC_read() > 10)
-#define JOY_pad_released()        (ADC_read() <= 10)
-#define JOY_all_released()        (JOY_act_released() && JOY_pad_released())
-
-static inline uint8_t JOY_up_pressed(void) {
- uint16_t val = ADC_read();
- return(   ((val > JOY_N  - JOY_DEV) && (val < JOY_N  + JOY_DEV))
-         | ((val > JOY_NE - JOY_DEV) && (val < JOY_NE + JOY_DEV))
-         | ((val > JOY_NW - JOY_DEV) && (val < JOY_NW + JOY_DEV)) );
-}
-
-static inline uint8_t JOY_down_pressed(void) {
- uint16_t val = ADC_read();
- return(   ((val > JOY_S  - JOY_DEV) && (val < JOY_S  + JOY_DEV))
-         | ((val > JOY_SE - JOY_DEV) && (val < JOY_SE + JOY_DEV))
-         | ((val > JOY_SW - JOY_DEV) && (val < JOY_SW + JOY_DEV)) );
-}
-
-static inline uint8_t JOY_left_pressed(void) {
- uint16_t val = ADC_read();
- return(   ((val > JOY_W  - JOY_DEV) && (val < JOY_W  + JOY_DEV))
-         | ((val > JOY_NW - JOY_DEV) && (val < JOY_NW + JOY_DEV))
-         | ((val > JOY_SW - JOY_DEV) && (val < JOY_SW + JOY_DEV)) );
-}
-
-static inline uint8_t JOY_right_pressed(void) {
- uint16_t val = ADC_read();
- return(   ((val > JOY_E  - JOY_DEV) && (val < JOY_E  + JOY_DEV))
-         | ((val > JOY_NE - JOY_DEV) && (val < JOY_NE + JOY_DEV))
-         | ((val > JOY_SE - JOY_DEV) && (val < JOY_SE + JOY_DEV)) );
-}
-
-// Buzzer
-void JOY_sound(uint8_t freq, uint8_t dur) {
-  while(dur--) {
-    #if JOY_SOUND == 1
-    if(freq) PIN_low(PIN_BEEP);
-    #endif
-    DLY_us(255 - freq);
-    PIN_high(PIN_BEEP);
-    DLY_us(255 - freq);
-  }
-}
-
-// Pseudo random number generator
-uint16_t rnval = 0xACE1;
-uint16_t JOY_random(void) {
-  rnval = (rnval >> 0x01) ^ (-(rnval & 0x01) & 0xB400);
-  return rnval;
-}
-
-// Delays
-#define JOY_DLY_ms    DLY_ms
-#define JOY_DLY_us    DLY_us
-
-// Additional Defines
-#define abs(n) ((n>=0)?(n):(-(n)))
-
-long map(long x, long in_min, long in_max, long out_min, long out_max) {
-  return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
-}
+#define JOY_OLED_data_start(y)    OLED_page_start(y)
+#define JOY_OLED_frame_begin      OLED_frame_begin
+#define JOY_OLED_window_begin     OLED_window_begin
+#define JOY_OLED_frame_end        OLED_frame_end
+#define JOY_OLED_rle_start        OLED_rle_start
+#define JOY_OLED_rle_page         OLED_rle_page
+#define JOY_OLED_fill             OLED_fill
+#define JOY_OLED_fill_window      OLED_fill_window
+#define JOY_OLED_compose          LAYER_compose
+
+// Screen layers
+#define JOY_LAYER_add             LAYER_add
+#define JOY_LAYER_set             LAYER_set
+#define JOY_LAYER_hide            LAYER_hide
+#define JOY_LAYER_place           LAYER_place
+#define JOY_LAYER_blit            LAYER_blit
+#define JOY_LAYER_or              LAYER_or
+#define JOY_LAYER_STATIC          LAYER_STATIC
+
+// Benchmark build (see bench.h): scripted input
+#if BENCH > 0
+const BENCH_STEP BENCH_SCRIPT[] = {
+  {BENCH_ACT, 8}, {0, 32},                                  // start game
+  {JOY_LEFT, 24}, {0, 16}, {BENCH_ACT, 4}, {0, 16},         // move, rotate
+  {JOY_RIGHT, 40}, {0, 16}, {JOY_DOWN, 60}, {0, 24},        // move, drop
+  {BENCH_ACT, 4}, {0, 40},
+  {0, 0}
+};
+#endif
 
 #ifdef __cplusplus
 };
@@ -29,36 +29,106 @@
 
 #include "driver.h"
 #include "spritebank.h"
+#include "flash_kv.h"
+
+#define KV_HIGHSCORE_TTRIS 0   // key of the high score (level, lines, score)
+#define SNAP_GAME_TTRIS 'T'    // snapshot of the game (SNAP_STATE variables, snapshot.h)
+#define SNAP_VER_TTRIS 1       // version of its state
+#define WALL_KICK_TTRIS 1      // 1: shift a piece that can't rotate in place (Kick_TTRIS)
+#define MAX_GARBAGE_TTRIS 18   // link play: most rows an opponent can have pending
+#ifndef AUTO_TTRIS
+#define AUTO_TTRIS 1           // autoplay: 0 off, 1 attract mode, 2 soak test ("make soak")
+#endif
+#define AUTO_WAIT_TTRIS ((AUTO_TTRIS==2)?0:300) // title screen rounds (33ms) until it starts
+#define AUTO_STEPS_TTRIS 4     // placements the planner scores per tick
+#define AUTO_GIVEUP_TTRIS 250  // ticks the planned placement is steered to, then it falls
+#define AUTO_SAFE_TTRIS 2      // a placement with a block in rows 0..n-1 is the last choice
+#define TLM_ID_GAMES_TTRIS TLM_ID_USER        // soak test: games played by the planner
+#define TLM_ID_PLAN_TTRIS (TLM_ID_USER+1)     // its longest planning tick (us)
+
+// Bitboard: a row of the playfield or piece in bits 4..15 of a 32-bit word,
+// everything left and right of the 12 columns counts as wall
+#define FULL_ROW_TTRIS 0x0FFF
+#define GRID_ROW_TTRIS(y) (((uint32_t)Grid_TTRIS[y]<<4)|~((uint32_t)FULL_ROW_TTRIS<<4))
+#define PIECE_ROW_AT_TTRIS(y,x) ((uint32_t)Piece_Row_TTRIS[y]<<((x)+4))
 
 // ===================================================================================
 // Global Variables
 // ===================================================================================
-uint8_t Grid_TTRIS[12][3]={{0}};
+uint16_t Grid_TTRIS[19] SNAP_STATE;   // playfield rows, bit x = column x
 const uint8_t  MEM_TTTRIS[16]= {0,2,0,4,3,7,6,9,9,12,11,15,14,17,17,19};
-uint8_t Level_TTRIS;
-uint16_t Scores_TTRIS;
-uint16_t Nb_of_line_F_TTRIS;
-uint8_t Level_Speed_ADJ_TTRIS;
-uint8_t Nb_of_line_TTRIS[3];
-uint8_t RND_VAR_TTRIS;
-uint8_t LONG_PRESS_X_TTRIS;
-uint8_t DOWN_DESACTIVE_TTRIS;
-uint8_t DROP_SPEED_TTRIS;
-uint8_t SPEED_x_trig_TTRIS;
-uint8_t DROP_TRIG_TTRIS;
-int8_t xx_TTRIS,yy_TTRIS;
-uint8_t Piece_Mat2_TTRIS[5][5];
-uint8_t Ripple_filter_TTRIS;
-uint8_t PIECEs_TTRIS;
-uint8_t PIECEs_TTRIS_PREVIEW;
-uint8_t PIECEs_rot_TTRIS;
-uint8_t DROP_BREAK_TTRIS;
-int8_t OU_SUIS_JE_X_TTRIS;
-int8_t OU_SUIS_JE_Y_TTRIS;
-uint8_t OU_SUIS_JE_X_ENGAGED_TTRIS;
-uint8_t OU_SUIS_JE_Y_ENGAGED_TTRIS;
-int8_t DEPLACEMENT_XX_TTRIS;
-int8_t DEPLACEMENT_YY_TTRIS;
+uint8_t Level_TTRIS SNAP_STATE;
+uint16_t Scores_TTRIS SNAP_STATE;
+uint16_t Nb_of_line_F_TTRIS SNAP_STATE;
+uint8_t Level_Speed_ADJ_TTRIS SNAP_STATE;
+BCD Scores_BCD_TTRIS SNAP_STATE;
+BCD Nb_of_line_BCD_TTRIS SNAP_STATE;
+uint8_t Line_Cache_TTRIS[13];
+uint8_t Score_Cache_TTRIS[25];
+uint8_t Level_Cache_TTRIS[10];
+BCD_HUD Line_HUD_TTRIS={BCD_NONE,16,13,1,1,Line_Cache_TTRIS};
+BCD_HUD Score_HUD_TTRIS={BCD_NONE,95,25,1,1,Score_Cache_TTRIS};
+BCD_HUD Level_HUD_TTRIS={BCD_NONE,109,10,5,5,Level_Cache_TTRIS};
+uint8_t RND_VAR_TTRIS SNAP_STATE;
+uint8_t LONG_PRESS_X_TTRIS SNAP_STATE;
+uint8_t DOWN_DESACTIVE_TTRIS SNAP_STATE;
+uint8_t DROP_SPEED_TTRIS SNAP_STATE;
+uint8_t SPEED_x_trig_TTRIS SNAP_STATE;
+uint8_t DROP_TRIG_TTRIS SNAP_STATE;
+int8_t xx_TTRIS SNAP_STATE,yy_TTRIS SNAP_STATE;
+const uint8_t No_Piece_TTRIS[5]={0};
+const uint8_t *Piece_Row_TTRIS=No_Piece_TTRIS; // rows of the piece in Piece_Rot_TTRIS
+uint8_t Ripple_filter_TTRIS SNAP_STATE;
+uint8_t PIECEs_TTRIS SNAP_STATE;
+uint8_t PIECEs_TTRIS_PREVIEW SNAP_STATE;
+uint8_t PIECEs_rot_TTRIS SNAP_STATE;
+uint8_t DROP_BREAK_TTRIS SNAP_STATE;
+int8_t OU_SUIS_JE_X_TTRIS SNAP_STATE;
+int8_t OU_SUIS_JE_Y_TTRIS SNAP_STATE;
+uint8_t OU_SUIS_JE_X_ENGAGED_TTRIS SNAP_STATE;
+uint8_t OU_SUIS_JE_Y_ENGAGED_TTRIS SNAP_STATE;
+int8_t DEPLACEMENT_XX_TTRIS SNAP_STATE;
+int8_t DEPLACEMENT_YY_TTRIS SNAP_STATE;
+int8_t Drawn_xx_TTRIS,Drawn_yy_TTRIS;  // screen state of the last flip
+const uint8_t *Drawn_Row_TTRIS=No_Piece_TTRIS;
+BCD Drawn_Score_TTRIS;
+BCD Drawn_Line_TTRIS;
+uint8_t Drawn_Level_TTRIS;
+uint8_t Drawn_Next_TTRIS;
+uint8_t Dirty_X0_TTRIS=255,Dirty_X1_TTRIS,Dirty_P0_TTRIS,Dirty_P1_TTRIS; // X0>X1: clean
+uint8_t Versus_TTRIS;                 // 1: head-to-head over the link cable
+uint8_t Garbage_TTRIS;                // rows sent by the opponent, not in yet
+uint8_t Pad_TTRIS;                    // directions of the tick: the joypad's or the planner's
+#if AUTO_TTRIS > 0
+uint8_t Auto_TTRIS;                   // 1: the planner plays
+uint8_t Auto_Done_TTRIS;              // 1: attract mode shown, not again until a game
+uint8_t Auto_Quit_TTRIS;              // 1: input during the attract mode
+uint8_t Auto_Act_TTRIS;               // button of the planner (1: pressed)
+uint8_t Auto_Step_TTRIS;              // next placement: rotation<<4|column+4
+uint8_t Auto_R_TTRIS;                 // best placement so far: rotation,
+int8_t Auto_X_TTRIS,Auto_Y_TTRIS;     // column, row the placements start in
+int16_t Auto_Cost_TTRIS;              // and its cost
+uint8_t Auto_Top_TTRIS[12];           // first block row of each column (19: empty)
+uint8_t Auto_Low_TTRIS[5];            // lowest row of each box column of the rotation
+uint8_t Auto_Ticks_TTRIS;             // ticks since the plan is done
+uint16_t Auto_Games_TTRIS;            // games played by the planner
+uint32_t Auto_Max_TTRIS;              // longest planning tick (SysTick counts)
+const uint8_t Bits_TTRIS[16]={0,1,1,2,1,2,2,3,1,2,2,3,2,3,3,4};
+#define BITS12_TTRIS(v) (Bits_TTRIS[(v)&15]+Bits_TTRIS[((v)>>4)&15]+Bits_TTRIS[((v)>>8)&15])
+#define AUTO_DONE_TTRIS 0xFF
+#define ACT_CLICKED_TTRIS() ((Auto_TTRIS)?Auto_Act_TTRIS:JOY_act_clicked())
+#define ACT_RELEASED_TTRIS() ((Auto_TTRIS)?!Auto_Act_TTRIS:JOY_act_released())
+#define Auto_Rearm_TTRIS() (Auto_Done_TTRIS=0)
+#else
+#define Auto_TTRIS 0
+#define Auto_Quit_TTRIS 0
+#define Auto_Begin_TTRIS(WAIT) ((void)(WAIT),0)
+#define Auto_Stop_TTRIS()
+#define Auto_Over_TTRIS()
+#define Auto_Rearm_TTRIS()
+#define ACT_CLICKED_TTRIS() JOY_act_clicked()
+#define ACT_RELEASED_TTRIS() JOY_act_released()
+#endif
 
 // ===================================================================================
 // Function Prototypes
@@ -73,23 +143,42 @@ void CONTROLE_TTRIS(uint8_t *Rot_TTRIS);
 void Game_Play_TTRIS(void);
 uint8_t End_Play_TTRIS(void);
 void DELETE_LINE_TTRIS(void);
+void Garbage_In_TTRIS(void);
+uint8_t Versus_Over_TTRIS(void);
+#if AUTO_TTRIS > 0
+uint8_t Auto_Begin_TTRIS(uint16_t *WAIT);
+void Auto_Input_TTRIS(uint8_t Rot_TTRIS);
+void Auto_Plan_TTRIS(void);
+int16_t Auto_Score_TTRIS(const uint8_t *Row_,int8_t X_,int8_t Y_);
+void Auto_Stop_TTRIS(void);
+void Auto_Over_TTRIS(void);
+#endif
 uint8_t Calcul_of_Score_TTRIS(uint8_t Tmp_TTRIS);
 void FLASH_LINE_TTRIS(uint8_t *PASS_LINE);
 void PAINT_LINE_TTRIS(uint8_t VISIBLE,uint8_t *PASS_LINE);
 void Clean_Grid_TTRIS(uint8_t *PASS_LINE);
 uint8_t CHECK_if_Rot_Ok_TTRIS(uint8_t *Rot_TTRIS);
-uint8_t Check_collision_x_TTRIS(int8_t x_Axe);
-uint8_t Check_collision_y_TTRIS(int8_t y_Axe);
+uint8_t Check_collision_TTRIS(int8_t x_Axe,int8_t y_Axe);
 void Move_Piece_TTRIS(void);
 void Ou_suis_Je_TTRIS(int8_t xx_,int8_t yy_);
 void Select_Piece_TTRIS(uint8_t Piece_);
 void rotate_Matrix_TTRIS(uint8_t ROT);
-uint8_t Scan_Piece_Matrix_TTRIS(int8_t x_Mat,int8_t y_Mat);
 uint8_t GRID_STAT_TTRIS(int8_t X_SCAN,int8_t Y_SCAN);
 uint8_t CHANGE_GRID_STAT_TTRIS(int8_t X_SCAN,int8_t Y_SCAN,uint8_t VALUE);
 uint8_t blitzSprite_TTRIS(int8_t xPos,int8_t yPos,uint8_t xPASS,uint8_t yPASS,uint8_t FRAME,const uint8_t *SPRITES);
+const uint16_t (*Shifted_TTRIS(const uint8_t *SPRITES))[8];
 uint8_t H_grid_Scan_TTRIS(uint8_t xPASS);
-uint8_t Recupe_TTRIS(uint8_t xPASS,uint8_t yPASS);
+void Layer_Init_TTRIS(void);
+void Layer_Mode_TTRIS(uint8_t INTRO,uint8_t *TIMER1);
+void Back_Layer_TTRIS(uint8_t *buf,uint8_t x0,uint8_t x1,uint8_t yPASS,void *ctx);
+void Grid_Layer_TTRIS(uint8_t *buf,uint8_t x0,uint8_t x1,uint8_t yPASS,void *ctx);
+void Drop_Layer_TTRIS(uint8_t *buf,uint8_t x0,uint8_t x1,uint8_t yPASS,void *ctx);
+void Next_Layer_TTRIS(uint8_t *buf,uint8_t x0,uint8_t x1,uint8_t yPASS,void *ctx);
+void Line_Layer_TTRIS(uint8_t *buf,uint8_t x0,uint8_t x1,uint8_t yPASS,void *ctx);
+void Score_Layer_TTRIS(uint8_t *buf,uint8_t x0,uint8_t x1,uint8_t yPASS,void *ctx);
+void Level_Layer_TTRIS(uint8_t *buf,uint8_t x0,uint8_t x1,uint8_t yPASS,void *ctx);
+void Chateau_Layer_TTRIS(uint8_t *buf,uint8_t x0,uint8_t x1,uint8_t yPASS,void *ctx);
+void Start_Layer_TTRIS(uint8_t *buf,uint8_t x0,uint8_t x1,uint8_t yPASS,void *ctx);
 uint8_t NEXT_BLOCK_TTRIS(uint8_t xPASS,uint8_t yPASS);
 uint8_t RECUPE_BACKGROUND_TTRIS(uint8_t xPASS,uint8_t yPASS);
 uint8_t DropPiece_TTRIS(uint8_t xPASS,uint8_t yPASS);
@@ -97,39 +186,50 @@ uint8_t SplitSpriteDecalageY_TTRIS(uint8_t decalage,uint8_t Input,uint8_t UPorDO
 uint8_t RecupeLineY_TTRIS(uint8_t Valeur);
 uint8_t RecupeDecalageY_TTRIS(uint8_t Valeur);
 void Tiny_Flip_TTRIS(uint8_t HR_TTRIS);
+void Flip_Window_TTRIS(uint8_t X0_TTRIS,uint8_t X1_TTRIS,uint8_t P0_TTRIS,uint8_t P1_TTRIS);
+void Dirty_Rect_TTRIS(int16_t X0_TTRIS,int16_t X1_TTRIS,int16_t Y0_TTRIS,int16_t Y1_TTRIS);
+void Dirty_Piece_TTRIS(int8_t xx_,int8_t yy_,const uint8_t *Row_);
+void Flip_Dirty_TTRIS(void);
+void Drawn_Sync_TTRIS(void);
 void Flip_intro_TTRIS(uint8_t *TIMER1);
-uint8_t intro_TTRIS(uint8_t xPASS,uint8_t yPASS,uint8_t *TIMER1);
+void Flip_Start_TTRIS(uint8_t *TIMER1);
 uint8_t Recupe_Start_TTRIS(uint8_t xPASS,uint8_t yPASS,uint8_t *TIMER1);
 uint8_t recupe_Chateau_TTRIS(uint8_t xPASS,uint8_t yPASS);
-uint8_t recupe_SCORES_TTRIS(uint8_t xPASS,uint8_t yPASS);
-void Convert_Nb_of_line_TTRIS(void);
-uint8_t recupe_Nb_of_line_TTRIS(uint8_t xPASS,uint8_t yPASS);
-uint8_t recupe_LEVEL_TTRIS(uint8_t xPASS,uint8_t yPASS);
+uint8_t recupe_SCORES_TTRIS(uint8_t xPASS,uint8_t yPASS,void *ctx);
+uint8_t recupe_Nb_of_line_TTRIS(uint8_t xPASS,uint8_t yPASS,void *ctx);
+uint8_t recupe_LEVEL_TTRIS(uint8_t xPASS,uint8_t yPASS,void *ctx);
 void INIT_ALL_VAR_TTRIS(void);
 void recupe_HIGHSCORE_TTRIS(void);
 void Reset_Value_TTRIS(void);
 void save_HIGHSCORE_TTRIS(void);
 void Check_NEW_RECORD(void);
-uint8_t checksum(uint8_t Byte_);
 
 // ===================================================================================
 // Main Function
 // ===================================================================================
 int main(void) {
+static uint8_t Rot_TTRIS SNAP_STATE;  // rotation of the piece
 // Setup
 JOY_init();
+KV_init();
+Layer_Init_TTRIS();
+if (JOY_resume(SNAP_GAME_TTRIS,SNAP_VER_TTRIS)) {  // suspended game: straight back in
+rotate_Matrix_TTRIS(Rot_TTRIS);
+Tiny_Flip_TTRIS(128);
+goto RESUME;}
 
 // Loop
 while(1) {
 Reset_Value_TTRIS();
+JOY_poll();
 if ((JOY_down_pressed())) {
 JOY_DLY_ms(1000);
+JOY_poll();
 if ((JOY_down_pressed())) {
 save_HIGHSCORE_TTRIS();}
 }
-MENU:;
-uint8_t Rot_TTRIS=0;
-uint8_t SKIP_FRAME=0;
+MENU:
+Rot_TTRIS=0;
 INIT_ALL_VAR_TTRIS();
 Game_Play_TTRIS();
 Ou_suis_Je_TTRIS(xx_TTRIS,yy_TTRIS);
@@ -138,34 +238,40 @@ SETUP_NEW_PREVIEW_PIECE_TTRIS(&Rot_TTRIS);
 Tiny_Flip_TTRIS(128);
 JOY_DLY_ms(1000);
 xx_TTRIS=55;yy_TTRIS=5;
+RESUME:
+JOY_frame_start();
 while(1){ 
 CONTROLE_TTRIS(&Rot_TTRIS);
 if (DROP_BREAK_TTRIS==6) {
   END_DROP_TTRIS();
-  if (End_Play_TTRIS()) {  Tiny_Flip_TTRIS(128);SND_TTRIS(3); JOY_DLY_ms(2000);Check_NEW_RECORD();goto MENU;}
+  Garbage_In_TTRIS();
+  if (End_Play_TTRIS()) {  JOY_link_stop();Tiny_Flip_TTRIS(128);SND_TTRIS(3); JOY_DLY_ms(2000);if (Auto_TTRIS) {Auto_Stop_TTRIS();Auto_Over_TTRIS();} else {Check_NEW_RECORD();} goto MENU;}
   yy_TTRIS=2;xx_TTRIS=55;
   PIECEs_TTRIS=PIECEs_TTRIS_PREVIEW;
   SETUP_NEW_PREVIEW_PIECE_TTRIS(&Rot_TTRIS);
   DOWN_DESACTIVE_TTRIS=1; 
-  Tiny_Flip_TTRIS(128);
   Game_Play_TTRIS();
-  Tiny_Flip_TTRIS(128);
+  Flip_Dirty_TTRIS();
   } 
    
-if ((JOY_act_pressed())&&(Ripple_filter_TTRIS==0)) {PSEUDO_RND_TTRIS();Ripple_filter_TTRIS=1;}
+if ((Ripple_filter_TTRIS==0)&&(ACT_CLICKED_TTRIS())) {PSEUDO_RND_TTRIS();Ripple_filter_TTRIS=1;}
 
 Move_Piece_TTRIS();
-if (SKIP_FRAME==6) {Tiny_Flip_TTRIS(82);SKIP_FRAME=0;}else{SKIP_FRAME++;}
+if (JOY_frame_render) {Flip_Dirty_TTRIS();}
+JOY_frame_wait();
+if (Auto_Quit_TTRIS) {Auto_Stop_TTRIS();goto MENU;}
+if ((Versus_TTRIS)&&(Versus_Over_TTRIS())) {Tiny_Flip_TTRIS(128);SND_TTRIS(2); JOY_DLY_ms(2000);Check_NEW_RECORD();goto MENU;}
 }}}
 
 // ===================================================================================
 // Functions
 // ===================================================================================
 void reset_Score_TTRIS(void){
-for(uint8_t x=0;x<3;x++){Nb_of_line_TTRIS[x]=0;}
 Level_TTRIS=0;
 Scores_TTRIS=0;
 Nb_of_line_F_TTRIS=0;
+Scores_BCD_TTRIS=0;
+Nb_of_line_BCD_TTRIS=0;
 }
 
 uint8_t PSEUDO_RND_TTRIS(void){
@@ -174,42 +280,39 @@ return RND_VAR_TTRIS;
 }
 
 void SND_TTRIS(uint8_t Snd_TTRIS){
-uint8_t q; 
-switch(Snd_TTRIS){
-    case 0:JOY_sound(3,5);JOY_sound(10,10);JOY_sound(3,5);break;
-    case 1:JOY_sound(3,2);break;
-    case 2:for(q=1;q<10;q++){JOY_sound(40,80);JOY_sound(150,80);}break;
-    case 3:for(q=100;q>10;q--){JOY_sound(q*2,6);JOY_sound(q,12);}break;
-    case 4:JOY_sound(20,150);JOY_sound(100,150);break;
-    case 5:for (q=0;q<126;q++){JOY_sound(q*2,1);}break;
-    default:break;
-}}
+JOY_sfx(SFX_TTRIS[Snd_TTRIS]);
+}
 
 void INTRO_MANIFEST_TTRIS(void){
 uint8_t TIMER_1=0;
+uint16_t WAIT=0;
 recupe_HIGHSCORE_TTRIS();
-Convert_Nb_of_line_TTRIS();
 Flip_intro_TTRIS(&TIMER_1);
+JOY_event_flush();
 while(1){
 PIECEs_TTRIS=PSEUDO_RND_TTRIS();
-if (JOY_act_pressed()) {reset_Score_TTRIS();break;}
-JOY_DLY_ms(33);
+if (JOY_act_clicked()) {reset_Score_TTRIS();Versus_TTRIS=JOY_link_start();Auto_Rearm_TTRIS();break;}
+if (Auto_Begin_TTRIS(&WAIT)) {reset_Score_TTRIS();break;}
+JOY_idle(33);
 TIMER_1=(TIMER_1<7)?TIMER_1+1:0;
-Flip_intro_TTRIS(&TIMER_1);}
+if ((TIMER_1==0)||(TIMER_1==4)) {Flip_Start_TTRIS(&TIMER_1);}}
+JOY_idle_wake();
 SND_TTRIS(4); 
 }
 
 void END_DROP_TTRIS(void){
-  uint8_t x,y;
   DROP_BREAK_TTRIS=0;
-  for (y=0;y<5;y++){
-  for (x=0;x<5;x++){
-  if (Piece_Mat2_TTRIS[x][y]==1) {CHANGE_GRID_STAT_TTRIS(OU_SUIS_JE_X_TTRIS+(x),OU_SUIS_JE_Y_TTRIS+(y),1);}
-  }}
-  Scores_TTRIS=(OU_SUIS_JE_Y_TTRIS<9)?Scores_TTRIS+2:Scores_TTRIS+1;
+  for (uint8_t y=0;y<5;y++){
+  int8_t Y_GRID=OU_SUIS_JE_Y_TTRIS+y;
+  if ((Y_GRID>=0)&&(Y_GRID<19)) {Grid_TTRIS[Y_GRID]|=(PIECE_ROW_AT_TTRIS(y,OU_SUIS_JE_X_TTRIS)>>4)&FULL_ROW_TTRIS;}
+  }
+  uint8_t POINTS=(OU_SUIS_JE_Y_TTRIS<9)?2:1;
+  Scores_TTRIS=Scores_TTRIS+POINTS;
+  Scores_BCD_TTRIS=BCD_add(Scores_BCD_TTRIS,POINTS);
+  Dirty_Piece_TTRIS(46+OU_SUIS_JE_X_TTRIS*3,5+OU_SUIS_JE_Y_TTRIS*3,Piece_Row_TTRIS); // cells it fills
   yy_TTRIS=0;
   xx_TTRIS=0;
-  DELETE_LINE_TTRIS();Convert_Nb_of_line_TTRIS();
+  DELETE_LINE_TTRIS();
 }
 
 void SETUP_NEW_PREVIEW_PIECE_TTRIS(uint8_t *Rot_TTRIS){
@@ -217,19 +320,26 @@ void SETUP_NEW_PREVIEW_PIECE_TTRIS(uint8_t *Rot_TTRIS){
   Select_Piece_TTRIS(PIECEs_TTRIS);
   *Rot_TTRIS=0;
   rotate_Matrix_TTRIS(*Rot_TTRIS);
+  #if AUTO_TTRIS > 0
+  Auto_Step_TTRIS=0;   // (the planner starts over)
+  #endif
   }
 
 void CONTROLE_TTRIS(uint8_t *Rot_TTRIS){
+Pad_TTRIS=JOY_poll();
+#if AUTO_TTRIS > 0
+if (Auto_TTRIS) {Auto_Input_TTRIS(*Rot_TTRIS);}
+#endif
 if ((OU_SUIS_JE_X_ENGAGED_TTRIS==0)) {
 if  (SPEED_x_trig_TTRIS==0){
-if (JOY_right_pressed()) {
+if (Pad_TTRIS&JOY_RIGHT) {
   if (LONG_PRESS_X_TTRIS==0) {SND_TTRIS(1);}
   if ((LONG_PRESS_X_TTRIS==0)||(LONG_PRESS_X_TTRIS==20)) {DEPLACEMENT_XX_TTRIS=1;
   SPEED_x_trig_TTRIS=2;
   }
   if (LONG_PRESS_X_TTRIS<20) {LONG_PRESS_X_TTRIS++;}
   }
-if (JOY_left_pressed()) {
+if (Pad_TTRIS&JOY_LEFT) {
   if (LONG_PRESS_X_TTRIS==0) {SND_TTRIS(1);}
   if ((LONG_PRESS_X_TTRIS==0)||(LONG_PRESS_X_TTRIS==20)) {
     DEPLACEMENT_XX_TTRIS=-1;
@@ -240,9 +350,9 @@ if (JOY_left_pressed()) {
 }else{
   SPEED_x_trig_TTRIS=(SPEED_x_trig_TTRIS>0)?SPEED_x_trig_TTRIS-1:0;}
   }
-if ((JOY_right_pressed()==0)&&(JOY_left_pressed()==0)) {LONG_PRESS_X_TTRIS=0;PSEUDO_RND_TTRIS();}
+if ((Pad_TTRIS&(JOY_RIGHT|JOY_LEFT))==0) {LONG_PRESS_X_TTRIS=0;PSEUDO_RND_TTRIS();}
 
-if (JOY_act_released()) {
+if (ACT_RELEASED_TTRIS()) {
   if ((OU_SUIS_JE_X_ENGAGED_TTRIS==0)&&(OU_SUIS_JE_Y_ENGAGED_TTRIS==0)) {Ripple_filter_TTRIS=0;}
   }
 if ((Ripple_filter_TTRIS==1)) {CHECK_if_Rot_Ok_TTRIS(Rot_TTRIS);Ripple_filter_TTRIS=2;}
@@ -255,7 +365,7 @@ if (DROP_SPEED_TTRIS>0) {
   }else{
     DROP_SPEED_TTRIS=Level_Speed_ADJ_TTRIS;
     }
-if (JOY_down_pressed()) {
+if (Pad_TTRIS&JOY_DOWN) {
   
 //ajouter cest 2 ligne
 if (OU_SUIS_JE_X_ENGAGED_TTRIS==0) {
@@ -271,43 +381,179 @@ LONG_PRESS_X_TTRIS=1;
 }
 
 void Game_Play_TTRIS(void){
-uint8_t LEVEL_TMP=(Nb_of_line_F_TTRIS/20);
+uint8_t LEVEL_TMP=(FM_div10(Nb_of_line_F_TTRIS)>>1);
 if (Level_TTRIS!=LEVEL_TMP) {Level_TTRIS=LEVEL_TMP;SND_TTRIS(2);}
-if (Level_TTRIS<21) {Level_Speed_ADJ_TTRIS=map(Level_TTRIS,0,20,11,1);}
+if (Level_TTRIS<21) {Level_Speed_ADJ_TTRIS=11-(Level_TTRIS>>1);}
 }
 
 uint8_t End_Play_TTRIS(void){
-for (uint8_t t=0;t<12;t++){
-if (GRID_STAT_TTRIS(t,1)==1) {return 1;}
-}
-return 0;
+return (Grid_TTRIS[1]!=0);
 }
 
 void DELETE_LINE_TTRIS(void){
-uint8_t LOOP,SCAN_Line,ADDs_Block,OK_DELETE=0;
+uint8_t LOOP;
 uint8_t LINE_MEM[19]={0}; 
 uint8_t Nb_of_Line_temp=0;
 for (LOOP=0;LOOP<19;LOOP++){
-ADDs_Block=1;
-for (SCAN_Line=0;SCAN_Line<12;SCAN_Line++){
-if (GRID_STAT_TTRIS(SCAN_Line,LOOP)==0) {ADDs_Block=0;}
-}
-if (ADDs_Block) {
+if (Grid_TTRIS[LOOP]==FULL_ROW_TTRIS) {
   LINE_MEM[LOOP]=1;
-  OK_DELETE=1;
+  Nb_of_Line_temp++;
   }
 }
-if (OK_DELETE==1) {
+if (Nb_of_Line_temp) {
   FLASH_LINE_TTRIS(&LINE_MEM[0]);
   Clean_Grid_TTRIS(&LINE_MEM[0]);
   }
-for (LOOP=0;LOOP<19;LOOP++){
-if (LINE_MEM[LOOP]==1) {Nb_of_Line_temp++;}
-}
+if (Nb_of_Line_temp>1) {JOY_link_send((Nb_of_Line_temp==4)?4:Nb_of_Line_temp-1);} // garbage rows
 Nb_of_line_F_TTRIS=Nb_of_line_F_TTRIS+Nb_of_Line_temp;
-Scores_TTRIS=(Scores_TTRIS+Calcul_of_Score_TTRIS(Nb_of_Line_temp));
+Nb_of_line_BCD_TTRIS=BCD_add(Nb_of_line_BCD_TTRIS,Nb_of_Line_temp);
+uint8_t POINTS=Calcul_of_Score_TTRIS(Nb_of_Line_temp);
+Scores_TTRIS=(Scores_TTRIS+POINTS);
+Scores_BCD_TTRIS=BCD_add(Scores_BCD_TTRIS,POINTS);
+TLM_counter(TLM_ID_LINES,Nb_of_line_F_TTRIS);
+TLM_counter(TLM_ID_SCORE,Scores_TTRIS);
+}
+
+// link play: the rows of the opponent push the playfield up from below, all
+// with the gap in one random column
+void Garbage_In_TTRIS(void){
+if (Garbage_TTRIS==0) return;
+uint16_t ROW=FULL_ROW_TTRIS&~(1<<FM_below(JOY_random(),12));
+for (uint8_t y=0;y<19;y++){
+Grid_TTRIS[y]=(y+Garbage_TTRIS<19)?Grid_TTRIS[y+Garbage_TTRIS]:ROW;
+}
+Garbage_TTRIS=0;
+Dirty_Rect_TTRIS(46,81,0,63);
+}
+
+// link play: take the rows the opponent sent, returns 1 if the opponent
+// topped out (or the link is lost)
+uint8_t Versus_Over_TTRIS(void){
+Garbage_TTRIS+=JOY_link_recv();
+if (Garbage_TTRIS>MAX_GARBAGE_TTRIS) {Garbage_TTRIS=MAX_GARBAGE_TTRIS;}
+if (JOY_linked()) return 0;
+Versus_TTRIS=0;
+return 1;
+}
+
+#if AUTO_TTRIS > 0
+// Autoplay: the planner scores every placement of the piece (rotation, column,
+// dropped straight down from the row it is in) on the bitboard, a few per tick,
+// and steers to the best one through the same inputs as a player, then drops it.
+// A straight drop ends on the first block row of a column, so the landing row of
+// a placement comes from the column tops (taken once per piece) and the lowest
+// cells of the rotation instead of a collision test per row. The attract
+// mode starts on an idle title screen (once until the next game), input ends it.
+// The soak test ("make soak") plays game after game right away and sends the
+// games and the longest planning tick as telemetry counters.
+
+// title screen: start the planner after AUTO_WAIT_TTRIS rounds, returns 1
+uint8_t Auto_Begin_TTRIS(uint16_t *WAIT){
+if ((Auto_Done_TTRIS)||((*WAIT)++<AUTO_WAIT_TTRIS)) return 0;
+Auto_TTRIS=1;
+Auto_Done_TTRIS=(AUTO_TTRIS==1);
+Auto_Quit_TTRIS=0;
+Auto_Act_TTRIS=0;
+Auto_Max_TTRIS=0;
+Versus_TTRIS=0;
+return 1;
+}
+
+// the planner's inputs of the tick, after it took the joypad
+void Auto_Input_TTRIS(uint8_t Rot_TTRIS){
+if ((AUTO_TTRIS==1)&&((Pad_TTRIS)||(JOY_act_clicked()))) {Auto_Quit_TTRIS=1;}
+Pad_TTRIS=0;
+Auto_Act_TTRIS=0;
+if (Auto_Step_TTRIS!=AUTO_DONE_TTRIS) {Auto_Plan_TTRIS();return;}
+if (Auto_Ticks_TTRIS>=AUTO_GIVEUP_TTRIS) return;           // (out of reach: it falls)
+Auto_Ticks_TTRIS++;
+if (Rot_TTRIS!=Auto_R_TTRIS) {Auto_Act_TTRIS=(Ripple_filter_TTRIS!=2);return;}  // (click)
+if (OU_SUIS_JE_X_ENGAGED_TTRIS) return;
+if (OU_SUIS_JE_X_TTRIS==Auto_X_TTRIS) {Pad_TTRIS=JOY_DOWN;return;}      // (in place: drop)
+if (LONG_PRESS_X_TTRIS) return;                                        // (tap, don't hold)
+Pad_TTRIS=(OU_SUIS_JE_X_TTRIS<Auto_X_TTRIS)?JOY_RIGHT:JOY_LEFT;
+}
+
+// score the next AUTO_STEPS_TTRIS placements, keep the cheapest
+void Auto_Plan_TTRIS(void){
+uint32_t T0=STK->CNT;
+uint8_t x,y;
+if (Auto_Step_TTRIS==0) {
+  uint16_t COVER=0;
+  for (x=0;x<12;x++) {Auto_Top_TTRIS[x]=19;}
+  for (y=0;y<19;y++){
+    uint16_t NEW=Grid_TTRIS[y]&~COVER;
+    COVER|=NEW;
+    for (x=0;NEW;x++,NEW>>=1) {if (NEW&1) {Auto_Top_TTRIS[x]=y;}}
+    }
+  Ou_suis_Je_TTRIS(xx_TTRIS,yy_TTRIS);
+  Auto_Y_TTRIS=OU_SUIS_JE_Y_TTRIS;
+  Auto_R_TTRIS=0;
+  Auto_X_TTRIS=OU_SUIS_JE_X_TTRIS;
+  Auto_Cost_TTRIS=0x7FFF;
+  Auto_Ticks_TTRIS=0;
+  }
+for (uint8_t n=0;n<AUTO_STEPS_TTRIS;n++){
+  uint8_t R=Auto_Step_TTRIS>>4;
+  int8_t X=(Auto_Step_TTRIS&15)-4;
+  int8_t Y=19;
+  const uint8_t *Row=Piece_Rot_TTRIS[PIECEs_TTRIS][R];
+  if (X==-4) {                                // (new rotation)
+    for (x=0;x<5;x++) {Auto_Low_TTRIS[x]=0xFF;}
+    for (y=0;y<5;y++) {for (x=0;x<5;x++) {if ((Row[y]>>x)&1) {Auto_Low_TTRIS[x]=y;}}}
+    }
+  for (x=0;x<5;x++){
+    if (Auto_Low_TTRIS[x]==0xFF) continue;
+    int8_t COL=X+x;
+    if ((COL<0)||(COL>11)) {Y=-128;break;}    // (in the wall)
+    int8_t LAND=Auto_Top_TTRIS[COL]-1-Auto_Low_TTRIS[x];
+    if (LAND<Y) {Y=LAND;}
+    }
+  if (Y>=Auto_Y_TTRIS) {                      // (else it doesn't fit where the piece is)
+    int16_t COST=Auto_Score_TTRIS(Row,X,Y);
+    if (COST<Auto_Cost_TTRIS) {Auto_Cost_TTRIS=COST;Auto_R_TTRIS=R;Auto_X_TTRIS=X;}
+    }
+  if ((++Auto_Step_TTRIS>>4)>PIECEs_rot_TTRIS) {Auto_Step_TTRIS=AUTO_DONE_TTRIS;break;}
+  }
+T0=STK->CNT-T0;
+if (T0>Auto_Max_TTRIS) {Auto_Max_TTRIS=T0;}
+}
+
+// cost of the playfield with the piece locked at X_/Y_ and the full rows gone:
+// one pass from the top, the OR of the rows so far marks the covered cells, so
+// per row it adds the column heights, the holes and the height steps
+int16_t Auto_Score_TTRIS(const uint8_t *Row_,int8_t X_,int8_t Y_){
+uint16_t COVER=0;
+int16_t HEIGHT=0,HOLES=0,STEPS=0,LINES=0;
+for (uint8_t y=0;y<19;y++){
+uint16_t ROW=Grid_TTRIS[y];
+uint8_t k=y-Y_;
+if (k<5) {ROW|=(((uint32_t)Row_[k]<<(X_+4))>>4)&FULL_ROW_TTRIS;}
+if (ROW==FULL_ROW_TTRIS) {LINES++;continue;}
+COVER|=ROW;
+if (COVER==0) continue;
+if (y<AUTO_SAFE_TTRIS) return 0x7FFE;
+HEIGHT+=BITS12_TTRIS(COVER);
+HOLES+=BITS12_TTRIS(COVER&~ROW);
+STEPS+=BITS12_TTRIS((COVER^(COVER>>1))&(FULL_ROW_TTRIS>>1));
+}
+return HEIGHT+(HOLES<<3)+STEPS-(LINES<<1);
 }
 
+// the planner stops (game over or input), the player takes the joypad again
+void Auto_Stop_TTRIS(void){
+Auto_TTRIS=0;
+Auto_Quit_TTRIS=0;
+}
+
+// end of a game the planner played to the end: counted and sent
+void Auto_Over_TTRIS(void){
+Auto_Games_TTRIS++;
+TLM_counter(TLM_ID_GAMES_TTRIS,Auto_Games_TTRIS);
+TLM_counter(TLM_ID_PLAN_TTRIS,Auto_Max_TTRIS/DLY_US_TIME);
+}
+#endif
+
 uint8_t Calcul_of_Score_TTRIS(uint8_t Tmp_TTRIS){
 switch(Tmp_TTRIS){
   case 0:return 0; break;
@@ -319,97 +565,93 @@ switch(Tmp_TTRIS){
 }
 }
 
+// only the pages of the cleared rows blink
 void FLASH_LINE_TTRIS(uint8_t *PASS_LINE){
-uint8_t LOOP;
+uint8_t LOOP,P0=7,P1=0;
+for (LOOP=0;LOOP<19;LOOP++){
+if (PASS_LINE[LOOP]==1) {
+  if (((5+LOOP*3)>>3)<P0) {P0=(5+LOOP*3)>>3;}
+  P1=(7+LOOP*3)>>3;
+  }
+}
+Flip_Dirty_TTRIS();
 for (LOOP=0;LOOP<5;LOOP++){
 PAINT_LINE_TTRIS(1,&PASS_LINE[0]);
-Tiny_Flip_TTRIS(82);
+Flip_Window_TTRIS(46,81,P0,P1);
 
 PAINT_LINE_TTRIS(0,&PASS_LINE[0]);
-Tiny_Flip_TTRIS(82);
+Flip_Window_TTRIS(46,81,P0,P1);
 }
 SND_TTRIS(5);
 }
 
 void PAINT_LINE_TTRIS(uint8_t VISIBLE,uint8_t *PASS_LINE){
-uint8_t LOOP,SCAN_Line;
-for (LOOP=0;LOOP<19;LOOP++){
- if (PASS_LINE[LOOP]==1){
-for (SCAN_Line=0;SCAN_Line<12;SCAN_Line++){ 
-CHANGE_GRID_STAT_TTRIS(SCAN_Line,LOOP,VISIBLE);
-}}}}
+for (uint8_t LOOP=0;LOOP<19;LOOP++){
+if (PASS_LINE[LOOP]==1) {Grid_TTRIS[LOOP]=(VISIBLE)?FULL_ROW_TTRIS:0;}
+}}
 
+// collapse: every row from the lowest cleared one up to row 1 takes the next
+// row above that isn't cleared (row 0 and above: empty)
 void Clean_Grid_TTRIS(uint8_t *PASS_LINE){
-uint8_t GRID_2=18,GRID_1=18;
-uint8_t x;
-  while(1){
-    if (PASS_LINE[GRID_1]==1) {GRID_2=GRID_1;GRID_2=(GRID_2>0)?GRID_2-1:0;break;}
-    GRID_1=(GRID_1>0)?GRID_1-1:0;}
-while(1){
-  while(1){   
-    if (PASS_LINE[GRID_2]==1) {GRID_2=(GRID_2>0)?GRID_2-1:0;}else{break;}
-          } 
- for(x=0;x<12;x++){
-CHANGE_GRID_STAT_TTRIS(x,GRID_1,(GRID_2>0)?GRID_STAT_TTRIS(x,GRID_2):0);
- }
-GRID_1=(GRID_1>0)?GRID_1-1:0;
-GRID_2=(GRID_2>0)?GRID_2-1:0;
-if (GRID_1==0) {break;}
+int8_t GRID_1=18,GRID_2;
+while (PASS_LINE[GRID_1]==0) {GRID_1--;}
+Dirty_Rect_TTRIS(46,81,0,7+GRID_1*3);
+GRID_2=GRID_1-1;
+for (;GRID_1>0;GRID_1--,GRID_2--){
+while ((GRID_2>0)&&(PASS_LINE[GRID_2]==1)) {GRID_2--;}
+Grid_TTRIS[GRID_1]=(GRID_2>0)?Grid_TTRIS[GRID_2]:0;
 }}
 
+// rotation is a table index change, tried in place and then with the wall kicks
 uint8_t CHECK_if_Rot_Ok_TTRIS(uint8_t *Rot_TTRIS){
 uint8_t Mem_rot=*Rot_TTRIS;
+uint8_t Nb_Kicks=(WALL_KICK_TTRIS)?Piece_Kicks_TTRIS[PIECEs_TTRIS]:1;
 Ou_suis_Je_TTRIS(xx_TTRIS,yy_TTRIS);
 *Rot_TTRIS=(*Rot_TTRIS<PIECEs_rot_TTRIS)?*Rot_TTRIS+1:0;
 rotate_Matrix_TTRIS(*Rot_TTRIS);
-
-
-if ((Check_collision_x_TTRIS(OU_SUIS_JE_X_ENGAGED_TTRIS)||(Check_collision_y_TTRIS(OU_SUIS_JE_Y_ENGAGED_TTRIS)))!=0) {
-  *Rot_TTRIS=Mem_rot;
-  rotate_Matrix_TTRIS(*Rot_TTRIS);
-  return 1;
+for (uint8_t t=0;t<Nb_Kicks;t++){
+int8_t KICK=Kick_TTRIS[t];
+if ((Check_collision_TTRIS(KICK+OU_SUIS_JE_X_ENGAGED_TTRIS,0)||(Check_collision_TTRIS(KICK,OU_SUIS_JE_Y_ENGAGED_TTRIS)))==0) {
+  xx_TTRIS+=KICK*3;
+  Ou_suis_Je_TTRIS(xx_TTRIS,yy_TTRIS);
+  SND_TTRIS(0);
+  return 0;
   }
-SND_TTRIS(0);
-return 0;
 }
-
-uint8_t Check_collision_x_TTRIS(int8_t x_Axe){
-uint8_t x,y;
-for (y=0;y<5;y++){
-for (x=0;x<5;x++){
-if (Piece_Mat2_TTRIS[x][y]==1) {
-  if (GRID_STAT_TTRIS((x+OU_SUIS_JE_X_TTRIS)+x_Axe,y+OU_SUIS_JE_Y_TTRIS)) {return 1;}
-  } 
-  }}
-return 0; 
+*Rot_TTRIS=Mem_rot;
+rotate_Matrix_TTRIS(*Rot_TTRIS);
+return 1;
 }
 
-uint8_t Check_collision_y_TTRIS(int8_t y_Axe){
-uint8_t x,y;
-for (y=0;y<5;y++){
-for (x=0;x<5;x++){
-if (Piece_Mat2_TTRIS[x][y]==1) {
-  if (GRID_STAT_TTRIS(x+OU_SUIS_JE_X_TTRIS,(y+OU_SUIS_JE_Y_TTRIS)+y_Axe)) {return 1;}} 
-  }}
+// piece moved by x_Axe/y_Axe overlaps blocks, walls or floor (rows above the
+// playfield are free): one AND per piece row
+uint8_t Check_collision_TTRIS(int8_t x_Axe,int8_t y_Axe){
+for (uint8_t y=0;y<5;y++){
+if (Piece_Row_TTRIS[y]==0) continue;
+int8_t Y_GRID=OU_SUIS_JE_Y_TTRIS+y+y_Axe;
+if (Y_GRID<0) continue;
+if ((Y_GRID>18)||(OU_SUIS_JE_X_TTRIS+x_Axe<-4)) return 1;
+if (PIECE_ROW_AT_TTRIS(y,OU_SUIS_JE_X_TTRIS+x_Axe)&GRID_ROW_TTRIS(Y_GRID)) return 1;
+}
 return 0; 
 }
 
 void Move_Piece_TTRIS(void){
 Ou_suis_Je_TTRIS(xx_TTRIS,yy_TTRIS);
 if (OU_SUIS_JE_X_ENGAGED_TTRIS==0){
-  if (Check_collision_x_TTRIS(DEPLACEMENT_XX_TTRIS)) {DEPLACEMENT_XX_TTRIS=0;}
+  if (Check_collision_TTRIS(DEPLACEMENT_XX_TTRIS,0)) {DEPLACEMENT_XX_TTRIS=0;}
 }
 if (DEPLACEMENT_XX_TTRIS==1) {xx_TTRIS++;}
 if (DEPLACEMENT_XX_TTRIS==-1) {xx_TTRIS--;}
 Ou_suis_Je_TTRIS(xx_TTRIS,yy_TTRIS);
 if (OU_SUIS_JE_X_ENGAGED_TTRIS==0) {DEPLACEMENT_XX_TTRIS=0;}
 
-if (Check_collision_y_TTRIS(DEPLACEMENT_YY_TTRIS)) {
+if (Check_collision_TTRIS(0,DEPLACEMENT_YY_TTRIS)) {
 DEPLACEMENT_YY_TTRIS=0;
 LONG_PRESS_X_TTRIS=0;
 Ripple_filter_TTRIS=0;
 DROP_BREAK_TTRIS=6;
-Tiny_Flip_TTRIS(82); //add line for refresh screen at drop
+Flip_Dirty_TTRIS(); //add line for refresh screen at drop
 }else{DROP_BREAK_TTRIS=0;}
 if (DROP_SPEED_TTRIS==0){
 if (DEPLACEMENT_YY_TTRIS==-1) {yy_TTRIS--;}
@@ -423,13 +665,13 @@ void Ou_suis_Je_TTRIS(int8_t xx_,int8_t yy_){
 int8_t xx_t,yy_t;
 xx_t=(((xx_)+9)-46);
 yy_t=(((yy_)+9)-5);
-OU_SUIS_JE_X_TTRIS=((xx_t/3)-3);
-if ((xx_t%3)!=0) {
+OU_SUIS_JE_X_TTRIS=(FM_sdiv3(xx_t)-3);
+if ((xx_t)!=((OU_SUIS_JE_X_TTRIS+3)*3)) {
   OU_SUIS_JE_X_ENGAGED_TTRIS=1;
   }else{
     OU_SUIS_JE_X_ENGAGED_TTRIS=0;
     }
-OU_SUIS_JE_Y_TTRIS=((yy_t/3)-3);
+OU_SUIS_JE_Y_TTRIS=(FM_sdiv3(yy_t)-3);
 if ((yy_t)!=((OU_SUIS_JE_Y_TTRIS+3)*3)) {
   OU_SUIS_JE_Y_ENGAGED_TTRIS=1;
   }else{
@@ -439,56 +681,24 @@ if ((yy_t)!=((OU_SUIS_JE_Y_TTRIS+3)*3)) {
 
 void Select_Piece_TTRIS(uint8_t Piece_){
 PIECEs_TTRIS =Piece_;
-switch(Piece_){
-  case 0:PIECEs_rot_TTRIS=3;break;
-  case 1:PIECEs_rot_TTRIS=0;break;
-  case 2:
-  case 3:
-  case 4:PIECEs_rot_TTRIS=1;break;
-  case 5:
-  case 6:PIECEs_rot_TTRIS=3;break;
-  default:PIECEs_rot_TTRIS=0;break;
-}}
-
-void rotate_Matrix_TTRIS(uint8_t ROT){
-uint8_t a_=0,b_=0;
-for (uint8_t y=0;y<5;y++){
-for (uint8_t x=0;x<5;x++){
-switch(ROT){
-  case 0:a_=x,b_=y;break;
-  case 1:a_=4-y,b_=x;break;
-  case 2:a_=4-x,b_=4-y;break;
-  case 3:a_=y,b_=4-x;break;
-  default:break;
+PIECEs_rot_TTRIS=Piece_Rot_Max_TTRIS[Piece_];
 }
-Piece_Mat2_TTRIS[a_][b_]=Scan_Piece_Matrix_TTRIS(x,y+(PIECEs_TTRIS*5));
-}}}
 
-uint8_t Scan_Piece_Matrix_TTRIS(int8_t x_Mat,int8_t y_Mat){
-uint8_t Result=(0b10000000>>x_Mat)&(Pieces_TTRIS[y_Mat]);
-if (Result) {return 1;}else{return 0;}
-return 0;
+void rotate_Matrix_TTRIS(uint8_t ROT){
+Piece_Row_TTRIS=Piece_Rot_TTRIS[PIECEs_TTRIS][ROT];
 }
 
 uint8_t GRID_STAT_TTRIS(int8_t X_SCAN,int8_t Y_SCAN){
 if (Y_SCAN<0) return 0;
 if ((X_SCAN<0)||(X_SCAN>11)) {return 1;}
 if (Y_SCAN>18) {return 1;}
-uint8_t Y_VAR_SELECT=Y_SCAN>>3;
-uint8_t Y_VAR_DECALAGE=RecupeDecalageY_TTRIS(Y_SCAN);
-uint8_t COMP_BYTE_DECALAGE = (0b10000000>>Y_VAR_DECALAGE);
-if ((COMP_BYTE_DECALAGE&Grid_TTRIS[X_SCAN][Y_VAR_SELECT])==0) {return 0;}else{return 1;}
-return 0;
+return (Grid_TTRIS[Y_SCAN]>>X_SCAN)&1;
 }
 
 uint8_t CHANGE_GRID_STAT_TTRIS(int8_t X_SCAN,int8_t Y_SCAN,uint8_t VALUE){
 if ((X_SCAN<0)||(X_SCAN>11)) return 0;
 if ((Y_SCAN<0)||(Y_SCAN>18)) return 0;
-uint8_t Y_VAR_SELECT=Y_SCAN>>3;
-uint8_t Y_VAR_DECALAGE=RecupeDecalageY_TTRIS(Y_SCAN);
-uint8_t COMP_BYTE_DECALAGE = (0b10000000>>Y_VAR_DECALAGE);
-if (VALUE) {Grid_TTRIS[X_SCAN][Y_VAR_SELECT]=COMP_BYTE_DECALAGE|Grid_TTRIS[X_SCAN][Y_VAR_SELECT];}else{
-Grid_TTRIS[X_SCAN][Y_VAR_SELECT]=(0xff-COMP_BYTE_DECALAGE)&Grid_TTRIS[X_SCAN][Y_VAR_SELECT];}
+if (VALUE) {Grid_TTRIS[Y_SCAN]|=1<<X_SCAN;}else{Grid_TTRIS[Y_SCAN]&=~(1<<X_SCAN);}
 return 0;
 }
 
@@ -504,6 +714,12 @@ uint8_t SPRITEyLINE=(yPASS-(RECUPELINEY));
 uint8_t SPRITEyDECALAGE=(RecupeDecalageY_TTRIS(yPos));
 uint8_t ScanA=(((xPASS-xPos)+(SPRITEyLINE*WSPRITE))+2);
 uint8_t ScanB=(((xPASS-xPos)+((SPRITEyLINE-1)*WSPRITE))+2);
+const uint16_t (*SHIFTED)[8]=Shifted_TTRIS(SPRITES);
+if (SHIFTED) {
+OUTBYTE=(ScanA>Wmax)?0x00:SPRITE_UP(SHIFTED[ScanA-2+PICBYTE][SPRITEyDECALAGE]);
+if ((SPRITEyLINE>0)&&(ScanB<=Wmax)) {OUTBYTE|=SPRITE_DOWN(SHIFTED[ScanB-2+PICBYTE][SPRITEyDECALAGE]);}
+return OUTBYTE;
+}
 if (ScanA>Wmax) {OUTBYTE=0x00;}else{OUTBYTE=SplitSpriteDecalageY_TTRIS(SPRITEyDECALAGE,(SPRITES[ScanA+(PICBYTE)]),1);}
 if ((SPRITEyLINE>0)) {
 uint8_t OUTBYTE2=SplitSpriteDecalageY_TTRIS(SPRITEyDECALAGE,(SPRITES[ScanB+(PICBYTE)]),0);
@@ -511,26 +727,25 @@ if (ScanB>Wmax) {return OUTBYTE;}else{return OUTBYTE|OUTBYTE2;}
 }else{return OUTBYTE;}
 }
 
-uint8_t H_grid_Scan_TTRIS(uint8_t xPASS){
-return (H_Grid_TTTRIS[xPASS-46]);  
+// pre-shifted table of a sprite or 0 if it is shifted at runtime
+const uint16_t (*Shifted_TTRIS(const uint8_t *SPRITES))[8]{
+#if JOY_PRESHIFT & 1
+if (SPRITES==police_TTRIS) return police_TTRIS_shifted;
+#endif
+#if JOY_PRESHIFT & 2
+if (SPRITES==tinyblock_TTTRIS) return tinyblock_TTTRIS_shifted;
+if (SPRITES==tinyblock2_TTTRIS) return tinyblock2_TTTRIS_shifted;
+if (SPRITES==tiny_PREVIEW_block_TTTRIS) return tiny_PREVIEW_block_TTTRIS_shifted;
+#endif
+#if JOY_PRESHIFT & 4
+if (SPRITES==start_button_1_TTRIS) return start_button_1_TTRIS_shifted;
+if (SPRITES==start_button_2_TTRIS) return start_button_2_TTRIS_shifted;
+#endif
+return 0;
 }
 
-uint8_t Recupe_TTRIS(uint8_t xPASS,uint8_t yPASS){
-uint8_t BYTE_TTRIS=0;
-uint8_t x=0;
-for (uint8_t y=MEM_TTTRIS[(yPASS<<1)];y<MEM_TTTRIS[(yPASS<<1)+1];y++){
-if ((xPASS>45)&&(xPASS<82)){
-  x=H_grid_Scan_TTRIS(xPASS);
-  }else{
-    return 
-    (RECUPE_BACKGROUND_TTRIS(xPASS,yPASS)|
-    NEXT_BLOCK_TTRIS(xPASS,yPASS)|
-    recupe_Nb_of_line_TTRIS(xPASS,yPASS)|
-    recupe_SCORES_TTRIS(xPASS,yPASS)|
-    recupe_LEVEL_TTRIS(xPASS,yPASS));}
-if (GRID_STAT_TTRIS(x,y)==1) {BYTE_TTRIS=BYTE_TTRIS|blitzSprite_TTRIS(46+(x*3),5+(y*3),xPASS,yPASS,0,tinyblock_TTTRIS);}
-}
-return RECUPE_BACKGROUND_TTRIS(xPASS,yPASS)|BYTE_TTRIS|DropPiece_TTRIS(xPASS,yPASS);
+uint8_t H_grid_Scan_TTRIS(uint8_t xPASS){
+return (H_Grid_TTTRIS[xPASS-46]);  
 }
 
 uint8_t NEXT_BLOCK_TTRIS(uint8_t xPASS,uint8_t yPASS){
@@ -550,7 +765,7 @@ switch(PIECEs_TTRIS_PREVIEW){
 }
 for (uint8_t y=0;y<5;y++){
 for (uint8_t x=0;x<5;x++){
-if (Scan_Piece_Matrix_TTRIS(x,y+(PIECEs_TTRIS_PREVIEW*5))==1) {Byte_Mem|=blitzSprite_TTRIS(92+(x*2)+x_add,(27+(y*2))-5+y_add,xPASS,yPASS,0,tiny_PREVIEW_block_TTTRIS);}
+if ((Piece_Rot_TTRIS[PIECEs_TTRIS_PREVIEW][0][y]>>x)&1) {Byte_Mem|=blitzSprite_TTRIS(92+(x*2)+x_add,(27+(y*2))-5+y_add,xPASS,yPASS,0,tiny_PREVIEW_block_TTTRIS);}
 }}
 return Byte_Mem;
 }
@@ -565,7 +780,7 @@ uint8_t DropPiece_TTRIS(uint8_t xPASS,uint8_t yPASS){
 uint8_t Byte_Mem=0;
 for (uint8_t y=0;y<5;y++){
 for (uint8_t x=0;x<5;x++){
-if (Piece_Mat2_TTRIS[x][y]==1) {Byte_Mem|=blitzSprite_TTRIS(xx_TTRIS+(x*3),(yy_TTRIS+(y*3))-5,xPASS,yPASS,0,tinyblock2_TTTRIS);}
+if ((Piece_Row_TTRIS[y]>>x)&1) {Byte_Mem|=blitzSprite_TTRIS(xx_TTRIS+(x*3),(yy_TTRIS+(y*3))-5,xPASS,yPASS,0,tinyblock2_TTTRIS);}
 }}
 return Byte_Mem;
 }
@@ -580,34 +795,184 @@ return (Valeur>>3);
 }
 
 uint8_t RecupeDecalageY_TTRIS(uint8_t Valeur){
-return (Valeur-((Valeur>>3)<<3));
+return (Valeur&7);
 }
 
 void Tiny_Flip_TTRIS(uint8_t HR_TTRIS){
-uint8_t y,x; 
-for (y = 0; y < 8; y++){ 
+Flip_Window_TTRIS(0,HR_TTRIS-1,0,7);
+Drawn_Sync_TTRIS();
+}
+
+// dirty rectangle in pixels, clipped to the playfield and merged into the one to flip
+void Dirty_Rect_TTRIS(int16_t X0_TTRIS,int16_t X1_TTRIS,int16_t Y0_TTRIS,int16_t Y1_TTRIS){
+if (X0_TTRIS<46) {X0_TTRIS=46;}
+if (X1_TTRIS>81) {X1_TTRIS=81;}
+if (Y0_TTRIS<0) {Y0_TTRIS=0;}
+if (Y1_TTRIS>63) {Y1_TTRIS=63;}
+if ((X0_TTRIS>X1_TTRIS)||(Y0_TTRIS>Y1_TTRIS)) return;
+if (Dirty_X0_TTRIS>Dirty_X1_TTRIS) {
+  Dirty_X0_TTRIS=X0_TTRIS;Dirty_X1_TTRIS=X1_TTRIS;
+  Dirty_P0_TTRIS=Y0_TTRIS>>3;Dirty_P1_TTRIS=Y1_TTRIS>>3;
+  return;
+  }
+if (X0_TTRIS<Dirty_X0_TTRIS) {Dirty_X0_TTRIS=X0_TTRIS;}
+if (X1_TTRIS>Dirty_X1_TTRIS) {Dirty_X1_TTRIS=X1_TTRIS;}
+if ((Y0_TTRIS>>3)<Dirty_P0_TTRIS) {Dirty_P0_TTRIS=Y0_TTRIS>>3;}
+if ((Y1_TTRIS>>3)>Dirty_P1_TTRIS) {Dirty_P1_TTRIS=Y1_TTRIS>>3;}
+}
+
+// bounding box of the blocks of a piece drawn at xx_/yy_ (DropPiece_TTRIS: a block
+// is the lower 3 rows of its sprite, 5 rows below yy_+y*3-5)
+void Dirty_Piece_TTRIS(int8_t xx_,int8_t yy_,const uint8_t *Row_){
+uint8_t COLS=0;
+int8_t R0=-1,R1=0,C0=0,C1=4;
+for (uint8_t y=0;y<5;y++){
+if (Row_[y]) {COLS|=Row_[y];if (R0<0) {R0=y;}R1=y;}
+}
+if (R0<0) return;
+while (((COLS>>C0)&1)==0) {C0++;}
+while (((COLS>>C1)&1)==0) {C1--;}
+Dirty_Rect_TTRIS(xx_+C0*3,xx_+C1*3+2,yy_+R0*3,yy_+R1*3+2);
+}
+
+// flip what changed since the last flip: the old and new place of the piece,
+// the marked grid rows and the HUD fields whose values changed
+void Flip_Dirty_TTRIS(void){
+if ((xx_TTRIS!=Drawn_xx_TTRIS)||(yy_TTRIS!=Drawn_yy_TTRIS)||(Piece_Row_TTRIS!=Drawn_Row_TTRIS)) {
+  Dirty_Piece_TTRIS(Drawn_xx_TTRIS,Drawn_yy_TTRIS,Drawn_Row_TTRIS);
+  Dirty_Piece_TTRIS(xx_TTRIS,yy_TTRIS,Piece_Row_TTRIS);
+  }
+if (Dirty_X0_TTRIS<=Dirty_X1_TTRIS) {Flip_Window_TTRIS(Dirty_X0_TTRIS,Dirty_X1_TTRIS,Dirty_P0_TTRIS,Dirty_P1_TTRIS);}
+if (Scores_BCD_TTRIS!=Drawn_Score_TTRIS) {Flip_Window_TTRIS(95,119,1,1);}
+if (Nb_of_line_BCD_TTRIS!=Drawn_Line_TTRIS) {Flip_Window_TTRIS(16,28,1,1);}
+if (Level_TTRIS!=Drawn_Level_TTRIS) {Flip_Window_TTRIS(109,118,5,5);}
+if (PIECEs_TTRIS_PREVIEW!=Drawn_Next_TTRIS) {Flip_Window_TTRIS(90,103,2,5);}
+Drawn_Sync_TTRIS();
+}
+
+void Drawn_Sync_TTRIS(void){
+Drawn_xx_TTRIS=xx_TTRIS;
+Drawn_yy_TTRIS=yy_TTRIS;
+Drawn_Row_TTRIS=Piece_Row_TTRIS;
+Drawn_Score_TTRIS=Scores_BCD_TTRIS;
+Drawn_Line_TTRIS=Nb_of_line_BCD_TTRIS;
+Drawn_Level_TTRIS=Level_TTRIS;
+Drawn_Next_TTRIS=PIECEs_TTRIS_PREVIEW;
+Dirty_X0_TTRIS=255;Dirty_X1_TTRIS=0;
+}
+
+void Flip_Window_TTRIS(uint8_t X0_TTRIS,uint8_t X1_TTRIS,uint8_t P0_TTRIS,uint8_t P1_TTRIS){
+uint8_t y; 
+Layer_Mode_TTRIS(0,0);
+JOY_OLED_window_begin(X0_TTRIS,X1_TTRIS,P0_TTRIS,P1_TTRIS);
+for (y = P0_TTRIS; y <= P1_TTRIS; y++){ 
 JOY_OLED_data_start(y);
-for (x = 0; x < HR_TTRIS; x++){JOY_OLED_send(Recupe_TTRIS(x,y));}
+JOY_OLED_compose(y,X0_TTRIS,X1_TTRIS,0);
 JOY_OLED_end();
+}
+JOY_OLED_frame_end();
+}
+
+enum {L_BACK_TTRIS=0,L_GRID_TTRIS,L_DROP_TTRIS,L_NEXT_TTRIS,L_LINE_TTRIS,L_SCORE_TTRIS,L_LEVEL_TTRIS,L_CHATEAU_TTRIS,L_START_TTRIS};
+
+void Layer_Init_TTRIS(void){
+JOY_LAYER_add(L_BACK_TTRIS,Back_Layer_TTRIS);
+JOY_LAYER_add(L_GRID_TTRIS,Grid_Layer_TTRIS);
+JOY_LAYER_add(L_DROP_TTRIS,Drop_Layer_TTRIS);
+JOY_LAYER_add(L_NEXT_TTRIS,Next_Layer_TTRIS);
+JOY_LAYER_add(L_LINE_TTRIS,Line_Layer_TTRIS);
+JOY_LAYER_add(L_SCORE_TTRIS,Score_Layer_TTRIS);
+JOY_LAYER_add(L_LEVEL_TTRIS,Level_Layer_TTRIS);
+JOY_LAYER_add(L_CHATEAU_TTRIS,Chateau_Layer_TTRIS);
+JOY_LAYER_add(L_START_TTRIS,Start_Layer_TTRIS);
+JOY_LAYER_set(L_BACK_TTRIS,0,127,0,7);
+JOY_LAYER_set(L_LINE_TTRIS,16,28,1,1);
+JOY_LAYER_set(L_SCORE_TTRIS,95,119,1,1);
+JOY_LAYER_set(L_LEVEL_TTRIS,109,118,5,5);
+}
+
+void Layer_Mode_TTRIS(uint8_t INTRO,uint8_t *TIMER1){
+if (INTRO) {
+JOY_LAYER_hide(L_GRID_TTRIS);
+JOY_LAYER_hide(L_DROP_TTRIS);
+JOY_LAYER_hide(L_NEXT_TTRIS);
+JOY_LAYER_set(L_CHATEAU_TTRIS,46,81,0,7);
+if (*TIMER1>3) {JOY_LAYER_set(L_START_TTRIS,49,78,3,5);}else{JOY_LAYER_hide(L_START_TTRIS);}
+}else{
+JOY_LAYER_set(L_GRID_TTRIS,46,81,0,7);
+JOY_LAYER_set(L_DROP_TTRIS,46,81,0,7);
+JOY_LAYER_set(L_NEXT_TTRIS,90,103,2,5);
+JOY_LAYER_hide(L_CHATEAU_TTRIS);
+JOY_LAYER_hide(L_START_TTRIS);
 }}
 
+void Back_Layer_TTRIS(uint8_t *buf,uint8_t x0,uint8_t x1,uint8_t yPASS,void *ctx){
+const uint8_t *src=&BACKGROUND_TTRIS[x0+(yPASS*128)];
+for (;x0<=x1;x0++){*buf++|=*src++;}
+}
+
+void Grid_Layer_TTRIS(uint8_t *buf,uint8_t x0,uint8_t x1,uint8_t yPASS,void *ctx){
+for (;x0<=x1;x0++){
+uint8_t BYTE_TTRIS=0;
+uint8_t x=H_grid_Scan_TTRIS(x0);
+for (uint8_t y=MEM_TTTRIS[(yPASS<<1)];y<MEM_TTTRIS[(yPASS<<1)+1];y++){
+if (GRID_STAT_TTRIS(x,y)==1) {BYTE_TTRIS=BYTE_TTRIS|blitzSprite_TTRIS(46+(x*3),5+(y*3),x0,yPASS,0,tinyblock_TTTRIS);}
+}
+*buf++|=BYTE_TTRIS;
+}}
+
+void Drop_Layer_TTRIS(uint8_t *buf,uint8_t x0,uint8_t x1,uint8_t yPASS,void *ctx){
+for (;x0<=x1;x0++){*buf++|=DropPiece_TTRIS(x0,yPASS);}
+}
+
+void Next_Layer_TTRIS(uint8_t *buf,uint8_t x0,uint8_t x1,uint8_t yPASS,void *ctx){
+for (;x0<=x1;x0++){*buf++|=NEXT_BLOCK_TTRIS(x0,yPASS);}
+}
+
+void Line_Layer_TTRIS(uint8_t *buf,uint8_t x0,uint8_t x1,uint8_t yPASS,void *ctx){
+BCD_HUD_span(&Line_HUD_TTRIS,Nb_of_line_BCD_TTRIS,buf,x0,x1,yPASS,recupe_Nb_of_line_TTRIS,0);
+}
+
+void Score_Layer_TTRIS(uint8_t *buf,uint8_t x0,uint8_t x1,uint8_t yPASS,void *ctx){
+BCD_HUD_span(&Score_HUD_TTRIS,Scores_BCD_TTRIS,buf,x0,x1,yPASS,recupe_SCORES_TTRIS,0);
+}
+
+void Level_Layer_TTRIS(uint8_t *buf,uint8_t x0,uint8_t x1,uint8_t yPASS,void *ctx){
+BCD_HUD_span(&Level_HUD_TTRIS,Level_TTRIS,buf,x0,x1,yPASS,recupe_LEVEL_TTRIS,0);
+}
+
+void Chateau_Layer_TTRIS(uint8_t *buf,uint8_t x0,uint8_t x1,uint8_t yPASS,void *ctx){
+for (;x0<=x1;x0++){*buf++|=recupe_Chateau_TTRIS(x0,yPASS);}
+}
+
+void Start_Layer_TTRIS(uint8_t *buf,uint8_t x0,uint8_t x1,uint8_t yPASS,void *ctx){
+for (;x0<=x1;x0++){*buf++|=Recupe_Start_TTRIS(x0,yPASS,(uint8_t*)ctx);}
+}
+
 void Flip_intro_TTRIS(uint8_t *TIMER1){
-uint8_t y,x; 
+uint8_t y; 
+Layer_Mode_TTRIS(1,TIMER1);
+JOY_OLED_frame_begin();
 for (y = 0; y < 8; y++){ 
 JOY_OLED_data_start(y);
-for (x = 0; x < 128; x++){JOY_OLED_send(intro_TTRIS(x,y,TIMER1));}
+JOY_OLED_compose(y,0,127,TIMER1);
 JOY_OLED_end();
-}}
+}
+JOY_OLED_frame_end();
+}
 
-uint8_t intro_TTRIS(uint8_t xPASS,uint8_t yPASS,uint8_t *TIMER1){
-return (RECUPE_BACKGROUND_TTRIS(xPASS,yPASS)|
-  recupe_Chateau_TTRIS(xPASS,yPASS)|
-  Recupe_Start_TTRIS(xPASS,yPASS,TIMER1)|
-  recupe_SCORES_TTRIS(xPASS,yPASS)|
-  recupe_Nb_of_line_TTRIS(xPASS,yPASS)|
-  recupe_SCORES_TTRIS(xPASS,yPASS)|
-  recupe_LEVEL_TTRIS(xPASS,yPASS)
-  );
+// the rest of the intro screen is still: only the start button blinks
+// (shown while TIMER1>3), it is flipped when it appears or disappears
+void Flip_Start_TTRIS(uint8_t *TIMER1){
+uint8_t y; 
+Layer_Mode_TTRIS(1,TIMER1);
+JOY_OLED_window_begin(49,78,3,5);
+for (y = 3; y <= 5; y++){ 
+JOY_OLED_data_start(y);
+JOY_OLED_compose(y,49,78,TIMER1);
+JOY_OLED_end();
+}
+JOY_OLED_frame_end();
 }
 
 uint8_t Recupe_Start_TTRIS(uint8_t xPASS,uint8_t yPASS,uint8_t *TIMER1){
@@ -624,56 +989,41 @@ if (xPASS>81) return 0;
 return (chateau_TTRIS[(xPASS-46)+(yPASS*36)]); 
 }
 
-uint8_t recupe_SCORES_TTRIS(uint8_t xPASS,uint8_t yPASS){
+uint8_t recupe_SCORES_TTRIS(uint8_t xPASS,uint8_t yPASS,void *ctx){
 if (xPASS<95) {return 0;}
 if (xPASS>119){return 0;}
 if (yPASS>1) {return 0;}
-#define M10000 (Scores_TTRIS/10000)
-#define M1000 (((Scores_TTRIS)-(M10000*10000))/1000)
-#define M100 (((Scores_TTRIS)-(M1000*1000)-(M10000*10000))/100)
-#define M10 (((Scores_TTRIS)-(M100*100)-(M1000*1000)-(M10000*10000))/10)
-#define M1 ((Scores_TTRIS)-(M10*10)-(M100*100)-(M1000*1000)-(M10000*10000))
 return 
-(blitzSprite_TTRIS(95,8,xPASS,yPASS,M10000,police_TTRIS)|
- blitzSprite_TTRIS(99,8,xPASS,yPASS,M1000,police_TTRIS)|
- blitzSprite_TTRIS(103,8,xPASS,yPASS,M100,police_TTRIS)|
- blitzSprite_TTRIS(107,8,xPASS,yPASS,M10,police_TTRIS)|
- blitzSprite_TTRIS(111,8,xPASS,yPASS,M1,police_TTRIS)|
+(blitzSprite_TTRIS(95,8,xPASS,yPASS,BCD_digit(Scores_BCD_TTRIS,4),police_TTRIS)|
+ blitzSprite_TTRIS(99,8,xPASS,yPASS,BCD_digit(Scores_BCD_TTRIS,3),police_TTRIS)|
+ blitzSprite_TTRIS(103,8,xPASS,yPASS,BCD_digit(Scores_BCD_TTRIS,2),police_TTRIS)|
+ blitzSprite_TTRIS(107,8,xPASS,yPASS,BCD_digit(Scores_BCD_TTRIS,1),police_TTRIS)|
+ blitzSprite_TTRIS(111,8,xPASS,yPASS,BCD_digit(Scores_BCD_TTRIS,0),police_TTRIS)|
  blitzSprite_TTRIS(115,8,xPASS,yPASS,0,police_TTRIS));
 }
 
-void Convert_Nb_of_line_TTRIS(void){
-Nb_of_line_TTRIS[2]= (Nb_of_line_F_TTRIS/100);
-Nb_of_line_TTRIS[1]= ((Nb_of_line_F_TTRIS-(Nb_of_line_TTRIS[2]*100))/10);
-Nb_of_line_TTRIS[0]= (Nb_of_line_F_TTRIS-(Nb_of_line_TTRIS[2]*100)-(Nb_of_line_TTRIS[1]*10));
-}
-
-uint8_t recupe_Nb_of_line_TTRIS(uint8_t xPASS,uint8_t yPASS){
+uint8_t recupe_Nb_of_line_TTRIS(uint8_t xPASS,uint8_t yPASS,void *ctx){
 if (xPASS<16) {return 0;}
 if (xPASS>28){return 0;}
 if (yPASS>1) {return 0;}
 return 
-(blitzSprite_TTRIS(16,8,xPASS,yPASS,Nb_of_line_TTRIS[2],police_TTRIS)|
- blitzSprite_TTRIS(20,8,xPASS,yPASS,Nb_of_line_TTRIS[1],police_TTRIS)|
- blitzSprite_TTRIS(24,8,xPASS,yPASS,Nb_of_line_TTRIS[0],police_TTRIS));
+(blitzSprite_TTRIS(16,8,xPASS,yPASS,BCD_digit(Nb_of_line_BCD_TTRIS,2),police_TTRIS)|
+ blitzSprite_TTRIS(20,8,xPASS,yPASS,BCD_digit(Nb_of_line_BCD_TTRIS,1),police_TTRIS)|
+ blitzSprite_TTRIS(24,8,xPASS,yPASS,BCD_digit(Nb_of_line_BCD_TTRIS,0),police_TTRIS));
 }
 
-uint8_t recupe_LEVEL_TTRIS(uint8_t xPASS,uint8_t yPASS){
+uint8_t recupe_LEVEL_TTRIS(uint8_t xPASS,uint8_t yPASS,void *ctx){
 if (xPASS<109) {return 0;}
 if (xPASS>118) {return 0;}
 if (yPASS!=5)  {return 0;}
 return 
-(blitzSprite_TTRIS(109,41,xPASS,yPASS,(Level_TTRIS/10),police_TTRIS)|
- blitzSprite_TTRIS(114,41,xPASS,yPASS,(Level_TTRIS%10),police_TTRIS));
+(blitzSprite_TTRIS(109,41,xPASS,yPASS,FM_div10(Level_TTRIS),police_TTRIS)|
+ blitzSprite_TTRIS(114,41,xPASS,yPASS,FM_mod10(Level_TTRIS),police_TTRIS));
 }
 
 void INIT_ALL_VAR_TTRIS(void){
-for(uint8_t y=0;y<3;y++){
-for(uint8_t x=0;x<12;x++){
-Grid_TTRIS[x][y]=0;}}
-for(uint8_t y=0;y<5;y++){
-for(uint8_t x=0;x<5;x++){
-Piece_Mat2_TTRIS[x][y]=0;}}
+for(uint8_t y=0;y<19;y++){Grid_TTRIS[y]=0;}
+Piece_Row_TTRIS=No_Piece_TTRIS;
 LONG_PRESS_X_TTRIS=0;
 DOWN_DESACTIVE_TTRIS=0;
 DROP_SPEED_TTRIS=0;
@@ -682,6 +1032,7 @@ DROP_TRIG_TTRIS=1;
 xx_TTRIS=0;
 yy_TTRIS=0;
 Ripple_filter_TTRIS=0;
+Garbage_TTRIS=0;
 PIECEs_TTRIS=0;
 PIECEs_TTRIS_PREVIEW=0;
 PIECEs_rot_TTRIS=0;
@@ -694,118 +1045,34 @@ DEPLACEMENT_XX_TTRIS=0;
 DEPLACEMENT_YY_TTRIS=0;
 }
 
-#define Number_of_Backup 4
-
 void recupe_HIGHSCORE_TTRIS(void){
-/*
-uint8_t RESAVE=0;
-uint8_t t;
-
-uint8_t Level_SUM[Number_of_Backup]={0};
-uint8_t line_SUM[Number_of_Backup]={0};
-uint8_t Scores_SUM[Number_of_Backup]={0};
-
-//recupe data eeprom 
-#define Level_(tt) EEPROM.read(1+(tt*10))
-#define line_A(tt) EEPROM.read(2+(tt*10))
-#define line_B(tt) EEPROM.read(3+(tt*10))
-#define Scores_A(tt) EEPROM.read(4+(tt*10))
-#define Scores_B(tt) EEPROM.read(5+(tt*10))
-
-for (t=0;t<Number_of_Backup;t++){
-Level_SUM[t]=EEPROM.read(7+(t*10));
-line_SUM[t]=EEPROM.read(8+(t*10));
-Scores_SUM[t]=EEPROM.read(9+(t*10));
-}
-//fin
-
-//SUM check
-for (t=0;t<Number_of_Backup;t++){
-if ((checksum(Level_(t)))!=(Level_SUM[t])) {Level_SUM[t]=255;RESAVE=1;}
-if ((checksum(line_A(t))+checksum(line_B(t)))!=(line_SUM[t])) {line_SUM[t]=255;RESAVE=1;}
-if ((checksum(Scores_A(t))+checksum(Scores_B(t)))!=(Scores_SUM[t])) {Scores_SUM[t]=255;RESAVE=1;}
-}
-//SUM check fin
-
-//Get Level
-for (t=0;t<Number_of_Backup;t++){
-if (Level_SUM[t]!=255) {
-Level_TTRIS=Level_(t);
-  goto Next_2;}
-}
-goto ED;
-Next_2:;
-//get level fin
-
-//Get Lines
-for (t=0;t<Number_of_Backup;t++){
-if (line_SUM[t]!=255) {
-Nb_of_line_F_TTRIS=uint16_t (line_A(t)<<8);
-Nb_of_line_F_TTRIS|=uint16_t (line_B(t));
-goto Next_3;}
-}
-goto ED;
-Next_3:;
-//get Lines fin
-
-//Get Scores
-for (t=0;t<Number_of_Backup;t++){
-if (Scores_SUM[t]!=255) {
-Scores_TTRIS=uint16_t (Scores_A(t)<<8);
-Scores_TTRIS|=uint16_t (Scores_B(t));
-goto Next_4;}
-}
-goto ED;
-//get Scores fin
-
-ED:;
-Reset_Value_TTRIS();
-Next_4:;
-if (RESAVE) {save_HIGHSCORE_TTRIS();} //resave if sumcheck not pass
-*/
+uint8_t HS[5];
 Reset_Value_TTRIS();
+if (KV_get(KV_HIGHSCORE_TTRIS,HS,5)!=5) return;
+Level_TTRIS=HS[0];
+Nb_of_line_F_TTRIS=HS[1]|(HS[2]<<8);
+Scores_TTRIS=HS[3]|(HS[4]<<8);
+Nb_of_line_BCD_TTRIS=BCD_from(Nb_of_line_F_TTRIS);
+Scores_BCD_TTRIS=BCD_from(Scores_TTRIS);
 }
 
 void Reset_Value_TTRIS(void){
 Level_TTRIS=0;
 Nb_of_line_F_TTRIS=0;
 Scores_TTRIS=0;
+Scores_BCD_TTRIS=0;
+Nb_of_line_BCD_TTRIS=0;
 }
 
 void save_HIGHSCORE_TTRIS(void){
-/*
-uint8_t LEVEL_=Level_TTRIS&0xff;
-uint8_t LINE_0=(Nb_of_line_F_TTRIS>>8) & 0xFF;
-uint8_t LINE_1=Nb_of_line_F_TTRIS&0xff;
-uint8_t Scores_0=(Scores_TTRIS>>8) & 0xFF;
-uint8_t Scores_1=Scores_TTRIS&0xff;
-uint8_t t;
-for (t=0;t<Number_of_Backup;t++){
-EEPROM.write(1+(t*10),LEVEL_);
-EEPROM.write(2+(t*10),LINE_0);
-EEPROM.write(3+(t*10),LINE_1);
-EEPROM.write(4+(t*10),Scores_0);
-EEPROM.write(5+(t*10),Scores_1);
-EEPROM.write(7+(t*10),checksum(LEVEL_));
-EEPROM.write(8+(t*10),(checksum(LINE_0)+checksum(LINE_1)));
-EEPROM.write(9+(t*10),(checksum(Scores_0)+checksum(Scores_1)));
-}
-*/
+uint8_t HS[5]={Level_TTRIS,Nb_of_line_F_TTRIS&0xff,Nb_of_line_F_TTRIS>>8,Scores_TTRIS&0xff,Scores_TTRIS>>8};
+KV_set(KV_HIGHSCORE_TTRIS,HS,5);
 }
 
 void Check_NEW_RECORD(void){
-/*
-if (Scores_TTRIS>uint16_t((EEPROM.read(4)<<8)|(EEPROM.read(5)))) {
+uint8_t HS[5]={0};
+KV_get(KV_HIGHSCORE_TTRIS,HS,5);
+if (Scores_TTRIS>(HS[3]|(HS[4]<<8))) {
 save_HIGHSCORE_TTRIS();
 }
-*/
-}
-
-uint8_t checksum(uint8_t Byte_){
-uint8_t Total_=0;
-uint8_t t=0;
-for (t=0;t<8;t++){
-if ((Byte_)&(0b00000001<<t)) {Total_++;}
-}
-return Total_;
 }
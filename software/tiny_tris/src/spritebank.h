@@ -25,98 +25,106 @@
 extern "C" {
 #endif
 
+#include "sprite_shift.h"
+
 const uint8_t  H_Grid_TTTRIS[] = {
 0,0,0,1,1,1,2,2,2,3,3,3,4,4,4,5,5,5,6,6,6,7,
 7,7,8,8,8,9,9,9,10,10,10,11,11,11,12,12,12  
 };
 
-const uint8_t Pieces_TTRIS[] = {
-//0
-0b00000000,
-0b00100000,
-0b01110000,
-0b00000000,
-0b00000000,
-//1
-0b00000000,
-0b00000000,
-0b00110000,
-0b00110000,
-0b00000000,
-//2
-0b00000000,
-0b00000000,
-0b00110000,
-0b01100000,
-0b00000000,
-//3
-0b00000000,
-0b00010000,
-0b00110000,
-0b00100000,
-0b00000000,
-//4
-0b00100000,
-0b00100000,
-0b00100000,
-0b00100000,
-0b00000000,
-//5
-0b00000000,
-0b00100000,
-0b00100000,
-0b01100000,
-0b00000000,
-//6
-0b00000000,
-0b00100000,
-0b00100000,
-0b00110000,
-0b00000000
+// Pieces in a 5x5 box, one row byte each (bit 7-x = column x)
+#define PIECES_TTRIS(P) \
+P(0b00000000,0b00100000,0b01110000,0b00000000,0b00000000) \
+P(0b00000000,0b00000000,0b00110000,0b00110000,0b00000000) \
+P(0b00000000,0b00000000,0b00110000,0b01100000,0b00000000) \
+P(0b00000000,0b00010000,0b00110000,0b00100000,0b00000000) \
+P(0b00100000,0b00100000,0b00100000,0b00100000,0b00000000) \
+P(0b00000000,0b00100000,0b00100000,0b01100000,0b00000000) \
+P(0b00000000,0b00100000,0b00100000,0b00110000,0b00000000)
+
+// All pieces in all four rotations as row masks (bit x = column x), expanded at
+// compile time: rotation r is the box turned r times by 90 degrees
+#define PIECE_CELL_TTRIS(r,x) ((((r)>>(7-(x)))&1))
+#define PIECE_ROW_TTRIS(r) (PIECE_CELL_TTRIS(r,0)|PIECE_CELL_TTRIS(r,1)<<1|PIECE_CELL_TTRIS(r,2)<<2|PIECE_CELL_TTRIS(r,3)<<3|PIECE_CELL_TTRIS(r,4)<<4)
+#define PIECE_MIRROR_TTRIS(r) (PIECE_CELL_TTRIS(r,4)|PIECE_CELL_TTRIS(r,3)<<1|PIECE_CELL_TTRIS(r,2)<<2|PIECE_CELL_TTRIS(r,1)<<3|PIECE_CELL_TTRIS(r,0)<<4)
+#define PIECE_COL_UP_TTRIS(x,a,b,c,d,e) (PIECE_CELL_TTRIS(a,x)<<4|PIECE_CELL_TTRIS(b,x)<<3|PIECE_CELL_TTRIS(c,x)<<2|PIECE_CELL_TTRIS(d,x)<<1|PIECE_CELL_TTRIS(e,x))
+#define PIECE_COL_DOWN_TTRIS(x,a,b,c,d,e) (PIECE_CELL_TTRIS(a,x)|PIECE_CELL_TTRIS(b,x)<<1|PIECE_CELL_TTRIS(c,x)<<2|PIECE_CELL_TTRIS(d,x)<<3|PIECE_CELL_TTRIS(e,x)<<4)
+#define PIECE_ROTATIONS_TTRIS(a,b,c,d,e) {\
+{PIECE_ROW_TTRIS(a),PIECE_ROW_TTRIS(b),PIECE_ROW_TTRIS(c),PIECE_ROW_TTRIS(d),PIECE_ROW_TTRIS(e)},\
+{PIECE_COL_UP_TTRIS(0,a,b,c,d,e),PIECE_COL_UP_TTRIS(1,a,b,c,d,e),PIECE_COL_UP_TTRIS(2,a,b,c,d,e),PIECE_COL_UP_TTRIS(3,a,b,c,d,e),PIECE_COL_UP_TTRIS(4,a,b,c,d,e)},\
+{PIECE_MIRROR_TTRIS(e),PIECE_MIRROR_TTRIS(d),PIECE_MIRROR_TTRIS(c),PIECE_MIRROR_TTRIS(b),PIECE_MIRROR_TTRIS(a)},\
+{PIECE_COL_DOWN_TTRIS(4,a,b,c,d,e),PIECE_COL_DOWN_TTRIS(3,a,b,c,d,e),PIECE_COL_DOWN_TTRIS(2,a,b,c,d,e),PIECE_COL_DOWN_TTRIS(1,a,b,c,d,e),PIECE_COL_DOWN_TTRIS(0,a,b,c,d,e)}},
+
+const uint8_t Piece_Rot_TTRIS[7][4][5] = {
+PIECES_TTRIS(PIECE_ROTATIONS_TTRIS)
 };
 
-const uint8_t  tiny_PREVIEW_block_TTTRIS[] = {
+// Last rotation of each piece (O: none, S, Z and I: two), wall kicks in cells
+// tried in turn when a rotation collides (I: up to two cells)
+const uint8_t Piece_Rot_Max_TTRIS[7] = {3,0,1,1,1,3,3};
+const uint8_t Piece_Kicks_TTRIS[7] = {3,1,3,3,5,3,3};
+const int8_t Kick_TTRIS[5] = {0,-1,1,-2,2};
+
+#define PREVIEW_BLOCK_TTRIS(B) \
+B(0b11000000) \
+B(0b11000000)
+
+const uint8_t  tiny_PREVIEW_block_TTTRIS [] = {
 2,1,
-0b11000000,
-0b11000000
+PREVIEW_BLOCK_TTRIS(SPRITE_RAW)
 };
 
-const uint8_t  tinyblock_TTTRIS[] = {
+#define TINYBLOCK_TTRIS(B) \
+B(0x07) B(0x05) B(0x07)
+
+const uint8_t  tinyblock_TTTRIS [] = {
 3,1,
-0x07,0x05,0x07
+TINYBLOCK_TTRIS(SPRITE_RAW)
 };
 
-const uint8_t  tinyblock2_TTTRIS[] = {
+#define TINYBLOCK2_TTRIS(B) \
+B(0b11100000) \
+B(0b11100000) \
+B(0b11100000)
+
+const uint8_t  tinyblock2_TTTRIS [] = {
 3,1,
-0b11100000,
-0b11100000,
-0b11100000
+TINYBLOCK2_TTRIS(SPRITE_RAW)
 };
 
+#define POLICE_TTRIS(B) \
+B(0x1F) B(0x11) B(0x1F) B(0x00) \
+B(0x00) B(0x1F) B(0x00) B(0x00) \
+B(0x1D) B(0x15) B(0x17) B(0x00) \
+B(0x11) B(0x15) B(0x1F) B(0x00) \
+B(0x07) B(0x04) B(0x1F) B(0x00) \
+B(0x17) B(0x15) B(0x1D) B(0x00) \
+B(0x1F) B(0x15) B(0x1D) B(0x00) \
+B(0x01) B(0x1D) B(0x03) B(0x00) \
+B(0x1F) B(0x15) B(0x1F) B(0x00) \
+B(0x17) B(0x15) B(0x1F) B(0x00)
+
 const uint8_t  police_TTRIS [] = {
 4,1,
-0x1F,0x11,0x1F,0x00,
-0x00,0x1F,0x00,0x00,
-0x1D,0x15,0x17,0x00,
-0x11,0x15,0x1F,0x00,
-0x07,0x04,0x1F,0x00,
-0x17,0x15,0x1D,0x00,
-0x1F,0x15,0x1D,0x00,
-0x01,0x1D,0x03,0x00,
-0x1F,0x15,0x1F,0x00,
-0x17,0x15,0x1F,0x00
+POLICE_TTRIS(SPRITE_RAW)
 };
 
+#define START_BUTTON_1_TTRIS(B) \
+B(0xFE) B(0x01) B(0x01) B(0x01) B(0x01) B(0x01) B(0x01) B(0x01) B(0x01) B(0x01) B(0x01) B(0x01) B(0x01) B(0x01) B(0x01) B(0x01) B(0x01) B(0x01) B(0x01) B(0x01) \
+B(0x01) B(0x01) B(0x01) B(0x01) B(0x01) B(0x01) B(0x01) B(0x01) B(0x01) B(0xFE)
+
 const uint8_t  start_button_1_TTRIS [] = {
 30,1,
-0xFE,0x01,0x01,0x01,0x01,0x01,0x01,0x01,0x01,0x01,0x01,0x01,0x01,0x01,0x01,0x01,0x01,0x01,0x01,0x01,
-0x01,0x01,0x01,0x01,0x01,0x01,0x01,0x01,0x01,0xFE
+START_BUTTON_1_TTRIS(SPRITE_RAW)
 };
 
+#define START_BUTTON_2_TTRIS(B) \
+B(0x03) B(0x04) B(0x04) B(0x04) B(0x04) B(0x04) B(0x04) B(0x04) B(0x04) B(0x04) B(0x04) B(0x04) B(0x04) B(0x04) B(0x04) B(0x04) B(0x04) B(0x04) B(0x04) B(0x04) \
+B(0x04) B(0x04) B(0x04) B(0x04) B(0x04) B(0x04) B(0x04) B(0x04) B(0x04) B(0x03)
+
 const uint8_t  start_button_2_TTRIS [] = {
 30,1,
-0x03,0x04,0x04,0x04,0x04,0x04,0x04,0x04,0x04,0x04,0x04,0x04,0x04,0x04,0x04,0x04,0x04,0x04,0x04,0x04,
-0x04,0x04,0x04,0x04,0x04,0x04,0x04,0x04,0x04,0x03
+START_BUTTON_2_TTRIS(SPRITE_RAW)
 };
 
 const uint8_t  chateau_TTRIS [] = {
@@ -192,6 +200,31 @@ const uint8_t  BACKGROUND_TTRIS [] = {
 0x00,0x00,0x00,0x00
 };
 
+// Pre-shifted sprites selected by JOY_PRESHIFT (without width/height header)
+#if JOY_PRESHIFT & 1
+const uint16_t police_TTRIS_shifted [][8] = { POLICE_TTRIS(SPRITE_SHIFTED) };
+#endif
+
+#if JOY_PRESHIFT & 2
+const uint16_t tiny_PREVIEW_block_TTTRIS_shifted [][8] = { PREVIEW_BLOCK_TTRIS(SPRITE_SHIFTED) };
+const uint16_t tinyblock_TTTRIS_shifted [][8] = { TINYBLOCK_TTRIS(SPRITE_SHIFTED) };
+const uint16_t tinyblock2_TTTRIS_shifted [][8] = { TINYBLOCK2_TTRIS(SPRITE_SHIFTED) };
+#endif
+
+#if JOY_PRESHIFT & 4
+const uint16_t start_button_1_TTRIS_shifted [][8] = { START_BUTTON_1_TTRIS(SPRITE_SHIFTED) };
+const uint16_t start_button_2_TTRIS_shifted [][8] = { START_BUTTON_2_TTRIS(SPRITE_SHIFTED) };
+#endif
+
+// Sound effects, see JOY_sfx()
+const uint8_t SFX_LOCK_TTRIS [] = {1, SFX_NOTE(3,5), SFX_NOTE(10,10), SFX_NOTE(3,5), SFX_END};
+const uint8_t SFX_MOVE_TTRIS [] = {0, SFX_NOTE(3,2), SFX_END};
+const uint8_t SFX_LEVEL_TTRIS [] = {2, SFX_LOOP(9), SFX_NOTE(40,80), SFX_NOTE(150,80), SFX_NEXT, SFX_END};
+const uint8_t SFX_OVER_TTRIS [] = {3, SFX_LOOP(90), SFX_SLIDE(200,6,-2), SFX_SLIDE(100,12,-1), SFX_NEXT, SFX_END};
+const uint8_t SFX_START_TTRIS [] = {3, SFX_NOTE(20,150), SFX_NOTE(100,150), SFX_END};
+const uint8_t SFX_LINE_TTRIS [] = {2, SFX_LOOP(126), SFX_SLIDE(0,1,2), SFX_NEXT, SFX_END};
+const uint8_t* const SFX_TTRIS [] = {SFX_LOCK_TTRIS, SFX_MOVE_TTRIS, SFX_LEVEL_TTRIS, SFX_OVER_TTRIS, SFX_START_TTRIS, SFX_LINE_TTRIS};
+
 #ifdef __cplusplus
 };
 #endif
@@ -0,0 +1,84 @@
+#!/usr/bin/env python3
+# ===================================================================================
+# Project:   EEPROM Asset Image Packer
+# Year:      2023
+# URL:       https://github.com/wagiminator
+# ===================================================================================
+#
+# Packs levels and bitmaps into the EEPROM image read by asset.c of the games
+# (see asset.h). All numbers are little-endian:
+#   u8 'T', u8 'A', u8 game, u8 count    header
+#   count x { u16 offset, u16 length }   index, one entry per asset (id 0, 1, ..)
+#   data of the assets
+#
+# Each asset is either a binary file or an array of a C header ("file.h:NAME").
+# The numbers of an array are taken in order, multi-dimensional arrays are
+# flattened, negative values are stored as bytes (two's complement). An empty
+# asset ("-") keeps its id free.
+#
+# Usage: python3 asset_pack.py -g <game tag> -o <image.bin> [-s <eeprom size>] asset...
+#   e.g. python3 asset_pack.py -g L -o lander.bin levels.h:EXTRA_LEVELS title.bin
+#
+# Game tags: L (Lander: 0 levels of 59 bytes, 1 title of 1024 bytes),
+#            I (Invaders: 0 monster grids of 24 bytes)
+# The simulator reads the image with "-e image.bin".
+# ===================================================================================
+
+import argparse
+import re
+import sys
+
+
+def read_array(filename, name):
+    text = open(filename).read()
+    m = re.search(r'\b' + re.escape(name) + r'\s*(?:\[\w*\]\s*)+=\s*\{(.*?)\};', text, re.S)
+    if not m:
+        sys.exit('array %s not found in %s' % (name, filename))
+    body = re.sub(r'//.*', '', m.group(1))
+    body = re.sub(r'/\*.*?\*/', '', body, flags=re.S)
+    return bytes(int(v, 0) & 0xFF for v in re.split(r'[\s,{}]+', body) if v)
+
+
+def read_asset(spec):
+    if spec == '-':
+        return b''
+    if ':' in spec:
+        filename, name = spec.rsplit(':', 1)
+        return read_array(filename, name)
+    return open(spec, 'rb').read()
+
+
+def pack(game, assets):
+    head = 4 + 4 * len(assets)
+    index = bytearray(b'TA' + bytes([ord(game), len(assets)]))
+    data = bytearray()
+    for a in assets:
+        off = head + len(data) if a else 0
+        index += bytes([off & 0xFF, off >> 8, len(a) & 0xFF, len(a) >> 8])
+        data += a
+    return bytes(index + data)
+
+
+def main():
+    ap = argparse.ArgumentParser(description='pack assets into an EEPROM image')
+    ap.add_argument('-g', '--game', required=True, help='game tag (one character)')
+    ap.add_argument('-o', '--output', required=True, help='image file')
+    ap.add_argument('-s', '--size', type=int, default=4096, help='EEPROM size in bytes')
+    ap.add_argument('assets', nargs='+', help='file.bin, file.h:ARRAY or -')
+    args = ap.parse_args()
+    if len(args.game) != 1:
+        sys.exit('game tag must be one character')
+    if len(args.assets) > 255:
+        sys.exit('too many assets')
+    assets = [read_asset(s) for s in args.assets]
+    image = pack(args.game, assets)
+    if len(image) > min(args.size, 0x10000):
+        sys.exit('image of %d bytes does not fit into %d bytes' % (len(image), args.size))
+    open(args.output, 'wb').write(image)
+    for i, (s, a) in enumerate(zip(args.assets, assets)):
+        print('asset %d: %5d bytes  %s' % (i, len(a), s))
+    print('%d of %d bytes used' % (len(image), args.size))
+
+
+if __name__ == '__main__':
+    main()
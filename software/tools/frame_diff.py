@@ -0,0 +1,201 @@
+#!/usr/bin/env python3
+# ===================================================================================
+# Project:   Golden Frame Comparison for the Games
+# Year:      2023
+# URL:       https://github.com/wagiminator
+# ===================================================================================
+#
+# Compares the screens captured by the host simulator ("-f", see host/sim.c). A
+# frames file holds one entry per screen content: u32 tick, then the 1024 bytes
+# of the SSD1306 display RAM page by page (8 pages of 128 columns, bit 0 = top).
+#
+#   diff  <golden> <frames> [prefix]   compare screen by screen, report the first
+#                                      differing one with its page and column and
+#                                      write prefix_golden/_frames/_diff.png
+#   png   <frames> <index> <out.png>   render one screen as image
+#   seed  <screenshot.png> <out>       turn a screenshot (e.g. documentation/) into
+#                                      a frames file of one expected screen
+#   match <seeds> <frames> [prefix]    find the best match of every seed screen
+#
+# Screenshots are scaled down by fitting their lit area to 128 x 64 and sampling
+# the middle of every pixel cell, so they only give expected screens once checked
+# by eye (screens that leave the outer rows or columns dark come out stretched);
+# captures of a known good build ("make golden") are exact. Exit code 1 if
+# screens differ.
+# ===================================================================================
+
+import struct
+import sys
+import zlib
+
+W, H = 128, 64
+FRAME = 4 + W * H // 8
+SCALE = 4
+
+
+def read_frames(name):
+    with open(name, 'rb') as f:
+        data = f.read()
+    return [(struct.unpack_from('<I', data, i)[0], data[i + 4:i + FRAME])
+            for i in range(0, len(data) - FRAME + 1, FRAME)]
+
+
+def pixel(ram, x, y):
+    return (ram[(y >> 3) * W + x] >> (y & 7)) & 1
+
+
+def write_png(name, rows):
+    # rows: list of lists of (r, g, b)
+    w, h = len(rows[0]), len(rows)
+    raw = b''.join(b'\0' + bytes(c for px in row for c in px) for row in rows)
+
+    def chunk(tag, body):
+        return (struct.pack('>I', len(body)) + tag + body +
+                struct.pack('>I', zlib.crc32(tag + body) & 0xFFFFFFFF))
+    with open(name, 'wb') as f:
+        f.write(b'\x89PNG\r\n\x1a\n')
+        f.write(chunk(b'IHDR', struct.pack('>IIBBBBB', w, h, 8, 2, 0, 0, 0)))
+        f.write(chunk(b'IDAT', zlib.compress(raw, 9)))
+        f.write(chunk(b'IEND', b''))
+
+
+def render(name, ram, other=None):
+    # screen scaled up; with other: pixels that differ from it in red
+    rows = []
+    for y in range(H):
+        row = []
+        for x in range(W):
+            p = pixel(ram, x, y)
+            if other is not None and p != pixel(other, x, y):
+                c = (255, 0, 0) if p else (128, 0, 0)
+            else:
+                c = (255, 255, 255) if p else (0, 0, 0)
+            row += [c] * SCALE
+        rows += [row] * SCALE
+    write_png(name, rows)
+
+
+def read_png(name):
+    # 8-bit grey/RGB/RGBA, non-interlaced; returns rows of luminance
+    with open(name, 'rb') as f:
+        data = f.read()
+    if data[:8] != b'\x89PNG\r\n\x1a\n':
+        sys.exit('%s: not a PNG file' % name)
+    pos, idat = 8, b''
+    while pos < len(data):
+        n, tag = struct.unpack_from('>I4s', data, pos)
+        body = data[pos + 8:pos + 8 + n]
+        if tag == b'IHDR':
+            w, h, depth, ctype, _, _, interlace = struct.unpack('>IIBBBBB', body)
+        elif tag == b'IDAT':
+            idat += body
+        pos += n + 12
+    bpp = {0: 1, 2: 3, 4: 2, 6: 4}.get(ctype)
+    if depth != 8 or bpp is None or interlace:
+        sys.exit('%s: only 8-bit non-interlaced grey/RGB(A) PNGs are supported' % name)
+    raw, stride, prev, rows = zlib.decompress(idat), w * bpp, None, []
+    for y in range(h):
+        ftype, line = raw[y * (stride + 1)], bytearray(raw[y * (stride + 1) + 1:(y + 1) * (stride + 1)])
+        up = prev or bytearray(stride)
+        for i in range(stride):
+            a = line[i - bpp] if i >= bpp else 0
+            b = up[i]
+            c = up[i - bpp] if i >= bpp else 0
+            if ftype == 1:
+                line[i] = (line[i] + a) & 0xFF
+            elif ftype == 2:
+                line[i] = (line[i] + b) & 0xFF
+            elif ftype == 3:
+                line[i] = (line[i] + ((a + b) >> 1)) & 0xFF
+            elif ftype == 4:
+                pa, pb, pc = abs(b - c), abs(a - c), abs(a + b - 2 * c)
+                line[i] = (line[i] + (a if pa <= pb and pa <= pc else b if pb <= pc else c)) & 0xFF
+        prev = line
+        if bpp >= 3:
+            rows.append([(line[i] * 3 + line[i + 1] * 6 + line[i + 2]) // 10
+                         for i in range(0, stride, bpp)])
+        else:
+            rows.append([line[i] for i in range(0, stride, bpp)])
+    return rows
+
+
+def seed(src, dst):
+    # the lit area of the screenshot is taken as the full 128 x 64 screen
+    rows = read_png(src)
+    lit = [(x, y) for y, row in enumerate(rows) for x, v in enumerate(row) if v >= 128]
+    if not lit:
+        sys.exit('%s: screenshot is dark' % src)
+    x0, x1 = min(p[0] for p in lit), max(p[0] for p in lit) + 1
+    y0, y1 = min(p[1] for p in lit), max(p[1] for p in lit) + 1
+    ram = bytearray(W * H // 8)
+    for y in range(H):
+        for x in range(W):
+            if rows[y0 + (2 * y + 1) * (y1 - y0) // (2 * H)][x0 + (2 * x + 1) * (x1 - x0) // (2 * W)] >= 128:
+                ram[(y >> 3) * W + x] |= 1 << (y & 7)
+    with open(dst, 'wb') as f:
+        f.write(struct.pack('<I', 0xFFFFFFFF) + ram)
+    print('%s: area %d,%d..%d,%d of the screenshot -> %s' % (src, x0, y0, x1 - 1, y1 - 1, dst))
+
+
+def first_diff(a, b):
+    for i in range(len(a)):
+        if a[i] != b[i]:
+            return i >> 7, i & 127
+    return None
+
+
+def bits(a, b):
+    return sum(bin(x ^ y).count('1') for x, y in zip(a, b))
+
+
+def diff(golden, frames, prefix=None):
+    ga, fb = read_frames(golden), read_frames(frames)
+    for i, ((ta, a), (tb, b)) in enumerate(zip(ga, fb)):
+        pos = first_diff(a, b)
+        if pos:
+            print('screen %d (tick %d / %d): first difference at page %d column %d, '
+                  '%d pixels differ' % (i, ta, tb, pos[0], pos[1], bits(a, b)))
+            if prefix:
+                render(prefix + '_golden.png', a, b)
+                render(prefix + '_frames.png', b, a)
+                render(prefix + '_diff.png', bytes(x ^ y for x, y in zip(a, b)))
+                print('images: %s_golden.png %s_frames.png %s_diff.png' % (prefix, prefix, prefix))
+            sys.exit(1)
+    if len(ga) != len(fb):
+        print('%d screens equal, then %s ends (%d / %d screens)' % (
+            min(len(ga), len(fb)), golden if len(ga) < len(fb) else frames, len(ga), len(fb)))
+        sys.exit(1)
+    print('%d screens equal' % len(ga))
+
+
+def match(seeds, frames, prefix=None):
+    fb, worst = read_frames(frames), 0
+    if not fb:
+        sys.exit('%s: no screens' % frames)
+    for i, (_, s) in enumerate(read_frames(seeds)):
+        n, best = min((bits(s, b), j) for j, (_, b) in enumerate(fb))
+        print('seed %d: best match screen %d (tick %d), %d pixels differ' % (i, best, fb[best][0], n))
+        if n and prefix:
+            render('%s_%d.png' % (prefix, i), fb[best][1], s)
+        worst = max(worst, n)
+    sys.exit(1 if worst else 0)
+
+
+def main():
+    cmd, args = (sys.argv[1] if len(sys.argv) > 1 else ''), sys.argv[2:]
+    if cmd == 'diff' and len(args) in (2, 3):
+        diff(*args)
+    elif cmd == 'png' and len(args) == 3:
+        frames = read_frames(args[0])
+        render(args[2], frames[int(args[1])][1])
+    elif cmd == 'seed' and len(args) == 2:
+        seed(*args)
+    elif cmd == 'match' and len(args) in (2, 3):
+        match(*args)
+    else:
+        sys.exit('usage: frame_diff.py diff <golden> <frames> [prefix] | png <frames> <index> <out.png>\n'
+                 '                     | seed <screenshot.png> <out> | match <seeds> <frames> [prefix]')
+
+
+if __name__ == '__main__':
+    main()
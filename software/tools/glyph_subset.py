@@ -0,0 +1,123 @@
+#!/usr/bin/env python3
+# ===================================================================================
+# Project:   Glyph Subset Generator for the Shared Text Renderer
+# Year:      2023
+# URL:       https://github.com/wagiminator
+# ===================================================================================
+#
+# Generates the font tables of glyph.c (see glyph.h) with only the glyphs a
+# firmware actually prints, taken from the master font lib/font_5x8.h:
+#   GLYPH_runs[]   runs of consecutive character codes: first code, number of
+#                  glyphs, ..., terminated by a run of 0 glyphs
+#   GLYPH_font[]   five columns of page bytes per glyph, in the order of the runs
+#
+# The characters are the ones of the string and character literals in the given
+# source files, plus the ones of "-c" (characters composed at run time, e.g. the
+# digits of a number). Glyphs without a pixel (space) are left out, glyph.c
+# renders all characters missing from the tables as blank columns.
+#
+# Usage: python3 glyph_subset.py [-f <master font>] [-c <chars>] -o <glyphs.h> source...
+#   e.g. python3 glyph_subset.py -c "0123456789ABCDEF" -o src/glyphs.h src/main.c
+# ===================================================================================
+
+import argparse
+import os
+import re
+import sys
+
+MASTER = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'lib', 'font_5x8.h')
+WIDTH  = 5
+
+ESCAPES = {'n': '\n', 'r': '\r', 't': '\t', '0': '\0', '\\': '\\', "'": "'", '"': '"'}
+
+
+def read_array(text, name):
+    text = re.sub(r'//.*', '', text)        # (the comments name the glyphs, e.g. "}")
+    m = re.search(r'\b' + re.escape(name) + r'\s*\[\]\s*=\s*\{(.*?)\}', text, re.S)
+    if not m:
+        sys.exit('array %s not found in the master font' % name)
+    body = m.group(1)
+    return [int(v, 0) for v in body.replace('\n', ' ').split(',') if v.strip()]
+
+
+def read_font(filename):
+    text = open(filename).read()
+    runs = read_array(text, 'GLYPH_runs')
+    data = read_array(text, 'GLYPH_font')
+    font = {}
+    i = 0
+    for first, count in zip(runs[0::2], runs[1::2]):
+        for c in range(first, first + count):
+            font[c] = data[i * WIDTH:(i + 1) * WIDTH]
+            i += 1
+    return font
+
+
+def literals(filename):
+    text = open(filename).read()
+    text = re.sub(r'/\*.*?\*/', ' ', text, flags=re.S)
+    chars = set()
+    for m in re.finditer(r'//[^\n]*|#include[^\n]*|"((?:[^"\\\n]|\\.)*)"|\'((?:[^\'\\\n]|\\.)+)\'', text):
+        s = m.group(1) if m.group(1) is not None else m.group(2)
+        if s is None:
+            continue                        # comment or include
+        s = re.sub(r'\\(x[0-9A-Fa-f]+|[0-7]{1,3}|.)',
+                   lambda e: chr(int(e.group(1)[1:], 16)) if e.group(1)[0] == 'x'
+                   else chr(int(e.group(1), 8)) if e.group(1)[0].isdigit()
+                   else ESCAPES.get(e.group(1), e.group(1)), s)
+        chars.update(ord(c) for c in s)
+    return chars
+
+
+def runs_of(codes):
+    runs = []
+    for c in codes:
+        if runs and runs[-1][0] + runs[-1][1] == c:
+            runs[-1][1] += 1
+        else:
+            runs.append([c, 1])
+    return runs
+
+
+def show(c):
+    return {0x5C: 'backslash', 0x7F: 'DEL'}.get(c, chr(c))
+
+
+if __name__ == '__main__':
+    p = argparse.ArgumentParser(description='generate the glyph tables of a firmware')
+    p.add_argument('-f', default=MASTER, help='master font (default: lib/font_5x8.h)')
+    p.add_argument('-c', default='', help='characters printed besides the literals')
+    p.add_argument('-o', required=True, help='generated header')
+    p.add_argument('sources', nargs='*')
+    a = p.parse_args()
+
+    font  = read_font(a.f)
+    chars = set(ord(c) for c in a.c)
+    for f in a.sources:
+        chars |= literals(f)
+    codes = sorted(c for c in chars if c in font and any(font[c]))
+
+    runs = runs_of(codes)
+    size = len(codes) * WIDTH + 2 * len(runs) + 2       # glyphs, runs and their end
+    full = len(font) * WIDTH + 4                        # all glyphs in one run
+    out  = ['// Glyph tables of this firmware for glyph.c, generated by tools/glyph_subset.py',
+            '// from %s - do not edit, run "make glyphs" instead' % os.path.basename(a.f),
+            '// %d of %d glyphs in %d runs, %d instead of %d bytes:'
+            % (len(codes), len(font), len(runs), size, full),
+            '// %s' % ''.join(chr(c) for c in codes),
+            '',
+            '#pragma once',
+            '',
+            '#include <stdint.h>',
+            '',
+            'const uint8_t GLYPH_runs[] = { %s0, 0 };' % ''.join('%d, %d, ' % (f, n) for f, n in runs),
+            '',
+            'const uint8_t GLYPH_font[] = {']
+    for c in codes:
+        out.append('  %s,  // %s' % (', '.join('0x%02X' % b for b in font[c]), show(c)))
+    if not codes:
+        out.append('  0')
+    out.append('};')
+    open(a.o, 'w').write('\n'.join(out) + '\n')
+    print('%s: %d glyphs in %d runs, %d bytes (all: %d bytes)'
+          % (a.o, len(codes), len(runs), size, full))
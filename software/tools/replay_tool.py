@@ -0,0 +1,103 @@
+#!/usr/bin/env python3
+# ===================================================================================
+# Project:   Input Recordings and Frame Hashes of the Games
+# Year:      2023
+# URL:       https://github.com/wagiminator
+# ===================================================================================
+#
+# Works on the telemetry streams of recorder and replay builds (see replay.h), as
+# captured from PD5 or written by the host simulator with "-u":
+#
+#   extract <stream> <out.rec>      recording file from the TLM_SEED / TLM_RUNS
+#                                   records (u16 seed, kind/value and count
+#                                   pairs, 0, 0)
+#   header  <in.rec> <out.h>        replay_data.h for "make replay"
+#   hashes  <stream>                list the frame hashes (tick, CRC-32)
+#   compare <stream a> <stream b>   compare the frame hashes of two runs tick by
+#                                   tick, exit code 1 on the first difference
+#
+# Recordings of the same game replay identically on the device and in the host
+# simulator ("bin/<game>_sim -r file.rec").
+# ===================================================================================
+
+import struct
+import sys
+
+from telemetry_decode import records, open_stream, run_count, SEED, RUNS, HASH
+
+
+def read_stream(name):
+    stream, follow = open_stream(name, 460800)
+    if follow:
+        sys.exit('%s: capture the stream into a file first' % name)
+    return list(records(stream, False))
+
+
+def extract(src, dst):
+    seed, pairs = None, bytearray()
+    for rtype, p in read_stream(src):
+        if rtype == SEED and seed is None:
+            seed = struct.unpack_from('<H', p)[0]
+        elif rtype == RUNS and seed is not None:
+            pairs += p[:len(p) & ~1]
+    if seed is None:
+        sys.exit('%s: no recording found (TLM_SEED record missing)' % src)
+    data = struct.pack('<H', seed) + pairs + b'\0\0'
+    with open(dst, 'wb') as f:
+        f.write(data)
+    print('%s: seed 0x%04X, %d reads in %d pairs, %d bytes' % (
+        dst, seed, sum(run_count(c) for c in pairs[1::2]), len(pairs) // 2, len(data)))
+
+
+def header(src, dst):
+    with open(src, 'rb') as f:
+        data = f.read()
+    if not data.endswith(b'\0\0'):
+        data += b'\0\0'
+    lines = ['// Input recording for make replay, generated by replay_tool.py from %s' % src,
+             '// (u16 seed of JOY_random(), pairs of kind/value and count byte, 0, 0)',
+             '',
+             'const uint8_t REC_DATA[] = {']
+    for i in range(0, len(data), 16):
+        lines.append('  ' + ', '.join('0x%02X' % b for b in data[i:i + 16]) + ',')
+    lines.append('};')
+    with open(dst, 'w') as f:
+        f.write('\n'.join(lines) + '\n')
+    print('%s: %d bytes' % (dst, len(data)))
+
+
+def frame_hashes(name):
+    return [struct.unpack_from('<II', p) for rtype, p in read_stream(name)
+            if rtype == HASH and len(p) >= 8]
+
+
+def compare(a, b):
+    ha, hb = dict(frame_hashes(a)), dict(frame_hashes(b))
+    common = sorted(set(ha) & set(hb))
+    for tick in common:
+        if ha[tick] != hb[tick]:
+            print('tick %d: %08X != %08X (%d frames equal before)' % (
+                tick, ha[tick], hb[tick], common.index(tick)))
+            sys.exit(1)
+    print('%d frames equal (%d / %d frames in the streams)' % (len(common), len(ha), len(hb)))
+
+
+def main():
+    cmd = sys.argv[1] if len(sys.argv) > 1 else ''
+    args = sys.argv[2:]
+    if cmd == 'extract' and len(args) == 2:
+        extract(*args)
+    elif cmd == 'header' and len(args) == 2:
+        header(*args)
+    elif cmd == 'hashes' and len(args) == 1:
+        for tick, crc in frame_hashes(args[0]):
+            print('tick %7d crc %08X' % (tick, crc))
+    elif cmd == 'compare' and len(args) == 2:
+        compare(*args)
+    else:
+        sys.exit('usage: replay_tool.py extract <stream> <out.rec> | header <in.rec> <out.h>\n'
+                 '                      | hashes <stream> | compare <stream a> <stream b>')
+
+
+if __name__ == '__main__':
+    main()
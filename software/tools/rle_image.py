@@ -0,0 +1,85 @@
+#!/usr/bin/env python3
+# ===================================================================================
+# Project:   Run-Length Encoder for OLED Images
+# Year:      2023
+# URL:       https://github.com/wagiminator
+# ===================================================================================
+#
+# Converts a raw bitmap array (e.g. a 1024-byte full screen image) of a C header
+# into the run-length encoded format decoded by OLED_rle_page() in oled_min.c:
+#   c = 0x00..0x7F: c+1 literal bytes follow
+#   c = 0x80..0xFF: the following byte is repeated c-0x7E times (2..129)
+#
+# Usage: python3 rle_image.py <header.h> <array name> [new array name]
+# The encoded array is printed to stdout.
+# ===================================================================================
+
+import re
+import sys
+
+
+def read_array(filename, name):
+    text = open(filename).read()
+    m = re.search(r'\b' + re.escape(name) + r'\s*\[\]\s*=\s*\{(.*?)\}', text, re.S)
+    if not m:
+        sys.exit('array %s not found in %s' % (name, filename))
+    body = re.sub(r'//.*', '', m.group(1))
+    return [int(v, 0) for v in body.replace('\n', ' ').split(',') if v.strip()]
+
+
+def encode(data):
+    out = []
+    lit = []
+
+    def flush():
+        while lit:
+            chunk = lit[:128]
+            del lit[:128]
+            out.append(len(chunk) - 1)
+            out.extend(chunk)
+
+    i = 0
+    while i < len(data):
+        run = 1
+        while i + run < len(data) and run < 129 and data[i + run] == data[i]:
+            run += 1
+        # a run of 2 only pays off if it doesn't split a literal block
+        if run >= 3 or (run == 2 and not lit):
+            flush()
+            out.append(0x7E + run)
+            out.append(data[i])
+            i += run
+        else:
+            lit.append(data[i])
+            i += 1
+    flush()
+    return out
+
+
+def decode(data, length):
+    out = []
+    i = 0
+    while len(out) < length:
+        c = data[i]
+        if c < 0x80:
+            out.extend(data[i + 1:i + c + 2])
+            i += c + 2
+        else:
+            out.extend([data[i + 1]] * (c - 0x7E))
+            i += 2
+    return out
+
+
+if __name__ == '__main__':
+    if len(sys.argv) < 3:
+        sys.exit('usage: rle_image.py <header.h> <array name> [new array name]')
+    raw = read_array(sys.argv[1], sys.argv[2])
+    rle = encode(raw)
+    assert decode(rle, len(raw)) == raw
+    name = sys.argv[3] if len(sys.argv) > 3 else sys.argv[2]
+    print('// %d bytes run-length encoded (raw: %d bytes)' % (len(rle), len(raw)))
+    print('const uint8_t %s[] = {' % name)
+    for i in range(0, len(rle), 16):
+        line = ', '.join('0x%02X' % b for b in rle[i:i + 16])
+        print('  ' + line + (',' if i + 16 < len(rle) else ''))
+    print('};')
@@ -0,0 +1,146 @@
+#!/usr/bin/env python3
+# ===================================================================================
+# Project:   Decoder for the UART Telemetry Stream of the Games
+# Year:      2023
+# URL:       https://github.com/wagiminator
+# ===================================================================================
+#
+# Decodes the binary records sent by telemetry.c (TLM_ENABLE 1) and by benchmark
+# builds (make bench, see bench.h) and input recorder builds (make record / replay,
+# see replay.h) on PD5:
+#   0xA5, type, len, payload[len], sum       sum = type + len + payload (mod 256)
+# Bytes that don't form a valid record are skipped until the next sync byte, so
+# the decoder can be started at any time.
+#
+# Usage: python3 telemetry_decode.py <serial port | capture file> [baud]
+#        (a serial port needs pyserial, default baud rate is 460800)
+# One line per record is printed; Ctrl+C prints a summary of the frame times.
+# ===================================================================================
+
+import struct
+import sys
+
+SYNC = 0xA5
+INFO, FRAME, INPUT, COUNTER, DROP, BENCH, SEED, RUNS, HASH, STARTUP = range(1, 11)
+PHASES = ['logic', 'input', 'compose', 'i2c', 'sound', 'idle']
+EVENTS = ['none', 'act-press', 'act-release', 'pad-press', 'pad-release']
+COUNTERS = ['score', 'lines', 'level', 'lives', 'stack', 'gray', 'bus_err', 'bus_rec',
+            'lat_min', 'lat_avg', 'lat_p99', 'lat_max', 'lat_lost', 'bat_level', 'bat_mv']
+STAGES = ['data', 'bss', 'clock', 'oled', 'init', 'frame', 'pad', 'shown']
+
+
+def run_count(c):
+    # count byte of a TLM_RUNS pair: e << 5 | m stands for m << 3e reads
+    return (c & 31) << (3 * (c >> 5))
+
+
+def records(stream, follow):
+    buf = bytearray()
+    while True:
+        data = stream.read(64)
+        if not data:
+            if not follow:
+                return              # end of capture file
+            continue                # serial port timeout
+        buf += data
+        while len(buf) >= 4:
+            if buf[0] != SYNC:
+                del buf[0]
+                continue
+            n = buf[2]
+            if len(buf) < n + 4:
+                break
+            body = buf[1:n + 3]
+            if sum(body) & 0xFF != buf[n + 3]:
+                del buf[0]
+                continue
+            yield body[0], bytes(body[2:])
+            del buf[:n + 4]
+
+
+class Decoder:
+    def __init__(self):
+        self.us = None              # microseconds per time unit (after TLM_INFO)
+        self.frames = 0
+        self.dropped = 0
+        self.busy = []
+
+    def time(self, v):
+        return '%.1fus' % (v * self.us) if self.us else '%d' % v
+
+    def record(self, rtype, p):
+        if rtype == INFO and len(p) >= 6:
+            stk_freq, shift, phases = struct.unpack_from('<IBB', p)
+            # SysTick counts at STK_FREQ (F_CPU without clock profiles)
+            self.us = 1e6 * (1 << shift) / stk_freq
+            return 'info    STK_FREQ=%d shift=%d phases=%d' % (stk_freq, shift, phases)
+        if rtype == FRAME and len(p) >= 3:
+            tick, rendered = struct.unpack_from('<HB', p)
+            t = struct.unpack_from('<%dH' % ((len(p) - 3) // 2), p, 3)
+            self.frames += 1
+            if t:
+                self.busy.append(sum(t) - (t[5] if len(t) > 5 else 0))
+            s = ' '.join('%s=%s' % (PHASES[i] if i < len(PHASES) else i, self.time(v))
+                         for i, v in enumerate(t))
+            return 'frame   %5d %s %s' % (tick, 'R' if rendered else '-', s)
+        if rtype == INPUT and len(p) >= 6:
+            etype, dirs, time = struct.unpack_from('<BBI', p)
+            name = EVENTS[etype] if etype < len(EVENTS) else str(etype)
+            return 'input   %-11s dirs=0x%02X t=%s' % (name, dirs, self.time(time))
+        if rtype == COUNTER and len(p) >= 5:
+            cid, value = struct.unpack_from('<BI', p)
+            name = COUNTERS[cid] if cid < len(COUNTERS) else 'id%d' % cid
+            return 'counter %s=%d' % (name, value)
+        if rtype == DROP and len(p) >= 2:
+            n, = struct.unpack_from('<H', p)
+            self.dropped += n
+            return 'drop    %d records' % n
+        if rtype == BENCH and len(p) >= 20:
+            ticks, renders, total, tmin, tmax, nbytes = struct.unpack_from('<HHIIII', p)
+            return ('bench   %d ticks, %d rendered: cycles/tick min %d avg %d max %d, '
+                    'cycles/rendered frame %d, I2C bytes/rendered frame %d' % (
+                        ticks, renders, tmin, total // max(ticks, 1), tmax,
+                        total // max(renders, 1), nbytes // max(renders, 1)))
+        if rtype == SEED and len(p) >= 2:
+            return 'seed    0x%04X' % struct.unpack_from('<H', p)
+        if rtype == RUNS:
+            return 'runs    ' + ' '.join('%s%02X*%d' % ('acp?'[p[i] >> 6], p[i] & 0x3F, run_count(p[i + 1]))
+                                         for i in range(0, len(p) - 1, 2))
+        if rtype == HASH and len(p) >= 8:
+            return 'hash    tick %7d crc %08X' % struct.unpack_from('<II', p)
+        if rtype == STARTUP and len(p) >= 5:
+            stage, us = struct.unpack_from('<BI', p)
+            name = STAGES[stage] if stage < len(STAGES) else 'stage%d' % stage
+            return 'startup %-6s %8.3fms' % (name, us / 1000.0)
+        return 'unknown type %d: %s' % (rtype, p.hex())
+
+    def summary(self):
+        print('%d frame records, %d records dropped' % (self.frames, self.dropped))
+        if self.busy:
+            b = sorted(self.busy)
+            print('busy per tick: min %s  avg %s  max %s' % (
+                self.time(b[0]), self.time(sum(b) / len(b)), self.time(b[-1])))
+
+
+def open_stream(name, baud):
+    if name.startswith('/dev/') or name.upper().startswith('COM'):
+        import serial
+        return serial.Serial(name, baud, timeout=0.1), True
+    return open(name, 'rb'), False
+
+
+def main():
+    if len(sys.argv) < 2:
+        sys.exit('usage: telemetry_decode.py <port | file> [baud]')
+    baud = int(sys.argv[2]) if len(sys.argv) > 2 else 460800
+    dec = Decoder()
+    try:
+        for rtype, payload in records(*open_stream(sys.argv[1], baud)):
+            print(dec.record(rtype, payload))
+    except KeyboardInterrupt:
+        pass
+    dec.summary()
+
+
+if __name__ == '__main__':
+    main()